@@ -0,0 +1,71 @@
+#ifndef GLA_AFFINE_TRANSFORM_H
+#define GLA_AFFINE_TRANSFORM_H
+
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <GLA/vertexArray.h>
+
+namespace gla {
+
+/**
+ * @brief Affine transform stored as a 3x4 matrix, the constant last row (0, 0, 0, 1) of a mat4 is left out.
+ *
+ * At 48 instead of 64 bytes it shrinks per object and per instance data by a quarter. The matrix is a glm::mat4x3, so it
+ * converts to the Program::setUniform() overload for mat4x3 without a copy and is read in GLSL as mat4x3, either as
+ * uniform or as instance attribute (see instanceAttributes()), with worldPosition = transform * vec4(position, 1.0).
+ *
+ * Composition, inversion and point transforms use SSE2 on x86.
+ */
+struct AffineTransform {
+    glm::mat4x3 matrix = glm::mat4x3(1.0f); ///< Columns x, y and z axis and translation.
+
+    AffineTransform() = default;
+    explicit AffineTransform(const glm::mat4x3& matrix) : matrix(matrix) {}
+
+    /**
+     * @brief Construct a new AffineTransform from a mat4 whose last row is (0, 0, 0, 1), which is not checked.
+     */
+    explicit AffineTransform(const glm::mat4& matrix) : matrix(matrix) {}
+
+    /**
+     * @brief Construct a new AffineTransform applying scale, rotation and translation in this order.
+     */
+    AffineTransform(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale = glm::vec3(1.0f));
+
+    glm::mat4 toMat4() const { return glm::mat4(matrix); } ///< Gets the transform as mat4 with the last row (0, 0, 0, 1).
+
+    /**
+     * @brief Composes two transforms, other is applied first.
+     */
+    AffineTransform operator*(const AffineTransform& other) const;
+    AffineTransform& operator*=(const AffineTransform& other) { return *this = *this * other; }
+
+    /**
+     * @brief Computes the inverse transform.
+     *
+     * @throws std::invalid_argument If the transform is singular
+     */
+    AffineTransform inverse() const;
+
+    glm::vec3 transformPoint(const glm::vec3& point) const;             ///< Gets matrix * vec4(point, 1).
+    glm::vec3 transformDirection(const glm::vec3& direction) const;     ///< Gets matrix * vec4(direction, 0).
+
+    operator const glm::mat4x3&() const { return matrix; }
+
+    /**
+     * @brief Gets the attributes of an instanced mat4x3 attribute, which takes the four locations starting at location.
+     *
+     * @param offset Offset of the AffineTransform in the instance data
+     * @param divisor Instances per transform
+     */
+    static std::vector<VertexAttribute> instanceAttributes(unsigned int location, int offset = 0, unsigned int divisor = 1);
+};
+
+static_assert(sizeof(AffineTransform) == 12 * sizeof(float), "AffineTransform must be tightly packed!");
+
+}
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef GLA_ASSET_PACK_H
+#define GLA_ASSET_PACK_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <stdexcept>
+
+#include <GLA/mappedFile.h>
+
+namespace gla {
+
+/**
+ * @brief Exception thrown when an asset pack is invalid or an entry fails verification.
+ */
+class AssetPackError : public std::runtime_error {
+public:
+    /**
+     * @brief Construct a new Asset Pack Error object.
+     *
+     * @param message Description of what is wrong with the pack.
+     */
+    AssetPackError(const std::string& message)
+        : std::runtime_error(
+              "Asset pack is invalid:\n" + message) {}
+};
+
+constexpr uint32_t kAssetPackMagic = 0x50414C47;   ///< "GLAP" in little endian.
+constexpr uint32_t kAssetPackVersion = 1;          ///< Version written by AssetPackWriter, packs with a different version are rejected.
+constexpr uint64_t kAssetPackAlignment = 4096;     ///< Alignment of every blob, matches the page size so blobs can be mapped and uploaded in place.
+
+/**
+ * @brief Enum flags of an asset pack entry.
+ */
+enum class AssetFlag : uint32_t {
+    None        = 0,
+    Compressed  = 1 << 0 ///< The blob is a raw LZ4 block.
+};
+
+inline AssetFlag operator|(AssetFlag a, AssetFlag b) {
+    return static_cast<AssetFlag>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+}
+
+inline AssetFlag operator&(AssetFlag a, AssetFlag b) {
+    return static_cast<AssetFlag>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+}
+
+/**
+ * @brief Header at the start of an asset pack.
+ *
+ * File layout (little endian): header, index sorted by nameHash, name table, blobs aligned to kAssetPackAlignment.
+ */
+struct AssetPackHeader {
+    uint32_t magic;         ///< kAssetPackMagic.
+    uint32_t version;       ///< kAssetPackVersion.
+    uint32_t entryCount;    ///< Amount of AssetPackEntry entries in the index.
+    uint32_t reserved;
+    uint64_t indexOffset;   ///< Offset of the index.
+    uint64_t namesOffset;   ///< Offset of the name table.
+    uint64_t namesSize;     ///< Size of the name table in bytes.
+};
+static_assert(sizeof(AssetPackHeader) == 40, "AssetPackHeader must not contain padding!");
+
+/**
+ * @brief Index entry of an asset pack.
+ */
+struct AssetPackEntry {
+    uint64_t nameHash;      ///< FNV-1a hash of the name, the index is sorted by it.
+    uint64_t contentHash;   ///< FNV-1a hash of the uncompressed content.
+    uint64_t offset;        ///< Offset of the blob.
+    uint64_t storedSize;    ///< Size of the blob in the pack.
+    uint64_t size;          ///< Size of the uncompressed content.
+    uint32_t nameOffset;    ///< Offset of the name in the name table.
+    uint32_t nameLength;    ///< Length of the name in bytes.
+    uint32_t flags;         ///< gla::AssetFlag
+    uint32_t reserved;
+};
+static_assert(sizeof(AssetPackEntry) == 56, "AssetPackEntry must not contain padding!");
+
+/**
+ * @brief Hashes an asset name the way the pack index does.
+ */
+uint64_t assetNameHash(std::string_view name);
+
+/**
+ * @brief Builds an asset pack file.
+ */
+class AssetPackWriter {
+private:
+    struct Asset {
+        std::string name;
+        std::vector<uint8_t> data;
+        bool compress;
+    };
+
+    std::vector<Asset> _assets;
+
+public:
+    /**
+     * @brief Adds an asset to the pack.
+     *
+     * @throws std::invalid_argument If an asset with the same name was already added
+     *
+     * @param name Name the asset is looked up with, e.g. "shaders/basicTriangle/vertex.shader"
+     * @param data Content of the asset
+     * @param compress Compress the asset with LZ4, kept uncompressed if that doesn't save at least 1/8 of its size
+     */
+    void add(const std::string& name, std::vector<uint8_t> data, bool compress = false);
+
+    /**
+     * @brief Writes all added assets into a pack file.
+     *
+     * @throws std::runtime_error If the file can't be written
+     */
+    void write(const std::string& path) const;
+};
+
+/**
+ * @brief Memory mapped asset pack.
+ *
+ * Opening a pack maps one file and validates its index, lookups binary search the sorted hash index.
+ * Uncompressed assets are served as spans into the mapping, so shader sources, mesh files and texture data
+ * are read by the loaders straight from the page cache without any copy.
+ *
+ * @note All methods are const and thread-safe.
+ */
+class AssetPack {
+private:
+    MappedFile _file;
+    const AssetPackHeader* _header = nullptr;
+    const AssetPackEntry* _entries = nullptr;
+    const char* _names = nullptr;
+
+    const AssetPackEntry& _get(std::string_view name) const;
+
+public:
+    /**
+     * @brief Maps and validates an asset pack.
+     *
+     * @throws std::invalid_argument If the file can't be opened
+     * @throws gla::AssetPackError If the file is not an asset pack, has an unsupported version or an entry lies outside of the file
+     */
+    AssetPack(const std::string& path);
+    AssetPack(AssetPack&& other) = default;
+    AssetPack(const AssetPack& other) = delete;
+
+    /**
+     * @brief Finds the index entry of an asset.
+     *
+     * @return The entry or nullptr if the pack contains no asset with that name
+     */
+    const AssetPackEntry* find(std::string_view name) const;
+
+    /**
+     * @brief Checks if the pack contains an asset.
+     */
+    bool contains(std::string_view name) const { return find(name) != nullptr; }
+
+    /**
+     * @brief Gets the stored bytes of an uncompressed asset without copying.
+     *
+     * @throws std::out_of_range If the pack contains no asset with that name
+     * @throws std::logic_error If the asset is compressed, use read() instead
+     */
+    std::span<const uint8_t> view(std::string_view name) const;
+
+    /**
+     * @brief Gets the content of an asset, zero copy if it is uncompressed.
+     *
+     * @throws std::out_of_range If the pack contains no asset with that name
+     * @throws std::runtime_error If a compressed asset is corrupt
+     *
+     * @param storage Receives the decompressed content of compressed assets and must outlive the returned span
+     */
+    std::span<const uint8_t> read(std::string_view name, std::vector<uint8_t>& storage) const;
+
+    /**
+     * @brief Gets the content of a text asset, e.g. a shader source for Shader::compile(std::string_view).
+     *
+     * @throws std::out_of_range If the pack contains no asset with that name
+     * @throws std::runtime_error If a compressed asset is corrupt
+     *
+     * @param storage Receives the decompressed content of compressed assets and must outlive the returned view
+     */
+    std::string_view text(std::string_view name, std::vector<uint8_t>& storage) const;
+
+    /**
+     * @brief Checks the content hash of an asset.
+     *
+     * @throws std::out_of_range If the pack contains no asset with that name
+     *
+     * @return true if the content matches the hash stored when the pack was built
+     */
+    bool verify(std::string_view name) const;
+
+    /**
+     * @brief Gets the amount of assets in the pack.
+     */
+    size_t size() const { return _header->entryCount; }
+
+    /**
+     * @brief Gets all index entries sorted by name hash.
+     */
+    std::span<const AssetPackEntry> entries() const { return { _entries, _header->entryCount }; }
+
+    /**
+     * @brief Gets the name of an index entry.
+     */
+    std::string_view name(const AssetPackEntry& entry) const { return { _names + entry.nameOffset, entry.nameLength }; }
+
+    AssetPack& operator=(AssetPack&& other) = default;
+    AssetPack& operator=(const AssetPack& other) = delete;
+};
+
+}
+
+#endif
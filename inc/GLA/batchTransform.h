@@ -0,0 +1,110 @@
+#ifndef GLA_BATCH_TRANSFORM_H
+#define GLA_BATCH_TRANSFORM_H
+
+/**
+ * @file batchTransform.h
+ * @brief Transforms of large arrays of glm vectors, matrices and boxes by one matrix.
+ *
+ * The kernels process 4 (SSE2) or 8 (AVX, selected at runtime) elements per instruction, arrays of vec3 are transposed
+ * into registers on the fly. Arrays longer than a few thousand elements are split into chunks run on the ThreadPool.
+ * result may be the same array as the input, but the arrays must not partially overlap.
+ */
+
+#include <span>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/bvh.h>
+#include <GLA/threadPool.h>
+
+namespace gla {
+
+/**
+ * @brief Array of vec3 stored as one array per component (structure of arrays).
+ */
+struct Vec3SoA {
+    std::vector<float> x; ///< x components.
+    std::vector<float> y; ///< y components.
+    std::vector<float> z; ///< z components.
+
+    size_t size() const { return x.size(); }
+    void resize(size_t size) { x.resize(size); y.resize(size); z.resize(size); }
+};
+
+/**
+ * @brief Transforms points by an affine matrix, the projective row of the matrix is ignored.
+ *
+ * @throws std::invalid_argument If result doesn't have the size of points
+ */
+void transformPoints(const glm::mat4& matrix, std::span<const glm::vec3> points, std::span<glm::vec3> result, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Transforms points stored as structure of arrays, see transformPoints().
+ *
+ * @throws std::invalid_argument If the component arrays of points differ in size
+ *
+ * @note result is resized to the size of points.
+ */
+void transformPoints(const glm::mat4& matrix, const Vec3SoA& points, Vec3SoA& result, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Transforms directions by the upper 3x3 part of a matrix, they are not normalized.
+ *
+ * @throws std::invalid_argument If result doesn't have the size of directions
+ */
+void transformDirections(const glm::mat4& matrix, std::span<const glm::vec3> directions, std::span<glm::vec3> result, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Transforms directions stored as structure of arrays, see transformDirections().
+ *
+ * @throws std::invalid_argument If the component arrays of directions differ in size
+ *
+ * @note result is resized to the size of directions.
+ */
+void transformDirections(const glm::mat4& matrix, const Vec3SoA& directions, Vec3SoA& result, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Multiplies homogeneous vectors by a matrix, result[i] = matrix * vectors[i].
+ *
+ * @throws std::invalid_argument If result doesn't have the size of vectors
+ */
+void transformVectors(const glm::mat4& matrix, std::span<const glm::vec4> vectors, std::span<glm::vec4> result, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Computes the axis aligned boxes bounding the boxes transformed by an affine matrix.
+ *
+ * @throws std::invalid_argument If result doesn't have the size of boxes
+ */
+void transformAABBs(const glm::mat4& matrix, std::span<const BvhBox> boxes, std::span<BvhBox> result, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Multiplies an array of matrices by one matrix from the left, result[i] = lhs * rhs[i].
+ *
+ * @throws std::invalid_argument If result doesn't have the size of rhs
+ */
+void multiplyMatrices(const glm::mat4& lhs, std::span<const glm::mat4> rhs, std::span<glm::mat4> result, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Multiplies two arrays of matrices element wise, result[i] = lhs[i] * rhs[i].
+ *
+ * @throws std::invalid_argument If the arrays don't have the same size
+ */
+void multiplyMatrices(std::span<const glm::mat4> lhs, std::span<const glm::mat4> rhs, std::span<glm::mat4> result, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Converts an array of vec3 into a structure of arrays, result is resized to the size of vectors.
+ */
+void toSoA(std::span<const glm::vec3> vectors, Vec3SoA& result);
+
+/**
+ * @brief Converts a structure of arrays into an array of vec3.
+ *
+ * @throws std::invalid_argument If result doesn't have the size of vectors or the component arrays of vectors differ in size
+ */
+void toAoS(const Vec3SoA& vectors, std::span<glm::vec3> result);
+
+}
+
+#endif
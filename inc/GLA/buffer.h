@@ -154,6 +154,11 @@ unsigned int toGLenum(MapUsage usage);
  */
 unsigned int toGLenum(BufferFlag flag);
 
+/**
+ * @brief Checks if the given BufferType has indexed binding points (glBindBufferBase / glBindBufferRange).
+ */
+bool indexedBufferType(BufferType type);
+
 /**
  * @brief Checks if the given MapUsage flag combination is valid.  
  * 
@@ -200,6 +205,53 @@ public:
      */
     void bind() const;
 
+    /**
+     * @brief Binds the whole Buffer to an indexed binding point of its type.
+     * 
+     * @throws std::logic_error If the BufferType has no indexed binding points (only AtomicCounter, ShaderStorage, TransformFeedback and Uniform have)
+     * 
+     * @param index The binding point index, e.g. layout(binding = index) in GLSL
+     */
+    void bindBase(unsigned int index) const;
+
+    /**
+     * @brief Binds a range of the Buffer to an indexed binding point of its type.
+     * 
+     * @throws std::logic_error If the BufferType has no indexed binding points (only AtomicCounter, ShaderStorage, TransformFeedback and Uniform have)
+     * @throws std::runtime_error If offset is negative or size is not greater than 0
+     * 
+     * @note offset has to be a multiple of the offset alignment of the binding point type (e.g. GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT).
+     * 
+     * @param index The binding point index, e.g. layout(binding = index) in GLSL
+     * @param offset The offset of the range in bytes
+     * @param size The size of the range in bytes
+     */
+    void bindRange(unsigned int index, int64_t offset, int64_t size) const;
+
+    /**
+     * @brief Binds the Buffer to the binding point of another BufferType.
+     * 
+     * Useful when one Buffer is used in several roles, e.g. written as BufferType::ShaderStorage and read as BufferType::DrawIndirect.
+     * 
+     * @param target The BufferType whose binding point is used
+     */
+    void bind(BufferType target) const;
+
+    /**
+     * @brief Binds the whole Buffer to an indexed binding point of another BufferType.
+     * 
+     * @throws std::logic_error If target has no indexed binding points
+     * 
+     * @param target The BufferType whose binding points are used
+     * @param index The binding point index
+     */
+    void bindBase(BufferType target, unsigned int index) const;
+
+    /**
+     * @brief Gets the underlying OpenGL buffer object name for low level OpenGL access.
+     */
+    unsigned int id() const { return _id; }
+
     /**
      * @brief Returns the size in bytes of the Buffer. 
      */
@@ -0,0 +1,186 @@
+#ifndef GLA_BVH_H
+#define GLA_BVH_H
+
+#include <span>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <functional>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/threadPool.h>
+
+namespace gla {
+
+/**
+ * @brief Axis aligned bounding box of a primitive in a gla::Bvh.
+ */
+struct BvhBox {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+/**
+ * @brief Node of a flattened gla::Bvh, two nodes share a 64 byte cache line.
+ *
+ * Nodes are stored depth first: the first child of an interior node directly follows it.
+ */
+struct BvhNode {
+    glm::vec3 min;
+    uint32_t offset;    ///< Interior nodes: index of the second child, leaves: first primitive (or triangle pack).
+    glm::vec3 max;
+    uint32_t count;     ///< Amount of primitives in a leaf, 0 for interior nodes.
+};
+static_assert(sizeof(BvhNode) == 32, "BvhNode must be 32 bytes!");
+
+/**
+ * @brief Ray with a maximum distance, the direction does not have to be normalized.
+ */
+struct Ray {
+    glm::vec3 origin = glm::vec3(0.0f);
+    glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    float maxDistance = std::numeric_limits<float>::infinity(); ///< In multiples of direction.
+};
+
+/**
+ * @brief Nearest intersection found by a ray cast.
+ */
+struct RayHit {
+    float distance = std::numeric_limits<float>::infinity(); ///< In multiples of the ray direction.
+    uint32_t primitive = UINT32_MAX;    ///< Primitive (triangle) index, UINT32_MAX if nothing was hit.
+    glm::vec2 barycentric = glm::vec2(0.0f); ///< Weights of the second and third triangle vertex.
+
+    bool hit() const { return primitive != UINT32_MAX; }
+};
+
+/**
+ * @brief Creates the world space ray through a cursor position, e.g. for mouse picking.
+ *
+ * @param cursor Cursor position in pixels, origin at the top left as reported by GLFW
+ * @param viewportSize Size of the viewport in pixels
+ * @param viewProjection Matrix the scene is rendered with
+ */
+Ray pickRay(const glm::vec2& cursor, const glm::vec2& viewportSize, const glm::mat4& viewProjection);
+
+/**
+ * @brief Bounding volume hierarchy over arbitrary boxes, e.g. the world space bounds of instances.
+ *
+ * The hierarchy is built with the binned surface area heuristic. Large nodes are binned in parallel
+ * and independent subtrees are built on different threads of a ThreadPool.
+ * Nodes are flattened depth first into one array, rays visit the nearer child first and test boxes with SSE.
+ *
+ * refit() updates the bounds of moved primitives without changing the topology, which is far cheaper
+ * than a rebuild and stays efficient as long as primitives don't move too far from where they were built.
+ *
+ * @note Queries are const and may run concurrently, build() and refit() must not run concurrently with anything.
+ */
+class Bvh {
+private:
+    std::vector<BvhNode> _nodes;
+    std::vector<uint32_t> _indices;
+    std::vector<BvhBox> _boxes;     // primitive boxes in leaf order
+
+public:
+    /**
+     * @brief Construct an empty Bvh.
+     */
+    Bvh() = default;
+
+    /**
+     * @brief Construct a Bvh over boxes, see build().
+     */
+    Bvh(std::span<const BvhBox> boxes, int maxLeafSize = 4, ThreadPool& pool = ThreadPool::shared()) { build(boxes, maxLeafSize, pool); }
+
+    /**
+     * @brief Builds the hierarchy over boxes, primitive indices are the indices into boxes.
+     *
+     * @throws std::invalid_argument If maxLeafSize is not greater than 0
+     *
+     * @param maxLeafSize Maximum amount of primitives in a leaf
+     */
+    void build(std::span<const BvhBox> boxes, int maxLeafSize = 4, ThreadPool& pool = ThreadPool::shared());
+
+    /**
+     * @brief Updates all node bounds after the primitives moved, the topology is kept.
+     *
+     * @throws std::invalid_argument If the amount of boxes differs from the last build()
+     */
+    void refit(std::span<const BvhBox> boxes);
+
+    /**
+     * @brief Finds the nearest primitive hit by a ray.
+     *
+     * @param intersect Called for primitives whose box is hit closer than the nearest hit so far,
+     *                  returns the distance along the ray or infinity on a miss
+     */
+    RayHit raycast(const Ray& ray, const std::function<float(uint32_t primitive, const Ray& ray, float maxDistance)>& intersect) const;
+
+    /**
+     * @brief Collects all primitives whose box overlaps box.
+     *
+     * @param result Primitive indices are appended to it
+     */
+    void overlap(const BvhBox& box, std::vector<uint32_t>& result) const;
+
+    const std::vector<BvhNode>& nodes() const { return _nodes; }
+    const std::vector<uint32_t>& indices() const { return _indices; }  ///< Primitive indices in leaf order.
+    size_t size() const { return _indices.size(); }                   ///< Gets the amount of primitives.
+};
+
+/**
+ * @brief Bounding volume hierarchy over a triangle mesh for ray casts.
+ *
+ * Built like gla::Bvh with at most 4 triangles per leaf, whose vertices are stored as one structure of arrays pack
+ * per leaf in traversal order. A leaf is tested with one 4 wide SSE ray/triangle intersection
+ * and picking a mesh with millions of triangles takes microseconds.
+ *
+ * @note raycast() is const and may run concurrently, refit() must not run concurrently with anything.
+ */
+class TriangleBvh {
+private:
+    struct alignas(16) Pack {
+        float v0[3][4];     // first vertex, x y z of 4 triangles
+        float e1[3][4];     // second - first vertex
+        float e2[3][4];     // third - first vertex
+        uint32_t triangle[4];
+    };
+
+    std::vector<BvhNode> _nodes;
+    std::vector<Pack> _packs;
+    std::vector<uint32_t> _indices;
+    ThreadPool& _pool;
+
+    void _fillPacks(std::span<const glm::vec3> positions);
+
+public:
+    /**
+     * @brief Builds the hierarchy over an indexed triangle list, the indices are copied.
+     *
+     * @throws std::invalid_argument If the amount of indices is not a multiple of 3
+     * @throws std::out_of_range If an index is out of range
+     */
+    TriangleBvh(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, ThreadPool& pool = ThreadPool::shared());
+
+    /**
+     * @brief Updates the triangles and node bounds after the vertices moved, the topology is kept.
+     *
+     * @throws std::out_of_range If an index is out of range
+     */
+    void refit(std::span<const glm::vec3> positions);
+
+    /**
+     * @brief Finds the nearest triangle hit by a ray, back faces are hit as well.
+     *
+     * RayHit::primitive is the index of the triangle in the index list divided by 3.
+     */
+    RayHit raycast(const Ray& ray) const;
+
+    const std::vector<BvhNode>& nodes() const { return _nodes; }
+    size_t triangleCount() const { return _indices.size() / 3; }
+};
+
+}
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef GLA_CASCADED_SHADOWS_H
+#define GLA_CASCADED_SHADOWS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/buffer.h>
+#include <GLA/texture.h>
+#include <GLA/framebuffer.h>
+
+namespace gla {
+
+/**
+ * @brief Settings of a gla::CascadedShadows.
+ */
+struct CascadedShadowSettings {
+    int cascades = 4;               ///< Amount of cascades, at most 8.
+    int resolution = 2048;          ///< Width and height of every cascade in texels, must be even.
+    float maxDistance = 100.0f;     ///< View depth up to which shadows are drawn, clamped to the far plane.
+    float splitLambda = 0.75f;      ///< Blend between uniform (0) and logarithmic (1) cascade splits.
+    float casterDistance = 200.0f;  ///< Distance towards the light in front of a cascade in which objects still cast shadows.
+    unsigned int textureUnit = 6;   ///< Texture unit of the shadow map in glslSource().
+    unsigned int binding = 7;       ///< Shader storage binding of the cascade matrices in glslSource().
+};
+
+/**
+ * @brief Cascaded shadow maps of a directional light with cached static casters.
+ *
+ * Every cascade covers the bounding sphere of its slice of the view frustum, so its size does not change when the camera
+ * rotates, and its light space position is snapped to whole texels, so shadow edges don't shimmer when the camera moves.
+ * Because of this a static object always lands on the same texels with the same depth, which allows caching:
+ * static casters are drawn into a cache layer that is only redrawn when the light turns, the projection changes
+ * or invalidateStatic() is called. When the camera moves, a cascade is scrolled by whole texels, the still valid
+ * part of its cache is shifted with a GPU copy and only the uncovered border strips are drawn with a scissor.
+ *
+ * Every frame the cache is copied into the sampled shadow map and the dynamic casters are drawn on top of it,
+ * so only moving objects are drawn every frame.
+ *
+ * @warning CascadedShadows must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class CascadedShadows {
+public:
+    /**
+     * @brief Draws shadow casters into a cascade, the depth framebuffer, viewport and scissor are already set.
+     */
+    using DrawCallback = std::function<void(int cascade, const glm::mat4& viewProjection)>;
+
+private:
+    struct Cascade {
+        glm::mat4 viewProjection = glm::mat4(1.0f);
+        int64_t originX = 0;    // light space center in texels
+        int64_t originY = 0;
+        float radius = 0.0f;
+        float depthCenter = 0.0f;   // quantized light space depth of the center
+        float split = 0.0f;         // view depth the cascade ends at
+        bool cached = false;        // the cache layer holds the static casters at origin
+    };
+
+    CascadedShadowSettings _settings;
+    Texture _cache;
+    Texture _shadowMap;
+    std::vector<Framebuffer> _cacheFramebuffers;
+    std::vector<Framebuffer> _shadowFramebuffers;
+    Buffer _cascadeBuffer;
+    std::vector<Cascade> _cascades;
+    glm::vec3 _lightDirection = glm::vec3(0.0f);
+    int64_t _staticTexels = 0;
+
+    void _drawStatic(int cascade, int x, int y, int width, int height, const DrawCallback& drawStatic);
+    void _scroll(int cascade, int dx, int dy);
+
+public:
+    /**
+     * @brief Construct new CascadedShadows and allocates the cache and shadow map.
+     *
+     * @throws std::invalid_argument If the amount of cascades is not within 1 and 8 or the resolution is not even and greater than 0
+     */
+    CascadedShadows(const CascadedShadowSettings& settings = {});
+    CascadedShadows(CascadedShadows&& other) = delete;
+    CascadedShadows(const CascadedShadows& other) = delete;
+
+    /**
+     * @brief Updates the cascades for a camera and draws what is not cached, call once per frame before shading.
+     *
+     * The current framebuffer, viewport and the depth and scissor test are restored afterwards.
+     *
+     * @throws std::invalid_argument If projection is not a perspective projection or lightDirection is zero
+     *
+     * @param view Matrix transforming world into view space
+     * @param projection Perspective projection of the camera
+     * @param lightDirection World space direction the light shines in
+     * @param drawStatic Draws the static casters, only called for cascades or strips that are not cached
+     * @param drawDynamic Draws the moving casters on top of the cache, called for every cascade
+     */
+    void update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& lightDirection,
+                const DrawCallback& drawStatic, const DrawCallback& drawDynamic);
+
+    /**
+     * @brief Marks the whole cache as outdated, e.g. after static objects were added, removed or moved.
+     */
+    void invalidateStatic();
+
+    /**
+     * @brief Binds the shadow map and the cascade matrices for shaders using glslSource().
+     */
+    void bind() const;
+
+    /**
+     * @brief Gets GLSL code declaring the shadow map and float cascadedShadow(vec3 worldPosition, float viewDepth, float bias),
+     * which returns 1 for lit and 0 for shadowed positions with 2x2 hardware filtering.
+     *
+     * @note The code has to be inserted after the #version directive.
+     */
+    std::string glslSource() const;
+
+    /**
+     * @brief Gets the matrix transforming world space into the clip space of a cascade.
+     *
+     * @throws std::out_of_range If cascade is out of range
+     */
+    const glm::mat4& viewProjection(int cascade) const { return _cascades.at(cascade).viewProjection; }
+
+    /**
+     * @brief Gets the view depth a cascade ends at.
+     *
+     * @throws std::out_of_range If cascade is out of range
+     */
+    float split(int cascade) const { return _cascades.at(cascade).split; }
+
+    /**
+     * @brief Gets the amount of texels the static casters were drawn into by the last update(), 0 if everything was cached.
+     */
+    int64_t staticTexelsDrawn() const { return _staticTexels; }
+
+    const Texture& shadowMap() const { return _shadowMap; }     ///< Depth32F array with one layer per cascade, depth compare enabled.
+    const Texture& cache() const { return _cache; }             ///< Static casters only, one layer per cascade.
+
+    CascadedShadows& operator=(CascadedShadows&& other) = delete;
+    CascadedShadows& operator=(const CascadedShadows& other) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef GLA_CLUSTERED_LIGHTING_H
+#define GLA_CLUSTERED_LIGHTING_H
+
+#include <span>
+#include <string>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/buffer.h>
+#include <GLA/program.h>
+#include <GLA/ringBuffer.h>
+
+namespace gla {
+
+/**
+ * @brief Point light as stored in the light Buffer of a gla::ClusteredLighting, 32 bytes.
+ */
+struct PointLight {
+    glm::vec3 position = glm::vec3(0.0f);  ///< World space position.
+    float radius = 1.0f;                    ///< Distance at which the light has no influence anymore.
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 1.0f;
+};
+static_assert(sizeof(PointLight) == 32, "PointLight must be 32 bytes!");
+
+/**
+ * @brief Settings of a gla::ClusteredLighting.
+ */
+struct ClusteredLightingSettings {
+    glm::ivec3 grid = glm::ivec3(16, 9, 24);    ///< Clusters along the screen width, height and the depth.
+    int maxLights = 4096;                       ///< Maximum amount of lights per update().
+    int maxLightsPerCluster = 128;              ///< Lights beyond this are dropped from a cluster.
+    int averageLightsPerCluster = 32;           ///< Sizes the light index list, clusters beyond it get no lights.
+    unsigned int binding = 4;                   ///< First of the three consecutive shader storage bindings used.
+};
+
+/**
+ * @brief Clustered forward lighting, lights are binned into a 3D grid of view frustum cells on the GPU.
+ *
+ * The view frustum is split into grid.x * grid.y screen tiles and grid.z depth slices, which grow exponentially
+ * with the distance so clusters stay roughly cubic. update() uploads the lights and runs one compute dispatch
+ * with an invocation per cluster, which tests every light sphere against the view space box of its cluster
+ * (lights are staged through shared memory in batches) and appends the indices of the hits to one light index list.
+ * The grid Buffer then holds the offset and count of every cluster in that list.
+ *
+ * Fragment shaders include glslSource(), look up their cluster with clusterRange() and only shade the lights in it,
+ * so the lighting cost follows the local light density instead of the total amount of lights.
+ *
+ * @warning ClusteredLighting must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class ClusteredLighting {
+private:
+    ClusteredLightingSettings _settings;
+    Program _binProgram;
+    RingBuffer _lights;
+    Buffer _grid;
+    Buffer _indices;
+    int64_t _lightOffset = 0;
+    int64_t _lightSize = 0;
+    uint32_t _lightCount = 0;
+    int64_t _storageAlignment = 256;
+    bool _frameOpen = false;    // the ring frame of the last update() stays open until the next one
+
+public:
+    /**
+     * @brief Construct a new ClusteredLighting and allocates the grid and light index list.
+     *
+     * @throws std::invalid_argument If a grid dimension or setting is not greater than 0
+     * @throws gla::ShaderCompileError If the compute shader fails to compile.
+     * @throws gla::ProgramLinkError If the compute Program fails to link.
+     */
+    ClusteredLighting(const ClusteredLightingSettings& settings = {});
+    ClusteredLighting(ClusteredLighting&& other) = delete;
+    ClusteredLighting(const ClusteredLighting& other) = delete;
+
+    /**
+     * @brief Uploads the lights and bins them into the clusters of a camera, call once per frame before drawing.
+     *
+     * @throws std::invalid_argument If there are more than maxLights lights, projection is not a perspective projection or the size is not greater than 0
+     *
+     * @param view Matrix transforming world into view space
+     * @param projection Perspective projection, near and far plane define the clustered depth range
+     * @param width Width of the viewport in pixels
+     * @param height Height of the viewport in pixels
+     */
+    void update(std::span<const PointLight> lights, const glm::mat4& view, const glm::mat4& projection, int width, int height);
+
+    /**
+     * @brief Binds the lights, the grid and the light index list for shaders using glslSource().
+     */
+    void bind() const;
+
+    /**
+     * @brief Gets GLSL code declaring the Buffers and the cluster lookup functions.
+     *
+     * Declares struct ClusterLight, uvec2 clusterRange(vec2 fragCoord, float viewDepth) returning offset and count,
+     * float clusterViewDepth(float fragDepth), ClusterLight clusterLight(uint i) for the light index list entries offset to offset + count - 1
+     * and float clusterAttenuation(ClusterLight light, vec3 position).
+     *
+     * @note The code has to be inserted after the #version directive.
+     */
+    std::string glslSource() const;
+
+    /**
+     * @brief Gets the amount of lights binned by the last update().
+     */
+    uint32_t lightCount() const { return _lightCount; }
+
+    /**
+     * @brief Gets the amount of clusters of the grid.
+     */
+    uint32_t clusterCount() const { return (uint32_t)_settings.grid.x * _settings.grid.y * _settings.grid.z; }
+
+    const Buffer& grid() const { return _grid; }
+    const Buffer& indices() const { return _indices; }
+
+    ClusteredLighting& operator=(ClusteredLighting&& other) = delete;
+    ClusteredLighting& operator=(const ClusteredLighting& other) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef GLA_COMPRESSION_H
+#define GLA_COMPRESSION_H
+
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <stdexcept>
+
+namespace gla {
+
+/**
+ * @brief Compresses data into a raw LZ4 block (no frame header).
+ *
+ * Uses a greedy single probe match finder, which trades compression ratio for speed.
+ * The output can be decompressed by any LZ4 block decoder.
+ *
+ * @param input The data to compress
+ * @return The compressed block, may be slightly larger than input for incompressible data
+ */
+std::vector<uint8_t> lz4Compress(std::span<const uint8_t> input);
+
+/**
+ * @brief Decompresses a raw LZ4 block.
+ *
+ * @throws std::runtime_error If the block is corrupt or doesn't decompress to exactly output.size() bytes
+ *
+ * @param input The compressed block
+ * @param output Receives the decompressed data, must have the exact decompressed size
+ */
+void lz4Decompress(std::span<const uint8_t> input, std::span<uint8_t> output);
+
+/**
+ * @brief Computes the 64 bit FNV-1a hash of data.
+ */
+constexpr uint64_t fnv1a64(std::span<const uint8_t> data, uint64_t hash = 0xCBF29CE484222325ull) {
+    for (uint8_t byte : data) {
+        hash ^= byte;
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+}
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef GLA_DEBUG_DRAW_H
+#define GLA_DEBUG_DRAW_H
+
+#include <vector>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/debug.h>
+
+#ifdef DEBUG_BUILD
+#include <GLA/program.h>
+#include <GLA/ringBuffer.h>
+#endif
+
+namespace gla {
+
+/**
+ * @brief Enum to indicate how debug primitives interact with the depth buffer.
+ */
+enum class DebugDepth {
+    Tested, ///< Hidden behind geometry in the depth buffer
+    Overlay ///< Always drawn on top
+};
+
+/**
+ * @brief Settings of a gla::DebugDraw.
+ */
+struct DebugDrawSettings {
+    int maxLinesPerFrame = 262144; ///< Maximum amount of line segments drawn per frame (spheres and boxes consist of multiple).
+};
+
+#ifdef DEBUG_BUILD
+
+/**
+ * @brief Immediate mode batcher for debug lines, boxes, frusta and spheres.
+ *
+ * All primitives added during a frame are collected as line segments, streamed into a gla::RingBuffer
+ * and drawn by render() with one instanced draw per DebugDepth mode. Every segment is an instance expanded
+ * into a screen space quad in the vertex shader, so lines of any width cost the same.
+ *
+ * @note When DEBUG_BUILD is not defined DebugDraw is replaced by an empty class with inline no-op methods,
+ *       so debug drawing compiles out without removing the calls.
+ *
+ * @warning DebugDraw must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class DebugDraw {
+private:
+    struct Line {
+        glm::vec3 a;
+        float width;
+        glm::vec3 b;
+        uint32_t color; // packUnorm4x8
+    };
+
+    DebugDrawSettings _settings;
+    Program _program;
+    RingBuffer _ring;
+    int64_t _storageAlignment = 256;
+    std::vector<Line> _lines[2]; // indexed by DebugDepth
+
+    void _draw(std::vector<Line>& lines);
+
+public:
+    /**
+     * @brief Construct a new DebugDraw.
+     *
+     * @throws std::invalid_argument If maxLinesPerFrame is not greater than 0
+     * @throws gla::ShaderCompileError If the debug shaders fail to compile.
+     * @throws gla::ProgramLinkError If the debug Program fails to link.
+     */
+    DebugDraw(const DebugDrawSettings& settings = {});
+    DebugDraw(DebugDraw&& other) = delete;
+    DebugDraw(const DebugDraw& other) = delete;
+
+    /**
+     * @brief Adds a line segment.
+     *
+     * @throws std::runtime_error If more than maxLinesPerFrame segments were added this frame
+     *
+     * @param a Start of the line in world space
+     * @param b End of the line in world space
+     * @param color Color of the line
+     * @param width Width of the line in pixels
+     * @param depth Whether the line is depth tested or drawn on top
+     */
+    void line(const glm::vec3& a, const glm::vec3& b, const glm::vec4& color, float width = 1.0f, DebugDepth depth = DebugDepth::Tested);
+
+    /**
+     * @brief Adds the 12 edges of an axis aligned bounding box.
+     *
+     * @throws std::runtime_error If more than maxLinesPerFrame segments were added this frame
+     */
+    void aabb(const glm::vec3& min, const glm::vec3& max, const glm::vec4& color, float width = 1.0f, DebugDepth depth = DebugDepth::Tested);
+
+    /**
+     * @brief Adds the 12 edges of the view frustum of a view projection matrix.
+     *
+     * @throws std::runtime_error If more than maxLinesPerFrame segments were added this frame
+     *
+     * @param viewProjection The projection * view matrix of the frustum to draw
+     */
+    void frustum(const glm::mat4& viewProjection, const glm::vec4& color, float width = 1.0f, DebugDepth depth = DebugDepth::Tested);
+
+    /**
+     * @brief Adds a wire sphere drawn as three orthogonal circles.
+     *
+     * @throws std::runtime_error If more than maxLinesPerFrame segments were added this frame
+     *
+     * @param segments Amount of segments per circle
+     */
+    void sphere(const glm::vec3& center, float radius, const glm::vec4& color, float width = 1.0f, DebugDepth depth = DebugDepth::Tested, int segments = 24);
+
+    /**
+     * @brief Draws all primitives added since the last call and clears them.
+     *
+     * @note Binds the debug Program and shader storage binding 0, depth test and depth writes are restored afterwards.
+     *
+     * @param viewProjection The projection * view matrix of the camera
+     * @param viewportSize The viewport size in pixels, used to expand lines to their width
+     */
+    void render(const glm::mat4& viewProjection, const glm::vec2& viewportSize);
+
+    DebugDraw& operator=(DebugDraw&& other) = delete;
+    DebugDraw& operator=(const DebugDraw& other) = delete;
+};
+
+#else
+
+class DebugDraw {
+public:
+    DebugDraw(const DebugDrawSettings& = {}) {}
+    DebugDraw(DebugDraw&& other) = delete;
+    DebugDraw(const DebugDraw& other) = delete;
+
+    void line(const glm::vec3&, const glm::vec3&, const glm::vec4&, float = 1.0f, DebugDepth = DebugDepth::Tested) {}
+    void aabb(const glm::vec3&, const glm::vec3&, const glm::vec4&, float = 1.0f, DebugDepth = DebugDepth::Tested) {}
+    void frustum(const glm::mat4&, const glm::vec4&, float = 1.0f, DebugDepth = DebugDepth::Tested) {}
+    void sphere(const glm::vec3&, float, const glm::vec4&, float = 1.0f, DebugDepth = DebugDepth::Tested, int = 24) {}
+    void render(const glm::mat4&, const glm::vec2&) {}
+
+    DebugDraw& operator=(DebugDraw&& other) = delete;
+    DebugDraw& operator=(const DebugDraw& other) = delete;
+};
+
+#endif
+
+}
+
+#endif
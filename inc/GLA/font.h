@@ -0,0 +1,148 @@
+#ifndef GLA_FONT_H
+#define GLA_FONT_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <glm/vec2.hpp>
+
+namespace gla {
+
+/**
+ * @brief Exception thrown when a font file can't be parsed.
+ */
+class FontParseError : public std::runtime_error {
+public:
+    /**
+     * @brief Construct a new Font Parse Error object.
+     *
+     * @param message Description of what could not be parsed.
+     */
+    FontParseError(const std::string& message)
+        : std::runtime_error(
+              "Font parsing failed:\n" + message) {}
+};
+
+/**
+ * @brief Horizontal metrics of a glyph in font units.
+ */
+struct GlyphMetrics {
+    int advance;        ///< Horizontal advance to the next glyph.
+    int leftBearing;    ///< Distance from the pen position to the left of the bounding box.
+    glm::ivec2 min;     ///< Bottom left of the bounding box.
+    glm::ivec2 max;     ///< Top right of the bounding box.
+};
+
+/**
+ * @brief Line segment of a flattened glyph outline in font units.
+ */
+struct OutlineEdge {
+    glm::vec2 a; ///< Start of the edge.
+    glm::vec2 b; ///< End of the edge.
+};
+
+/**
+ * @brief Signed distance field of a single glyph.
+ *
+ * Texels store 0.5 on the outline, values above 0.5 are inside of the glyph.
+ * The distance range covered from 0 to 1 is 2 * spread pixels.
+ */
+struct SdfGlyph {
+    int width = 0;                  ///< Width of the bitmap in pixels (0 for glyphs without outline).
+    int height = 0;                 ///< Height of the bitmap in pixels (0 for glyphs without outline).
+    glm::vec2 planeMin = {};        ///< Bottom left of the bitmap relative to the pen position in em.
+    glm::vec2 planeMax = {};        ///< Top right of the bitmap relative to the pen position in em.
+    std::vector<uint8_t> pixels;    ///< Row major distances, first row is the top row.
+};
+
+/**
+ * @brief TrueType font parsed from a .ttf file.
+ *
+ * Supports glyf outlines (simple and composite), cmap formats 4 and 12 and kern table format 0.
+ *
+ * @note All const methods only read the parsed font data and are therefore thread-safe.
+ */
+class Font {
+private:
+    std::vector<uint8_t> _data;
+    uint32_t _cmap = 0;
+    uint32_t _loca = 0;
+    uint32_t _glyf = 0;
+    uint32_t _hmtx = 0;
+    uint32_t _kern = 0;
+    int _unitsPerEm = 0;
+    int _numGlyphs = 0;
+    int _numHMetrics = 0;
+    int _ascender = 0;
+    int _descender = 0;
+    int _lineGap = 0;
+    bool _longLoca = false;
+
+    void _parse();
+    uint32_t _glyphOffset(uint32_t glyph, uint32_t& length) const;
+    void _outline(uint32_t glyph, const float transform[6], std::vector<OutlineEdge>& edges, int depth) const;
+
+public:
+    Font() = delete;
+    /**
+     * @brief Loads a Font from a .ttf file.
+     *
+     * @throws std::invalid_argument If the file could not be read.
+     * @throws gla::FontParseError If the file is not a valid TrueType font.
+     */
+    Font(const std::string& path);
+    /**
+     * @brief Loads a Font from the bytes of a .ttf file.
+     *
+     * @throws gla::FontParseError If the data is not a valid TrueType font.
+     */
+    Font(std::vector<uint8_t> data);
+
+    int unitsPerEm() const { return _unitsPerEm; }  ///< Gets the font units per em.
+    int ascender() const { return _ascender; }      ///< Gets the ascender in font units.
+    int descender() const { return _descender; }    ///< Gets the descender in font units (usually negative).
+    int lineGap() const { return _lineGap; }        ///< Gets the line gap in font units.
+    int glyphCount() const { return _numGlyphs; }   ///< Gets the amount of glyphs in the font.
+
+    /**
+     * @brief Gets the glyph index of a unicode codepoint, 0 (the missing glyph) if it is not mapped.
+     */
+    uint32_t glyphIndex(uint32_t codepoint) const;
+
+    /**
+     * @brief Gets the metrics of a glyph.
+     *
+     * @throws std::out_of_range If the glyph index is invalid.
+     */
+    GlyphMetrics metrics(uint32_t glyph) const;
+
+    /**
+     * @brief Gets the horizontal kerning adjustment between two glyphs in font units.
+     */
+    int kerning(uint32_t left, uint32_t right) const;
+
+    /**
+     * @brief Gets the outline of a glyph flattened into edges in font units.
+     *
+     * @throws std::out_of_range If the glyph index is invalid.
+     * @throws gla::FontParseError If the glyph data is corrupt.
+     */
+    std::vector<OutlineEdge> outline(uint32_t glyph) const;
+
+    /**
+     * @brief Rasterizes the signed distance field of a glyph.
+     *
+     * @throws std::out_of_range If the glyph index is invalid.
+     * @throws std::invalid_argument If pixelsPerEm or spread is not greater than 0.
+     *
+     * @param glyph The glyph index
+     * @param pixelsPerEm The size of one em in pixels
+     * @param spread The distance in pixels covered on each side of the outline, also used as padding
+     */
+    SdfGlyph rasterizeSdf(uint32_t glyph, float pixelsPerEm, int spread) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef GLA_FRAMEBUFFER_H
+#define GLA_FRAMEBUFFER_H
+
+#include <span>
+#include <vector>
+#include <stdexcept>
+#include <glm/vec4.hpp>
+
+#include <GLA/texture.h>
+
+namespace gla {
+
+/**
+ * @brief Framebuffer class to abstract OpenGL framebuffer objects rendering into Textures.
+ *
+ * The draw buffers always list the attached color attachments, so fragment output location i writes color attachment i.
+ * Attaching, checking and clearing keep the currently bound framebuffer, only bind() changes it.
+ *
+ * @warning Framebuffer must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ *
+ * @note This class owns the underlying OpenGL framebuffer object, but not the attached Textures.
+ */
+class Framebuffer {
+private:
+    unsigned int _id = 0;
+    int _width = 0;
+    int _height = 0;
+    std::vector<bool> _colors;
+    bool _depthStencil = false; // the depth attachment has a stencil part
+
+    void _delete();
+    void _attach(unsigned int attachment, const Texture& texture, int level, int layer);
+    void _updateDrawBuffers();
+
+public:
+    /**
+     * @brief Construct a new Framebuffer without attachments.
+     *
+     * @throws std::runtime_error If OpenGL failed to create a framebuffer object.
+     */
+    Framebuffer();
+    Framebuffer(Framebuffer&& other);
+    Framebuffer(const Framebuffer& other) = delete; // OpenGL framebuffers are not copy safe
+    ~Framebuffer() noexcept;
+
+    /**
+     * @brief Attaches a level of a Texture as color attachment.
+     *
+     * @throws std::logic_error If the Texture has no storage
+     * @throws std::invalid_argument If the level is out of range
+     *
+     * @param index The color attachment, e.g. layout(location = index) out in GLSL
+     * @param layer The layer of array, 3D and cube Textures or -1 to attach all layers for layered rendering
+     */
+    void attachColor(unsigned int index, const Texture& texture, int level = 0, int layer = -1);
+
+    /**
+     * @brief Attaches a level of a depth Texture, Depth24Stencil8 Textures are attached as depth and stencil.
+     *
+     * @throws std::logic_error If the Texture has no storage
+     * @throws std::invalid_argument If the level is out of range or the Texture has no depth format
+     *
+     * @param layer The layer of array, 3D and cube Textures or -1 to attach all layers for layered rendering
+     */
+    void attachDepth(const Texture& texture, int level = 0, int layer = -1);
+
+    /**
+     * @brief Checks if the Framebuffer can be rendered to.
+     *
+     * @throws std::runtime_error If the Framebuffer is incomplete
+     */
+    void check() const;
+
+    /**
+     * @brief Binds the Framebuffer for drawing and reading and sets the viewport to its size.
+     */
+    void bind() const;
+
+    /**
+     * @brief Binds the default framebuffer of the window.
+     */
+    static void bindDefault();
+
+    /**
+     * @brief Clears a float or normalized color attachment.
+     */
+    void clearColor(unsigned int index, const glm::vec4& color) const;
+
+    /**
+     * @brief Clears an unsigned integer color attachment.
+     */
+    void clearColor(unsigned int index, const glm::uvec4& color) const;
+
+    /**
+     * @brief Clears the depth attachment.
+     */
+    void clearDepth(float depth = 1.0f) const;
+
+    /**
+     * @brief Tells the driver that the content of attachments is no longer needed.
+     *
+     * Invalidated attachments don't have to be written back to or loaded from memory, which saves bandwidth
+     * for transient attachments like G-buffers and is free on tile based GPUs. Their content is undefined afterwards.
+     *
+     * @param colors Indices of the color attachments to invalidate
+     * @param depth Invalidates the depth (and stencil) attachment as well
+     */
+    void invalidate(std::span<const unsigned int> colors, bool depth = false) const;
+
+    /**
+     * @brief Gets the underlying OpenGL framebuffer object name for low level OpenGL access.
+     */
+    unsigned int id() const { return _id; }
+
+    int width() const { return _width; }    ///< Gets the width of the attachments (0 without attachments).
+    int height() const { return _height; }  ///< Gets the height of the attachments (0 without attachments).
+
+    Framebuffer& operator=(Framebuffer&& other);
+    Framebuffer& operator=(const Framebuffer& other) = delete; // OpenGL framebuffers are not copy safe
+};
+
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef GLA_G_BUFFER_H
+#define GLA_G_BUFFER_H
+
+#include <span>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/texture.h>
+#include <GLA/framebuffer.h>
+#include <GLA/program.h>
+#include <GLA/ringBuffer.h>
+#include <GLA/clusteredLighting.h>
+
+namespace gla {
+
+/**
+ * @brief Settings of a gla::GBuffer.
+ */
+struct GBufferSettings {
+    int maxLights = 4096;           ///< Maximum amount of lights per light() call.
+    int maxLightsPerTile = 256;     ///< Lights beyond this are dropped from a 16x16 pixel tile.
+    bool keepDepth = true;          ///< Keep the depth after light(), e.g. to draw transparent objects forward, otherwise it is invalidated as well.
+    glm::vec3 ambient = glm::vec3(0.03f); ///< Ambient light added to every pixel, scaled by its occlusion.
+};
+
+/**
+ * @brief Deferred shading with a bandwidth packed G-buffer and a tiled compute lighting pass.
+ *
+ * Objects are drawn between begin() and end() with fragment shaders that call writeGBuffer() from glslSource().
+ * A pixel costs 16 bytes:
+ * - albedo and occlusion in SRGB8Alpha8, written linear and encoded by GL_FRAMEBUFFER_SRGB between begin() and end()
+ * - the world space normal octahedral encoded in RG16
+ * - roughness, metallic and a 16 bit material id in RGBA8
+ * - depth and stencil in Depth24Stencil8, positions are reconstructed from it and never stored
+ *
+ * light() runs one compute workgroup per 16x16 pixel tile: the tile reduces its depth range, culls all lights against
+ * the view space box between its nearest and farthest pixel into shared memory and every pixel shades only those lights.
+ * Each G-buffer texel is read exactly once and the result is written once into an RGBA16F output Texture.
+ * The G-buffer attachments are invalidated when they are not needed anymore (before drawing and after lighting),
+ * so they don't have to be loaded or stored by the GPU.
+ *
+ * @warning GBuffer must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class GBuffer {
+private:
+    GBufferSettings _settings;
+    Texture _albedo;
+    Texture _normal;
+    Texture _material;
+    Texture _depth;
+    Texture _output;
+    Framebuffer _framebuffer;
+    Program _lightProgram;
+    RingBuffer _lights;
+    int64_t _storageAlignment = 256;
+    bool _frameOpen = false;    // the ring frame of the last light() stays open until the next one
+    int _previousFramebuffer = 0;
+    int _previousReadFramebuffer = 0;
+    int _previousViewport[4] = {};
+    int _previousStencilMask = 0xFF;
+    bool _previousDepthMask = true;
+    bool _previousSrgb = false;
+    bool _drawing = false;
+
+    void _allocate(int width, int height);
+
+public:
+    /**
+     * @brief Construct a new GBuffer of the given size.
+     *
+     * @throws std::invalid_argument If a size or setting is not greater than 0
+     * @throws gla::ShaderCompileError If the lighting shader fails to compile.
+     * @throws gla::ProgramLinkError If the lighting Program fails to link.
+     */
+    GBuffer(int width, int height, const GBufferSettings& settings = {});
+    GBuffer(GBuffer&& other) = delete;
+    GBuffer(const GBuffer& other) = delete;
+
+    /**
+     * @brief Reallocates all attachments and the output.
+     *
+     * @throws std::invalid_argument If width or height is not greater than 0
+     */
+    void resize(int width, int height);
+
+    /**
+     * @brief Binds the G-buffer, invalidates its color attachments and clears depth and stencil.
+     *
+     * Pixels no object is drawn to are never read, so the color attachments don't have to be cleared.
+     * Enables GL_FRAMEBUFFER_SRGB so the linear albedo is encoded into its sRGB attachment.
+     * The current framebuffers, viewport, depth and stencil write masks and sRGB state are restored by end().
+     *
+     * @throws std::logic_error If begin() was already called without end()
+     */
+    void begin();
+
+    /**
+     * @brief Stops drawing into the G-buffer.
+     *
+     * @throws std::logic_error If begin() was not called
+     */
+    void end();
+
+    /**
+     * @brief Shades every pixel of the G-buffer into output(), pixels without geometry become transparent black.
+     *
+     * @throws std::logic_error If called between begin() and end()
+     * @throws std::invalid_argument If there are more than maxLights lights
+     *
+     * @param view Matrix the G-buffer was drawn with
+     * @param projection Matrix the G-buffer was drawn with
+     */
+    void light(std::span<const PointLight> lights, const glm::mat4& view, const glm::mat4& projection);
+
+    /**
+     * @brief Gets GLSL code declaring the G-buffer outputs and
+     * void writeGBuffer(vec3 albedo, float occlusion, vec3 normal, float roughness, float metallic, uint materialId).
+     *
+     * @note The code has to be inserted after the #version directive of a fragment shader.
+     */
+    static const char* glslSource();
+
+    const Texture& albedo() const { return _albedo; }
+    const Texture& normal() const { return _normal; }
+    const Texture& material() const { return _material; }
+    const Texture& depth() const { return _depth; }
+    const Texture& output() const { return _output; }   ///< Lit RGBA16F result of light().
+    const Framebuffer& framebuffer() const { return _framebuffer; }
+
+    GBuffer& operator=(GBuffer&& other) = delete;
+    GBuffer& operator=(const GBuffer& other) = delete;
+};
+
+}
+
+#endif
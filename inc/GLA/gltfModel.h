@@ -0,0 +1,162 @@
+#ifndef GLA_GLTF_MODEL_H
+#define GLA_GLTF_MODEL_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <stdexcept>
+#include <glm/glm.hpp>
+
+#include <GLA/vertexArray.h>
+
+namespace gla {
+
+/**
+ * @brief Exception thrown when a GLB file is invalid or uses unsupported glTF features.
+ */
+class GltfError : public std::runtime_error {
+public:
+    /**
+     * @brief Construct a new Gltf Error object.
+     *
+     * @param message Description of what is wrong with the file.
+     */
+    GltfError(const std::string& message)
+        : std::runtime_error(
+              "glTF loading failed:\n" + message) {}
+};
+
+/**
+ * @brief Gets the vertex attribute location a glTF attribute semantic is bound to.
+ *
+ * POSITION 0, NORMAL 1, TEXCOORD_0 2, COLOR_0 3 (matching gla::importObj()), TANGENT 4, TEXCOORD_1 5, JOINTS_0 6, WEIGHTS_0 7.
+ *
+ * @return The location or -1 if the semantic is not loaded
+ */
+int gltfAttributeLocation(std::string_view semantic);
+
+/**
+ * @brief Attributes read from one region of the shared Buffer with a common stride.
+ */
+struct GltfVertexStream {
+    int64_t offset;                             ///< Offset of the first vertex in the shared Buffer.
+    int stride;                                 ///< Distance between two vertices in bytes.
+    std::vector<VertexAttribute> attributes;    ///< Attributes with offsets relative to offset.
+};
+
+/**
+ * @brief Drawable part of a GltfMesh.
+ */
+struct GltfPrimitive {
+    std::vector<GltfVertexStream> streams;  ///< One stream per interleaved bufferView or per accessor if not interleaved.
+    unsigned int mode = 4;                  ///< Primitive topology as GLenum, glTF modes equal GL_POINTS to GL_TRIANGLE_FAN.
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;                ///< 0 if the primitive is not indexed.
+    IndexType indexType = IndexType::UnsignedInt;
+    int64_t indexOffset = 0;                ///< Offset of the first index in the shared Buffer.
+    int material = -1;                      ///< Index of the glTF material or -1.
+    glm::vec3 boundsMin = glm::vec3(0.0f);  ///< From the min of the POSITION accessor.
+    glm::vec3 boundsMax = glm::vec3(0.0f);  ///< From the max of the POSITION accessor.
+};
+
+/**
+ * @brief glTF mesh, a list of primitives.
+ */
+struct GltfMesh {
+    std::string name;
+    std::vector<GltfPrimitive> primitives;
+};
+
+/**
+ * @brief glTF node with its transforms resolved.
+ */
+struct GltfNode {
+    std::string name;
+    int mesh = -1;                          ///< Index into GltfModel::meshes() or -1.
+    int parent = -1;
+    std::vector<int> children;
+    glm::mat4 local = glm::mat4(1.0f);      ///< From matrix or translation, rotation and scale.
+    glm::mat4 world = glm::mat4(1.0f);      ///< local multiplied with all parent transforms.
+};
+
+/**
+ * @brief Model loaded from a binary glTF (GLB) file.
+ *
+ * The JSON chunk is read by a small streaming parser that keeps only what rendering needs, no document tree is built.
+ * Every bufferView referenced by a vertex or index accessor is uploaded once from the mapping into a single Buffer
+ * shared by all primitives, so vertex data is never copied per vertex on the CPU. Accessors turn into VertexAttributes
+ * that point into that Buffer, keeping their component type and normalized flag. Integer JOINTS attributes use
+ * VertexAttribInterp::Integer, other integer attributes are read as (normalized) floats like glTF specifies.
+ *
+ * Only the embedded binary buffer is supported, buffers referenced by uri and sparse accessors throw gla::GltfError.
+ *
+ * @warning GltfModel must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class GltfModel {
+private:
+    VertexArray _buffer;
+    std::vector<GltfMesh> _meshes;
+    std::vector<GltfNode> _nodes;
+    std::vector<int> _scene;
+
+    void _load(std::span<const uint8_t> glb, BufferFlag flags);
+
+public:
+    /**
+     * @brief Maps and uploads a GLB file.
+     *
+     * @throws std::invalid_argument If the file can't be opened
+     * @throws gla::GltfError If the file is invalid or unsupported
+     *
+     * @param flags BufferFlags of the shared Buffer, BufferFlag::DynamicStorage is always added for the upload
+     */
+    GltfModel(const std::string& path, BufferFlag flags = BufferFlag::None);
+
+    /**
+     * @brief Uploads a GLB file from memory, e.g. a view into an AssetPack.
+     *
+     * @throws gla::GltfError If the data is invalid or unsupported
+     */
+    GltfModel(std::span<const uint8_t> glb, BufferFlag flags = BufferFlag::None);
+
+    GltfModel(GltfModel&& other) = default;
+    GltfModel(const GltfModel& other) = delete;
+
+    /**
+     * @brief Binds the vertex streams of a primitive and the shared Buffer as index Buffer.
+     *
+     * @note Vertex attribute state is global in this abstraction, so a primitive must be bound again after binding something else.
+     */
+    void bind(const GltfPrimitive& primitive);
+
+    /**
+     * @brief Draws a primitive, it must be bound.
+     */
+    void draw(const GltfPrimitive& primitive) const;
+
+    /**
+     * @brief Binds and draws all primitives of a mesh.
+     *
+     * @throws std::out_of_range If mesh is not a valid mesh index
+     */
+    void draw(size_t mesh);
+
+    const VertexArray& buffer() const { return _buffer; }
+    const std::vector<GltfMesh>& meshes() const { return _meshes; }
+    const std::vector<GltfNode>& nodes() const { return _nodes; }
+
+    /**
+     * @brief Gets the root nodes of the default scene, all nodes without parent if the file has no scene.
+     */
+    const std::vector<int>& scene() const { return _scene; }
+
+    GltfModel& operator=(GltfModel&& other) = default;
+    GltfModel& operator=(const GltfModel& other) = delete;
+};
+
+}
+
+#endif
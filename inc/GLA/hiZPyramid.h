@@ -0,0 +1,156 @@
+#ifndef GLA_HI_Z_PYRAMID_H
+#define GLA_HI_Z_PYRAMID_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/buffer.h>
+#include <GLA/program.h>
+#include <GLA/texture.h>
+#include <GLA/sync.h>
+
+namespace gla {
+
+/**
+ * @brief Settings of a gla::HiZPyramid.
+ */
+struct HiZSettings {
+    bool reversedZ = false; ///< Depth is cleared to 0 and tested with GL_GREATER, requires glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE).
+    int cpuLevelSize = 64;  ///< The first level not larger than this in both dimensions is downloaded for testCpu(), 0 disables the download.
+};
+
+/**
+ * @brief Enum to indicate which objects HiZPyramid::cull() tests.
+ */
+enum class HiZCullMode {
+    All,    ///< Test every object, visibility becomes 1 if it may be visible and 0 otherwise
+    Hidden  ///< Only test objects with visibility 0, those that may be visible become 2 (second phase of two phase culling)
+};
+
+/**
+ * @brief Hierarchical depth pyramid for occlusion culling.
+ *
+ * Every texel of a level holds the farthest depth of the four texels below it, level 0 reduces 2x2 depth texels.
+ * The whole pyramid is built by one compute dispatch: every workgroup reduces a 64x64 depth tile down to a single texel
+ * in shared memory and the last workgroup to finish (found with an atomic counter) reduces the remaining levels.
+ * Levels are stored in a shader storage Buffer, so there is no limit on image units and any level can be read anywhere.
+ *
+ * Testing a box projects its corners, picks the level on which the screen rectangle covers at most 2x2 texels and
+ * compares the nearest corner depth against the farthest of those 4 texels, so a test costs the same for every box.
+ * The same test runs in cull() for a Buffer of boxes, in user shaders through glslSource() and on the CPU
+ * against a small level that is downloaded asynchronously after every build().
+ *
+ * Two phase culling per frame: cull(All) against last frame's pyramid and draw the objects with visibility 1,
+ * build() from the resulting depth, cull(Hidden) and draw the objects with visibility 2.
+ * Objects wrongly culled in the first phase because they were disoccluded are caught by the second one.
+ *
+ * @warning HiZPyramid must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class HiZPyramid {
+private:
+    struct Level {
+        int64_t offset; // in floats from the start of the depth array
+        int width;
+        int height;
+    };
+
+    HiZSettings _settings;
+    Program _reduceProgram;
+    Program _cullProgram;
+    Buffer _pyramid;
+    Buffer _counter;
+    Buffer _readback;
+    const float* _readbackData = nullptr;
+    Fence _readbackFence;
+    int _readbackLevel = -1;    // level copied into _readback, -1 if no copy is in flight
+    glm::ivec2 _readbackDepthSize = glm::ivec2(0);
+    int _depthWidth = 0;
+    int _depthHeight = 0;
+    std::vector<Level> _levels;
+    int _cpuLevel = -1;         // pyramid level of _cpuLevels[0], -1 if nothing was downloaded yet
+    glm::ivec2 _cpuDepthSize = glm::ivec2(0);
+    std::vector<glm::ivec2> _cpuLevelSizes;
+    std::vector<std::vector<float>> _cpuLevels; // downloaded level and the levels reduced from it on the CPU
+
+    void _allocate(int depthWidth, int depthHeight);
+    void _collectReadback();
+
+public:
+    /**
+     * @brief Construct a new HiZPyramid, storage is allocated by the first build().
+     *
+     * @throws gla::ShaderCompileError If the compute shaders fail to compile.
+     * @throws gla::ProgramLinkError If a compute Program fails to link.
+     */
+    HiZPyramid(const HiZSettings& settings = {});
+    HiZPyramid(HiZPyramid&& other) = delete;
+    HiZPyramid(const HiZPyramid& other) = delete;
+
+    /**
+     * @brief Builds the pyramid from a depth Texture, storage is reallocated when its size changes.
+     *
+     * @throws std::invalid_argument If depth has no storage or is not a 2D Texture
+     */
+    void build(const Texture& depth);
+
+    /**
+     * @brief Tests boxes against the pyramid on the GPU.
+     *
+     * @throws std::logic_error If the pyramid was never built
+     *
+     * @param boxes ShaderStorage Buffer with two vec4 per box (minimum, maximum), w is ignored
+     * @param visibility ShaderStorage Buffer with one uint per box, see HiZCullMode
+     * @param count Amount of boxes
+     * @param viewProjection Matrix the boxes are projected with
+     */
+    void cull(const Buffer& boxes, const Buffer& visibility, uint32_t count, const glm::mat4& viewProjection, HiZCullMode mode = HiZCullMode::All);
+
+    /**
+     * @brief Tests a box against the last downloaded level on the CPU.
+     *
+     * The downloaded level is a frame or two old, so the result is only as exact as the camera is still.
+     *
+     * @return false if the box is certainly hidden, true if it may be visible or no level was downloaded yet
+     */
+    bool testCpu(const glm::vec3& min, const glm::vec3& max, const glm::mat4& viewProjection);
+
+    /**
+     * @brief Binds the pyramid Buffer for shaders using glslSource().
+     */
+    void bind(unsigned int binding) const { _pyramid.bindBase(binding); }
+
+    /**
+     * @brief Gets GLSL code declaring the pyramid Buffer and bool hizVisible(vec3 minimum, vec3 maximum, mat4 viewProjection).
+     *
+     * @note The code has to be inserted after the #version directive.
+     *
+     * @param binding The shader storage binding the pyramid is bound to with bind()
+     */
+    std::string glslSource(unsigned int binding) const;
+
+    /**
+     * @brief Gets the amount of levels (0 before the first build()).
+     */
+    int levels() const { return (int)_levels.size(); }
+
+    /**
+     * @brief Gets the size of a level in texels.
+     *
+     * @throws std::out_of_range If level is out of range
+     */
+    glm::ivec2 levelSize(int level) const;
+
+    const Buffer& buffer() const { return _pyramid; }
+
+    HiZPyramid& operator=(HiZPyramid&& other) = delete;
+    HiZPyramid& operator=(const HiZPyramid& other) = delete;
+};
+
+}
+
+#endif
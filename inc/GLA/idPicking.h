@@ -0,0 +1,165 @@
+#ifndef GLA_ID_PICKING_H
+#define GLA_ID_PICKING_H
+
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <glm/vec2.hpp>
+
+#include <GLA/buffer.h>
+#include <GLA/texture.h>
+#include <GLA/framebuffer.h>
+#include <GLA/sync.h>
+
+namespace gla {
+
+/**
+ * @brief Object under one pixel of the ID buffer.
+ */
+struct PickResult {
+    uint32_t id = UINT32_MAX;        ///< Id written with writePickId(), UINT32_MAX for background.
+    uint32_t primitive = 0;          ///< gl_PrimitiveID of the drawn triangle.
+
+    bool hit() const { return id != UINT32_MAX; }
+};
+
+/**
+ * @brief Pixels of the ID buffer read back for one pick request.
+ */
+struct PickRegion {
+    glm::ivec2 origin = glm::ivec2(0);  ///< Top left pixel in window coordinates (origin at the top left).
+    glm::ivec2 size = glm::ivec2(0);
+    glm::ivec2 cursor = glm::ivec2(0);  ///< Pixel the request was centered on.
+    std::vector<PickResult> pixels;     ///< Row major, the first row is the top.
+
+    /**
+     * @brief Gets the result of a pixel in window coordinates, background outside of the region.
+     */
+    PickResult at(const glm::ivec2& pixel) const;
+
+    /**
+     * @brief Gets the hit closest to the cursor, background if the region contains no hit.
+     */
+    PickResult closest() const;
+};
+
+/**
+ * @brief Settings of a gla::IdPicking.
+ */
+struct IdPickingSettings {
+    int maxRequests = 8;        ///< Maximum amount of pick requests waiting for their readback.
+    int maxRegionSize = 64;     ///< Maximum width and height of a requested region.
+};
+
+/**
+ * @brief Pixel exact picking with an ID render pass and asynchronous readback.
+ *
+ * Objects are drawn between begin() and end() with shaders that call writePickId() from glslSource(),
+ * which writes the id and gl_PrimitiveID into an RG32UI render target with its own depth buffer.
+ * Only the requested region is copied into a PixelPack Buffer with glReadPixels, which returns immediately
+ * because the destination is a Buffer, and a Fence is placed behind it. update() delivers the regions
+ * whose Fence signaled, usually a frame or two later, so neither the CPU nor the GPU ever waits
+ * and no geometry is traversed on the CPU.
+ *
+ * @warning IdPicking must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class IdPicking {
+public:
+    using Callback = std::function<void(const PickRegion& region)>;
+
+private:
+    struct Request {
+        Fence fence;
+        PickRegion region;
+        Callback callback;
+        bool active = false;
+    };
+
+    IdPickingSettings _settings;
+    Texture _ids;
+    Texture _depth;
+    Framebuffer _framebuffer;
+    Buffer _readback;
+    const uint32_t* _readbackData = nullptr;
+    std::vector<Request> _requests;
+    int _previousFramebuffer = 0;
+    int _previousReadFramebuffer = 0;
+    int _previousViewport[4] = {};
+    bool _drawing = false;
+
+    void _allocate(int width, int height);
+    bool _queue(const glm::ivec2& origin, const glm::ivec2& size, const glm::ivec2& cursor, Callback callback);
+
+public:
+    /**
+     * @brief Construct a new IdPicking with a render target of the given size.
+     *
+     * @throws std::invalid_argument If a size or setting is not greater than 0
+     */
+    IdPicking(int width, int height, const IdPickingSettings& settings = {});
+    IdPicking(IdPicking&& other) = delete;
+    IdPicking(const IdPicking& other) = delete;
+
+    /**
+     * @brief Reallocates the render target, pending requests are still delivered.
+     *
+     * @throws std::invalid_argument If width or height is not greater than 0
+     */
+    void resize(int width, int height);
+
+    /**
+     * @brief Binds and clears the ID render target, the current framebuffer and viewport are restored by end().
+     *
+     * @throws std::logic_error If begin() was already called without end()
+     */
+    void begin();
+
+    /**
+     * @brief Stops drawing into the ID render target.
+     *
+     * @throws std::logic_error If begin() was not called
+     */
+    void end();
+
+    /**
+     * @brief Requests the ids of the pixels around a cursor position from the last ID pass.
+     *
+     * @param cursor Pixel in window coordinates (origin at the top left as reported by GLFW)
+     * @param radius The region reaches this many pixels from the cursor in every direction, 0 reads a single pixel
+     * @param callback Called by update() once the pixels arrived
+     * @return false if the region is outside of the render target or maxRequests requests are already pending
+     *
+     * @throws std::invalid_argument If the region is larger than maxRegionSize
+     */
+    bool pick(const glm::ivec2& cursor, int radius, Callback callback);
+
+    /**
+     * @brief Requests the ids of a rectangle of pixels from the last ID pass, e.g. for box selection.
+     *
+     * @param origin Top left pixel in window coordinates, the region is clipped to the render target
+     *
+     * @throws std::invalid_argument If the region is larger than maxRegionSize
+     */
+    bool pickRegion(const glm::ivec2& origin, const glm::ivec2& size, Callback callback);
+
+    /**
+     * @brief Delivers all requests whose readback finished, never waits.
+     */
+    void update();
+
+    /**
+     * @brief Gets GLSL code declaring the output at location 0 and void writePickId(uint id).
+     *
+     * @note The code has to be inserted after the #version directive of a fragment shader.
+     */
+    static const char* glslSource();
+
+    const Texture& ids() const { return _ids; }
+    const Framebuffer& framebuffer() const { return _framebuffer; }
+    size_t pendingRequests() const;
+};
+
+}
+
+#endif
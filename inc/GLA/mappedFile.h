@@ -0,0 +1,65 @@
+#ifndef GLA_MAPPED_FILE_H
+#define GLA_MAPPED_FILE_H
+
+#include <string>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+namespace gla {
+
+/**
+ * @brief Read only memory mapping of a whole file.
+ *
+ * The file contents are paged in by the operating system on first access instead of being read into a copy,
+ * so data can be handed to OpenGL or parsed in place straight from the page cache.
+ *
+ * @note The mapping stays valid after the file is deleted or renamed, but writes to the file by other processes may be visible.
+ */
+class MappedFile {
+private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+
+    void _unmap();
+
+public:
+    /**
+     * @brief Construct a new empty MappedFile.
+     */
+    MappedFile() = default;
+
+    /**
+     * @brief Maps the file at path into memory.
+     *
+     * @throws std::invalid_argument If the file can't be opened
+     * @throws std::runtime_error If the file can't be mapped
+     */
+    MappedFile(const std::string& path);
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile& other) = delete;
+    ~MappedFile();
+
+    /**
+     * @brief Gets a pointer to the first byte of the file, nullptr for empty files.
+     */
+    const uint8_t* data() const { return _data; }
+
+    /**
+     * @brief Gets the size of the file in bytes.
+     */
+    size_t size() const { return _size; }
+
+    /**
+     * @brief Gets the whole file as a span of bytes.
+     */
+    std::span<const uint8_t> bytes() const { return { _data, _size }; }
+
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile& operator=(const MappedFile& other) = delete;
+};
+
+}
+
+#endif
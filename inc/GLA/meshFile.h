@@ -0,0 +1,256 @@
+#ifndef GLA_MESH_FILE_H
+#define GLA_MESH_FILE_H
+
+#include <string>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <stdexcept>
+#include <glm/vec3.hpp>
+
+#include <GLA/mappedFile.h>
+#include <GLA/vertexArray.h>
+
+namespace gla {
+
+/**
+ * @brief Exception thrown when a binary mesh file is invalid or has an unsupported version.
+ */
+class MeshFileError : public std::runtime_error {
+public:
+    /**
+     * @brief Construct a new Mesh File Error object.
+     *
+     * @param message Description of what is wrong with the file.
+     */
+    MeshFileError(const std::string& message)
+        : std::runtime_error(
+              "Mesh file is invalid:\n" + message) {}
+};
+
+constexpr uint32_t kMeshFileMagic = 0x4D414C47;    ///< "GLAM" in little endian.
+constexpr uint32_t kMeshFileVersion = 1;           ///< Version written by writeMeshFile(), files with a different major version are rejected.
+constexpr uint64_t kMeshFileAlignment = 64;        ///< Alignment of every block in a mesh file.
+
+/**
+ * @brief Header at the start of a binary mesh file, all offsets are relative to the start of the file.
+ *
+ * File layout (all blocks aligned to kMeshFileAlignment, little endian):
+ * header, attribute table, submesh table, vertex block, index block.
+ * The vertex block is stored in exactly the interleaved layout described by the attribute table and the index block
+ * in the layout of indexType, so both can be handed to OpenGL without conversion.
+ */
+struct MeshFileHeader {
+    uint32_t magic;             ///< kMeshFileMagic.
+    uint32_t version;           ///< kMeshFileVersion.
+    uint32_t attributeCount;    ///< Amount of MeshFileAttribute entries.
+    uint32_t submeshCount;      ///< Amount of Submesh entries.
+    uint32_t vertexCount;       ///< Amount of vertices in the vertex block.
+    uint32_t vertexStride;      ///< Size of one vertex in bytes.
+    uint32_t indexCount;        ///< Amount of indices in the index block, 0 for non indexed meshes.
+    uint32_t indexType;         ///< gla::IndexType of the index block.
+    uint64_t attributeOffset;   ///< Offset of the attribute table.
+    uint64_t submeshOffset;     ///< Offset of the submesh table.
+    uint64_t vertexOffset;      ///< Offset of the vertex block.
+    uint64_t indexOffset;       ///< Offset of the index block.
+    float boundsMin[3];         ///< Minimum of the axis aligned bounding box.
+    float boundsMax[3];         ///< Maximum of the axis aligned bounding box.
+};
+static_assert(sizeof(MeshFileHeader) == 88, "MeshFileHeader must not contain padding!");
+
+/**
+ * @brief On disk representation of a gla::VertexAttribute.
+ */
+struct MeshFileAttribute {
+    uint32_t index;
+    uint32_t numComponents;
+    uint32_t type;          ///< gla::VertexAttribType
+    uint32_t interp;        ///< gla::VertexAttribInterp
+    uint32_t normalized;
+    uint32_t offset;
+};
+static_assert(sizeof(MeshFileAttribute) == 24, "MeshFileAttribute must not contain padding!");
+
+/**
+ * @brief Range of indices drawn with one material.
+ */
+struct Submesh {
+    uint32_t firstIndex;    ///< First index (or vertex for non indexed meshes) of the submesh.
+    uint32_t count;         ///< Amount of indices (or vertices) of the submesh.
+    int32_t baseVertex;     ///< Value added to every index.
+    uint32_t material;      ///< Material slot of the submesh.
+};
+static_assert(sizeof(Submesh) == 16, "Submesh must not contain padding!");
+
+/**
+ * @brief CPU side mesh in GPU layout, as produced by importers and written by writeMeshFile().
+ */
+struct MeshData {
+    std::vector<VertexAttribute> attributes;    ///< Layout of one interleaved vertex.
+    int stride = 0;                             ///< Size of one vertex in bytes.
+    uint32_t vertexCount = 0;                   ///< Amount of vertices.
+    std::vector<uint8_t> vertices;              ///< vertexCount * stride bytes of interleaved vertices.
+    IndexType indexType = IndexType::UnsignedInt;   ///< Type of the indices.
+    uint32_t indexCount = 0;                    ///< Amount of indices, 0 for non indexed meshes.
+    std::vector<uint8_t> indices;               ///< indexCount indices of indexType.
+    std::vector<Submesh> submeshes;             ///< Submeshes, a mesh without submeshes is drawn as one.
+    glm::vec3 boundsMin = glm::vec3(0.0f);      ///< Minimum of the axis aligned bounding box.
+    glm::vec3 boundsMax = glm::vec3(0.0f);      ///< Maximum of the axis aligned bounding box.
+};
+
+/**
+ * @brief Writes a mesh into a binary mesh file.
+ *
+ * @throws std::invalid_argument If the vertex or index data doesn't match the counts, stride or index type or a submesh lies outside of the mesh
+ * @throws std::runtime_error If the file can't be written
+ */
+void writeMeshFile(const std::string& path, const MeshData& mesh);
+
+/**
+ * @brief Memory mapped, validated binary mesh file.
+ *
+ * Nothing is parsed or copied: all accessors point into the mapping, which stays valid as long as the MeshFile lives.
+ */
+class MeshFile {
+private:
+    MappedFile _file;
+    std::span<const uint8_t> _data;
+    const MeshFileHeader* _header = nullptr;
+
+    void _validate();
+
+public:
+    /**
+     * @brief Maps and validates a binary mesh file.
+     *
+     * @throws std::invalid_argument If the file can't be opened
+     * @throws gla::MeshFileError If the file is not a mesh file, has an unsupported version or any block or submesh lies outside of the file
+     */
+    MeshFile(const std::string& path);
+
+    /**
+     * @brief Validates a binary mesh file that is already in memory, e.g. an entry of a gla::AssetPack.
+     *
+     * @warning data is not copied and must outlive the MeshFile, it must be aligned to at least 8 bytes.
+     *
+     * @throws gla::MeshFileError If the data is not a mesh file, has an unsupported version or any block or submesh lies outside of it
+     */
+    MeshFile(std::span<const uint8_t> data);
+    MeshFile(MeshFile&& other) = default;
+    MeshFile(const MeshFile& other) = delete;
+
+    /**
+     * @brief Gets the vertex attributes of the interleaved vertex block.
+     */
+    std::vector<VertexAttribute> attributes() const;
+
+    /**
+     * @brief Gets the submeshes.
+     */
+    std::span<const Submesh> submeshes() const;
+
+    /**
+     * @brief Gets the interleaved vertex block.
+     */
+    std::span<const uint8_t> vertexData() const;
+
+    /**
+     * @brief Gets the index block, empty for non indexed meshes.
+     */
+    std::span<const uint8_t> indexData() const;
+
+    int stride() const { return (int)_header->vertexStride; }
+    uint32_t vertexCount() const { return _header->vertexCount; }
+    uint32_t indexCount() const { return _header->indexCount; }
+    IndexType indexType() const { return (IndexType)_header->indexType; }
+    glm::vec3 boundsMin() const { return { _header->boundsMin[0], _header->boundsMin[1], _header->boundsMin[2] }; }
+    glm::vec3 boundsMax() const { return { _header->boundsMax[0], _header->boundsMax[1], _header->boundsMax[2] }; }
+
+    MeshFile& operator=(MeshFile&& other) = default;
+    MeshFile& operator=(const MeshFile& other) = delete;
+};
+
+/**
+ * @brief Mesh stored in an interleaved vertex Buffer and an optional index Buffer.
+ *
+ * @warning Mesh must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class Mesh {
+private:
+    VertexArray _vertices;
+    Buffer _indices;
+    std::vector<VertexAttribute> _attributes;
+    int _stride = 0;
+    uint32_t _vertexCount = 0;
+    uint32_t _indexCount = 0;
+    IndexType _indexType = IndexType::UnsignedInt;
+    std::vector<Submesh> _submeshes;
+    glm::vec3 _boundsMin = glm::vec3(0.0f);
+    glm::vec3 _boundsMax = glm::vec3(0.0f);
+
+    void _upload(std::span<const uint8_t> vertices, std::span<const uint8_t> indices, BufferFlag flags);
+
+public:
+    /**
+     * @brief Uploads a mapped mesh file, the blocks are passed straight from the mapping to Buffer::setStorage.
+     *
+     * @param flags BufferFlags of the vertex and index Buffer
+     */
+    Mesh(const MeshFile& file, BufferFlag flags = BufferFlag::None);
+
+    /**
+     * @brief Uploads a CPU side mesh.
+     *
+     * @param flags BufferFlags of the vertex and index Buffer
+     */
+    Mesh(const MeshData& data, BufferFlag flags = BufferFlag::None);
+
+    /**
+     * @brief Maps and uploads the binary mesh file at path.
+     *
+     * @throws std::invalid_argument If the file can't be opened
+     * @throws gla::MeshFileError If the file is invalid
+     */
+    static Mesh load(const std::string& path, BufferFlag flags = BufferFlag::None);
+
+    Mesh(Mesh&& other) = default;
+    Mesh(const Mesh& other) = delete;
+
+    /**
+     * @brief Binds the vertex Buffer with its attributes and the index Buffer.
+     *
+     * @note Vertex attribute state is global in this abstraction, so the Mesh must be bound again after binding another one.
+     */
+    void bind();
+
+    /**
+     * @brief Draws a single submesh as triangles, the Mesh must be bound.
+     *
+     * @throws std::out_of_range If submesh is not a valid submesh index
+     */
+    void draw(size_t submesh) const;
+
+    /**
+     * @brief Draws all submeshes as triangles, the Mesh must be bound.
+     */
+    void draw() const;
+
+    const VertexArray& vertices() const { return _vertices; }
+    const Buffer& indices() const { return _indices; }
+    const std::vector<VertexAttribute>& attributes() const { return _attributes; }
+    const std::vector<Submesh>& submeshes() const { return _submeshes; }
+    int stride() const { return _stride; }
+    uint32_t vertexCount() const { return _vertexCount; }
+    uint32_t indexCount() const { return _indexCount; }
+    IndexType indexType() const { return _indexType; }
+    glm::vec3 boundsMin() const { return _boundsMin; }
+    glm::vec3 boundsMax() const { return _boundsMax; }
+
+    Mesh& operator=(Mesh&& other) = default;
+    Mesh& operator=(const Mesh& other) = delete;
+};
+
+}
+
+#endif
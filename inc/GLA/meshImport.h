@@ -0,0 +1,79 @@
+#ifndef GLA_MESH_IMPORT_H
+#define GLA_MESH_IMPORT_H
+
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+
+#include <GLA/meshFile.h>
+#include <GLA/threadPool.h>
+
+namespace gla {
+
+/**
+ * @brief Exception thrown when an interchange mesh file can't be parsed.
+ */
+class MeshImportError : public std::runtime_error {
+public:
+    /**
+     * @brief Construct a new Mesh Import Error object.
+     *
+     * @param message Description of what could not be parsed.
+     */
+    MeshImportError(const std::string& message)
+        : std::runtime_error(
+              "Mesh import failed:\n" + message) {}
+};
+
+/**
+ * @brief Settings of the mesh importers.
+ */
+struct MeshImportSettings {
+    size_t chunkSize = 4 << 20; ///< Approximate size of the line aligned chunks parsed in parallel in bytes.
+    bool deduplicate = true;    ///< Merge OBJ face corners referencing the same position, uv and normal into one vertex.
+};
+
+/**
+ * @brief Imports a Wavefront OBJ file.
+ *
+ * The file is memory mapped and split into line aligned chunks that are parsed in parallel with std::from_chars.
+ * A cheap counting pass first determines where every chunk's positions, uvs and normals start, so chunks write
+ * straight into the merged arrays and face indices (including negative ones) resolve without a second pass.
+ *
+ * Polygons are triangulated as fans, "usemtl" starts a new Submesh and per vertex colors ("v x y z r g b") are kept.
+ * Files without faces import as point clouds with indexCount 0.
+ * The resulting vertex layout (interleaved, missing attributes omitted) is:
+ * location 0 position (3 floats), 1 normal (3 floats), 2 uv (2 floats), 3 color (4 normalized unsigned bytes).
+ *
+ * @throws std::invalid_argument If the file can't be opened
+ * @throws gla::MeshImportError If the file is malformed
+ *
+ * @param pool The ThreadPool the chunks are parsed on
+ */
+MeshData importObj(const std::string& path, const MeshImportSettings& settings = {}, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Imports a Stanford PLY file in ascii, binary little endian or binary big endian format.
+ *
+ * The file is memory mapped, vertices are converted in parallel (line aligned chunks for ascii,
+ * fixed size records for binary) and faces are triangulated as fans. Files without faces import as point clouds
+ * with indexCount 0. The vertex layout matches importObj(), colors are read from red/green/blue(/alpha).
+ *
+ * @throws std::invalid_argument If the file can't be opened
+ * @throws gla::MeshImportError If the file is malformed or has no vertex element
+ *
+ * @param pool The ThreadPool the vertices are converted on
+ */
+MeshData importPly(const std::string& path, const MeshImportSettings& settings = {}, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Imports an OBJ or PLY file depending on its extension.
+ *
+ * @throws std::invalid_argument If the extension is neither .obj nor .ply or the file can't be opened
+ * @throws gla::MeshImportError If the file is malformed
+ */
+MeshData importMesh(const std::string& path, const MeshImportSettings& settings = {}, ThreadPool& pool = ThreadPool::shared());
+
+}
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef GLA_OCCLUSION_QUERIES_H
+#define GLA_OCCLUSION_QUERIES_H
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/program.h>
+#include <GLA/ringBuffer.h>
+
+namespace gla {
+
+/**
+ * @brief Pool of OpenGL query objects.
+ *
+ * Query names are generated in batches and recycled instead of being created and deleted every frame.
+ * Names are typeless until they are first begun, so one pool can serve queries of any target.
+ *
+ * @warning QueryPool must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class QueryPool {
+private:
+    std::vector<unsigned int> _queries;
+    std::vector<unsigned int> _free;
+    int _batchSize;
+
+    void _delete();
+
+public:
+    /**
+     * @brief Construct an empty QueryPool.
+     *
+     * @throws std::invalid_argument If batchSize is not greater than 0
+     *
+     * @param batchSize Amount of query names generated at once when the pool runs empty
+     */
+    QueryPool(int batchSize = 64);
+    QueryPool(QueryPool&& other);
+    QueryPool(const QueryPool& other) = delete;
+    ~QueryPool() noexcept;
+
+    /**
+     * @brief Gets an unused query name.
+     */
+    unsigned int acquire();
+
+    /**
+     * @brief Returns a query name to the pool, its result must not be needed anymore.
+     */
+    void release(unsigned int query);
+
+    /**
+     * @brief Gets the amount of query names owned by the pool.
+     */
+    size_t size() const { return _queries.size(); }
+
+    QueryPool& operator=(QueryPool&& other);
+    QueryPool& operator=(const QueryPool& other) = delete;
+};
+
+/**
+ * @brief Settings of gla::OcclusionQueries.
+ */
+struct OcclusionSettings {
+    int maxQueriesPerFrame = 8192;  ///< Maximum amount of proxy boxes queried per frame.
+    int maxQueriesInFlight = 3;     ///< Per object, no new query is issued while this many results are outstanding.
+    float boxInflation = 0.0f;      ///< World space margin added to every proxy box, hides depth precision issues of tight boxes.
+};
+
+/**
+ * @brief Handle of an object tested by gla::OcclusionQueries.
+ */
+using OcclusionObject = uint32_t;
+
+/**
+ * @brief Hardware occlusion culling with proxy bounding boxes.
+ *
+ * Every frame the boxes of the tested objects are rasterized against the depth buffer of the occluders drawn so far,
+ * each inside its own GL_ANY_SAMPLES_PASSED_CONSERVATIVE query with color and depth writes disabled.
+ * All boxes of a frame are uploaded with one RingBuffer allocation and expanded in the vertex shader.
+ *
+ * Results are consumed without stalling: beginFrame() only reads queries whose result is already available,
+ * which is usually the case one frame later, so visible() reports the latest known result.
+ * beginConditionalRender() additionally lets the GPU skip the draws of an object if its most recent query
+ * found no samples (GL_QUERY_NO_WAIT draws if the result isn't ready yet).
+ *
+ * Usage per frame: beginFrame(), draw occluders, query() the tested objects, flush(),
+ * draw tested objects with visible() and beginConditionalRender() / endConditionalRender().
+ * Objects skipped because they were hidden must still be queried to notice when they reappear.
+ *
+ * @warning OcclusionQueries must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class OcclusionQueries {
+private:
+    struct Object {
+        std::vector<unsigned int> pending; // issued queries with unread result, oldest first
+        unsigned int latest = 0;    // query used for conditional rendering, 0 if there is none
+        bool visible = true;
+        bool alive = false;
+    };
+
+    struct Box {
+        glm::vec4 min;
+        glm::vec4 max;
+    };
+
+    OcclusionSettings _settings;
+    QueryPool _pool;
+    Program _program;
+    RingBuffer _ring;
+    int64_t _storageAlignment = 256;
+    glm::mat4 _viewProjection = glm::mat4(1.0f);
+    std::vector<Object> _objects;
+    std::vector<OcclusionObject> _freeObjects;
+    std::vector<Box> _boxes;
+    std::vector<OcclusionObject> _boxObjects;
+    bool _conditional = false;
+    bool _conditionalQuery = false; // glBeginConditionalRender was called for the active conditional render
+
+    Object& _get(OcclusionObject object);
+    const Object& _get(OcclusionObject object) const;
+    void _releaseLatest(Object& object);
+
+public:
+    /**
+     * @brief Construct new OcclusionQueries.
+     *
+     * @throws std::invalid_argument If maxQueriesPerFrame or maxQueriesInFlight is not greater than 0
+     * @throws gla::ShaderCompileError If the proxy shaders fail to compile.
+     * @throws gla::ProgramLinkError If the proxy Program fails to link.
+     */
+    OcclusionQueries(const OcclusionSettings& settings = {});
+    OcclusionQueries(OcclusionQueries&& other) = delete;
+    OcclusionQueries(const OcclusionQueries& other) = delete;
+
+    /**
+     * @brief Adds an object, it counts as visible until its first query completed.
+     */
+    OcclusionObject create();
+
+    /**
+     * @brief Removes an object and recycles its queries.
+     *
+     * @throws std::out_of_range If object is not a valid object
+     */
+    void destroy(OcclusionObject object);
+
+    /**
+     * @brief Starts a frame by reading all query results that are available without waiting.
+     *
+     * @param viewProjection Matrix the proxy boxes of this frame are rendered with
+     */
+    void beginFrame(const glm::mat4& viewProjection);
+
+    /**
+     * @brief Queues a proxy box test for an object.
+     *
+     * Boxes crossing the near plane can't be rasterized reliably, their objects count as visible without a query.
+     *
+     * @throws std::out_of_range If object is not a valid object
+     * @throws std::runtime_error If more than maxQueriesPerFrame boxes were queued this frame
+     *
+     * @param min Minimum of the world space bounding box
+     * @param max Maximum of the world space bounding box
+     */
+    void query(OcclusionObject object, const glm::vec3& min, const glm::vec3& max);
+
+    /**
+     * @brief Renders all queued proxy boxes against the current depth buffer and issues their queries.
+     *
+     * @note Color, depth writes, depth test and face culling state are restored afterwards.
+     */
+    void flush();
+
+    /**
+     * @brief Gets the latest known visibility of an object.
+     *
+     * @throws std::out_of_range If object is not a valid object
+     */
+    bool visible(OcclusionObject object) const;
+
+    /**
+     * @brief Starts conditional rendering on the most recent query of an object.
+     *
+     * If the object has no query (never queried or crossing the near plane) drawing is unconditional.
+     *
+     * @throws std::out_of_range If object is not a valid object
+     * @throws std::logic_error If conditional rendering is already active
+     */
+    void beginConditionalRender(OcclusionObject object);
+
+    /**
+     * @brief Ends conditional rendering started by beginConditionalRender().
+     *
+     * @throws std::logic_error If conditional rendering is not active
+     */
+    void endConditionalRender();
+
+    /**
+     * @brief Gets the amount of query objects allocated by the pool.
+     */
+    size_t queryCount() const { return _pool.size(); }
+
+    OcclusionQueries& operator=(OcclusionQueries&& other) = delete;
+    OcclusionQueries& operator=(const OcclusionQueries& other) = delete;
+};
+
+}
+
+#endif
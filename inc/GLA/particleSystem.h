@@ -0,0 +1,133 @@
+#ifndef GLA_PARTICLE_SYSTEM_H
+#define GLA_PARTICLE_SYSTEM_H
+
+#include <vector>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/buffer.h>
+#include <GLA/program.h>
+
+namespace gla {
+
+/**
+ * @brief Settings of a gla::ParticleSystem.
+ */
+struct ParticleSystemSettings {
+    unsigned int maxParticles = 262144; ///< Capacity of the particle pool.
+    bool depthSort = false;             ///< Sort particles back to front on the GPU before rendering (needed for non additive blending).
+};
+
+/**
+ * @brief Describes how newly emitted particles are initialized.
+ */
+struct ParticleEmitter {
+    glm::vec3 position = glm::vec3(0.0f);                       ///< Center of the spawn volume.
+    float positionSpread = 0.0f;                                ///< Radius of the spawn sphere.
+    glm::vec3 velocity = glm::vec3(0.0f, 1.0f, 0.0f);           ///< Initial velocity.
+    float velocitySpread = 0.5f;                                ///< Radius of the random velocity added to velocity.
+    glm::vec4 colorStart = glm::vec4(1.0f);                     ///< Color at birth.
+    glm::vec4 colorEnd = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);     ///< Color at death.
+    float sizeStart = 0.1f;                                     ///< World space size at birth.
+    float sizeEnd = 0.05f;                                      ///< World space size at death.
+    float lifetime = 2.0f;                                      ///< Average lifetime in seconds.
+    float lifetimeSpread = 0.5f;                                ///< Random variation of the lifetime in seconds.
+};
+
+/**
+ * @brief GPU particle system where particle state never leaves video memory.
+ *
+ * Particles live in a shader storage pool, free slots in a dead list and living particles in two alive lists
+ * that are swapped every update. Emission allocates slots from the dead list with atomic counters, simulation
+ * compacts survivors into the other alive list and returns dead slots, all in compute shaders.
+ * The alive count never reaches the CPU: it is turned into indirect dispatch and draw arguments on the GPU.
+ * Optionally the alive list is depth sorted with a bitonic sort before rendering.
+ *
+ * Usage per frame: any amount of emit() calls, update(), render().
+ *
+ * @warning ParticleSystem must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class ParticleSystem {
+private:
+    struct Emission {
+        ParticleEmitter emitter;
+        unsigned int count;
+    };
+
+    ParticleSystemSettings _settings;
+    unsigned int _sortCapacity = 0;
+    Buffer _particles;
+    Buffer _aliveLists[2];
+    Buffer _deadList;
+    Buffer _counters;
+    Buffer _indirect;
+    Buffer _sortKeys;
+    Program _emitProgram;
+    Program _prepareProgram;
+    Program _simulateProgram;
+    Program _finalizeProgram;
+    Program _sortKeyProgram;
+    Program _sortProgram;
+    Program _renderProgram;
+    int _current = 0;
+    uint32_t _seed = 0;
+    std::vector<Emission> _emissions;
+
+    void _bindLists() const;
+    void _sort(const glm::mat4& view);
+
+public:
+    /**
+     * @brief Construct a new ParticleSystem with an empty particle pool.
+     *
+     * @throws std::invalid_argument If maxParticles is 0
+     * @throws gla::ShaderCompileError If a particle shader fails to compile.
+     * @throws gla::ProgramLinkError If a particle Program fails to link.
+     */
+    ParticleSystem(const ParticleSystemSettings& settings = {});
+    ParticleSystem(ParticleSystem&& other) = delete;
+    ParticleSystem(const ParticleSystem& other) = delete;
+
+    /**
+     * @brief Queues count particles to be emitted in the next update().
+     *
+     * @note Particles that don't fit into the pool are silently dropped on the GPU.
+     */
+    void emit(const ParticleEmitter& emitter, unsigned int count);
+
+    /**
+     * @brief Emits the queued particles and advances the simulation.
+     *
+     * @note Binds the particle compute Programs, shader storage bindings 0 to 5 and atomic counter binding 0.
+     *
+     * @param deltaTime Simulated time in seconds
+     * @param gravity Acceleration applied to all particles
+     * @param drag Fraction of velocity lost per second
+     */
+    void update(float deltaTime, const glm::vec3& gravity = glm::vec3(0.0f, -9.81f, 0.0f), float drag = 0.0f);
+
+    /**
+     * @brief Draws all living particles as camera facing quads with one indirect instanced draw.
+     *
+     * @note Binds the particle render Program and shader storage bindings 0 to 6, the blend state is left to the caller.
+     *
+     * @param view The view matrix of the camera
+     * @param projection The projection matrix of the camera
+     */
+    void render(const glm::mat4& view, const glm::mat4& projection);
+
+    /**
+     * @brief Gets the capacity of the particle pool.
+     */
+    unsigned int capacity() const { return _settings.maxParticles; }
+
+    ParticleSystem& operator=(ParticleSystem&& other) = delete;
+    ParticleSystem& operator=(const ParticleSystem& other) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,306 @@
+#ifndef GLA_POINT_CLOUD_H
+#define GLA_POINT_CLOUD_H
+
+#include <map>
+#include <span>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+#include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/mappedFile.h>
+#include <GLA/vertexArray.h>
+#include <GLA/program.h>
+#include <GLA/threadPool.h>
+
+namespace gla {
+
+/**
+ * @brief Exception thrown when a point cloud file is invalid or has an unsupported version.
+ */
+class PointCloudFileError : public std::runtime_error {
+public:
+    /**
+     * @brief Construct a new Point Cloud File Error object.
+     *
+     * @param message Description of what is wrong with the file.
+     */
+    PointCloudFileError(const std::string& message)
+        : std::runtime_error(
+              "Point cloud file is invalid:\n" + message) {}
+};
+
+constexpr uint32_t kPointCloudMagic = 0x50414C47;   ///< "GLAP" in little endian.
+constexpr uint32_t kPointCloudVersion = 1;          ///< Version written by buildPointCloudFile(), files with a different version are rejected.
+constexpr uint64_t kPointCloudAlignment = 64;       ///< Alignment of the point block and the node table.
+
+/**
+ * @brief Header at the start of a point cloud file, all offsets are relative to the start of the file.
+ *
+ * File layout (little endian): header, point block, node table.
+ * The points of every node are contiguous in the point block and stored in exactly the layout of PointCloudPoint,
+ * so a node is handed to OpenGL without conversion. Nodes are stored breadth first, the children of a node are
+ * contiguous starting at firstChild in the order of the bits set in childMask.
+ */
+struct PointCloudHeader {
+    uint32_t magic;             ///< kPointCloudMagic.
+    uint32_t version;           ///< kPointCloudVersion.
+    uint32_t nodeCount;         ///< Amount of PointCloudNode entries, node 0 is the root.
+    uint32_t gridSize;          ///< Cells per axis of the sampling grid of inner nodes.
+    uint64_t pointCount;        ///< Amount of points in the point block.
+    uint64_t pointOffset;       ///< Offset of the point block.
+    uint64_t nodeOffset;        ///< Offset of the node table.
+    float boundsMin[3];         ///< Minimum of the bounding cube of the root.
+    float size;                 ///< Edge length of the bounding cube of the root.
+};
+static_assert(sizeof(PointCloudHeader) == 56, "PointCloudHeader must not contain padding!");
+
+/**
+ * @brief Octree node of a point cloud file.
+ *
+ * Inner nodes hold a subsample with one point per cell of a gridSize^3 grid over their cube, the remaining points
+ * are passed on to the children. Leaves hold all remaining points. A node never repeats points of its ancestors,
+ * so drawing a node and its children adds detail without overdraw.
+ */
+struct PointCloudNode {
+    uint64_t firstPoint;    ///< Index of the first point of the node in the point block.
+    uint32_t pointCount;    ///< Amount of points of the node.
+    uint32_t firstChild;    ///< Index of the first child, 0 for leaves.
+    uint32_t childMask;     ///< Bit i is set if the child in octant i (x = bit 0, y = bit 1, z = bit 2) exists.
+    uint32_t level;         ///< Depth of the node, 0 for the root.
+    uint32_t parent;        ///< Index of the parent, UINT32_MAX for the root.
+    float boundsMin[3];     ///< Minimum of the bounding cube.
+    float size;             ///< Edge length of the bounding cube.
+    float spacing;          ///< Average distance between the points of the node.
+};
+static_assert(sizeof(PointCloudNode) == 48, "PointCloudNode must not contain padding!");
+
+/**
+ * @brief Quantized point, the position is relative to the bounding cube of its node.
+ */
+struct PointCloudPoint {
+    uint16_t position[3];   ///< boundsMin + position / 65535 * size of the node.
+    uint16_t intensity;     ///< Intensity of the source point, 0 if it has none.
+    uint8_t color[4];       ///< sRGB color and alpha.
+};
+static_assert(sizeof(PointCloudPoint) == 12, "PointCloudPoint must not contain padding!");
+
+/**
+ * @brief Point read from a source file, input of buildPointCloudFile().
+ */
+struct PointCloudSourcePoint {
+    glm::vec3 position = glm::vec3(0.0f);
+    uint8_t color[4] = { 255, 255, 255, 255 };
+    uint16_t intensity = 0;
+};
+
+/**
+ * @brief Settings of buildPointCloudFile().
+ */
+struct PointCloudBuildSettings {
+    uint32_t maxNodePoints = 20000;     ///< Nodes with more points are split, must be at least 1.
+    uint32_t gridSize = 128;            ///< Cells per axis of the sampling grid, in [2;256].
+    uint32_t maxDepth = 20;             ///< Nodes at this depth are leaves regardless of their point count.
+    uint64_t maxMemory = 1ull << 30;    ///< Bytes the build may hold in memory, larger nodes are streamed from spill files.
+    std::string spillDirectory;         ///< Directory of the temporary spill files, empty for the directory of the output file.
+};
+
+/**
+ * @brief Streams the source points of buildPointCloudFile() into consume, in batches of any size.
+ */
+using PointCloudSource = std::function<void(const std::function<void(std::span<const PointCloudSourcePoint> points)>& consume)>;
+
+/**
+ * @brief Builds the octree of a point cloud out of core and writes it into a point cloud file.
+ *
+ * The source is streamed once into a spill file on disk while the bounds are computed. Nodes whose points don't fit
+ * into maxMemory are sampled in two passes over their spill file, keeping the point of the lowest pseudo random
+ * priority per grid cell and spilling the rest into one file per child. Every node that fits is loaded and built
+ * with its whole subtree in memory, level by level on the ThreadPool, so the peak memory stays below maxMemory
+ * regardless of the size of the source. Spill files are deleted as soon as they are consumed.
+ *
+ * @throws std::invalid_argument If the source has no points or a setting is out of range, maxMemory must hold
+ * maxNodePoints points and a uint32_t per sampling grid cell
+ * @throws std::runtime_error If the file or a spill file can't be written or read
+ *
+ * @param source Called exactly once
+ */
+void buildPointCloudFile(const std::string& path, const PointCloudSource& source,
+                         const PointCloudBuildSettings& settings = {}, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Builds the octree of points already in memory, see buildPointCloudFile(const std::string&, const PointCloudSource&, const PointCloudBuildSettings&, ThreadPool&).
+ */
+void buildPointCloudFile(const std::string& path, std::span<const PointCloudSourcePoint> points,
+                         const PointCloudBuildSettings& settings = {}, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Memory mapped, validated point cloud file, safe to read from several threads.
+ */
+class PointCloudFile {
+private:
+    MappedFile _file;
+    std::span<const uint8_t> _data;
+    const PointCloudHeader* _header = nullptr;
+
+    void _validate();
+
+public:
+    /**
+     * @brief Maps and validates a point cloud file, the points are paged in when a node is read.
+     *
+     * @throws std::invalid_argument If the file can't be opened
+     * @throws gla::PointCloudFileError If the file is not a point cloud file, has an unsupported version or any block or node lies outside of the file
+     */
+    PointCloudFile(const std::string& path);
+    PointCloudFile(PointCloudFile&& other) = default;
+    PointCloudFile(const PointCloudFile& other) = delete;
+
+    /**
+     * @brief Gets the node table, node 0 is the root.
+     */
+    std::span<const PointCloudNode> nodes() const;
+
+    /**
+     * @brief Gets the points of a node.
+     *
+     * @throws std::out_of_range If node is not a valid node index
+     */
+    std::span<const PointCloudPoint> points(uint32_t node) const;
+
+    uint64_t pointCount() const { return _header->pointCount; }
+    uint32_t gridSize() const { return _header->gridSize; }
+    glm::vec3 boundsMin() const { return { _header->boundsMin[0], _header->boundsMin[1], _header->boundsMin[2] }; }
+    float size() const { return _header->size; }
+
+    PointCloudFile& operator=(PointCloudFile&& other) = default;
+    PointCloudFile& operator=(const PointCloudFile& other) = delete;
+};
+
+/**
+ * @brief Settings of a gla::PointCloud.
+ */
+struct PointCloudSettings {
+    uint32_t capacity = 16u << 20;  ///< Points the GPU Buffer holds, resident nodes not drawn stay cached in the rest.
+    uint32_t pointBudget = 8u << 20;///< Maximum amount of points drawn per frame.
+    float maxError = 1.5f;          ///< Nodes whose point spacing covers more pixels on screen are refined.
+    int maxLoads = 16;              ///< Maximum amount of nodes being loaded on the ThreadPool.
+    int maxUploadsPerFrame = 32;    ///< Maximum amount of loaded nodes uploaded per update().
+    float pointScale = 1.0f;        ///< Scale of the adaptive point size.
+    float minPointSize = 1.0f;      ///< Minimum point size in pixels.
+    float maxPointSize = 16.0f;     ///< Maximum point size in pixels.
+};
+
+/**
+ * @brief Out of core point cloud renderer streaming the octree of a point cloud file by screen space error.
+ *
+ * update() traverses the octree from the root, largest screen space error first, where the error of a node is its
+ * point spacing projected to pixels. Visible nodes are selected until the point budget is used up and refined while
+ * their error exceeds maxError. Only children of resident nodes are considered, so the cloud always refines from
+ * coarse to fine while nodes stream in.
+ *
+ * Missing nodes are read from the mapped file on the ThreadPool and uploaded into ranges of one GPU Buffer, which is
+ * sub-allocated with a first fit free list. When it is full, the least recently drawn nodes are evicted, deepest first.
+ *
+ * Points are drawn as quantized 16 bit positions relative to their node, decoded in the vertex shader. The point size
+ * adapts to the spacing of the finest level drawn over a node, so coarse nodes fill the gaps until their children arrive.
+ *
+ * @warning PointCloud must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class PointCloud {
+private:
+    struct LoadedNode {
+        uint32_t node;
+        bool loaded;
+        std::vector<PointCloudPoint> points;
+    };
+
+    // shared with the loading tasks, which may outlive the PointCloud
+    struct LoadQueue {
+        std::mutex mutex;
+        std::vector<LoadedNode> nodes;
+    };
+
+    struct NodeState {
+        uint32_t offset = UINT32_MAX;   // first point in the GPU Buffer, UINT32_MAX if not resident
+        uint64_t lastUsed = 0;          // frame the node was last drawn
+        bool loading = false;
+        bool failed = false;
+    };
+
+    struct VisibleNode {
+        uint32_t node;
+        float spacing;          // spacing of the finest level drawn over the node
+    };
+
+    PointCloudSettings _settings;
+    std::shared_ptr<const PointCloudFile> _file;
+    ThreadPool& _pool;
+    std::shared_ptr<LoadQueue> _queue;
+    std::vector<NodeState> _nodes;
+    std::map<uint32_t, uint32_t> _free;     // free ranges of the GPU Buffer, first point -> amount of points
+    std::vector<VisibleNode> _visible;
+    VertexArray _points;
+    Program _program;
+    uint64_t _frame = 1;
+    uint64_t _visiblePoints = 0;
+    uint64_t _residentPoints = 0;
+    int _loads = 0;
+
+    bool _allocate(uint32_t count, uint32_t& offset);
+    void _release(uint32_t node);
+    void _upload(LoadedNode& loaded);
+
+public:
+    /**
+     * @brief Construct a new PointCloud drawing a mapped point cloud file.
+     *
+     * @throws std::invalid_argument If file is null or a setting is not greater than 0
+     */
+    PointCloud(std::shared_ptr<const PointCloudFile> file, const PointCloudSettings& settings = {}, ThreadPool& pool = ThreadPool::shared());
+
+    /**
+     * @brief Maps a point cloud file and constructs a new PointCloud drawing it.
+     *
+     * @throws std::invalid_argument If the file can't be opened or a setting is not greater than 0
+     * @throws gla::PointCloudFileError If the file is invalid
+     */
+    PointCloud(const std::string& path, const PointCloudSettings& settings = {}, ThreadPool& pool = ThreadPool::shared());
+    PointCloud(PointCloud&& other) = delete;
+    PointCloud(const PointCloud& other) = delete;
+
+    /**
+     * @brief Uploads loaded nodes, selects the visible nodes within the point budget and starts loads, never waits.
+     *
+     * @param viewportHeight Height of the viewport in pixels
+     */
+    void update(const glm::mat4& view, const glm::mat4& projection, int viewportHeight);
+
+    /**
+     * @brief Draws the nodes selected by the last update() into the current framebuffer.
+     *
+     * @note Vertex attribute state is global in this abstraction, attributes 0 and 1 are replaced.
+     *
+     * @param viewportHeight Height of the viewport in pixels
+     */
+    void draw(const glm::mat4& view, const glm::mat4& projection, int viewportHeight);
+
+    const PointCloudFile& file() const { return *_file; }
+    size_t visibleNodes() const { return _visible.size(); }     ///< Gets the amount of nodes drawn by draw().
+    uint64_t visiblePoints() const { return _visiblePoints; }   ///< Gets the amount of points drawn by draw().
+    uint64_t residentPoints() const { return _residentPoints; } ///< Gets the amount of points in the GPU Buffer.
+    int pendingLoads() const { return _loads; }                 ///< Gets the amount of nodes being loaded.
+
+    PointCloud& operator=(PointCloud&& other) = delete;
+    PointCloud& operator=(const PointCloud& other) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef GLA_QUANTIZED_INSTANCE_H
+#define GLA_QUANTIZED_INSTANCE_H
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <GLA/vertexArray.h>
+#include <GLA/threadPool.h>
+#include <GLA/affineTransform.h>
+
+namespace gla {
+
+/**
+ * @brief Box the positions of quantized instances are relative to, e.g. a cell of the world grid.
+ */
+struct InstanceChunk {
+    glm::vec3 origin = glm::vec3(0.0f);     ///< Minimum corner of the chunk.
+    glm::vec3 extent = glm::vec3(1.0f);     ///< Size of the chunk per axis, greater than 0.
+};
+
+/**
+ * @brief Transform of an instance quantized into 16 bytes, a quarter of a mat4.
+ *
+ * The position is 16 bit fixed point in its InstanceChunk, so the precision is extent / 65535 per axis.
+ * The rotation is stored as smallest three quaternion: the largest component is dropped and rebuilt from the unit length,
+ * the other three are in [-1 / sqrt(2); 1 / sqrt(2)] and get 10 bits each, leaving 2 bits for the index of the dropped one.
+ * The scale is stored as half floats.
+ */
+struct QuantizedInstance {
+    uint16_t position[3];   ///< Position in the chunk, origin + position / 65535 * extent.
+    uint16_t scale[3];      ///< Half float scale per axis.
+    uint32_t rotation;      ///< Index of the dropped component in bits 30 - 31, the other components in order in bits 20 - 29, 10 - 19 and 0 - 9.
+};
+
+static_assert(sizeof(QuantizedInstance) == 16, "QuantizedInstance must be 16 bytes!");
+
+/**
+ * @brief Quantizes the transform of one instance, positions outside of the chunk are clamped onto it.
+ *
+ * @note Encodes exactly like encodeInstances().
+ */
+QuantizedInstance encodeInstance(const InstanceChunk& chunk, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale = glm::vec3(1.0f));
+
+/**
+ * @brief Quantizes the transforms of many instances, 4 per SSE2 instruction, split into chunks run on the ThreadPool.
+ *
+ * @throws std::invalid_argument If the spans differ in size, scales may be empty for a scale of 1
+ *
+ * @param rotations Unit quaternions
+ */
+void encodeInstances(const InstanceChunk& chunk, std::span<const glm::vec3> positions, std::span<const glm::quat> rotations,
+                     std::span<const glm::vec3> scales, std::span<QuantizedInstance> result, ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * @brief Decodes a quantized instance on the CPU the way the GLSL code of quantizedInstanceSource() does.
+ */
+AffineTransform decodeInstance(const InstanceChunk& chunk, const QuantizedInstance& instance);
+
+/**
+ * @brief Gets the instance attributes of a QuantizedInstance, which take the three locations starting at location.
+ *
+ * @param offset Offset of the QuantizedInstance in the instance data
+ * @param divisor Instances per QuantizedInstance
+ */
+std::vector<VertexAttribute> quantizedInstanceAttributes(unsigned int location, int offset = 0, unsigned int divisor = 1);
+
+/**
+ * @brief Gets GLSL code declaring the attributes of quantizedInstanceAttributes(), the uniforms vec3 uInstanceChunkOrigin and
+ * vec3 uInstanceChunkExtent and the functions decoding the instance of the current vertex: vec4 instanceRotation(),
+ * vec3 instanceTransform(vec4 rotation, vec3 position) and vec3 instanceRotate(vec4 rotation, vec3 direction).
+ *
+ * @note The code has to be inserted after the #version directive of a vertex shader.
+ */
+std::string quantizedInstanceSource(unsigned int location);
+
+}
+
+#endif
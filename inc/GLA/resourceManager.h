@@ -0,0 +1,309 @@
+#ifndef GLA_RESOURCE_MANAGER_H
+#define GLA_RESOURCE_MANAGER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <typeindex>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdexcept>
+#include <cstdint>
+
+#include <GLA/threadPool.h>
+
+namespace gla {
+
+class ResourceManager;
+
+/**
+ * @brief Enum of the states a managed resource goes through.
+ */
+enum class ResourceState {
+    Loading,    ///< Queued, being read on a worker thread or waiting for the upload.
+    Ready,      ///< Uploaded and usable.
+    Failed,     ///< Reading or uploading threw, see ResourceHandle::error().
+    Evicted     ///< Freed to stay within the memory budget, reloaded on the next access.
+};
+
+/**
+ * @brief Describes how resources of type T are loaded.
+ *
+ * Loading is split in two stages: read runs on a worker thread and may not call OpenGL functions,
+ * upload runs on the OpenGL thread during ResourceManager::update() and turns the read data into T.
+ *
+ * @tparam T The resource type, must be move constructible
+ * @tparam D The intermediate CPU side data, e.g. decoded pixels or a file's contents
+ */
+template <typename T, typename D>
+struct ResourceLoader {
+    std::function<D(const std::string& key)> read;      ///< Reads the resource identified by key, runs on a worker thread.
+    std::function<T(D& data)> upload;                   ///< Creates the resource from the read data, runs on the OpenGL thread.
+    std::function<int64_t(const T& resource)> bytes;    ///< Optional memory usage of a resource counted against the budget, 0 if empty.
+};
+
+/**
+ * @brief Settings of a gla::ResourceManager.
+ */
+struct ResourceManagerSettings {
+    int64_t memoryBudget = 512ll << 20; ///< Memory usage in bytes above which resources are evicted.
+    int maxUploadsPerFrame = 8;         ///< Maximum amount of uploads done by one update() to bound frame time spikes.
+    uint64_t evictionDelay = 60;        ///< Amount of frames a still referenced resource must go unused before it may be evicted.
+};
+
+namespace detail {
+
+    using ResourceUploader = std::function<std::pair<std::shared_ptr<void>, int64_t>()>;
+    using ResourceReader = std::function<ResourceUploader(const std::string& key)>;
+
+    struct ResourceEntry {
+        std::string key;
+        std::type_index type;
+        ResourceReader reader;
+        std::atomic<ResourceState> state = ResourceState::Loading;
+        std::atomic<uint64_t> lastUsed = 0;
+        std::shared_ptr<void> resource; // only touched on the OpenGL thread
+        int64_t bytes = 0;
+        std::string error;
+
+        ResourceEntry(const std::string& key, std::type_index type, ResourceReader reader)
+            : key(key), type(type), reader(std::move(reader)) {}
+    };
+
+}
+
+/**
+ * @brief Shared, reference counted handle to a resource owned by a gla::ResourceManager.
+ *
+ * Handles to the same key share one resource. A handle never blocks: get() returns nullptr while the
+ * resource is loading, failed or evicted. Accessing an evicted resource queues it to be loaded again.
+ *
+ * @warning Handles may not outlive the ResourceManager that created them.
+ * @warning get() may only be called on the OpenGL thread, the resource is only valid until the next ResourceManager::update().
+ */
+template <typename T>
+class ResourceHandle {
+private:
+    std::shared_ptr<detail::ResourceEntry> _entry;
+    ResourceManager* _manager = nullptr;
+
+    friend class ResourceManager;
+
+    ResourceHandle(std::shared_ptr<detail::ResourceEntry> entry, ResourceManager* manager)
+        : _entry(std::move(entry)), _manager(manager) {}
+
+public:
+    /**
+     * @brief Construct a new empty ResourceHandle.
+     */
+    ResourceHandle() = default;
+
+    /**
+     * @brief Gets the resource and marks it as used this frame.
+     *
+     * @return The resource or nullptr if it isn't ready (yet)
+     */
+    T* get() const;
+
+    /**
+     * @brief Gets the state of the resource.
+     *
+     * @throws std::logic_error If the handle is empty
+     */
+    ResourceState state() const {
+        if (!_entry)
+            throw std::logic_error("ResourceHandle is empty!");
+        return _entry->state.load();
+    }
+
+    /**
+     * @brief Checks whether the resource is ready to be used.
+     */
+    bool ready() const { return _entry && _entry->state.load() == ResourceState::Ready; }
+
+    /**
+     * @brief Gets the key the resource was loaded with.
+     *
+     * @throws std::logic_error If the handle is empty
+     */
+    const std::string& key() const {
+        if (!_entry)
+            throw std::logic_error("ResourceHandle is empty!");
+        return _entry->key;
+    }
+
+    /**
+     * @brief Gets the error message of a failed resource, only valid in ResourceState::Failed.
+     *
+     * @throws std::logic_error If the handle is empty
+     */
+    const std::string& error() const {
+        if (!_entry)
+            throw std::logic_error("ResourceHandle is empty!");
+        return _entry->error;
+    }
+
+    T* operator->() const { return get(); }
+    explicit operator bool() const { return _entry != nullptr; }
+};
+
+/**
+ * @brief Maps keys (paths or ids) to shared resource handles that are loaded asynchronously.
+ *
+ * Requesting a key that is already known returns a handle to the same resource, so concurrent loads of one
+ * key are deduplicated. Resources are read on worker threads and uploaded on the OpenGL thread in update().
+ * When the memory of the ready resources exceeds the budget, update() evicts the least recently used ones:
+ * first those without handles, then those whose handles went unused for evictionDelay frames.
+ *
+ * Example:
+ * @code
+ * manager.registerLoader<gla::Texture, Image>({ readImage, uploadImage, textureBytes });
+ * gla::ResourceHandle<gla::Texture> albedo = manager.load<gla::Texture>("res/textures/rock.png");
+ * ...
+ * manager.update(); // once per frame
+ * if (gla::Texture* texture = albedo.get())
+ *     texture->bind(0);
+ * @endcode
+ *
+ * @note load() and registerLoader() are thread-safe, update() and ResourceHandle::get() must be called on the OpenGL thread.
+ *
+ * @warning ResourceManager must be deconstructed before the OpenGL context is destroyed.
+ */
+class ResourceManager {
+private:
+    struct Completed {
+        std::shared_ptr<detail::ResourceEntry> entry;
+        detail::ResourceUploader uploader; // empty if reading failed
+        std::string error;
+    };
+
+    struct Workers {
+        std::mutex mutex;
+        std::condition_variable idle;
+        std::vector<Completed> completed;
+        int inFlight = 0;
+    };
+
+    ResourceManagerSettings _settings;
+    ThreadPool& _pool;
+    std::shared_ptr<Workers> _workers;
+    std::mutex _mutex;
+    std::unordered_map<std::string, std::shared_ptr<detail::ResourceEntry>> _entries;
+    std::unordered_map<std::type_index, detail::ResourceReader> _loaders;
+    std::vector<Completed> _pending; // completed reads waiting for an upload slot
+    std::atomic<uint64_t> _frame = 1;
+    int64_t _memoryUsage = 0;
+
+    template <typename T>
+    friend class ResourceHandle;
+
+    template <typename T, typename D>
+    static detail::ResourceReader _erase(ResourceLoader<T, D> loader);
+
+    std::shared_ptr<detail::ResourceEntry> _load(const std::string& key, std::type_index type, const detail::ResourceReader* reader);
+    void _submit(const std::shared_ptr<detail::ResourceEntry>& entry);
+    void _request(const std::shared_ptr<detail::ResourceEntry>& entry);
+    void _evict();
+
+public:
+    /**
+     * @brief Construct a new ResourceManager.
+     *
+     * @throws std::invalid_argument If memoryBudget is negative or maxUploadsPerFrame is not greater than 0
+     *
+     * @param pool The ThreadPool resources are read on
+     */
+    ResourceManager(const ResourceManagerSettings& settings = {}, ThreadPool& pool = ThreadPool::shared());
+    ResourceManager(ResourceManager&& other) = delete;
+    ResourceManager(const ResourceManager& other) = delete;
+    /**
+     * @brief Waits for in-flight reads and frees all resources.
+     */
+    ~ResourceManager();
+
+    /**
+     * @brief Sets the loader used by load() for resources of type T.
+     */
+    template <typename T, typename D>
+    void registerLoader(ResourceLoader<T, D> loader) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _loaders.insert_or_assign(std::type_index(typeid(T)), _erase(std::move(loader)));
+    }
+
+    /**
+     * @brief Gets a handle to the resource identified by key, starting to load it if it isn't known yet.
+     *
+     * A failed resource is loaded again.
+     *
+     * @throws std::logic_error If no loader was registered for T
+     * @throws std::logic_error If key was already loaded as a different type
+     */
+    template <typename T>
+    ResourceHandle<T> load(const std::string& key) {
+        return ResourceHandle<T>(_load(key, std::type_index(typeid(T)), nullptr), this);
+    }
+
+    /**
+     * @brief Gets a handle to the resource identified by key, loading it with a specific loader if it isn't known yet.
+     *
+     * @throws std::logic_error If key was already loaded as a different type
+     */
+    template <typename T, typename D>
+    ResourceHandle<T> load(const std::string& key, ResourceLoader<T, D> loader) {
+        detail::ResourceReader reader = _erase(std::move(loader));
+        return ResourceHandle<T>(_load(key, std::type_index(typeid(T)), &reader), this);
+    }
+
+    /**
+     * @brief Uploads finished reads and evicts resources over the memory budget, call once per frame on the OpenGL thread.
+     */
+    void update();
+
+    /**
+     * @brief Gets the memory usage of all ready resources in bytes.
+     */
+    int64_t memoryUsage() const { return _memoryUsage; }
+
+    /**
+     * @brief Gets the settings the ResourceManager was created with.
+     */
+    const ResourceManagerSettings& settings() const { return _settings; }
+
+    ResourceManager& operator=(ResourceManager&& other) = delete;
+    ResourceManager& operator=(const ResourceManager& other) = delete;
+};
+
+template <typename T, typename D>
+detail::ResourceReader ResourceManager::_erase(ResourceLoader<T, D> loader) {
+    if (!loader.read || !loader.upload)
+        throw std::invalid_argument("ResourceLoader needs a read and an upload function!");
+    auto shared = std::make_shared<ResourceLoader<T, D>>(std::move(loader));
+    return [shared](const std::string& key) -> detail::ResourceUploader {
+        auto data = std::make_shared<D>(shared->read(key));
+        return [shared, data]() -> std::pair<std::shared_ptr<void>, int64_t> {
+            auto resource = std::make_shared<T>(shared->upload(*data));
+            int64_t bytes = shared->bytes ? shared->bytes(*resource) : 0;
+            return { std::move(resource), bytes };
+        };
+    };
+}
+
+template <typename T>
+T* ResourceHandle<T>::get() const {
+    if (!_entry)
+        return nullptr;
+    _entry->lastUsed.store(_manager->_frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    ResourceState state = _entry->state.load();
+    if (state == ResourceState::Ready)
+        return static_cast<T*>(_entry->resource.get());
+    if (state == ResourceState::Evicted)
+        _manager->_request(_entry);
+    return nullptr;
+}
+
+}
+
+#endif
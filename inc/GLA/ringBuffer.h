@@ -0,0 +1,110 @@
+#ifndef GLA_RING_BUFFER_H
+#define GLA_RING_BUFFER_H
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include <GLA/buffer.h>
+#include <GLA/sync.h>
+
+namespace gla {
+
+/**
+ * @brief A sub-allocation returned by gla::RingBuffer::allocate.
+ */
+struct RingAllocation {
+    void* data;     ///< Persistently mapped pointer to write the data to.
+    int64_t offset; ///< Offset of the allocation from the start of the Buffer in bytes.
+    int64_t size;   ///< Size of the allocation in bytes.
+};
+
+/**
+ * @brief Persistently mapped Buffer split into per frame regions for streaming data to the GPU.
+ *
+ * Every frame the CPU writes into its own region while the GPU may still read the regions of
+ * the previous frames. Each region is guarded by a gla::Fence, so a region is only reused once the
+ * GPU has finished with it and no implicit synchronization happens on upload.
+ *
+ * Usage per frame: beginFrame(), any amount of allocate() calls and draws using the allocations, endFrame().
+ *
+ * @warning RingBuffer must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class RingBuffer {
+private:
+    Buffer _buffer;
+    int64_t _frameSize = 0;
+    int _frameCount = 0;
+    uint8_t* _mapped = nullptr;
+    std::vector<Fence> _fences;
+    int _frame = 0;
+    int64_t _head = 0;
+    bool _inFrame = false;
+
+public:
+    RingBuffer() = delete;
+    /**
+     * @brief Construct a new RingBuffer.
+     *
+     * @throws std::invalid_argument If frameSize or frameCount are not greater than 0
+     * @throws std::runtime_error If the Buffer could not be created or mapped
+     *
+     * @param type The BufferType, decides which binding point is used by bind(), bindBase() and bindRange()
+     * @param frameSize The amount of bytes that can be allocated per frame
+     * @param frameCount The amount of frames in flight (3 is usually enough to never block)
+     */
+    RingBuffer(BufferType type, int64_t frameSize, int frameCount = 3);
+    RingBuffer(RingBuffer&& other);
+    RingBuffer(const RingBuffer& other) = delete;
+
+    /**
+     * @brief Starts a new frame by moving to the next region.
+     *
+     * @note Blocks if the GPU is still reading the region (only happens when more than frameCount frames are in flight).
+     *
+     * @throws std::logic_error If the previous frame was not ended
+     */
+    void beginFrame();
+
+    /**
+     * @brief Allocates memory in the region of the current frame.
+     *
+     * @throws std::logic_error If no frame was begun
+     * @throws std::invalid_argument If size is not greater than 0 or alignment is not greater than 0
+     * @throws std::runtime_error If the region of the current frame has not enough space left
+     *
+     * @param size The size of the allocation in bytes
+     * @param alignment The alignment of the offset in bytes (e.g. GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT)
+     */
+    RingAllocation allocate(int64_t size, int64_t alignment = 256);
+
+    /**
+     * @brief Ends the current frame by placing a Fence behind all commands using its region.
+     *
+     * @throws std::logic_error If no frame was begun
+     */
+    void endFrame();
+
+    /**
+     * @brief Gets the amount of bytes still available in the current frame (ignoring alignment).
+     */
+    int64_t remaining() const { return _frameSize - _head; }
+
+    /**
+     * @brief Gets the amount of bytes available per frame.
+     */
+    int64_t frameSize() const { return _frameSize; }
+
+    /**
+     * @brief Gets the underlying Buffer, e.g. to bind ranges of allocations.
+     */
+    const Buffer& buffer() const { return _buffer; }
+
+    RingBuffer& operator=(RingBuffer&& other);
+    RingBuffer& operator=(const RingBuffer& other) = delete;
+};
+
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define GLA_SHADER_H
 
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <iosfwd> // std::istream forward-declared
 
@@ -75,6 +76,7 @@ protected:
     void _check();
     void _ensure();
     std::string _getError();
+    void _compile(const char* src, int length); // length < 0 for null terminated sources
 
 public:
     Shader() = delete;
@@ -103,6 +105,15 @@ public:
      * @throws gla::ShaderCompileError If the Shader fails to compile.
      */
     Shader(ShaderType type, const std::string& src);
+    /**
+     * @brief Constructs and compiles a new Shader object of given type.
+     * 
+     * @throws std::logic_error If the given ShaderType is invalid.
+     * @throws std::runtime_error If OpenGL failed to create a Shader object.
+     * @throws std::invalid_argument If the Shader source is NULL.
+     * @throws gla::ShaderCompileError If the Shader fails to compile.
+     */
+    Shader(ShaderType type, std::string_view src);
     /**
      * @brief Constructs and compiles a new Shader object of given type.
      * 
@@ -163,6 +174,19 @@ public:
      */
     void compile(const char* src);
 
+    /**
+     * @brief Compiles the Shader with the given source.
+     * 
+     * @note The source does not need to be null terminated, e.g. a std::span of an gla::AssetPack can be passed without a copy.
+     * 
+     * @throws std::invalid_argument If the Shader source is NULL.
+     * @throws std::logic_error If the current Shader object does not exist (reset() is recommended to return to a valid state).
+     * @throws gla::ShaderCompileError If the Shader fails to compile.
+     * 
+     * @param src Source to compile.
+     */
+    void compile(std::string_view src);
+
     /**
      * @brief Compiles the Shader with the given source input stream.
      * 
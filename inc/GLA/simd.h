@@ -0,0 +1,66 @@
+#ifndef GLA_SIMD_H
+#define GLA_SIMD_H
+
+/**
+ * @file simd.h
+ * @brief Helpers for code paths using x86 SIMD instruction sets beyond the compiler's baseline.
+ *
+ * Functions with such a path compile it with GLA_TARGET_AVX2 / GLA_TARGET_AVX and select it at runtime
+ * with hasAvx2() / hasAvx(), so the library runs on every x86-64 CPU without special compiler flags.
+ */
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GLA_X86 ///< Defined when compiling for x86, SSE2 is always available then.
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define GLA_TARGET_AVX2
+#define GLA_TARGET_AVX
+#else
+#define GLA_TARGET_AVX2 __attribute__((target("avx2")))   ///< Allows AVX2 intrinsics in a function.
+#define GLA_TARGET_AVX __attribute__((target("avx")))     ///< Allows AVX intrinsics in a function.
+#endif
+
+namespace gla {
+
+/**
+ * @brief Checks if the CPU and the operating system support AVX2 (always false outside of x86).
+ */
+bool hasAvx2();
+
+/**
+ * @brief Checks if the CPU and the operating system support AVX (always false outside of x86).
+ */
+bool hasAvx();
+
+}
+
+#ifdef GLA_X86
+#include <emmintrin.h>
+
+namespace gla {
+
+/**
+ * @brief Transposes 4 tightly packed vec3 loaded into 3 registers (x0 y0 z0 x1, y1 z1 x2 y2, z2 x3 y3 z3) into one register per component.
+ *
+ * @note _mm256_shuffle_ps shuffles within each 128 bit half, so the same masks transpose 8 vec3 in the halves of 3 AVX registers.
+ */
+inline void deinterleave3(__m128 a, __m128 b, __m128 c, __m128& x, __m128& y, __m128& z) {
+    x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+/**
+ * @brief Inverse of deinterleave3(), packs one register per component into 3 registers of tightly packed vec3.
+ */
+inline void interleave3(__m128 x, __m128 y, __m128 z, __m128& a, __m128& b, __m128& c) {
+    a = _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+    b = _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+    c = _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+}
+#endif
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef GLA_SKINNING_H
+#define GLA_SKINNING_H
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/matrix.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <GLA/ringBuffer.h>
+#include <GLA/program.h>
+#include <GLA/vertexArray.h>
+#include <GLA/threadPool.h>
+
+namespace gla {
+
+/**
+ * @brief Bone hierarchy of a skinned mesh.
+ */
+class Skeleton {
+private:
+    std::vector<int> _parents;
+    std::vector<glm::mat4> _inverseBind;
+
+public:
+    static constexpr int kMaxBones = 256; ///< Bones addressable by the 8 bit bone indices of a SkinVertex.
+
+    /**
+     * @brief Construct a new Skeleton.
+     *
+     * @throws std::invalid_argument If the sizes differ, there are no or more than kMaxBones bones or a bone is not preceded by its parent
+     *
+     * @param parents Parent of every bone, -1 for roots, parents must precede their children
+     * @param inverseBindMatrices Transforms from model space into the space of every bone in the bind pose
+     */
+    Skeleton(std::vector<int> parents, std::vector<glm::mat4> inverseBindMatrices);
+
+    int boneCount() const { return (int)_parents.size(); }
+    const std::vector<int>& parents() const { return _parents; }
+    const std::vector<glm::mat4>& inverseBindMatrices() const { return _inverseBind; }
+};
+
+/**
+ * @brief Local transform of a bone relative to its parent.
+ */
+struct BoneTransform {
+    glm::vec3 translation = glm::vec3(0.0f);                    ///< Translation applied last.
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);     ///< Rotation applied after scaling.
+    glm::vec3 scale = glm::vec3(1.0f);                          ///< Scale applied first.
+};
+
+/**
+ * @brief Animation of every bone of a Skeleton, sampled at a fixed rate.
+ *
+ * Keyframes are stored as structure of arrays, one stream per component with the bones next to each other,
+ * so sampling interpolates 4 (SSE2) or 8 (AVX) bones per instruction. Animations with arbitrary key times, like those of
+ * glTF files, have to be resampled at a fixed rate first.
+ */
+class AnimationClip {
+private:
+    std::vector<float> _data;   // per frame and component, the bones padded to a multiple of 8
+    int _boneCount = 0;
+    int _stride = 0;            // floats per component stream
+    int _frameCount = 0;
+    float _sampleRate = 0.0f;
+
+public:
+    /**
+     * @brief Construct a new AnimationClip.
+     *
+     * @throws std::invalid_argument If boneCount is not in [1;Skeleton::kMaxBones], sampleRate is not greater than 0 or keys is empty or not a multiple of boneCount
+     *
+     * @param sampleRate Keyframes per second
+     * @param keys Local transforms of every bone per keyframe, frame after frame
+     */
+    AnimationClip(int boneCount, float sampleRate, std::span<const BoneTransform> keys);
+
+    int boneCount() const { return _boneCount; }
+    int frameCount() const { return _frameCount; }
+    float duration() const { return (float)(_frameCount - 1) / _sampleRate; }  ///< Gets the time of the last keyframe in seconds.
+
+    /**
+     * @brief Gets the component streams of a keyframe, 10 streams (translation xyz, rotation xyzw, scale xyz) of stride() floats.
+     */
+    const float* frame(int frame) const { return _data.data() + (size_t)frame * 10 * _stride; }
+    int stride() const { return _stride; }
+};
+
+/**
+ * @brief Weighted sample of an AnimationClip contributing to a pose.
+ */
+struct AnimationLayer {
+    const AnimationClip* clip = nullptr;    ///< Sampled clip, must have as many bones as the Skeleton.
+    float time = 0.0f;                      ///< Time in seconds.
+    float weight = 1.0f;                    ///< Weight relative to the other layers of the pose, at least 0.
+    bool loop = true;                       ///< Wraps the time into the duration of the clip instead of clamping it.
+};
+
+/**
+ * @brief Pose of one character, evaluated by Skinning::update().
+ */
+struct SkinnedPose {
+    const Skeleton* skeleton = nullptr;         ///< Skeleton of the character.
+    std::span<const AnimationLayer> layers;     ///< Blended animations, the sum of the weights must be greater than 0.
+};
+
+/**
+ * @brief Compact per vertex skinning data, 4 bone indices and 4 weights summing up to 65535 in 12 bytes.
+ */
+struct SkinVertex {
+    uint8_t joints[4] = {};     ///< Bone indices into the Skeleton.
+    uint16_t weights[4] = {};   ///< Normalized weights.
+};
+
+/**
+ * @brief Packs the bone indices and weights of a vertex, the weights are normalized so they sum up to exactly 1.
+ *
+ * @throws std::invalid_argument If a joint is not less than Skeleton::kMaxBones, a weight is negative or none is greater than 0
+ */
+SkinVertex packSkinVertex(const glm::uvec4& joints, const glm::vec4& weights);
+
+/**
+ * @brief Evaluates the skinning matrices of a pose on the calling thread.
+ *
+ * @throws std::invalid_argument If the pose is invalid
+ *
+ * @param palette Receives 12 floats per bone, the three rows of the affine matrix from bind pose to posed model space
+ */
+void evaluateSkinPalette(const SkinnedPose& pose, float* palette);
+
+/**
+ * @brief Settings of gla::Skinning.
+ */
+struct SkinningSettings {
+    int maxBones = 65536;               ///< Maximum amount of bones of all poses per update().
+    unsigned int paletteBinding = 9;    ///< ShaderStorage binding of the bone palettes in glslSource().
+    unsigned int jointsLocation = 6;    ///< Attribute location of the bone indices, JOINTS_0 of a gla::GltfModel.
+    unsigned int weightsLocation = 7;   ///< Attribute location of the weights, WEIGHTS_0 of a gla::GltfModel.
+};
+
+/**
+ * @brief Evaluates the poses of skinned characters on the ThreadPool and skins them in the vertex shader.
+ *
+ * update() samples and blends the animations of every pose in parallel and writes the resulting bone palettes of
+ * all characters directly into one persistently mapped ShaderStorage RingBuffer, so a frame needs no copies and no
+ * synchronization with the GPU. A character is drawn by binding its palette offset with bind().
+ *
+ * Vertices reference their bones with 8 bit indices and 16 bit normalized weights (SkinVertex), which skinAttributes()
+ * describes to a VertexArray.
+ *
+ * @warning Skinning must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class Skinning {
+private:
+    SkinningSettings _settings;
+    ThreadPool& _pool;
+    RingBuffer _palettes;
+    int _storageAlignment = 256;
+    bool _frameOpen = false;            // the ring frame of the last update() stays open until the next one
+    int64_t _paletteOffset = 0;
+    int64_t _paletteSize = 0;
+    std::vector<uint32_t> _offsets;     // first bone of every pose
+
+public:
+    /**
+     * @brief Construct a new Skinning.
+     *
+     * @throws std::invalid_argument If maxBones is not greater than 0
+     */
+    Skinning(const SkinningSettings& settings = {}, ThreadPool& pool = ThreadPool::shared());
+    Skinning(Skinning&& other) = delete;
+    Skinning(const Skinning& other) = delete;
+
+    /**
+     * @brief Evaluates the bone palettes of the poses, which stay valid until the next update().
+     *
+     * @throws std::invalid_argument If a pose is invalid or the poses have more than maxBones bones
+     */
+    void update(std::span<const SkinnedPose> poses);
+
+    /**
+     * @brief Binds the palettes of the last update() and sets uSkinPaletteOffset of a program using glslSource().
+     *
+     * @throws std::out_of_range If pose is not less than the amount of poses of the last update()
+     *
+     * @param pose Index of the pose in the last update()
+     */
+    void bind(Program& program, size_t pose) const;
+
+    /**
+     * @brief Gets the first bone of a pose in the palettes of the last update(), e.g. to pass it per instance.
+     */
+    uint32_t paletteOffset(size_t pose) const { return _offsets.at(pose); }
+
+    /**
+     * @brief Gets the attributes of a SkinVertex, bone indices as uvec4 and weights as normalized vec4.
+     *
+     * @param offset Offset of the SkinVertex in the vertex
+     */
+    std::vector<VertexAttribute> skinAttributes(int offset = 0) const;
+
+    /**
+     * @brief Gets GLSL code declaring the skinning attributes and mat3x4 skinMatrix(), the blended bone matrix of the current
+     * vertex, which vec3 skinPosition(mat3x4, vec3) and vec3 skinDirection(mat3x4, vec3) apply.
+     *
+     * @note The code has to be inserted after the #version directive of a vertex shader.
+     */
+    std::string glslSource() const;
+
+    Skinning& operator=(Skinning&& other) = delete;
+    Skinning& operator=(const Skinning& other) = delete;
+};
+
+}
+
+#endif
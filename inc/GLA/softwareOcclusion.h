@@ -0,0 +1,147 @@
+#ifndef GLA_SOFTWARE_OCCLUSION_H
+#define GLA_SOFTWARE_OCCLUSION_H
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/threadPool.h>
+
+namespace gla {
+
+/**
+ * @brief Settings of a gla::SoftwareOcclusion.
+ */
+struct SoftwareOcclusionSettings {
+    int width = 320;                ///< Horizontal resolution of the depth buffer, only needs the aspect ratio of the real framebuffer.
+    int height = 192;               ///< Vertical resolution of the depth buffer.
+    bool backfaceCulling = true;    ///< Skip occluder triangles that are clockwise on screen.
+};
+
+/**
+ * @brief Occlusion culling against occluders rasterized on the CPU.
+ *
+ * Occluder triangles are clipped against the near plane, set up and binned into 32x32 pixel tiles.
+ * rasterize() then draws the tiles in parallel on a ThreadPool, 8 pixels at once with AVX2 where the CPU supports it.
+ * Pixels covered at their center receive the farthest depth of the triangle inside the pixel,
+ * so occluders never end up nearer than they are.
+ * Afterwards every 8x8 block and every tile stores its farthest depth, so most box tests finish
+ * on the tile or block level instead of reading pixels.
+ *
+ * Unlike GPU queries the results are available immediately, so the visibility mask of testBoxes()
+ * can filter objects before any draw of the frame is recorded.
+ *
+ * Usage per frame: beginFrame(), addOccluder() for a few large occluders, rasterize(), testBoxes().
+ *
+ * @note Depth follows the OpenGL convention of glm (window depth ndc.z * 0.5 + 0.5, 1 is far).
+ * @note testBox() and testBoxes() may be called from several threads after rasterize(), all other methods are not thread-safe.
+ */
+class SoftwareOcclusion {
+private:
+    struct Triangle {
+        float edgeA[3];     // edge functions at pixel (x, y): A * x + B * y + C >= 0 if the pixel center is inside
+        float edgeB[3];
+        float edgeC[3];
+        float depthA;       // farthest depth inside pixel (x, y): min(A * x + B * y + C, depthMax)
+        float depthB;
+        float depthC;
+        float depthMax;
+        int minX, minY, maxX, maxY; // pixel bounds, max exclusive
+    };
+
+    SoftwareOcclusionSettings _settings;
+    ThreadPool& _pool;
+    int _stride;    // width rounded up to whole tiles
+    int _tilesX;
+    int _tilesY;
+    glm::mat4 _viewProjection = glm::mat4(1.0f);
+    std::vector<Triangle> _triangles;
+    std::vector<std::vector<uint32_t>> _bins;
+    std::vector<float> _depth;
+    std::vector<float> _blockMax;
+    std::vector<float> _tileMax;
+    bool _avx2;
+
+    void _setup(const glm::vec4* clip);
+    void _rasterizeTile(int tile);
+
+public:
+    /**
+     * @brief Construct a new SoftwareOcclusion.
+     *
+     * @throws std::invalid_argument If width or height is not greater than 0
+     *
+     * @param pool ThreadPool rasterize() and testBoxes() run on
+     */
+    SoftwareOcclusion(const SoftwareOcclusionSettings& settings = {}, ThreadPool& pool = ThreadPool::shared());
+    SoftwareOcclusion(SoftwareOcclusion&& other) = delete;
+    SoftwareOcclusion(const SoftwareOcclusion& other) = delete;
+
+    /**
+     * @brief Removes all occluders and sets the matrix occluders and boxes are projected with.
+     */
+    void beginFrame(const glm::mat4& viewProjection);
+
+    /**
+     * @brief Transforms and sets up the triangles of an occluder mesh.
+     *
+     * Occluders should be few, large and closed, simplified proxy meshes are usually best.
+     *
+     * @throws std::invalid_argument If the amount of indices is not a multiple of 3
+     * @throws std::out_of_range If an index is out of range
+     *
+     * @param positions Vertex positions in model space
+     * @param indices Triangle list indices
+     * @param model Model matrix of the occluder
+     */
+    void addOccluder(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, const glm::mat4& model = glm::mat4(1.0f));
+
+    /**
+     * @brief Clears the depth buffer and rasterizes all occluders added since beginFrame().
+     */
+    void rasterize();
+
+    /**
+     * @brief Tests a world space box against the rasterized occluders.
+     *
+     * @return false if the box is outside the view or certainly hidden, true if it may be visible
+     */
+    bool testBox(const glm::vec3& min, const glm::vec3& max) const;
+
+    /**
+     * @brief Tests many boxes in parallel.
+     *
+     * @throws std::invalid_argument If the spans differ in size
+     *
+     * @param visibility Receives 1 for boxes that may be visible and 0 for culled ones
+     */
+    void testBoxes(std::span<const glm::vec3> minimums, std::span<const glm::vec3> maximums, std::span<uint8_t> visibility) const;
+
+    int width() const { return _settings.width; }
+    int height() const { return _settings.height; }
+
+    /**
+     * @brief Gets the depth buffer of the last rasterize(), rows are stride() floats apart and the first row is the bottom.
+     */
+    const float* depth() const { return _depth.data(); }
+    int stride() const { return _stride; }
+
+    /**
+     * @brief Gets the amount of occluder triangles after clipping and culling.
+     */
+    size_t triangleCount() const { return _triangles.size(); }
+
+    /**
+     * @brief Checks if rasterize() uses the AVX2 code path.
+     */
+    bool usesAvx2() const { return _avx2; }
+
+    SoftwareOcclusion& operator=(SoftwareOcclusion&& other) = delete;
+    SoftwareOcclusion& operator=(const SoftwareOcclusion& other) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef GLA_SYNC_H
+#define GLA_SYNC_H
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace gla {
+
+/**
+ * @brief Fence class to abstract OpenGL sync objects.
+ *
+ * A Fence is placed into the OpenGL command stream and becomes signaled once the GPU
+ * has executed all commands issued before it.
+ *
+ * @warning Fence must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ *
+ * @note An empty Fence (never placed or reset) counts as signaled.
+ */
+class Fence {
+private:
+    void* _sync = nullptr; // GLsync
+
+    void _delete();
+
+public:
+    /**
+     * @brief Construct an empty Fence.
+     */
+    Fence() = default;
+    Fence(Fence&& other);
+    Fence(const Fence& other) = delete;
+    ~Fence() noexcept;
+
+    /**
+     * @brief Places the Fence into the command stream, replacing a previously placed one.
+     *
+     * @throws std::runtime_error If OpenGL failed to create a sync object.
+     */
+    void place();
+
+    /**
+     * @brief Deletes the underlying sync object and returns to the empty state.
+     */
+    void reset();
+
+    /**
+     * @brief Gets if the Fence has been placed and not yet reset.
+     */
+    bool placed() const { return _sync != nullptr; }
+
+    /**
+     * @brief Checks without blocking if the GPU has passed the Fence.
+     */
+    bool signaled() const;
+
+    /**
+     * @brief Blocks until the GPU has passed the Fence or the timeout expired.
+     *
+     * @note Flushes the command stream so the Fence is guaranteed to be reached eventually.
+     *
+     * @throws std::runtime_error If waiting failed.
+     *
+     * @param timeout The maximum time to wait in nanoseconds
+     * @return true if the Fence is signaled, false if the timeout expired
+     */
+    bool wait(uint64_t timeout = UINT64_MAX);
+
+    Fence& operator=(Fence&& other);
+    Fence& operator=(const Fence& other) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef GLA_TERRAIN_H
+#define GLA_TERRAIN_H
+
+#include <span>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/texture.h>
+#include <GLA/ringBuffer.h>
+#include <GLA/meshFile.h>
+#include <GLA/program.h>
+#include <GLA/threadPool.h>
+
+namespace gla {
+
+/**
+ * @brief Settings of a gla::Terrain.
+ */
+struct TerrainSettings {
+    int rootTilesX = 4;             ///< Amount of coarsest tiles along x.
+    int rootTilesZ = 4;             ///< Amount of coarsest tiles along z.
+    int levels = 6;                 ///< Amount of LOD levels, level 0 is the finest, at most 16.
+    float rootSize = 4096.0f;       ///< World size of a coarsest tile, the terrain starts at the origin and extends along +x and +z.
+    float minHeight = 0.0f;         ///< World height of the height value 0.
+    float maxHeight = 512.0f;       ///< World height of the height value 65535.
+    int tileSize = 128;             ///< Height texels per tile edge, tiles store tileSize + 1 texels to share their edges.
+    int gridSize = 64;              ///< Quads per chunk edge of the shared grid mesh, even.
+    float lodDistance = 256.0f;     ///< View distance drawn at level 0, doubles every level, at least twice the size of a level 0 chunk.
+    float morphRatio = 0.7f;        ///< Fraction of the distance range of a level after which its chunks morph towards the next level.
+    int cacheTiles = 256;           ///< Layers of the height Texture array, the coarsest tiles are always resident.
+    int maxChunks = 4096;           ///< Maximum amount of chunks drawn per frame.
+    int maxLoads = 16;              ///< Maximum amount of tiles being loaded on the ThreadPool.
+    int maxUploadsPerFrame = 8;     ///< Maximum amount of loaded tiles uploaded per update().
+    unsigned int heightUnit = 10;   ///< Texture unit of the height Texture array in glslSource().
+    unsigned int chunkBinding = 8;  ///< ShaderStorage binding of the chunk list in glslSource().
+};
+
+/**
+ * @brief Terrain rendered with continuous distance dependent LOD (CDLOD) from streamed height tiles.
+ *
+ * The terrain is a quadtree per coarsest tile, a node at level L covers the tile (L, x, z) of the height data.
+ * update() selects nodes by their distance to the camera: a node is split where it lies inside the distance range of
+ * the next finer level, quadrants outside of it are drawn with the node itself. Every chunk is an instance of one
+ * shared grid mesh, whose index Buffer is ordered by quadrant, so a frame takes at most 5 instanced draw calls
+ * no matter how large the terrain is.
+ *
+ * Towards the end of its distance range, every vertex morphs onto the grid of the next coarser level, so chunks of
+ * neighbouring levels match along their edges without cracks or popping.
+ *
+ * Heights live in a Texture array with one tile per layer. Missing tiles of selected nodes are loaded on the ThreadPool,
+ * coarse first, and replace the least recently used tile. Until a tile arrived, its node samples the corresponding part
+ * of its finest resident ancestor, which only lowers the detail of the heights. Memory is bounded by cacheTiles.
+ *
+ * @warning Terrain must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class Terrain {
+public:
+    /**
+     * @brief Loads a height tile, called on a worker thread.
+     *
+     * Tile (level, x, z) covers the tiles (level - 1, 2x .. 2x + 1, 2z .. 2z + 1). Coarse tiles should keep every second
+     * height of the finer level instead of averaging, so morphed chunks meet their coarser neighbours exactly.
+     *
+     * @param heights Receives (tileSize + 1)^2 heights, row by row starting at the minimum z, the edges are shared with the neighbouring tiles
+     * @return false if the tile could not be loaded, it is not requested again
+     */
+    using TileLoader = std::function<bool(int level, int x, int z, std::span<uint16_t> heights)>;
+
+private:
+    struct LoadedTile {
+        uint32_t key;
+        bool loaded;
+        std::vector<uint16_t> heights;
+    };
+
+    // shared with the loading tasks, which may outlive the Terrain
+    struct LoadQueue {
+        std::mutex mutex;
+        std::vector<LoadedTile> tiles;
+    };
+
+    struct TileState {
+        int layer = -1;             // layer in the height Texture array, -1 if not resident
+        bool loading = false;
+        bool failed = false;
+        glm::vec2 heights = {};     // world height range, valid while resident
+    };
+
+    struct Layer {
+        uint32_t key = UINT32_MAX;  // tile in the layer, UINT32_MAX if free
+        uint64_t lastUsed = 0;      // frame a chunk last sampled the tile, UINT64_MAX for the coarsest tiles
+    };
+
+    struct Chunk {
+        glm::vec4 bounds;       // origin x, origin z, size, level
+        glm::vec4 tile;         // uv offset, uv scale, layer
+    };
+
+    TerrainSettings _settings;
+    TileLoader _loader;
+    ThreadPool& _pool;
+    std::shared_ptr<LoadQueue> _queue;
+    std::unordered_map<uint32_t, TileState> _tiles;
+    std::vector<Layer> _layers;
+    std::vector<float> _ranges;         // view distance covered per level
+    uint64_t _frame = 1;
+    int _loads = 0;
+
+    Texture _heights;
+    Mesh _grid;
+    RingBuffer _chunks;
+    int _storageAlignment = 256;
+    bool _frameOpen = false;            // the ring frame of the last update() stays open until the next one
+    int64_t _chunkOffset = 0;
+    int64_t _chunkSize = 0;
+    uint32_t _groups[6] = {};           // first chunk of every quadrant group (full chunks, quadrant 0 - 3) and the end
+
+    float _nodeSize(int level) const;
+    glm::vec2 _heightRange(int level, int x, int z) const;
+    const TileState* _residentTile(int level, int x, int z, int& residentLevel) const;
+    void _upload(LoadedTile& tile);
+
+public:
+    /**
+     * @brief Construct a new Terrain and loads the coarsest tiles on the calling thread.
+     *
+     * @throws std::invalid_argument If a setting is invalid or a coarsest tile can't be loaded
+     *
+     * @param loader Loads the tiles, called concurrently from the worker threads
+     */
+    Terrain(const TerrainSettings& settings, TileLoader loader, ThreadPool& pool = ThreadPool::shared());
+    Terrain(Terrain&& other) = delete;
+    Terrain(const Terrain& other) = delete;
+
+    /**
+     * @brief Uploads loaded tiles, selects the chunks to draw and starts loads of missing tiles, never waits.
+     */
+    void update(const glm::mat4& view, const glm::mat4& projection);
+
+    /**
+     * @brief Draws the chunks selected by the last update() with a program whose vertex shader uses glslSource().
+     *
+     * @note Vertex attribute state is global in this abstraction, attribute 0 is replaced.
+     */
+    void draw(Program& program);
+
+    /**
+     * @brief Gets GLSL code declaring void terrainVertex(out vec3 worldPosition, out vec3 normal), which computes the
+     * morphed position and normal of the current vertex from the grid mesh attribute at location 0.
+     *
+     * @note The code has to be inserted after the #version directive of a vertex shader.
+     */
+    std::string glslSource() const;
+
+    /**
+     * @brief Gets the world height range of the finest resident tile containing a point, e.g. to keep the camera above ground.
+     */
+    glm::vec2 heightRange(const glm::vec2& position) const;
+
+    size_t chunkCount() const { return _groups[5]; }    ///< Gets the amount of chunks drawn by draw().
+    int pendingLoads() const { return _loads; }         ///< Gets the amount of tiles being loaded.
+    size_t residentTiles() const;                       ///< Gets the amount of tiles in the height Texture array.
+    const Texture& heights() const { return _heights; }
+
+    Terrain& operator=(Terrain&& other) = delete;
+    Terrain& operator=(const Terrain& other) = delete;
+};
+
+}
+
+#endif
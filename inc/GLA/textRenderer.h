@@ -0,0 +1,182 @@
+#ifndef GLA_TEXT_RENDERER_H
+#define GLA_TEXT_RENDERER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/font.h>
+#include <GLA/texture.h>
+#include <GLA/program.h>
+#include <GLA/ringBuffer.h>
+#include <GLA/threadPool.h>
+
+namespace gla {
+
+/**
+ * @brief Settings of a gla::TextRenderer.
+ */
+struct TextRendererSettings {
+    int atlasSize = 1024;               ///< Width and height of an atlas page in texels.
+    int atlasPages = 4;                 ///< Amount of atlas pages (layers of the atlas Texture array).
+    float glyphPixelsPerEm = 48.0f;     ///< Size the signed distance fields are rasterized at, independent of the drawn size.
+    int spread = 6;                     ///< Distance range of the signed distance fields in pixels at glyphPixelsPerEm.
+    int maxGlyphsPerFrame = 65536;      ///< Maximum amount of glyphs drawn per frame.
+    size_t shapedRunCacheSize = 1024;   ///< Amount of shaped strings kept in the cache.
+};
+
+/**
+ * @brief Renders text with signed distance field glyphs.
+ *
+ * Glyphs are rasterized on demand on worker threads and packed into a Texture array atlas on the OpenGL thread.
+ * The shaped layout of every drawn string is cached, so drawing the same label every frame does no shaping.
+ * All glyphs drawn in a frame are written into a persistently mapped gla::RingBuffer and rendered as instanced
+ * quads in a single draw call, the atlas pages are layers of one Texture array.
+ * Since glyphs are stored as distance fields any size can be drawn without re-rasterization.
+ *
+ * Glyphs still being rasterized are skipped and appear once ready, usually in the next frame.
+ *
+ * Usage per frame: any amount of drawText() calls followed by render().
+ *
+ * @warning The Font must outlive the TextRenderer.
+ * @warning TextRenderer must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class TextRenderer {
+private:
+    struct GlyphEntry {
+        bool ready = false;
+        bool empty = false;
+        int layer = 0;
+        glm::vec4 uv = {};
+        glm::vec2 planeMin = {};
+        glm::vec2 planeMax = {};
+    };
+
+    struct ShapedGlyph {
+        uint32_t glyph;
+        glm::vec2 pen; // in em, y pointing up
+    };
+
+    struct ShapedRun {
+        std::vector<ShapedGlyph> glyphs;
+        glm::vec2 size; // in em
+    };
+
+    struct RasterizedGlyph {
+        uint32_t glyph;
+        uint32_t generation;
+        SdfGlyph sdf;
+    };
+
+    // shared with the worker threads, which may still run while the TextRenderer is destroyed
+    struct Workers {
+        std::mutex mutex;
+        std::condition_variable idle;
+        std::vector<RasterizedGlyph> completed;
+        int inFlight = 0;
+    };
+
+    struct GlyphInstance {
+        glm::vec4 rect;     // left, bottom, right, top
+        glm::vec4 uv;       // u left, v bottom, u right, v top
+        uint32_t color;     // packUnorm4x8
+        uint32_t layer;
+        float pxRange;      // screen pixels per distance field unit
+        float padding;
+    };
+
+    const Font& _font;
+    TextRendererSettings _settings;
+    ThreadPool& _pool;
+    Texture _atlas;
+    Program _program;
+    RingBuffer _ring;
+    int64_t _storageAlignment = 256;
+
+    int _page = 0;
+    int _shelfX = 0;
+    int _shelfY = 0;
+    int _shelfHeight = 0;
+    uint32_t _generation = 0;
+    std::unordered_map<uint32_t, GlyphEntry> _glyphs;
+    std::shared_ptr<Workers> _workers;
+
+    std::list<std::string> _runOrder; // most recently used first
+    std::unordered_map<std::string, std::pair<ShapedRun, std::list<std::string>::iterator>> _runs;
+
+    std::vector<GlyphInstance> _instances;
+
+    const ShapedRun& _shape(std::string_view text);
+    const GlyphEntry* _request(uint32_t glyph);
+    bool _pack(int width, int height, int& x, int& y, int& layer);
+    void _resetAtlas();
+    void _uploadCompleted();
+
+public:
+    TextRenderer() = delete;
+    /**
+     * @brief Construct a new TextRenderer for the given Font.
+     *
+     * @throws std::invalid_argument If a setting is not greater than 0
+     * @throws gla::ShaderCompileError If the text shaders fail to compile.
+     * @throws gla::ProgramLinkError If the text Program fails to link.
+     *
+     * @param font The Font to draw, must outlive the TextRenderer
+     * @param settings Atlas and streaming settings
+     * @param pool The ThreadPool used to rasterize glyphs
+     */
+    TextRenderer(const Font& font, const TextRendererSettings& settings = {}, ThreadPool& pool = ThreadPool::shared());
+    TextRenderer(TextRenderer&& other) = delete;
+    TextRenderer(const TextRenderer& other) = delete;
+    /**
+     * @brief Waits for glyphs still being rasterized and releases the OpenGL objects.
+     */
+    ~TextRenderer();
+
+    /**
+     * @brief Queues a UTF-8 string to be drawn in this frame.
+     *
+     * @note '\\n' starts a new line.
+     *
+     * @throws std::runtime_error If more than maxGlyphsPerFrame glyphs were queued this frame
+     *
+     * @param text UTF-8 encoded text
+     * @param position Pen position on the baseline of the first line, y pointing up
+     * @param size Size of one em (the font size)
+     * @param color Color of the text
+     */
+    void drawText(std::string_view text, glm::vec2 position, float size, const glm::vec4& color);
+
+    /**
+     * @brief Measures the extent of a UTF-8 string drawn with the given size.
+     *
+     * @return Width of the longest line and height of all lines
+     */
+    glm::vec2 measureText(std::string_view text, float size);
+
+    /**
+     * @brief Uploads newly rasterized glyphs and draws all text queued in this frame in one draw call.
+     *
+     * @note Enables alpha blending and binds the text Program, texture unit 0 and shader storage binding 0.
+     *
+     * @param projection Matrix transforming text positions into clip space, e.g. glm::ortho(0, width, 0, height)
+     */
+    void render(const glm::mat4& projection);
+
+    TextRenderer& operator=(TextRenderer&& other) = delete;
+    TextRenderer& operator=(const TextRenderer& other) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,281 @@
+#ifndef GLA_TEXTURE_H
+#define GLA_TEXTURE_H
+
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+
+namespace gla {
+
+/**
+ * @brief Enum to indicate the type of Texture.
+ */
+enum class TextureType {
+    Texture2D,      ///< Single two dimensional image per level
+    Texture2DArray, ///< Array of two dimensional layers per level
+    Texture3D,      ///< Three dimensional image per level
+    CubeMap         ///< Six two dimensional faces per level
+};
+
+/**
+ * @brief Enum to indicate the sized internal format of a Texture.
+ */
+enum class TextureFormat {
+    R8,                 ///< Normalized unsigned 8 bit red channel
+    RG8,                ///< Normalized unsigned 8 bit red and green channels
+    RGBA8,              ///< Normalized unsigned 8 bit per channel
+    SRGB8Alpha8,        ///< sRGB encoded 8 bit color with linear 8 bit alpha
+    R16,                ///< Normalized unsigned 16 bit red channel
+    RG16,               ///< Normalized unsigned 16 bit red and green channels
+    RG16SNorm,          ///< Normalized signed 16 bit red and green channels
+    RGBA16,             ///< Normalized unsigned 16 bit per channel
+    R16F,               ///< 16 bit float red channel
+    RG16F,              ///< 16 bit float red and green channels
+    RGBA16F,            ///< 16 bit float per channel
+    R32F,               ///< 32 bit float red channel
+    RG32F,              ///< 32 bit float red and green channels
+    RGBA32F,            ///< 32 bit float per channel
+    R32UI,              ///< Unsigned 32 bit integer red channel
+    RG32UI,             ///< Unsigned 32 bit integer red and green channels
+    RGBA32UI,           ///< Unsigned 32 bit integer per channel
+    Depth16,            ///< 16 bit normalized depth
+    Depth24,            ///< 24 bit normalized depth
+    Depth32F,           ///< 32 bit float depth
+    Depth24Stencil8     ///< 24 bit normalized depth with 8 bit stencil
+};
+
+/**
+ * @brief Enum to indicate the filtering of a Texture.
+ */
+enum class TextureFilter {
+    Nearest,
+    Linear,
+    NearestMipmapNearest,   ///< Only valid as minification filter
+    LinearMipmapNearest,    ///< Only valid as minification filter
+    NearestMipmapLinear,    ///< Only valid as minification filter
+    LinearMipmapLinear      ///< Only valid as minification filter
+};
+
+/**
+ * @brief Enum to indicate the wrapping of Texture coordinates.
+ */
+enum class TextureWrap {
+    Repeat,
+    MirroredRepeat,
+    ClampToEdge,
+    ClampToBorder
+};
+
+/**
+ * @brief Enum to indicate the access of a shader to a Texture bound as image.
+ */
+enum class ImageAccess {
+    Read,
+    Write,
+    ReadWrite
+};
+
+/**
+ * @brief Converts a TextureType enum into a GLenum.
+ *
+ * @throws std::invalid_argument If the TextureType is invalid.
+ */
+unsigned int toGLenum(TextureType type);
+
+/**
+ * @brief Converts a TextureFormat enum into a GLenum.
+ *
+ * @throws std::invalid_argument If the TextureFormat is invalid.
+ */
+unsigned int toGLenum(TextureFormat format);
+
+/**
+ * @brief Converts a TextureFilter enum into a GLenum.
+ *
+ * @throws std::invalid_argument If the TextureFilter is invalid.
+ */
+unsigned int toGLenum(TextureFilter filter);
+
+/**
+ * @brief Converts a TextureWrap enum into a GLenum.
+ *
+ * @throws std::invalid_argument If the TextureWrap is invalid.
+ */
+unsigned int toGLenum(TextureWrap wrap);
+
+/**
+ * @brief Converts an ImageAccess enum into a GLenum.
+ *
+ * @throws std::invalid_argument If the ImageAccess is invalid.
+ */
+unsigned int toGLenum(ImageAccess access);
+
+/**
+ * @brief Gets the pixel transfer format (e.g. GL_RED_INTEGER) matching a TextureFormat.
+ *
+ * @throws std::invalid_argument If the TextureFormat is invalid.
+ */
+unsigned int toPixelFormat(TextureFormat format);
+
+/**
+ * @brief Gets the pixel transfer type (e.g. GL_UNSIGNED_BYTE) matching a TextureFormat.
+ *
+ * @throws std::invalid_argument If the TextureFormat is invalid.
+ */
+unsigned int toPixelType(TextureFormat format);
+
+/**
+ * @brief Gets the size of one texel of the given TextureFormat in bytes as used in pixel transfers.
+ *
+ * @throws std::invalid_argument If the TextureFormat is invalid.
+ */
+int formatToBytes(TextureFormat format);
+
+/**
+ * @brief Gets the amount of mip levels of a full mip chain for the given size.
+ */
+int mipLevelCount(int width, int height, int depth = 1);
+
+/**
+ * @brief Texture class to abstract OpenGL Textures with immutable storage.
+ *
+ * @warning Texture must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ *
+ * @note This class owns the underlying OpenGL Texture object and
+ *       releases it upon destruction.
+ */
+class Texture {
+protected:
+    unsigned int _id = 0;
+    TextureType _type;
+    TextureFormat _format = TextureFormat::RGBA8;
+    int _width = 0;
+    int _height = 0;
+    int _depth = 0;
+    int _levels = 0;
+
+    void _delete();
+    void _check();
+    void _ensureStorage() const;
+
+public:
+    Texture() = delete;
+    /**
+     * @brief Construct a new Texture object of given type without storage.
+     *
+     * @throws std::runtime_error If OpenGL failed to create a Texture object.
+     */
+    Texture(TextureType type);
+    Texture(Texture&& other);
+    Texture(const Texture& other) = delete; // OpenGL Textures are not copy safe
+    ~Texture() noexcept;
+
+    /**
+     * @brief Binds the Texture to the given texture unit, e.g. layout(binding = unit) in GLSL.
+     */
+    void bind(unsigned int unit) const;
+
+    /**
+     * @brief Binds a level of the Texture to the given image unit for load / store access in shaders.
+     *
+     * @throws std::logic_error If the Texture has no storage
+     * @throws std::invalid_argument If the level is out of range
+     *
+     * @param unit The image unit, e.g. layout(binding = unit) in GLSL
+     * @param level The mip level to bind
+     * @param access The access of the shader
+     * @param layer The layer to bind for array, 3D and cube Textures or -1 to bind all layers
+     */
+    void bindImage(unsigned int unit, int level, ImageAccess access, int layer = -1) const;
+
+    /**
+     * @brief Allocates immutable storage for the Texture.
+     *
+     * @throws std::logic_error If storage was already allocated
+     * @throws std::invalid_argument If levels, width, height or depth are not greater than 0
+     * @throws std::invalid_argument If levels is greater than mipLevelCount(width, height, depth)
+     *
+     * @param levels Amount of mip levels
+     * @param format The internal format
+     * @param width Width of level 0 in texels
+     * @param height Height of level 0 in texels (ignored for cube maps, which use width)
+     * @param depth Depth of level 0 for 3D Textures or amount of layers for array Textures (ignored otherwise)
+     */
+    void setStorage(int levels, TextureFormat format, int width, int height, int depth = 1);
+
+    /**
+     * @brief Uploads a region of texels.
+     *
+     * The data has to be tightly packed in the format given by toPixelFormat() and toPixelType().
+     *
+     * @throws std::logic_error If the Texture has no storage
+     * @throws std::invalid_argument If the level is out of range or the region is outside of the level
+     *
+     * @note If a BufferType::PixelUnpack Buffer is bound, data is an offset into that Buffer.
+     *
+     * @param level The mip level to upload to
+     * @param x X offset of the region in texels
+     * @param y Y offset of the region in texels
+     * @param z Z offset, layer or cube face of the region
+     * @param width Width of the region in texels
+     * @param height Height of the region in texels
+     * @param depth Depth or layer count of the region
+     * @param data The texel data
+     */
+    void setSubImage(int level, int x, int y, int z, int width, int height, int depth, const void* data);
+
+    /**
+     * @brief Sets the minification and magnification filter.
+     *
+     * @throws std::invalid_argument If a mipmap filter is given as magnification filter
+     */
+    void setFilter(TextureFilter min, TextureFilter mag);
+
+    /**
+     * @brief Sets the wrapping of all Texture coordinates.
+     */
+    void setWrap(TextureWrap wrap);
+
+    /**
+     * @brief Enables or disables depth comparison, e.g. for sampler2DShadow and sampler2DArrayShadow in GLSL.
+     *
+     * Enabled comparison returns 1 if the reference is less or equal to the stored depth and 0 otherwise,
+     * a Linear filter averages the results of the 4 nearest texels.
+     */
+    void setDepthCompare(bool enabled);
+
+    /**
+     * @brief Sets the finest mip level that is sampled, e.g. while finer levels are not uploaded yet.
+     *
+     * @throws std::logic_error If the Texture has no storage
+     * @throws std::invalid_argument If the level is out of range
+     */
+    void setBaseLevel(int level);
+
+    /**
+     * @brief Generates all mip levels from level 0.
+     *
+     * @throws std::logic_error If the Texture has no storage
+     */
+    void generateMipmaps();
+
+    /**
+     * @brief Gets the underlying OpenGL texture object name for low level OpenGL access.
+     */
+    unsigned int id() const { return _id; }
+
+    TextureType getType() const { return _type; }      ///< Gets the type of the Texture.
+    TextureFormat getFormat() const { return _format; } ///< Gets the internal format of the Texture.
+    int width() const { return _width; }                ///< Gets the width of level 0.
+    int height() const { return _height; }              ///< Gets the height of level 0.
+    int depth() const { return _depth; }                ///< Gets the depth or layer count of level 0.
+    int levels() const { return _levels; }              ///< Gets the amount of mip levels (0 if no storage was allocated).
+
+    Texture& operator=(Texture&& other);
+    Texture& operator=(const Texture& other) = delete; // OpenGL Textures are not copy safe
+};
+
+}
+
+#endif
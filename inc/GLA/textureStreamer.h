@@ -0,0 +1,197 @@
+#ifndef GLA_TEXTURE_STREAMER_H
+#define GLA_TEXTURE_STREAMER_H
+
+#include <span>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
+
+#include <GLA/texture.h>
+#include <GLA/threadPool.h>
+
+namespace gla {
+
+/**
+ * @brief Settings of a gla::TextureStreamer.
+ */
+struct TextureStreamerSettings {
+    int64_t budget = 512ll * 1024 * 1024;   ///< Bytes of texture memory the streamed textures may occupy.
+    int residentSize = 64;                  ///< Levels not larger than this are loaded by add() and never dropped.
+    int maxLoads = 16;                      ///< Maximum amount of levels being loaded on the ThreadPool.
+    int maxUploadsPerFrame = 4;             ///< Maximum amount of loaded levels made visible per update().
+    int unusedFrames = 60;                  ///< Textures not used for this many updates drop to their resident levels first under pressure.
+    bool sparse = true;                     ///< Use ARB_sparse_texture when available and the size is a multiple of the page size.
+};
+
+/**
+ * @brief Description of a texture streamed by a gla::TextureStreamer.
+ */
+struct StreamedTextureDesc {
+    /**
+     * @brief Loads one mip level, called on a worker thread.
+     *
+     * @param texels Receives the level tightly packed in the format given by toPixelFormat() and toPixelType()
+     * @return false if the level could not be loaded
+     */
+    using LevelLoader = std::function<bool(int level, std::span<uint8_t> texels)>;
+
+    TextureFormat format = TextureFormat::SRGB8Alpha8;
+    int width = 0;
+    int height = 0;
+    LevelLoader loader;
+    TextureFilter minFilter = TextureFilter::LinearMipmapLinear;
+    TextureFilter magFilter = TextureFilter::Linear;
+    TextureWrap wrap = TextureWrap::Repeat;
+};
+
+/**
+ * @brief Streams the mip levels of textures depending on how large they appear on screen.
+ *
+ * Every frame use() reports the screen size of a texture, from which the finest required level follows:
+ * a texture 4096 texels wide covering 300 pixels needs level 3. update() loads missing levels one at a time
+ * on the ThreadPool, finest required ones of the largest on screen textures first, and makes arrived levels visible.
+ *
+ * With ARB_sparse_texture the full chain is allocated virtually, levels are committed when they arrive and
+ * GL_TEXTURE_BASE_LEVEL hides the levels that are not committed. Without it, the texture is reallocated with
+ * the resident levels only and the existing levels are copied over on the GPU, so only resident levels occupy memory
+ * either way. Uploads are limited per frame to keep frame times stable.
+ *
+ * When the required levels exceed the budget, the finest levels of textures not used for a while are dropped first,
+ * then those of the smallest textures on screen, so resident memory follows what is actually visible.
+ *
+ * @warning TextureStreamer must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class TextureStreamer {
+private:
+    struct LoadedLevel {
+        uint32_t handle;
+        uint32_t generation;
+        int level;
+        bool loaded;
+        std::vector<uint8_t> texels;
+    };
+
+    // shared with the loading tasks, which may outlive the TextureStreamer
+    struct LoadQueue {
+        std::mutex mutex;
+        std::vector<LoadedLevel> levels;
+    };
+
+    struct Entry {
+        StreamedTextureDesc desc;
+        Texture texture = Texture(TextureType::Texture2D);
+        uint32_t generation = 0;
+        bool active = false;
+        bool sparse = false;
+        int levels = 0;         // full mip chain
+        int tailLevel = 0;      // first level that is always resident (sparse: also the first mip tail level)
+        int resident = 0;       // finest resident level
+        int wanted = 0;         // finest level required by the last update()
+        int finest = 0;         // finest level that can be loaded, raised when a level fails to load
+        float screenSize = 0.0f;        // largest screen size reported since the last update()
+        float lastScreenSize = 0.0f;
+        uint64_t lastUsed = 0;
+        bool loading = false;
+    };
+
+    TextureStreamerSettings _settings;
+    ThreadPool& _pool;
+    std::shared_ptr<LoadQueue> _queue;
+    std::vector<Entry> _entries;
+    std::vector<uint32_t> _free;
+    uint64_t _frame = 1;
+    int _loads = 0;
+    int64_t _memory = 0;
+    bool _sparseSupported = false;
+
+    Entry& _get(uint32_t handle);
+    const Entry& _get(uint32_t handle) const;
+    int64_t _levelBytes(const Entry& entry, int level) const;
+    int64_t _residentBytes(const Entry& entry, int resident) const;
+    void _setResident(Entry& entry, int resident, const LoadedLevel* arrived);
+
+public:
+    /**
+     * @brief Construct a new TextureStreamer.
+     *
+     * @throws std::invalid_argument If a setting is not greater than 0
+     */
+    TextureStreamer(const TextureStreamerSettings& settings = {}, ThreadPool& pool = ThreadPool::shared());
+    TextureStreamer(TextureStreamer&& other) = delete;
+    TextureStreamer(const TextureStreamer& other) = delete;
+
+    /**
+     * @brief Adds a texture and loads its levels up to residentSize on the calling thread.
+     *
+     * @throws std::invalid_argument If the size is not greater than 0, the loader is empty or the format has no texel size
+     * @throws std::runtime_error If a resident level fails to load
+     *
+     * @return Handle of the texture
+     */
+    uint32_t add(StreamedTextureDesc desc);
+
+    /**
+     * @brief Removes a texture and frees its memory, levels being loaded are discarded.
+     *
+     * @throws std::out_of_range If the handle is invalid
+     */
+    void remove(uint32_t handle);
+
+    /**
+     * @brief Reports the size a texture covers on screen this frame, the largest report per frame counts.
+     *
+     * @throws std::out_of_range If the handle is invalid
+     *
+     * @param screenSize Size in pixels the full width of the texture covers, e.g. from screenSize() times the uv range
+     */
+    void use(uint32_t handle, float screenSize);
+
+    /**
+     * @brief Computes the required levels, starts loads, drops levels over budget and makes arrived levels visible.
+     */
+    void update();
+
+    /**
+     * @brief Binds a texture to a texture unit.
+     *
+     * @throws std::out_of_range If the handle is invalid
+     */
+    void bind(uint32_t handle, unsigned int unit) const { _get(handle).texture.bind(unit); }
+
+    /**
+     * @brief Gets the Texture of a handle, which may be reallocated by update().
+     *
+     * @throws std::out_of_range If the handle is invalid
+     */
+    const Texture& texture(uint32_t handle) const { return _get(handle).texture; }
+
+    /**
+     * @brief Gets the finest level of a texture that can be sampled.
+     *
+     * @throws std::out_of_range If the handle is invalid
+     */
+    int residentLevel(uint32_t handle) const { return _get(handle).resident; }
+
+    /**
+     * @brief Computes the diameter in pixels of a bounding sphere on screen.
+     *
+     * @param viewportHeight Height of the viewport in pixels
+     */
+    static float screenSize(const glm::vec3& center, float radius, const glm::mat4& view, const glm::mat4& projection, int viewportHeight);
+
+    int64_t memoryUsage() const { return _memory; }     ///< Gets the bytes of all resident levels.
+    int pendingLoads() const { return _loads; }         ///< Gets the amount of levels being loaded.
+    bool usesSparse() const { return _sparseSupported; } ///< Checks if sparse textures are used when the size allows.
+
+    TextureStreamer& operator=(TextureStreamer&& other) = delete;
+    TextureStreamer& operator=(const TextureStreamer& other) = delete;
+};
+
+}
+
+#endif
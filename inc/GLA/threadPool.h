@@ -0,0 +1,97 @@
+#ifndef GLA_THREAD_POOL_H
+#define GLA_THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+namespace gla {
+
+/**
+ * @brief Fixed size pool of worker threads for CPU side work.
+ *
+ * Used by the Easy OpenGL abstraction for work that does not touch the OpenGL context,
+ * e.g. rasterizing glyphs, decoding files or evaluating animations.
+ *
+ * @warning Tasks run on worker threads and may not call any OpenGL functions.
+ *
+ * @note All methods are thread-safe.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stop = false;
+
+    void _work();
+    void _push(std::function<void()> task);
+
+public:
+    /**
+     * @brief Construct a new ThreadPool with the given amount of worker threads.
+     *
+     * @param threadCount Amount of worker threads, 0 uses one less than the hardware concurrency (at least 1)
+     */
+    ThreadPool(unsigned int threadCount = 0);
+    ThreadPool(ThreadPool&& other) = delete;
+    ThreadPool(const ThreadPool& other) = delete;
+    /**
+     * @brief Finishes all queued tasks and joins the worker threads.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Gets the amount of worker threads.
+     */
+    unsigned int size() const { return (unsigned int)_workers.size(); }
+
+    /**
+     * @brief Queues a task to be run on a worker thread.
+     *
+     * @param task Callable without arguments
+     * @return A future holding the result (or exception) of the task
+     */
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto packaged = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+        std::future<R> result = packaged->get_future();
+        _push([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    /**
+     * @brief Runs func over [0;count) split into chunks on the worker threads and the calling thread.
+     *
+     * Blocks until all chunks are done. The calling thread takes part in the work,
+     * so it is safe to call parallelFor from within a task.
+     *
+     * @throws Rethrows the first exception thrown by func.
+     *
+     * @param count The amount of elements
+     * @param chunkSize The amount of elements per call of func (at least 1)
+     * @param func Called with the half open range [begin;end) of each chunk
+     */
+    void parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t begin, size_t end)>& func);
+
+    /**
+     * @brief Gets the process wide default ThreadPool.
+     */
+    static ThreadPool& shared();
+
+    ThreadPool& operator=(ThreadPool&& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef GLA_TIME_SERIES_PLOT_H
+#define GLA_TIME_SERIES_PLOT_H
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <GLA/buffer.h>
+#include <GLA/program.h>
+
+namespace gla {
+
+/**
+ * @brief Visible part of a series, x in samples and y in values.
+ */
+struct PlotRange {
+    double firstSample = 0.0;   ///< Sample index at the left edge of the plot, may be fractional.
+    double lastSample = 0.0;    ///< Sample index at the right edge of the plot, may be fractional.
+    float minValue = 0.0f;      ///< Value at the bottom edge of the plot.
+    float maxValue = 1.0f;      ///< Value at the top edge of the plot.
+};
+
+/**
+ * @brief Plots long, evenly sampled series at a cost proportional to the plot width instead of the series length.
+ *
+ * Every series keeps its newest samples in an append-only ring in a ShaderStorage Buffer, next to a pyramid of
+ * min/max rings where every level aggregates 8 entries of the level below. append() builds the pyramid entries of
+ * the new samples on the CPU with SIMD and uploads only the samples and entries it touched.
+ *
+ * draw() renders one column per pixel: the level with at most 8 entries per column is chosen and every column covers
+ * the min/max of its entries, including the entries at its edges shared with its neighbours so the plot is connected.
+ * When zoomed in to less than 8 samples per column, the columns span the linear interpolation of the raw samples.
+ * Samples older than the ring capacity are dropped.
+ *
+ * @warning TimeSeriesPlot must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class TimeSeriesPlot {
+private:
+    struct Series {
+        Buffer data = Buffer(BufferType::ShaderStorage);
+        bool active = false;
+        uint32_t capacity = 0;                  // samples in the raw ring, a power of two
+        int levels = 0;                         // including the raw samples as level 0
+        uint64_t count = 0;                     // samples appended in total
+        std::vector<glm::vec2> partial;         // per level, min / max of the completed entries below in the current entry
+    };
+
+    std::vector<Series> _series;
+    std::vector<uint32_t> _free;
+    Program _program;
+
+    Series& _get(uint32_t handle);
+    const Series& _get(uint32_t handle) const;
+    void _write(Series& series, int level, uint64_t first, std::span<const float> values);
+
+public:
+    /**
+     * @brief Construct a new TimeSeriesPlot and compiles its shaders.
+     */
+    TimeSeriesPlot();
+    TimeSeriesPlot(TimeSeriesPlot&& other) = delete;
+    TimeSeriesPlot(const TimeSeriesPlot& other) = delete;
+
+    /**
+     * @brief Adds an empty series.
+     *
+     * @throws std::invalid_argument If capacity is not a power of two of at least 64
+     *
+     * @param capacity Amount of the newest samples that stay visible
+     * @return Handle of the series
+     */
+    uint32_t addSeries(uint32_t capacity = 1u << 24);
+
+    /**
+     * @brief Removes a series and frees its memory.
+     *
+     * @throws std::out_of_range If the handle is invalid
+     */
+    void removeSeries(uint32_t handle);
+
+    /**
+     * @brief Appends samples to a series, only the newest capacity samples are uploaded.
+     *
+     * @throws std::out_of_range If the handle is invalid
+     *
+     * @param samples Finite values, NaN is not supported by the min/max pyramid
+     */
+    void append(uint32_t handle, std::span<const float> samples);
+
+    /**
+     * @brief Draws a series into the current viewport, one column per pixel.
+     *
+     * @throws std::out_of_range If the handle is invalid
+     * @throws std::invalid_argument If width or height is not greater than 0 or the range is empty
+     *
+     * @param width Width of the current viewport in pixels
+     * @param height Height of the current viewport in pixels
+     * @param thickness Line thickness in pixels
+     */
+    void draw(uint32_t handle, const PlotRange& range, int width, int height, const glm::vec4& color, float thickness = 1.0f);
+
+    /**
+     * @brief Gets the amount of samples appended to a series in total, the first visible sample is max(count - capacity, 0).
+     *
+     * @throws std::out_of_range If the handle is invalid
+     */
+    uint64_t sampleCount(uint32_t handle) const { return _get(handle).count; }
+
+    TimeSeriesPlot& operator=(TimeSeriesPlot&& other) = delete;
+    TimeSeriesPlot& operator=(const TimeSeriesPlot& other) = delete;
+};
+
+}
+
+#endif
@@ -27,6 +27,12 @@ enum class VertexAttribInterp {
     Integer ///< Interprets the vertex attribute as an interger
 };
 
+enum class IndexType {
+    UnsignedByte,   ///< GL_UNSIGNED_BYTE
+    UnsignedShort,  ///< GL_UNSIGNED_SHORT
+    UnsignedInt     ///< GL_UNSIGNED_INT
+};
+
 
 /**
  * @brief Converts a VertexAttribType into a GLenum.
@@ -51,6 +57,20 @@ bool validateTypeInterpretation(VertexAttribType type, VertexAttribInterp interp
  */
 int typeToBytes(VertexAttribType type);
 
+/**
+ * @brief Converts an IndexType into a GLenum.
+ * 
+ * @throws std::invalid_argument If the given IndexType is invalid
+ */
+unsigned int toGLenum(IndexType type);
+
+/**
+ * @brief Gets the size of the given index type in bytes.
+ * 
+ * @throws std::invalid_argument If the given IndexType is invalid
+ */
+int typeToBytes(IndexType type);
+
 /**
  * @brief Defines a vertex attribute for the gla::VertexArray.
  */
@@ -61,6 +81,7 @@ struct VertexAttribute {
     VertexAttribInterp interp; ///< Interpretation of the VertexAttribute, for example is type Byte is specified, but should be used as a float
     bool normalized; ///< If it the vertex Attribute should be mapped to [-1;1] for signed values or [0;1] for unsigned values. (disregarded for int types)
     int offset; ///< Offset to the start of the current VertexAttribute
+    unsigned int divisor = 0; ///< Instances per attribute value, 0 advances the attribute per vertex, 1 per instance.
 };
 
 /**
@@ -97,8 +118,22 @@ public:
      * @note Calling this function binds this Buffer.
      * 
      * @param attribs Vector of Attributes to assign to the VertexArray
+     * @param offset Byte offset added to the offset of every VertexAttribute, e.g. the start of a vertex stream in a shared Buffer
+     */
+    void setAttributes(const std::vector<VertexAttribute>& attribs, int stride, int64_t offset = 0);
+
+    /**
+     * @brief Enables additional attributes without disabling the ones set before, e.g. for non interleaved vertex streams.
+     *
+     * @throws std::invalid_argument If offset is less than 0
+     * @throws Everything setAttributes() throws
+     *
+     * @note Calling this function binds this Buffer.
+     *
+     * @param attribs Vector of Attributes to assign to the VertexArray
+     * @param offset Byte offset added to the offset of every VertexAttribute
      */
-    void setAttributes(const std::vector<VertexAttribute>& attribs, int stride);
+    void addAttributes(const std::vector<VertexAttribute>& attribs, int stride, int64_t offset = 0);
 
     VertexArray& operator=(VertexArray&& other) { Buffer::operator=(std::move(other)); return *this; }
     VertexArray& operator=(const VertexArray& other) = delete;
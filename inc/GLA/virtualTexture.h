@@ -0,0 +1,209 @@
+#ifndef GLA_VIRTUAL_TEXTURE_H
+#define GLA_VIRTUAL_TEXTURE_H
+
+#include <span>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <GLA/buffer.h>
+#include <GLA/texture.h>
+#include <GLA/framebuffer.h>
+#include <GLA/sync.h>
+#include <GLA/threadPool.h>
+
+namespace gla {
+
+class AssetPack;
+
+/**
+ * @brief Settings of a gla::VirtualTexture.
+ */
+struct VirtualTextureSettings {
+    int width = 65536;              ///< Width of the virtual texture in texels, pageSize times a power of two.
+    int height = 65536;             ///< Height of the virtual texture in texels, pageSize times a power of two.
+    int pageSize = 128;             ///< Width and height of the content of a page in texels.
+    int border = 4;                 ///< Texels repeated from the neighbouring pages on each side of a page for filtering.
+    int cachePages = 32;            ///< Width and height of the physical page cache in pages, at most 256.
+    TextureFormat format = TextureFormat::SRGB8Alpha8; ///< Format of the page cache, must be uncompressed.
+    int feedbackScale = 8;          ///< The feedback pass renders at 1 / feedbackScale of the screen resolution.
+    int maxLoads = 32;              ///< Maximum amount of page loads running on the ThreadPool.
+    int maxUploadsPerFrame = 16;    ///< Maximum amount of loaded pages copied into the cache per update().
+    unsigned int cacheUnit = 8;     ///< Texture unit of the page cache in glslSource().
+    unsigned int indirectionUnit = 9; ///< Texture unit of the indirection Texture in glslSource().
+};
+
+/**
+ * @brief Virtual texture streaming only the pages that are visible into a fixed size page cache.
+ *
+ * The virtual texture is a mip chain of square pages, page (level, x, y) covers the texture coordinates
+ * [x, x + 1] / pages(level) and [y, y + 1] / pages(level) where pages(level) = max(pages >> level, 1).
+ *
+ * 1. The scene is drawn into a small feedback target between beginFeedback() and endFeedback() with shaders that call
+ *    writeVirtualFeedback(), which writes the page and mip level every pixel would sample.
+ * 2. The feedback target is copied into a PixelPack Buffer behind a Fence, update() reads it a frame or two later
+ *    without waiting, counts the requested pages and marks the resident ones as used.
+ * 3. Missing pages are loaded by the PageLoader on the ThreadPool, coarse levels first.
+ * 4. update() copies finished pages into a free cache slot or the least recently used slot not visible this frame
+ *    and updates only the affected texels of the indirection Texture, which maps every page of every level to the
+ *    finest resident page covering it, so sampling falls back to coarser data until a page arrived.
+ *
+ * The coarsest page is loaded in the constructor and never evicted, so every lookup finds data.
+ *
+ * @warning VirtualTexture must be deconstructed before the OpenGL context is destroyed.
+ * @warning This class is not guaranteed to be thread-safe.
+ */
+class VirtualTexture {
+public:
+    /**
+     * @brief Loads a page, called on a worker thread.
+     *
+     * @param texels Receives (pageSize + 2 * border)^2 texels tightly packed in the cache format, the first row is at the bottom
+     * @return false if the page could not be loaded, it is not requested again
+     */
+    using PageLoader = std::function<bool(int level, int x, int y, std::span<uint8_t> texels)>;
+
+private:
+    struct LoadedPage {
+        uint32_t key;
+        bool loaded;
+        std::vector<uint8_t> texels;
+    };
+
+    // shared with the loading tasks, which may outlive the VirtualTexture
+    struct LoadQueue {
+        std::mutex mutex;
+        std::vector<LoadedPage> pages;
+    };
+
+    struct PageState {
+        int slot = -1;          // cache slot, -1 if not resident
+        bool loading = false;
+        bool failed = false;
+    };
+
+    struct Slot {
+        uint32_t key = UINT32_MAX;  // page in the slot, UINT32_MAX if free
+        uint64_t lastUsed = 0;      // frame the page was last requested by the feedback
+    };
+
+    struct Readback {
+        Fence fence;
+        bool active = false;
+        int width = 0;
+        int height = 0;
+    };
+
+    VirtualTextureSettings _settings;
+    PageLoader _loader;
+    ThreadPool& _pool;
+    std::shared_ptr<LoadQueue> _queue;
+    int _pagesX = 0;
+    int _pagesY = 0;
+    int _levels = 0;
+    int _loads = 0;
+    uint64_t _frame = 1;
+
+    Texture _cache;
+    Texture _indirection;
+    std::vector<std::vector<uint32_t>> _indirectionData;  // per level, packed physical x, y, level, 255
+    std::vector<glm::ivec4> _dirty;                      // per level, changed rectangle (min x, min y, max x, max y)
+    std::unordered_map<uint32_t, PageState> _pages;
+    std::vector<Slot> _slots;
+
+    Texture _feedback;
+    Texture _feedbackDepth;
+    Framebuffer _feedbackFramebuffer;
+    Buffer _readback;
+    const uint32_t* _readbackData = nullptr;
+    std::vector<Readback> _readbacks;
+    int _previousFramebuffer = 0;
+    int _previousReadFramebuffer = 0;
+    int _previousViewport[4] = {};
+    bool _drawing = false;
+
+    glm::ivec2 _pageCount(int level) const;
+    void _map(uint32_t key, uint32_t entry, bool evict);
+    void _upload(const LoadedPage& page);
+    void _collectFeedback();
+
+public:
+    /**
+     * @brief Construct a new VirtualTexture and loads the coarsest page on the calling thread.
+     *
+     * @throws std::invalid_argument If a setting is invalid or the coarsest page can't be loaded
+     *
+     * @param loader Loads the pages, called concurrently from the worker threads
+     * @param screenWidth Width of the screen the feedback target is derived from
+     * @param screenHeight Height of the screen the feedback target is derived from
+     */
+    VirtualTexture(const VirtualTextureSettings& settings, PageLoader loader, int screenWidth, int screenHeight, ThreadPool& pool = ThreadPool::shared());
+    VirtualTexture(VirtualTexture&& other) = delete;
+    VirtualTexture(const VirtualTexture& other) = delete;
+
+    /**
+     * @brief Reallocates the feedback target for a new screen size.
+     *
+     * @throws std::invalid_argument If width or height is not greater than 0
+     */
+    void resize(int screenWidth, int screenHeight);
+
+    /**
+     * @brief Binds and clears the feedback target, the current framebuffer and viewport are restored by endFeedback().
+     *
+     * @throws std::logic_error If beginFeedback() was already called without endFeedback()
+     */
+    void beginFeedback();
+
+    /**
+     * @brief Stops drawing into the feedback target and starts its asynchronous readback.
+     *
+     * The readback is skipped if all readback slots are still in flight.
+     *
+     * @throws std::logic_error If beginFeedback() was not called
+     */
+    void endFeedback();
+
+    /**
+     * @brief Processes finished readbacks, starts page loads and uploads loaded pages, never waits.
+     */
+    void update();
+
+    /**
+     * @brief Binds the page cache and the indirection Texture for shaders using glslSource().
+     */
+    void bind() const;
+
+    /**
+     * @brief Gets GLSL code declaring vec4 sampleVirtual(vec2 uv) and, if feedback is true, void writeVirtualFeedback(vec2 uv)
+     * with its output at location 0.
+     *
+     * @note The code has to be inserted after the #version directive of a fragment shader.
+     */
+    std::string glslSource(bool feedback = false) const;
+
+    /**
+     * @brief Creates a PageLoader reading pages from an AssetPack, page (level, x, y) is the asset "prefix/level/x_y".
+     */
+    static PageLoader packLoader(std::shared_ptr<const AssetPack> pack, const std::string& prefix);
+
+    int levels() const { return _levels; }              ///< Gets the amount of mip levels of the virtual texture.
+    int pendingLoads() const { return _loads; }         ///< Gets the amount of pages being loaded.
+    size_t residentPages() const;                       ///< Gets the amount of pages in the cache.
+    const Texture& cache() const { return _cache; }
+    const Texture& indirection() const { return _indirection; }
+    const Texture& feedback() const { return _feedback; }
+
+    VirtualTexture& operator=(VirtualTexture&& other) = delete;
+    VirtualTexture& operator=(const VirtualTexture& other) = delete;
+};
+
+}
+
+#endif
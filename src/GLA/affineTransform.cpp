@@ -0,0 +1,164 @@
+#include <GLA/affineTransform.h>
+
+#include <GLA/simd.h>
+
+#include <stdexcept>
+#include <glm/glm.hpp>
+
+namespace gla {
+
+namespace {
+
+#ifdef GLA_X86
+    // the 4 vec3 columns are transposed into the 3 rows, the translation ends up in the last lane
+    void loadRows(const glm::mat4x3& matrix, __m128& row0, __m128& row1, __m128& row2) {
+        const float* data = &matrix[0][0];
+        deinterleave3(_mm_loadu_ps(data), _mm_loadu_ps(data + 4), _mm_loadu_ps(data + 8), row0, row1, row2);
+    }
+
+    void storeRows(glm::mat4x3& matrix, __m128 row0, __m128 row1, __m128 row2) {
+        float* data = &matrix[0][0];
+        __m128 a, b, c;
+        interleave3(row0, row1, row2, a, b, c);
+        _mm_storeu_ps(data, a);
+        _mm_storeu_ps(data + 4, b);
+        _mm_storeu_ps(data + 8, c);
+    }
+
+    // a x b = (a * b.yzx - a.yzx * b).yzx, the last lane stays 0
+    __m128 cross(__m128 a, __m128 b) {
+        __m128 aYzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 bYzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYzx), _mm_mul_ps(aYzx, b));
+        return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    float dot(__m128 a, __m128 b) {
+        __m128 products = _mm_mul_ps(a, b);
+        __m128 sums = _mm_add_ps(products, _mm_movehl_ps(products, products));
+        return _mm_cvtss_f32(_mm_add_ss(sums, _mm_shuffle_ps(sums, sums, 0x55)));
+    }
+
+    // columns of the matrix, the last one loaded shifted so no load reads past the matrix
+    __m128 transformColumns(const glm::mat4x3& matrix, const glm::vec3& v, bool translate) {
+        const float* data = &matrix[0][0];
+        __m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(data), _mm_set1_ps(v.x)), _mm_mul_ps(_mm_loadu_ps(data + 3), _mm_set1_ps(v.y))),
+                                   _mm_mul_ps(_mm_loadu_ps(data + 6), _mm_set1_ps(v.z)));
+        if (translate) {
+            __m128 last = _mm_loadu_ps(data + 8);
+            result = _mm_add_ps(result, _mm_shuffle_ps(last, last, _MM_SHUFFLE(3, 3, 2, 1)));
+        }
+        return result;
+    }
+
+    glm::vec3 toVec3(__m128 v) {
+        alignas(16) float values[4];
+        _mm_store_ps(values, v);
+        return glm::vec3(values[0], values[1], values[2]);
+    }
+#endif
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// struct AffineTransform
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+AffineTransform::AffineTransform(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale) {
+    glm::mat3 basis = glm::mat3_cast(rotation);
+    matrix = glm::mat4x3(basis[0] * scale.x, basis[1] * scale.y, basis[2] * scale.z, translation);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+AffineTransform AffineTransform::operator*(const AffineTransform& other) const {
+    AffineTransform result;
+#ifdef GLA_X86
+    // every row of the result combines the rows of other, the translation of this passes through the implicit (0, 0, 0, 1)
+    __m128 a[3], b[3];
+    loadRows(matrix, a[0], a[1], a[2]);
+    loadRows(other.matrix, b[0], b[1], b[2]);
+    __m128 lastLane = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+    __m128 rows[3];
+    for (int row = 0; row < 3; row++) {
+        __m128 r = a[row];
+        rows[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(r, r, 0x00), b[0]), _mm_mul_ps(_mm_shuffle_ps(r, r, 0x55), b[1])),
+                               _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(r, r, 0xAA), b[2]), _mm_and_ps(r, lastLane)));
+    }
+    storeRows(result.matrix, rows[0], rows[1], rows[2]);
+#else
+    glm::mat3 basis(matrix);
+    result.matrix = glm::mat4x3(basis * glm::mat3(other.matrix));
+    result.matrix[3] = basis * other.matrix[3] + matrix[3];
+#endif
+    return result;
+}
+
+AffineTransform AffineTransform::inverse() const {
+    AffineTransform result;
+#ifdef GLA_X86
+    // the columns of the inverse 3x3 part are the cross products of its rows divided by the determinant
+    __m128 rows[3];
+    loadRows(matrix, rows[0], rows[1], rows[2]);
+    __m128 basisLanes = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    __m128 r0 = _mm_and_ps(rows[0], basisLanes), r1 = _mm_and_ps(rows[1], basisLanes), r2 = _mm_and_ps(rows[2], basisLanes);
+    __m128 c0 = cross(r1, r2), c1 = cross(r2, r0), c2 = cross(r0, r1);
+    float determinant = dot(r0, c0);
+    if (determinant == 0.0f)
+        throw std::invalid_argument("AffineTransform is singular and can't be inverted!");
+    __m128 inverseDeterminant = _mm_set1_ps(1.0f / determinant);
+    c0 = _mm_mul_ps(c0, inverseDeterminant);
+    c1 = _mm_mul_ps(c1, inverseDeterminant);
+    c2 = _mm_mul_ps(c2, inverseDeterminant);
+
+    // translation -inverse * t, t is the last lane of the rows
+    __m128 high = _mm_unpackhi_ps(rows[0], rows[1]);
+    __m128 t = _mm_shuffle_ps(high, rows[2], _MM_SHUFFLE(3, 3, 3, 2));
+    __m128 c3 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_shuffle_ps(t, t, 0x00)), _mm_mul_ps(c1, _mm_shuffle_ps(t, t, 0x55))),
+                           _mm_mul_ps(c2, _mm_shuffle_ps(t, t, 0xAA)));
+    c3 = _mm_sub_ps(_mm_setzero_ps(), c3);
+
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    storeRows(result.matrix, c0, c1, c2);
+#else
+    glm::mat3 basis(matrix);
+    float determinant = glm::determinant(basis);
+    if (determinant == 0.0f)
+        throw std::invalid_argument("AffineTransform is singular and can't be inverted!");
+    glm::mat3 inverse = glm::inverse(basis);
+    result.matrix = glm::mat4x3(inverse);
+    result.matrix[3] = -(inverse * matrix[3]);
+#endif
+    return result;
+}
+
+glm::vec3 AffineTransform::transformPoint(const glm::vec3& point) const {
+#ifdef GLA_X86
+    return toVec3(transformColumns(matrix, point, true));
+#else
+    return matrix * glm::vec4(point, 1.0f);
+#endif
+}
+
+glm::vec3 AffineTransform::transformDirection(const glm::vec3& direction) const {
+#ifdef GLA_X86
+    return toVec3(transformColumns(matrix, direction, false));
+#else
+    return matrix * glm::vec4(direction, 0.0f);
+#endif
+}
+
+std::vector<VertexAttribute> AffineTransform::instanceAttributes(unsigned int location, int offset, unsigned int divisor) {
+    std::vector<VertexAttribute> attributes;
+    for (unsigned int column = 0; column < 4; column++)
+        attributes.push_back({ location + column, 3, VertexAttribType::Float, VertexAttribInterp::Float, false, offset + (int)(column * sizeof(glm::vec3)), divisor });
+    return attributes;
+}
+
+}
@@ -0,0 +1,225 @@
+#include <GLA/assetPack.h>
+
+#include <GLA/compression.h>
+
+#include <algorithm>
+#include <fstream>
+
+namespace gla {
+
+namespace {
+
+    // a LZ4 sequence can't expand to more than 255 bytes per stored byte, larger sizes are corrupt
+    const uint64_t kLz4MaxRatio = 255;
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    void writePadding(std::ofstream& file, uint64_t& position, uint64_t alignment) {
+        static const char zeros[kAssetPackAlignment] = {};
+        uint64_t aligned = alignUp(position, alignment);
+        file.write(zeros, (std::streamsize)(aligned - position));
+        position = aligned;
+    }
+
+    void writeBlock(std::ofstream& file, uint64_t& position, const void* data, uint64_t size) {
+        file.write((const char*)data, (std::streamsize)size);
+        position += size;
+    }
+
+}
+
+uint64_t assetNameHash(std::string_view name) {
+    return fnv1a64({ (const uint8_t*)name.data(), name.size() });
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class AssetPackWriter
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void AssetPackWriter::add(const std::string& name, std::vector<uint8_t> data, bool compress) {
+    for (const Asset& asset : _assets)
+        if (asset.name == name)
+            throw std::invalid_argument("Asset " + name + " was already added!");
+    _assets.push_back({ name, std::move(data), compress });
+}
+
+void AssetPackWriter::write(const std::string& path) const {
+    struct Blob {
+        const Asset* asset;
+        std::vector<uint8_t> compressed;
+        AssetPackEntry entry;
+    };
+
+    std::vector<Blob> blobs(_assets.size());
+    std::string names;
+    for (size_t i = 0; i < _assets.size(); i++) {
+        const Asset& asset = _assets[i];
+        Blob& blob = blobs[i];
+        blob.asset = &asset;
+        blob.entry = {};
+        blob.entry.nameHash = assetNameHash(asset.name);
+        blob.entry.contentHash = fnv1a64(asset.data);
+        blob.entry.size = asset.data.size();
+        blob.entry.storedSize = asset.data.size();
+        blob.entry.nameOffset = (uint32_t)names.size();
+        blob.entry.nameLength = (uint32_t)asset.name.size();
+        names += asset.name;
+
+        if (asset.compress && !asset.data.empty()) {
+            std::vector<uint8_t> compressed = lz4Compress(asset.data);
+            if (compressed.size() <= asset.data.size() - asset.data.size() / 8) {
+                blob.compressed = std::move(compressed);
+                blob.entry.storedSize = blob.compressed.size();
+                blob.entry.flags = (uint32_t)AssetFlag::Compressed;
+            }
+        }
+    }
+
+    std::sort(blobs.begin(), blobs.end(), [](const Blob& a, const Blob& b) { return a.entry.nameHash < b.entry.nameHash; });
+
+    AssetPackHeader header = {};
+    header.magic = kAssetPackMagic;
+    header.version = kAssetPackVersion;
+    header.entryCount = (uint32_t)blobs.size();
+    header.indexOffset = alignUp(sizeof(AssetPackHeader), 64);
+    header.namesOffset = header.indexOffset + blobs.size() * sizeof(AssetPackEntry);
+    header.namesSize = names.size();
+
+    uint64_t offset = alignUp(header.namesOffset + header.namesSize, kAssetPackAlignment);
+    for (Blob& blob : blobs) {
+        blob.entry.offset = offset;
+        offset = alignUp(offset + blob.entry.storedSize, kAssetPackAlignment);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("Could not open file for writing: " + path + "!");
+
+    uint64_t position = 0;
+    writeBlock(file, position, &header, sizeof(header));
+    writePadding(file, position, 64);
+    for (const Blob& blob : blobs)
+        writeBlock(file, position, &blob.entry, sizeof(AssetPackEntry));
+    writeBlock(file, position, names.data(), names.size());
+    for (const Blob& blob : blobs) {
+        writePadding(file, position, kAssetPackAlignment);
+        if (blob.entry.flags & (uint32_t)AssetFlag::Compressed)
+            writeBlock(file, position, blob.compressed.data(), blob.compressed.size());
+        else
+            writeBlock(file, position, blob.asset->data.data(), blob.asset->data.size());
+    }
+
+    if (!file)
+        throw std::runtime_error("Could not write file: " + path + "!");
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class AssetPack
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+const AssetPackEntry& AssetPack::_get(std::string_view name) const {
+    const AssetPackEntry* entry = find(name);
+    if (!entry)
+        throw std::out_of_range("Asset pack contains no asset named " + std::string(name) + "!");
+    return *entry;
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+AssetPack::AssetPack(const std::string& path) : _file(path) {
+    size_t size = _file.size();
+    if (size < sizeof(AssetPackHeader))
+        throw AssetPackError("File is smaller than the header!");
+    _header = (const AssetPackHeader*)_file.data();
+    if (_header->magic != kAssetPackMagic)
+        throw AssetPackError("File is not an asset pack!");
+    if (_header->version != kAssetPackVersion)
+        throw AssetPackError("Unsupported asset pack version " + std::to_string(_header->version) + ", expected " + std::to_string(kAssetPackVersion) + "!");
+
+    uint64_t indexSize = (uint64_t)_header->entryCount * sizeof(AssetPackEntry);
+    if (_header->indexOffset % alignof(AssetPackEntry) != 0 || _header->indexOffset > size || indexSize > size - _header->indexOffset)
+        throw AssetPackError("Index lies outside of the file!");
+    if (_header->namesOffset > size || _header->namesSize > size - _header->namesOffset)
+        throw AssetPackError("Name table lies outside of the file!");
+
+    _entries = (const AssetPackEntry*)(_file.data() + _header->indexOffset);
+    _names = (const char*)(_file.data() + _header->namesOffset);
+
+    for (uint32_t i = 0; i < _header->entryCount; i++) {
+        const AssetPackEntry& entry = _entries[i];
+        if (entry.offset > size || entry.storedSize > size - entry.offset)
+            throw AssetPackError("Entry " + std::to_string(i) + " lies outside of the file!");
+        if (entry.flags & (uint32_t)AssetFlag::Compressed) {
+            if (entry.size > entry.storedSize * kLz4MaxRatio)
+                throw AssetPackError("Entry " + std::to_string(i) + " claims a size its compressed blob can't hold!");
+        } else if (entry.size != entry.storedSize) {
+            throw AssetPackError("Uncompressed entry " + std::to_string(i) + " differs from its stored size!");
+        }
+        if ((uint64_t)entry.nameOffset + entry.nameLength > _header->namesSize)
+            throw AssetPackError("Name of entry " + std::to_string(i) + " lies outside of the name table!");
+        if (i > 0 && _entries[i - 1].nameHash > entry.nameHash)
+            throw AssetPackError("Index is not sorted!");
+    }
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+const AssetPackEntry* AssetPack::find(std::string_view name) const {
+    uint64_t hash = assetNameHash(name);
+    const AssetPackEntry* end = _entries + _header->entryCount;
+    const AssetPackEntry* it = std::lower_bound(_entries, end, hash, [](const AssetPackEntry& entry, uint64_t hash) { return entry.nameHash < hash; });
+    // names are compared as well so hash collisions can't return the wrong asset
+    for (; it != end && it->nameHash == hash; it++)
+        if (this->name(*it) == name)
+            return it;
+    return nullptr;
+}
+
+std::span<const uint8_t> AssetPack::view(std::string_view name) const {
+    const AssetPackEntry& entry = _get(name);
+    if (entry.flags & (uint32_t)AssetFlag::Compressed)
+        throw std::logic_error("Asset " + std::string(name) + " is compressed and can't be viewed in place!");
+    return { _file.data() + entry.offset, (size_t)entry.size };
+}
+
+std::span<const uint8_t> AssetPack::read(std::string_view name, std::vector<uint8_t>& storage) const {
+    const AssetPackEntry& entry = _get(name);
+    std::span<const uint8_t> stored(_file.data() + entry.offset, (size_t)entry.storedSize);
+    if (!(entry.flags & (uint32_t)AssetFlag::Compressed))
+        return stored;
+    storage.resize((size_t)entry.size);
+    lz4Decompress(stored, storage);
+    return storage;
+}
+
+std::string_view AssetPack::text(std::string_view name, std::vector<uint8_t>& storage) const {
+    std::span<const uint8_t> data = read(name, storage);
+    return { (const char*)data.data(), data.size() };
+}
+
+bool AssetPack::verify(std::string_view name) const {
+    const AssetPackEntry& entry = _get(name);
+    std::vector<uint8_t> storage;
+    try {
+        return fnv1a64(read(name, storage)) == entry.contentHash;
+    }
+    catch (const std::runtime_error&) {
+        return false;
+    }
+}
+
+}
@@ -0,0 +1,437 @@
+#include <GLA/batchTransform.h>
+
+#include <GLA/simd.h>
+
+#include <string>
+#include <functional>
+#include <stdexcept>
+#include <glm/glm.hpp>
+
+#ifdef GLA_X86
+#include <immintrin.h>
+#endif
+
+namespace gla {
+
+namespace {
+
+    constexpr size_t kChunkSize = 8192;     // elements per ThreadPool task, smaller arrays are transformed on the calling thread
+
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float) && sizeof(BvhBox) == 6 * sizeof(float), "glm types must be tightly packed!");
+
+    void checkSize(size_t input, size_t result, const char* function) {
+        if (input != result)
+            throw std::invalid_argument(std::string(function) + " result must have the size of the input!");
+    }
+
+    void checkSoA(const Vec3SoA& vectors, const char* function) {
+        if (vectors.y.size() != vectors.x.size() || vectors.z.size() != vectors.x.size())
+            throw std::invalid_argument(std::string(function) + " component arrays must have the same size!");
+    }
+
+    void forChunks(size_t count, ThreadPool& pool, const std::function<void(size_t begin, size_t end)>& func) {
+        if (count <= kChunkSize)
+            func(0, count);
+        else
+            pool.parallelFor(count, kChunkSize, func);
+    }
+
+    // the upper 3x3 part of a matrix and a translation, which is 0 for directions
+    struct Affine {
+        glm::mat3 basis;
+        glm::vec3 translation;
+    };
+
+    void transform3Scalar(const Affine& affine, const float* x, const float* y, const float* z, float* outX, float* outY, float* outZ, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 v = affine.basis * glm::vec3(x[i], y[i], z[i]) + affine.translation;
+            outX[i] = v.x;
+            outY[i] = v.y;
+            outZ[i] = v.z;
+        }
+    }
+
+    void transform3Scalar(const Affine& affine, const glm::vec3* in, glm::vec3* out, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = affine.basis * in[i] + affine.translation;
+    }
+
+#ifndef GLA_X86
+    void transform4Scalar(const glm::mat4& matrix, const glm::vec4* in, glm::vec4* out, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = matrix * in[i];
+    }
+
+    void transformAABBsScalar(const glm::mat4& matrix, const BvhBox* in, BvhBox* out, size_t count) {
+        glm::vec3 column0 = glm::abs(glm::vec3(matrix[0])), column1 = glm::abs(glm::vec3(matrix[1])), column2 = glm::abs(glm::vec3(matrix[2]));
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 center = (in[i].min + in[i].max) * 0.5f;
+            glm::vec3 extent = (in[i].max - in[i].min) * 0.5f;
+            center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+            extent = column0 * extent.x + column1 * extent.y + column2 * extent.z;
+            out[i] = { center - extent, center + extent };
+        }
+    }
+
+    void multiplyScalar(const glm::mat4* lhs, size_t lhsStep, const glm::mat4* rhs, glm::mat4* out, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            out[i] = lhs[i * lhsStep] * rhs[i];
+    }
+#endif
+
+#ifdef GLA_X86
+    struct Affine4 {
+        __m128 m[3][3];     // row, column
+        __m128 t[3];
+
+        explicit Affine4(const Affine& affine) {
+            for (int row = 0; row < 3; row++) {
+                for (int column = 0; column < 3; column++)
+                    m[row][column] = _mm_set1_ps(affine.basis[column][row]);
+                t[row] = _mm_set1_ps(affine.translation[row]);
+            }
+        }
+
+        void apply(__m128& x, __m128& y, __m128& z) const {
+            __m128 r[3];
+            for (int row = 0; row < 3; row++)
+                r[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[row][0], x), _mm_mul_ps(m[row][1], y)), _mm_add_ps(_mm_mul_ps(m[row][2], z), t[row]));
+            x = r[0];
+            y = r[1];
+            z = r[2];
+        }
+    };
+
+    void transform3Sse2(const Affine& affine, const glm::vec3* in, glm::vec3* out, size_t count) {
+        Affine4 a(affine);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const float* src = &in[i].x;
+            float* dst = &out[i].x;
+            __m128 x, y, z;
+            deinterleave3(_mm_loadu_ps(src), _mm_loadu_ps(src + 4), _mm_loadu_ps(src + 8), x, y, z);
+            a.apply(x, y, z);
+            __m128 r0, r1, r2;
+            interleave3(x, y, z, r0, r1, r2);
+            _mm_storeu_ps(dst, r0);
+            _mm_storeu_ps(dst + 4, r1);
+            _mm_storeu_ps(dst + 8, r2);
+        }
+        transform3Scalar(affine, in + i, out + i, count - i);
+    }
+
+    void transform3Sse2(const Affine& affine, const float* x, const float* y, const float* z, float* outX, float* outY, float* outZ, size_t count) {
+        Affine4 a(affine);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 x4 = _mm_loadu_ps(x + i), y4 = _mm_loadu_ps(y + i), z4 = _mm_loadu_ps(z + i);
+            a.apply(x4, y4, z4);
+            _mm_storeu_ps(outX + i, x4);
+            _mm_storeu_ps(outY + i, y4);
+            _mm_storeu_ps(outZ + i, z4);
+        }
+        transform3Scalar(affine, x + i, y + i, z + i, outX + i, outY + i, outZ + i, count - i);
+    }
+
+    void transform4Sse2(const glm::mat4& matrix, const glm::vec4* in, glm::vec4* out, size_t count) {
+        __m128 c0 = _mm_loadu_ps(&matrix[0][0]), c1 = _mm_loadu_ps(&matrix[1][0]), c2 = _mm_loadu_ps(&matrix[2][0]), c3 = _mm_loadu_ps(&matrix[3][0]);
+        for (size_t i = 0; i < count; i++) {
+            __m128 v = _mm_loadu_ps(&in[i].x);
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_shuffle_ps(v, v, 0x00)), _mm_mul_ps(c1, _mm_shuffle_ps(v, v, 0x55))),
+                                  _mm_add_ps(_mm_mul_ps(c2, _mm_shuffle_ps(v, v, 0xAA)), _mm_mul_ps(c3, _mm_shuffle_ps(v, v, 0xFF))));
+            _mm_storeu_ps(&out[i].x, r);
+        }
+    }
+
+    void transformAABBsSse2(const glm::mat4& matrix, const BvhBox* in, BvhBox* out, size_t count) {
+        __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        __m128 c0 = _mm_loadu_ps(&matrix[0][0]), c1 = _mm_loadu_ps(&matrix[1][0]), c2 = _mm_loadu_ps(&matrix[2][0]), c3 = _mm_loadu_ps(&matrix[3][0]);
+        __m128 a0 = _mm_and_ps(c0, absMask), a1 = _mm_and_ps(c1, absMask), a2 = _mm_and_ps(c2, absMask);
+        __m128 half = _mm_set1_ps(0.5f);
+        for (size_t i = 0; i < count; i++) {
+            // 6 floats per box, the loads must not read past the last one
+            const float* src = &in[i].min.x;
+            __m128 min = _mm_loadu_ps(src);
+            __m128 max = _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd((const double*)(src + 3))), _mm_load_ss(src + 5));
+            __m128 center = _mm_mul_ps(_mm_add_ps(min, max), half);
+            __m128 extent = _mm_mul_ps(_mm_sub_ps(max, min), half);
+            center = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_shuffle_ps(center, center, 0x00)), _mm_mul_ps(c1, _mm_shuffle_ps(center, center, 0x55))),
+                                _mm_add_ps(_mm_mul_ps(c2, _mm_shuffle_ps(center, center, 0xAA)), c3));
+            extent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_shuffle_ps(extent, extent, 0x00)), _mm_mul_ps(a1, _mm_shuffle_ps(extent, extent, 0x55))),
+                                _mm_mul_ps(a2, _mm_shuffle_ps(extent, extent, 0xAA)));
+            min = _mm_sub_ps(center, extent);
+            max = _mm_add_ps(center, extent);
+            float* dst = &out[i].min.x;
+            _mm_storel_pi((__m64*)dst, min);
+            _mm_store_ss(dst + 2, _mm_shuffle_ps(min, min, 0xAA));
+            _mm_storel_pi((__m64*)(dst + 3), max);
+            _mm_store_ss(dst + 5, _mm_shuffle_ps(max, max, 0xAA));
+        }
+    }
+
+    // every column of rhs is read before the same column of out is written, so out may be lhs or rhs
+    void multiplySse2(const glm::mat4* lhs, size_t lhsStep, const glm::mat4* rhs, glm::mat4* out, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            const glm::mat4& l = lhs[i * lhsStep];
+            __m128 c0 = _mm_loadu_ps(&l[0][0]), c1 = _mm_loadu_ps(&l[1][0]), c2 = _mm_loadu_ps(&l[2][0]), c3 = _mm_loadu_ps(&l[3][0]);
+            for (int column = 0; column < 4; column++) {
+                __m128 r = _mm_loadu_ps(&rhs[i][column][0]);
+                r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_shuffle_ps(r, r, 0x00)), _mm_mul_ps(c1, _mm_shuffle_ps(r, r, 0x55))),
+                               _mm_add_ps(_mm_mul_ps(c2, _mm_shuffle_ps(r, r, 0xAA)), _mm_mul_ps(c3, _mm_shuffle_ps(r, r, 0xFF))));
+                _mm_storeu_ps(&out[i][column][0], r);
+            }
+        }
+    }
+
+    GLA_TARGET_AVX inline __m256 load2x4(const float* low, const float* high) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+    }
+
+    GLA_TARGET_AVX inline void store2x4(float* low, float* high, __m256 v) {
+        _mm_storeu_ps(low, _mm256_castps256_ps128(v));
+        _mm_storeu_ps(high, _mm256_extractf128_ps(v, 1));
+    }
+
+    struct Affine8 {
+        __m256 m[3][3];     // row, column
+        __m256 t[3];
+    };
+
+    GLA_TARGET_AVX inline Affine8 affine8(const Affine& affine) {
+        Affine8 a;
+        for (int row = 0; row < 3; row++) {
+            for (int column = 0; column < 3; column++)
+                a.m[row][column] = _mm256_set1_ps(affine.basis[column][row]);
+            a.t[row] = _mm256_set1_ps(affine.translation[row]);
+        }
+        return a;
+    }
+
+    GLA_TARGET_AVX inline void apply8(const Affine8& a, __m256& x, __m256& y, __m256& z) {
+        __m256 r[3];
+        for (int row = 0; row < 3; row++)
+            r[row] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a.m[row][0], x), _mm256_mul_ps(a.m[row][1], y)),
+                                   _mm256_add_ps(_mm256_mul_ps(a.m[row][2], z), a.t[row]));
+        x = r[0];
+        y = r[1];
+        z = r[2];
+    }
+
+    // the lower halves hold vectors 0 - 3, the upper halves vectors 4 - 7, transposed like deinterleave3() / interleave3()
+    GLA_TARGET_AVX void transform3Avx(const Affine& affine, const glm::vec3* in, glm::vec3* out, size_t count) {
+        Affine8 a = affine8(affine);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const float* src = &in[i].x;
+            float* dst = &out[i].x;
+            __m256 v0 = load2x4(src, src + 12), v1 = load2x4(src + 4, src + 16), v2 = load2x4(src + 8, src + 20);
+            __m256 x = _mm256_shuffle_ps(v0, _mm256_shuffle_ps(v1, v2, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+            __m256 y = _mm256_shuffle_ps(_mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(0, 0, 1, 1)), _mm256_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 z = _mm256_shuffle_ps(_mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 1, 2, 2)), _mm256_shuffle_ps(v2, v2, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+            apply8(a, x, y, z);
+            v0 = _mm256_shuffle_ps(_mm256_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm256_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+            v1 = _mm256_shuffle_ps(_mm256_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+            v2 = _mm256_shuffle_ps(_mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+            store2x4(dst, dst + 12, v0);
+            store2x4(dst + 4, dst + 16, v1);
+            store2x4(dst + 8, dst + 20, v2);
+        }
+        transform3Sse2(affine, in + i, out + i, count - i);
+    }
+
+    GLA_TARGET_AVX void transform3Avx(const Affine& affine, const float* x, const float* y, const float* z, float* outX, float* outY, float* outZ, size_t count) {
+        Affine8 a = affine8(affine);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256 x8 = _mm256_loadu_ps(x + i), y8 = _mm256_loadu_ps(y + i), z8 = _mm256_loadu_ps(z + i);
+            apply8(a, x8, y8, z8);
+            _mm256_storeu_ps(outX + i, x8);
+            _mm256_storeu_ps(outY + i, y8);
+            _mm256_storeu_ps(outZ + i, z8);
+        }
+        transform3Sse2(affine, x + i, y + i, z + i, outX + i, outY + i, outZ + i, count - i);
+    }
+
+    // two vec4 per register, every column of the matrix is repeated in both halves
+    GLA_TARGET_AVX void transform4Avx(const glm::mat4& matrix, const glm::vec4* in, glm::vec4* out, size_t count) {
+        __m256 c0 = _mm256_broadcast_ps((const __m128*)&matrix[0][0]), c1 = _mm256_broadcast_ps((const __m128*)&matrix[1][0]);
+        __m256 c2 = _mm256_broadcast_ps((const __m128*)&matrix[2][0]), c3 = _mm256_broadcast_ps((const __m128*)&matrix[3][0]);
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            __m256 v = _mm256_loadu_ps(&in[i].x);
+            __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c0, _mm256_permute_ps(v, 0x00)), _mm256_mul_ps(c1, _mm256_permute_ps(v, 0x55))),
+                                     _mm256_add_ps(_mm256_mul_ps(c2, _mm256_permute_ps(v, 0xAA)), _mm256_mul_ps(c3, _mm256_permute_ps(v, 0xFF))));
+            _mm256_storeu_ps(&out[i].x, r);
+        }
+        transform4Sse2(matrix, in + i, out + i, count - i);
+    }
+
+    // two columns of rhs per register, see multiplySse2()
+    GLA_TARGET_AVX void multiplyAvx(const glm::mat4* lhs, size_t lhsStep, const glm::mat4* rhs, glm::mat4* out, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            const glm::mat4& l = lhs[i * lhsStep];
+            __m256 c0 = _mm256_broadcast_ps((const __m128*)&l[0][0]), c1 = _mm256_broadcast_ps((const __m128*)&l[1][0]);
+            __m256 c2 = _mm256_broadcast_ps((const __m128*)&l[2][0]), c3 = _mm256_broadcast_ps((const __m128*)&l[3][0]);
+            for (int column = 0; column < 4; column += 2) {
+                __m256 r = _mm256_loadu_ps(&rhs[i][column][0]);
+                r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c0, _mm256_permute_ps(r, 0x00)), _mm256_mul_ps(c1, _mm256_permute_ps(r, 0x55))),
+                                  _mm256_add_ps(_mm256_mul_ps(c2, _mm256_permute_ps(r, 0xAA)), _mm256_mul_ps(c3, _mm256_permute_ps(r, 0xFF))));
+                _mm256_storeu_ps(&out[i][column][0], r);
+            }
+        }
+    }
+#endif
+
+    void transform3(const Affine& affine, const glm::vec3* in, glm::vec3* out, size_t count, ThreadPool& pool) {
+        forChunks(count, pool, [&, avx = hasAvx()](size_t begin, size_t end) {
+#ifdef GLA_X86
+            if (avx)
+                transform3Avx(affine, in + begin, out + begin, end - begin);
+            else
+                transform3Sse2(affine, in + begin, out + begin, end - begin);
+#else
+            (void)avx;
+            transform3Scalar(affine, in + begin, out + begin, end - begin);
+#endif
+        });
+    }
+
+    void transform3(const Affine& affine, const Vec3SoA& in, Vec3SoA& out, ThreadPool& pool) {
+        out.resize(in.size());
+        const float* x = in.x.data(), * y = in.y.data(), * z = in.z.data();
+        float* outX = out.x.data(), * outY = out.y.data(), * outZ = out.z.data();
+        forChunks(in.size(), pool, [&, avx = hasAvx()](size_t begin, size_t end) {
+#ifdef GLA_X86
+            if (avx)
+                transform3Avx(affine, x + begin, y + begin, z + begin, outX + begin, outY + begin, outZ + begin, end - begin);
+            else
+                transform3Sse2(affine, x + begin, y + begin, z + begin, outX + begin, outY + begin, outZ + begin, end - begin);
+#else
+            (void)avx;
+            transform3Scalar(affine, x + begin, y + begin, z + begin, outX + begin, outY + begin, outZ + begin, end - begin);
+#endif
+        });
+    }
+
+    void multiply(const glm::mat4* lhs, size_t lhsStep, const glm::mat4* rhs, glm::mat4* out, size_t count, ThreadPool& pool) {
+        forChunks(count, pool, [&, avx = hasAvx()](size_t begin, size_t end) {
+#ifdef GLA_X86
+            if (avx)
+                multiplyAvx(lhs + begin * lhsStep, lhsStep, rhs + begin, out + begin, end - begin);
+            else
+                multiplySse2(lhs + begin * lhsStep, lhsStep, rhs + begin, out + begin, end - begin);
+#else
+            (void)avx;
+            multiplyScalar(lhs + begin * lhsStep, lhsStep, rhs + begin, out + begin, end - begin);
+#endif
+        });
+    }
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// functions
+// ----------------------------------------------------------------------------------------------------
+
+void transformPoints(const glm::mat4& matrix, std::span<const glm::vec3> points, std::span<glm::vec3> result, ThreadPool& pool) {
+    checkSize(points.size(), result.size(), "transformPoints");
+    transform3({ glm::mat3(matrix), glm::vec3(matrix[3]) }, points.data(), result.data(), points.size(), pool);
+}
+
+void transformPoints(const glm::mat4& matrix, const Vec3SoA& points, Vec3SoA& result, ThreadPool& pool) {
+    checkSoA(points, "transformPoints");
+    transform3({ glm::mat3(matrix), glm::vec3(matrix[3]) }, points, result, pool);
+}
+
+void transformDirections(const glm::mat4& matrix, std::span<const glm::vec3> directions, std::span<glm::vec3> result, ThreadPool& pool) {
+    checkSize(directions.size(), result.size(), "transformDirections");
+    transform3({ glm::mat3(matrix), glm::vec3(0.0f) }, directions.data(), result.data(), directions.size(), pool);
+}
+
+void transformDirections(const glm::mat4& matrix, const Vec3SoA& directions, Vec3SoA& result, ThreadPool& pool) {
+    checkSoA(directions, "transformDirections");
+    transform3({ glm::mat3(matrix), glm::vec3(0.0f) }, directions, result, pool);
+}
+
+void transformVectors(const glm::mat4& matrix, std::span<const glm::vec4> vectors, std::span<glm::vec4> result, ThreadPool& pool) {
+    checkSize(vectors.size(), result.size(), "transformVectors");
+    const glm::vec4* in = vectors.data();
+    glm::vec4* out = result.data();
+    forChunks(vectors.size(), pool, [&, avx = hasAvx()](size_t begin, size_t end) {
+#ifdef GLA_X86
+        if (avx)
+            transform4Avx(matrix, in + begin, out + begin, end - begin);
+        else
+            transform4Sse2(matrix, in + begin, out + begin, end - begin);
+#else
+        (void)avx;
+        transform4Scalar(matrix, in + begin, out + begin, end - begin);
+#endif
+    });
+}
+
+void transformAABBs(const glm::mat4& matrix, std::span<const BvhBox> boxes, std::span<BvhBox> result, ThreadPool& pool) {
+    checkSize(boxes.size(), result.size(), "transformAABBs");
+    const BvhBox* in = boxes.data();
+    BvhBox* out = result.data();
+    forChunks(boxes.size(), pool, [&](size_t begin, size_t end) {
+#ifdef GLA_X86
+        transformAABBsSse2(matrix, in + begin, out + begin, end - begin);
+#else
+        transformAABBsScalar(matrix, in + begin, out + begin, end - begin);
+#endif
+    });
+}
+
+void multiplyMatrices(const glm::mat4& lhs, std::span<const glm::mat4> rhs, std::span<glm::mat4> result, ThreadPool& pool) {
+    checkSize(rhs.size(), result.size(), "multiplyMatrices");
+    // lhs is read for every element and may itself be an element of result
+    glm::mat4 left = lhs;
+    multiply(&left, 0, rhs.data(), result.data(), rhs.size(), pool);
+}
+
+void multiplyMatrices(std::span<const glm::mat4> lhs, std::span<const glm::mat4> rhs, std::span<glm::mat4> result, ThreadPool& pool) {
+    checkSize(lhs.size(), rhs.size(), "multiplyMatrices");
+    checkSize(rhs.size(), result.size(), "multiplyMatrices");
+    multiply(lhs.data(), 1, rhs.data(), result.data(), rhs.size(), pool);
+}
+
+void toSoA(std::span<const glm::vec3> vectors, Vec3SoA& result) {
+    result.resize(vectors.size());
+    size_t i = 0;
+#ifdef GLA_X86
+    for (; i + 4 <= vectors.size(); i += 4) {
+        const float* src = &vectors[i].x;
+        __m128 x, y, z;
+        deinterleave3(_mm_loadu_ps(src), _mm_loadu_ps(src + 4), _mm_loadu_ps(src + 8), x, y, z);
+        _mm_storeu_ps(&result.x[i], x);
+        _mm_storeu_ps(&result.y[i], y);
+        _mm_storeu_ps(&result.z[i], z);
+    }
+#endif
+    for (; i < vectors.size(); i++) {
+        result.x[i] = vectors[i].x;
+        result.y[i] = vectors[i].y;
+        result.z[i] = vectors[i].z;
+    }
+}
+
+void toAoS(const Vec3SoA& vectors, std::span<glm::vec3> result) {
+    checkSoA(vectors, "toAoS");
+    checkSize(vectors.size(), result.size(), "toAoS");
+    size_t i = 0;
+#ifdef GLA_X86
+    for (; i + 4 <= result.size(); i += 4) {
+        float* dst = &result[i].x;
+        __m128 a, b, c;
+        interleave3(_mm_loadu_ps(&vectors.x[i]), _mm_loadu_ps(&vectors.y[i]), _mm_loadu_ps(&vectors.z[i]), a, b, c);
+        _mm_storeu_ps(dst, a);
+        _mm_storeu_ps(dst + 4, b);
+        _mm_storeu_ps(dst + 8, c);
+    }
+#endif
+    for (; i < result.size(); i++)
+        result[i] = glm::vec3(vectors.x[i], vectors.y[i], vectors.z[i]);
+}
+
+}
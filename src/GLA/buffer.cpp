@@ -76,6 +76,11 @@ unsigned int toGLenum(BufferFlag flag) {
     return flags;
 }
 
+bool indexedBufferType(BufferType type) {
+    return type == BufferType::AtomicCounter || type == BufferType::ShaderStorage
+        || type == BufferType::TransformFeedback || type == BufferType::Uniform;
+}
+
 bool validateMapUsage(MapUsage usage, std::string& error) { // returns true if valid
     if ((usage & (MapUsage::Read | MapUsage::Write)) == MapUsage::None) {
         error = "Neither MapUsage::Read nor MapUsage::Write where defined!";
@@ -158,6 +163,30 @@ void Buffer::bind() const {
     GL_CALL(glBindBuffer(toGLenum(_type), _id)); 
 }
 
+void Buffer::bindBase(unsigned int index) const {
+    bindBase(_type, index);
+}
+
+void Buffer::bindRange(unsigned int index, int64_t offset, int64_t size) const {
+    if (!indexedBufferType(_type))
+        throw std::logic_error("BufferType has no indexed binding points!");
+    if (offset < 0)
+        throw std::runtime_error("offset may not be negative!");
+    if (size <= 0)
+        throw std::runtime_error("size must be greater than 0!");
+    GL_CALL(glBindBufferRange(toGLenum(_type), index, _id, offset, size));
+}
+
+void Buffer::bind(BufferType target) const {
+    GL_CALL(glBindBuffer(toGLenum(target), _id));
+}
+
+void Buffer::bindBase(BufferType target, unsigned int index) const {
+    if (!indexedBufferType(target))
+        throw std::logic_error("BufferType has no indexed binding points!");
+    GL_CALL(glBindBufferBase(toGLenum(target), index, _id));
+}
+
 int64_t Buffer::size() const {
     bind();
     GLint64 size = 0;
@@ -0,0 +1,604 @@
+#include <GLA/bvh.h>
+
+#include <GLA/simd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <glm/glm.hpp>
+
+#ifdef GLA_X86
+#include <emmintrin.h>
+#endif
+
+namespace gla {
+
+namespace {
+
+    constexpr int kBinCount = 16;
+    constexpr int kMaxBuildDepth = 64;      // deeper nodes are split at the median, which bounds the depth
+    constexpr int kStackSize = 128;
+    constexpr uint32_t kParallelCount = 16384;  // nodes with more primitives are binned and split on several threads
+
+    float area(const BvhBox& box) {
+        glm::vec3 extent = glm::max(box.max - box.min, glm::vec3(0.0f));
+        return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+    }
+
+    void grow(BvhBox& box, const BvhBox& other) {
+        box.min = glm::min(box.min, other.min);
+        box.max = glm::max(box.max, other.max);
+    }
+
+    constexpr BvhBox kEmptyBox = { glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()) };
+
+    class Builder {
+    private:
+        struct Node {
+            BvhBox bounds;
+            uint32_t children[2];   // UINT32_MAX for leaves
+            uint32_t first;
+            uint32_t count;
+        };
+
+        // primitives are partitioned by value so every pass over a node streams through memory
+        struct Ref {
+            glm::vec3 min;
+            uint32_t index;
+            glm::vec3 max;
+            uint32_t padding;
+
+            glm::vec3 centroid() const { return (min + max) * 0.5f; }
+        };
+
+        struct Bin {
+            BvhBox bounds = kEmptyBox;
+            uint32_t count = 0;
+        };
+
+        std::vector<Ref> _refs;
+        std::vector<Node> _nodes;
+        std::atomic<uint32_t> _nodeCount = 0;
+        uint32_t _maxLeafSize;
+        ThreadPool& _pool;
+
+        // bounds of the primitives and of their centroids
+        std::pair<BvhBox, BvhBox> _bounds(uint32_t first, uint32_t count) {
+            std::pair<BvhBox, BvhBox> result(kEmptyBox, kEmptyBox);
+            std::mutex mutex;
+            auto accumulate = [&](size_t begin, size_t end) {
+                std::pair<BvhBox, BvhBox> local(kEmptyBox, kEmptyBox);
+                for (size_t i = begin; i < end; i++) {
+                    const Ref& ref = _refs[first + i];
+                    glm::vec3 centroid = ref.centroid();
+                    grow(local.first, { ref.min, ref.max });
+                    grow(local.second, { centroid, centroid });
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                grow(result.first, local.first);
+                grow(result.second, local.second);
+            };
+            if (count > kParallelCount)
+                _pool.parallelFor(count, kParallelCount / 4, accumulate);
+            else
+                accumulate(0, count);
+            return result;
+        }
+
+        BvhBox _centroidBounds(uint32_t first, uint32_t count) const {
+            BvhBox result = kEmptyBox;
+            for (uint32_t i = first; i < first + count; i++) {
+                glm::vec3 centroid = _refs[i].centroid();
+                grow(result, { centroid, centroid });
+            }
+            return result;
+        }
+
+        void _bin(uint32_t first, uint32_t count, const BvhBox& centroidBounds, int binCount, Bin (&bins)[3][kBinCount]) {
+            glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+            glm::vec3 scale = glm::vec3((float)binCount) / glm::max(extent, glm::vec3(1e-30f));
+            auto accumulate = [&](size_t begin, size_t end, Bin (&local)[3][kBinCount]) {
+                for (size_t i = begin; i < end; i++) {
+                    const Ref& ref = _refs[first + i];
+                    glm::vec3 position = (ref.centroid() - centroidBounds.min) * scale;
+                    for (int axis = 0; axis < 3; axis++) {
+                        Bin& bin = local[axis][std::clamp((int)position[axis], 0, binCount - 1)];
+                        grow(bin.bounds, { ref.min, ref.max });
+                        bin.count++;
+                    }
+                }
+            };
+            if (count <= kParallelCount) {
+                accumulate(0, count, bins);
+                return;
+            }
+            std::mutex mutex;
+            _pool.parallelFor(count, kParallelCount / 4, [&](size_t begin, size_t end) {
+                Bin local[3][kBinCount];
+                accumulate(begin, end, local);
+                std::lock_guard<std::mutex> lock(mutex);
+                for (int axis = 0; axis < 3; axis++) {
+                    for (int i = 0; i < binCount; i++) {
+                        grow(bins[axis][i].bounds, local[axis][i].bounds);
+                        bins[axis][i].count += local[axis][i].count;
+                    }
+                }
+            });
+        }
+
+        uint32_t _build(uint32_t first, uint32_t count, const BvhBox& bounds, const BvhBox& centroidBounds, int depth) {
+            uint32_t index = _nodeCount++;
+            Node& node = _nodes[index];
+            node.bounds = bounds;
+            node.first = first;
+            node.count = count;
+            node.children[0] = node.children[1] = UINT32_MAX;
+            if (count == 1)
+                return index;
+
+            // binned SAH, costs are relative to intersecting one primitive with the parent's area,
+            // small nodes use fewer bins
+            int bestAxis = -1, bestSplit = 0;
+            float bestCost = std::numeric_limits<float>::max();
+            BvhBox childBounds[2];
+            glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+            int binCount = (int)std::clamp<uint32_t>(count, 4, kBinCount);
+            if (depth < kMaxBuildDepth && glm::max(extent.x, glm::max(extent.y, extent.z)) > 0.0f) {
+                Bin bins[3][kBinCount];
+                _bin(first, count, centroidBounds, binCount, bins);
+                float parentArea = std::max(area(bounds), 1e-30f);
+                for (int axis = 0; axis < 3; axis++) {
+                    if (extent[axis] <= 0.0f)
+                        continue;
+                    BvhBox rightBounds[kBinCount];
+                    uint32_t rightCount[kBinCount];
+                    BvhBox right = kEmptyBox;
+                    uint32_t countRight = 0;
+                    for (int i = binCount - 1; i > 0; i--) {
+                        grow(right, bins[axis][i].bounds);
+                        countRight += bins[axis][i].count;
+                        rightBounds[i] = right;
+                        rightCount[i] = countRight;
+                    }
+                    BvhBox left = kEmptyBox;
+                    uint32_t countLeft = 0;
+                    for (int i = 1; i < binCount; i++) {
+                        grow(left, bins[axis][i - 1].bounds);
+                        countLeft += bins[axis][i - 1].count;
+                        if (countLeft == 0 || rightCount[i] == 0)
+                            continue;
+                        float cost = 1.0f + (area(left) * countLeft + area(rightBounds[i]) * rightCount[i]) / parentArea;
+                        if (cost < bestCost) {
+                            bestCost = cost;
+                            bestAxis = axis;
+                            bestSplit = i;
+                            childBounds[0] = left;
+                            childBounds[1] = rightBounds[i];
+                        }
+                    }
+                }
+            }
+            if (count <= _maxLeafSize && bestCost >= (float)count)
+                return index;
+
+            uint32_t middle = 0;
+            if (bestAxis >= 0) {
+                float scale = binCount / extent[bestAxis];
+                float origin = centroidBounds.min[bestAxis];
+                middle = (uint32_t)(std::partition(_refs.begin() + first, _refs.begin() + first + count, [&](const Ref& ref) {
+                    return std::clamp((int)((ref.centroid()[bestAxis] - origin) * scale), 0, binCount - 1) < bestSplit;
+                }) - _refs.begin()) - first;
+            }
+            BvhBox childCentroids[2];
+            if (middle == 0 || middle == count) {
+                // no usable SAH split (equal centroids or too deep), split at the median of the largest axis
+                int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+                middle = count / 2;
+                std::nth_element(_refs.begin() + first, _refs.begin() + first + middle, _refs.begin() + first + count,
+                                 [&](const Ref& a, const Ref& b) { return a.min[axis] + a.max[axis] < b.min[axis] + b.max[axis]; });
+                std::tie(childBounds[0], childCentroids[0]) = _bounds(first, middle);
+                std::tie(childBounds[1], childCentroids[1]) = _bounds(first + middle, count - middle);
+            }
+            else {
+                childCentroids[0] = _centroidBounds(first, middle);
+                childCentroids[1] = _centroidBounds(first + middle, count - middle);
+            }
+
+            uint32_t children[2];
+            auto buildChild = [&](int i) {
+                uint32_t childFirst = i == 0 ? first : first + middle;
+                uint32_t childCount = i == 0 ? middle : count - middle;
+                children[i] = _build(childFirst, childCount, childBounds[i], childCentroids[i], depth + 1);
+            };
+            if (count > kParallelCount) {
+                _pool.parallelFor(2, 1, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++)
+                        buildChild((int)i);
+                });
+            }
+            else {
+                buildChild(0);
+                buildChild(1);
+            }
+            _nodes[index].children[0] = children[0];
+            _nodes[index].children[1] = children[1];
+            return index;
+        }
+
+        uint32_t _flatten(uint32_t index, std::vector<BvhNode>& result) const {
+            const Node& node = _nodes[index];
+            uint32_t flat = (uint32_t)result.size();
+            result.push_back({ node.bounds.min, node.first, node.bounds.max, node.count });
+            if (node.children[0] != UINT32_MAX) {
+                result[flat].count = 0;
+                _flatten(node.children[0], result);
+                result[flat].offset = _flatten(node.children[1], result);
+            }
+            return flat;
+        }
+
+    public:
+        Builder(std::span<const BvhBox> boxes, uint32_t maxLeafSize, ThreadPool& pool)
+            : _refs(boxes.size()), _nodes(boxes.size() * 2), _maxLeafSize(maxLeafSize), _pool(pool) {
+            _pool.parallelFor(boxes.size(), 65536, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    _refs[i] = { boxes[i].min, (uint32_t)i, boxes[i].max, 0 };
+            });
+        }
+
+        void build(std::vector<BvhNode>& nodes, std::vector<uint32_t>& indices) {
+            nodes.clear();
+            if (!_refs.empty()) {
+                auto [bounds, centroidBounds] = _bounds(0, (uint32_t)_refs.size());
+                _build(0, (uint32_t)_refs.size(), bounds, centroidBounds, 0);
+                nodes.reserve(_nodeCount);
+                _flatten(0, nodes);
+            }
+            indices.resize(_refs.size());
+            for (size_t i = 0; i < _refs.size(); i++)
+                indices[i] = _refs[i].index;
+        }
+    };
+
+    // interior bounds from the children, children are always stored after their parent
+    void refitInterior(std::vector<BvhNode>& nodes) {
+        for (size_t i = nodes.size(); i-- > 0;) {
+            BvhNode& node = nodes[i];
+            if (node.count != 0)
+                continue;
+            const BvhNode& a = nodes[i + 1];
+            const BvhNode& b = nodes[node.offset];
+            node.min = glm::min(a.min, b.min);
+            node.max = glm::max(a.max, b.max);
+        }
+    }
+
+    struct RaySetup {
+        glm::vec3 origin;
+        glm::vec3 inverse;
+#ifdef GLA_X86
+        __m128 origin4;
+        __m128 inverse4;
+#endif
+
+        RaySetup(const Ray& ray) : origin(ray.origin), inverse(1.0f / ray.direction) {
+#ifdef GLA_X86
+            origin4 = _mm_setr_ps(origin.x, origin.y, origin.z, 0.0f);
+            inverse4 = _mm_setr_ps(inverse.x, inverse.y, inverse.z, 0.0f);
+#endif
+        }
+    };
+
+    // slab test, returns the entry distance or infinity on a miss
+    inline float intersectBox(const BvhNode& node, const RaySetup& ray, float maxDistance) {
+#ifdef GLA_X86
+        // the 4th lane holds offset / count and is ignored
+        __m128 low = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.min.x), ray.origin4), ray.inverse4);
+        __m128 high = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.max.x), ray.origin4), ray.inverse4);
+        __m128 near4 = _mm_min_ps(low, high);
+        __m128 far4 = _mm_max_ps(low, high);
+        __m128 near = _mm_max_ss(_mm_max_ss(near4, _mm_shuffle_ps(near4, near4, 1)), _mm_shuffle_ps(near4, near4, 2));
+        __m128 far = _mm_min_ss(_mm_min_ss(far4, _mm_shuffle_ps(far4, far4, 1)), _mm_shuffle_ps(far4, far4, 2));
+        float entry = std::max(_mm_cvtss_f32(near), 0.0f);
+        float exit = std::min(_mm_cvtss_f32(far), maxDistance);
+#else
+        glm::vec3 low = (node.min - ray.origin) * ray.inverse;
+        glm::vec3 high = (node.max - ray.origin) * ray.inverse;
+        glm::vec3 near = glm::min(low, high), far = glm::max(low, high);
+        float entry = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+        float exit = std::min(std::min(far.x, far.y), std::min(far.z, maxDistance));
+#endif
+        return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+    }
+
+    // nearest child first traversal, leaf(node, maxDistance) returns the new maximum distance
+    template <typename Leaf>
+    void traverse(const std::vector<BvhNode>& nodes, const Ray& ray, Leaf&& leaf) {
+        if (nodes.empty())
+            return;
+        RaySetup setup(ray);
+        float maxDistance = ray.maxDistance;
+        if (intersectBox(nodes[0], setup, maxDistance) == std::numeric_limits<float>::infinity())
+            return;
+
+        uint32_t stack[kStackSize];
+        int size = 0;
+        uint32_t index = 0;
+        while (true) {
+            const BvhNode& node = nodes[index];
+            if (node.count != 0) {
+                maxDistance = leaf(node, maxDistance);
+            }
+            else {
+                uint32_t first = index + 1, second = node.offset;
+                float distanceFirst = intersectBox(nodes[first], setup, maxDistance);
+                float distanceSecond = intersectBox(nodes[second], setup, maxDistance);
+                if (distanceSecond < distanceFirst) {
+                    std::swap(first, second);
+                    std::swap(distanceFirst, distanceSecond);
+                }
+                if (distanceFirst != std::numeric_limits<float>::infinity()) {
+                    if (distanceSecond != std::numeric_limits<float>::infinity())
+                        stack[size++] = second;
+                    index = first;
+                    continue;
+                }
+            }
+            // popped nodes may be farther than a hit found after they were pushed
+            do {
+                if (size == 0)
+                    return;
+                index = stack[--size];
+            } while (intersectBox(nodes[index], setup, maxDistance) == std::numeric_limits<float>::infinity());
+        }
+    }
+
+}
+
+Ray pickRay(const glm::vec2& cursor, const glm::vec2& viewportSize, const glm::mat4& viewProjection) {
+    glm::vec2 ndc(cursor.x / viewportSize.x * 2.0f - 1.0f, 1.0f - cursor.y / viewportSize.y * 2.0f);
+    glm::mat4 inverse = glm::inverse(viewProjection);
+    glm::vec4 near = inverse * glm::vec4(ndc, -1.0f, 1.0f);
+    glm::vec4 far = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+    Ray ray;
+    ray.origin = glm::vec3(near) / near.w;
+    ray.direction = glm::normalize(glm::vec3(far) / far.w - ray.origin);
+    return ray;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class Bvh
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void Bvh::build(std::span<const BvhBox> boxes, int maxLeafSize, ThreadPool& pool) {
+    if (maxLeafSize <= 0)
+        throw std::invalid_argument("maxLeafSize must be greater than 0!");
+    Builder(boxes, (uint32_t)maxLeafSize, pool).build(_nodes, _indices);
+    _boxes.resize(_indices.size());
+    for (size_t i = 0; i < _indices.size(); i++)
+        _boxes[i] = boxes[_indices[i]];
+}
+
+void Bvh::refit(std::span<const BvhBox> boxes) {
+    if (boxes.size() != _indices.size())
+        throw std::invalid_argument("Bvh refit needs the same amount of boxes it was built with!");
+    for (BvhNode& node : _nodes) {
+        if (node.count == 0)
+            continue;
+        BvhBox bounds = kEmptyBox;
+        for (uint32_t i = node.offset; i < node.offset + node.count; i++) {
+            _boxes[i] = boxes[_indices[i]];
+            grow(bounds, _boxes[i]);
+        }
+        node.min = bounds.min;
+        node.max = bounds.max;
+    }
+    refitInterior(_nodes);
+}
+
+RayHit Bvh::raycast(const Ray& ray, const std::function<float(uint32_t primitive, const Ray& ray, float maxDistance)>& intersect) const {
+    RayHit hit;
+    traverse(_nodes, ray, [&](const BvhNode& node, float maxDistance) {
+        for (uint32_t i = node.offset; i < node.offset + node.count; i++) {
+            float distance = intersect(_indices[i], ray, maxDistance);
+            if (distance < maxDistance) {
+                maxDistance = distance;
+                hit.distance = distance;
+                hit.primitive = _indices[i];
+            }
+        }
+        return maxDistance;
+    });
+    return hit;
+}
+
+void Bvh::overlap(const BvhBox& box, std::vector<uint32_t>& result) const {
+    if (_nodes.empty())
+        return;
+    uint32_t stack[kStackSize];
+    int size = 0;
+    stack[size++] = 0;
+    while (size > 0) {
+        const BvhNode& node = _nodes[stack[--size]];
+        if (glm::any(glm::greaterThan(node.min, box.max)) || glm::any(glm::lessThan(node.max, box.min)))
+            continue;
+        if (node.count != 0) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++)
+                if (!glm::any(glm::greaterThan(_boxes[i].min, box.max)) && !glm::any(glm::lessThan(_boxes[i].max, box.min)))
+                    result.push_back(_indices[i]);
+            continue;
+        }
+        stack[size++] = node.offset;
+        stack[size++] = (uint32_t)(&node - _nodes.data()) + 1;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class TriangleBvh
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void TriangleBvh::_fillPacks(std::span<const glm::vec3> positions) {
+    for (uint32_t index : _indices)
+        if (index >= positions.size())
+            throw std::out_of_range("Triangle index " + std::to_string(index) + " is out of range!");
+
+    // leaves own one pack each, unused lanes keep zero edges which never hit
+    _pool.parallelFor(_nodes.size(), 4096, [&](size_t begin, size_t end) {
+        for (size_t n = begin; n < end; n++) {
+            BvhNode& node = _nodes[n];
+            if (node.count == 0)
+                continue;
+            Pack& pack = _packs[node.offset];
+            BvhBox bounds = kEmptyBox;
+            for (uint32_t lane = 0; lane < 4; lane++) {
+                glm::vec3 v0(0.0f), e1(0.0f), e2(0.0f);
+                if (lane < node.count) {
+                    const uint32_t* triangle = _indices.data() + (size_t)pack.triangle[lane] * 3;
+                    v0 = positions[triangle[0]];
+                    e1 = positions[triangle[1]] - v0;
+                    e2 = positions[triangle[2]] - v0;
+                    grow(bounds, { glm::min(v0, glm::min(v0 + e1, v0 + e2)), glm::max(v0, glm::max(v0 + e1, v0 + e2)) });
+                }
+                for (int axis = 0; axis < 3; axis++) {
+                    pack.v0[axis][lane] = v0[axis];
+                    pack.e1[axis][lane] = e1[axis];
+                    pack.e2[axis][lane] = e2[axis];
+                }
+            }
+            node.min = bounds.min;
+            node.max = bounds.max;
+        }
+    });
+    refitInterior(_nodes);
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+TriangleBvh::TriangleBvh(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, ThreadPool& pool)
+    : _indices(indices.begin(), indices.end()), _pool(pool) {
+    if (indices.size() % 3 != 0)
+        throw std::invalid_argument("Triangle index count must be a multiple of 3!");
+    for (uint32_t index : indices)
+        if (index >= positions.size())
+            throw std::out_of_range("Triangle index " + std::to_string(index) + " is out of range!");
+
+    std::vector<BvhBox> boxes(indices.size() / 3);
+    pool.parallelFor(boxes.size(), 65536, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const glm::vec3& a = positions[indices[i * 3]];
+            const glm::vec3& b = positions[indices[i * 3 + 1]];
+            const glm::vec3& c = positions[indices[i * 3 + 2]];
+            boxes[i] = { glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c)) };
+        }
+    });
+    std::vector<uint32_t> order;
+    Builder(boxes, 4, pool).build(_nodes, order);
+
+    // leaves are renumbered to their pack in traversal order
+    for (BvhNode& node : _nodes) {
+        if (node.count == 0)
+            continue;
+        Pack pack = {};
+        for (uint32_t lane = 0; lane < node.count; lane++)
+            pack.triangle[lane] = order[node.offset + lane];
+        node.offset = (uint32_t)_packs.size();
+        _packs.push_back(pack);
+    }
+    _fillPacks(positions);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void TriangleBvh::refit(std::span<const glm::vec3> positions) {
+    _fillPacks(positions);
+}
+
+RayHit TriangleBvh::raycast(const Ray& ray) const {
+    RayHit hit;
+    traverse(_nodes, ray, [&](const BvhNode& node, float maxDistance) {
+        const Pack& pack = _packs[node.offset];
+#ifdef GLA_X86
+        // Moeller-Trumbore for 4 triangles at once
+        __m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y), dz = _mm_set1_ps(ray.direction.z);
+        __m128 e1x = _mm_load_ps(pack.e1[0]), e1y = _mm_load_ps(pack.e1[1]), e1z = _mm_load_ps(pack.e1[2]);
+        __m128 e2x = _mm_load_ps(pack.e2[0]), e2y = _mm_load_ps(pack.e2[1]), e2z = _mm_load_ps(pack.e2[2]);
+        __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+        __m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), det);
+        __m128 tx = _mm_sub_ps(_mm_set1_ps(ray.origin.x), _mm_load_ps(pack.v0[0]));
+        __m128 ty = _mm_sub_ps(_mm_set1_ps(ray.origin.y), _mm_load_ps(pack.v0[1]));
+        __m128 tz = _mm_sub_ps(_mm_set1_ps(ray.origin.z), _mm_load_ps(pack.v0[2]));
+        __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), inverse);
+        __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+        __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+        __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+        __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverse);
+        __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverse);
+
+        // degenerate lanes have det == 0 and an infinite or NaN inverse, which fails the comparisons
+        __m128 zero = _mm_setzero_ps();
+        __m128 mask = _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmpge_ps(v, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+        mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmplt_ps(t, _mm_set1_ps(maxDistance))));
+        int lanes = _mm_movemask_ps(mask);
+        if (lanes == 0)
+            return maxDistance;
+
+        alignas(16) float ts[4], us[4], vs[4];
+        _mm_store_ps(ts, t);
+        _mm_store_ps(us, u);
+        _mm_store_ps(vs, v);
+        for (int lane = 0; lane < 4; lane++) {
+            if ((lanes & (1 << lane)) && ts[lane] < maxDistance) {
+                maxDistance = ts[lane];
+                hit.distance = ts[lane];
+                hit.primitive = pack.triangle[lane];
+                hit.barycentric = glm::vec2(us[lane], vs[lane]);
+            }
+        }
+#else
+        for (uint32_t lane = 0; lane < node.count; lane++) {
+            glm::vec3 e1(pack.e1[0][lane], pack.e1[1][lane], pack.e1[2][lane]);
+            glm::vec3 e2(pack.e2[0][lane], pack.e2[1][lane], pack.e2[2][lane]);
+            glm::vec3 p = glm::cross(ray.direction, e2);
+            float det = glm::dot(e1, p);
+            if (det == 0.0f)
+                continue;
+            float inverse = 1.0f / det;
+            glm::vec3 s = ray.origin - glm::vec3(pack.v0[0][lane], pack.v0[1][lane], pack.v0[2][lane]);
+            float u = glm::dot(s, p) * inverse;
+            glm::vec3 q = glm::cross(s, e1);
+            float v = glm::dot(ray.direction, q) * inverse;
+            float t = glm::dot(e2, q) * inverse;
+            if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f && t < maxDistance) {
+                maxDistance = t;
+                hit.distance = t;
+                hit.primitive = pack.triangle[lane];
+                hit.barycentric = glm::vec2(u, v);
+            }
+        }
+#endif
+        return maxDistance;
+    });
+    return hit;
+}
+
+}
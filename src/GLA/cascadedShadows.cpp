@@ -0,0 +1,261 @@
+#include <GLA/cascadedShadows.h>
+
+#include <GLA/debug.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    constexpr int kMaxCascades = 8;
+
+    struct CascadeData {
+        glm::mat4 viewProjection;
+        glm::vec4 params;   // view depth the cascade ends at, world size of a texel
+    };
+
+    const char* kShadowSource = R"(
+layout(binding = SHADOW_UNIT) uniform sampler2DArrayShadow shadowMap;
+
+struct ShadowCascade {
+    mat4 viewProjection;
+    vec4 params;    // view depth the cascade ends at, world size of a texel
+};
+
+layout(std430, binding = SHADOW_BINDING) readonly buffer ShadowCascades {
+    uvec4 shadowInfo;   // cascade count
+    ShadowCascade shadowCascades[];
+};
+
+// 1 if lit, 0 if shadowed, positions beyond the last cascade are lit
+float cascadedShadow(vec3 worldPosition, float viewDepth, float bias) {
+    uint cascade = 0u;
+    while (cascade < shadowInfo.x && viewDepth > shadowCascades[cascade].params.x)
+        cascade++;
+    if (cascade == shadowInfo.x)
+        return 1.0;
+    vec4 clip = shadowCascades[cascade].viewProjection * vec4(worldPosition, 1.0);
+    vec3 coords = clip.xyz / clip.w * 0.5 + 0.5;
+    return texture(shadowMap, vec4(coords.xy, float(cascade), coords.z - bias));
+}
+)";
+
+    // restores the render state changed while drawing the cascades
+    class RenderStateScope {
+    private:
+        GLint _drawFramebuffer = 0;
+        GLint _readFramebuffer = 0;
+        GLint _viewport[4] = {};
+        GLint _scissorBox[4] = {};
+        GLboolean _depthTest = GL_FALSE;
+        GLboolean _scissorTest = GL_FALSE;
+        GLboolean _depthMask = GL_TRUE;
+
+    public:
+        RenderStateScope() {
+            GL_CALL(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_drawFramebuffer));
+            GL_CALL(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &_readFramebuffer));
+            GL_CALL(glGetIntegerv(GL_VIEWPORT, _viewport));
+            GL_CALL(glGetIntegerv(GL_SCISSOR_BOX, _scissorBox));
+            GL_CALL(glGetBooleanv(GL_DEPTH_WRITEMASK, &_depthMask));
+            _depthTest = glIsEnabled(GL_DEPTH_TEST);
+            _scissorTest = glIsEnabled(GL_SCISSOR_TEST);
+        }
+
+        ~RenderStateScope() {
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _drawFramebuffer);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, _readFramebuffer);
+            glViewport(_viewport[0], _viewport[1], _viewport[2], _viewport[3]);
+            glScissor(_scissorBox[0], _scissorBox[1], _scissorBox[2], _scissorBox[3]);
+            glDepthMask(_depthMask);
+            if (_depthTest) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+            if (_scissorTest) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
+        }
+    };
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class CascadedShadows
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void CascadedShadows::_drawStatic(int cascade, int x, int y, int width, int height, const DrawCallback& drawStatic) {
+    _cacheFramebuffers[cascade].bind();
+    GL_CALL(glEnable(GL_SCISSOR_TEST));
+    GL_CALL(glScissor(x, y, width, height));
+    _cacheFramebuffers[cascade].clearDepth(1.0f);
+    if (drawStatic)
+        drawStatic(cascade, _cascades[cascade].viewProjection);
+    GL_CALL(glDisable(GL_SCISSOR_TEST));
+    _staticTexels += (int64_t)width * height;
+}
+
+void CascadedShadows::_scroll(int cascade, int dx, int dy) {
+    // moving the cascade by +dx texels moves its content by -dx, the shadow map layer serves as scratch
+    // because copies within one image must not overlap and the layer is overwritten by the composite anyway
+    int width = _settings.resolution - std::abs(dx);
+    int height = _settings.resolution - std::abs(dy);
+    int sourceX = std::max(dx, 0), sourceY = std::max(dy, 0);
+    int targetX = std::max(-dx, 0), targetY = std::max(-dy, 0);
+    GL_CALL(glCopyImageSubData(_cache.id(), GL_TEXTURE_2D_ARRAY, 0, sourceX, sourceY, cascade,
+                               _shadowMap.id(), GL_TEXTURE_2D_ARRAY, 0, targetX, targetY, cascade, width, height, 1));
+    GL_CALL(glCopyImageSubData(_shadowMap.id(), GL_TEXTURE_2D_ARRAY, 0, targetX, targetY, cascade,
+                               _cache.id(), GL_TEXTURE_2D_ARRAY, 0, targetX, targetY, cascade, width, height, 1));
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+CascadedShadows::CascadedShadows(const CascadedShadowSettings& settings)
+    : _settings(settings), _cache(TextureType::Texture2DArray), _shadowMap(TextureType::Texture2DArray), _cascadeBuffer(BufferType::ShaderStorage) {
+    if (settings.cascades <= 0 || settings.cascades > kMaxCascades)
+        throw std::invalid_argument("CascadedShadows needs between 1 and 8 cascades!");
+    if (settings.resolution <= 0 || settings.resolution % 2 != 0)
+        throw std::invalid_argument("CascadedShadows resolution must be even and greater than 0!");
+
+    _cache.setStorage(1, TextureFormat::Depth32F, settings.resolution, settings.resolution, settings.cascades);
+    _cache.setFilter(TextureFilter::Nearest, TextureFilter::Nearest);
+    _shadowMap.setStorage(1, TextureFormat::Depth32F, settings.resolution, settings.resolution, settings.cascades);
+    _shadowMap.setFilter(TextureFilter::Linear, TextureFilter::Linear);
+    _shadowMap.setWrap(TextureWrap::ClampToEdge);
+    _shadowMap.setDepthCompare(true);
+
+    for (int i = 0; i < settings.cascades; i++) {
+        _cacheFramebuffers.emplace_back().attachDepth(_cache, 0, i);
+        _shadowFramebuffers.emplace_back().attachDepth(_shadowMap, 0, i);
+    }
+    _cascades.resize(settings.cascades);
+    _cascadeBuffer.setStorage(sizeof(glm::uvec4) + sizeof(CascadeData) * settings.cascades, nullptr, BufferFlag::DynamicStorage);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void CascadedShadows::update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& lightDirection,
+                             const DrawCallback& drawStatic, const DrawCallback& drawDynamic) {
+    float near = projection[3][2] / (projection[2][2] - 1.0f);
+    float far = projection[3][2] / (projection[2][2] + 1.0f);
+    if (projection[2][3] != -1.0f || projection[3][3] != 0.0f || !(near > 0.0f) || !(far > near))
+        throw std::invalid_argument("CascadedShadows needs a perspective projection!");
+    if (glm::length(lightDirection) == 0.0f)
+        throw std::invalid_argument("CascadedShadows light direction must not be zero!");
+
+    // any rotation of the light changes the depth of every cached texel, tiny ones are ignored until they add up
+    glm::vec3 direction = glm::normalize(lightDirection);
+    if (glm::dot(direction, _lightDirection) < 1.0f - 1.0e-6f) {
+        invalidateStatic();
+        _lightDirection = direction;
+    }
+    glm::vec3 up = std::abs(_lightDirection.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), _lightDirection, up);
+    glm::mat4 inverseView = glm::inverse(view);
+    glm::mat4 inverseProjection = glm::inverse(projection);
+    far = std::min(far, std::max(_settings.maxDistance, near * 1.001f));
+
+    RenderStateScope state;
+    GL_CALL(glEnable(GL_DEPTH_TEST));
+    GL_CALL(glDepthMask(GL_TRUE));
+    _staticTexels = 0;
+
+    int resolution = _settings.resolution;
+    int count = _settings.cascades;
+    std::vector<CascadeData> data(count);
+    for (int i = 0; i < count; i++) {
+        // practical split scheme between uniform and logarithmic splits
+        float t = (float)(i + 1) / count;
+        float split = glm::mix(near + (far - near) * t, near * std::pow(far / near, t), _settings.splitLambda);
+        float begin = i == 0 ? near : _cascades[i - 1].split;
+
+        // the bounding sphere of the frustum slice only depends on the projection, not on the camera rotation
+        glm::vec3 corners[8];
+        glm::vec3 center(0.0f);
+        for (int c = 0; c < 8; c++) {
+            glm::vec4 onNear = inverseProjection * glm::vec4((c & 1) ? 1.0f : -1.0f, (c & 2) ? 1.0f : -1.0f, -1.0f, 1.0f);
+            glm::vec3 point = glm::vec3(onNear) / onNear.w * (((c & 4) ? split : begin) / near);
+            corners[c] = glm::vec3(inverseView * glm::vec4(point, 1.0f));
+            center += corners[c] / 8.0f;
+        }
+        float radius = 0.0f;
+        for (const glm::vec3& corner : corners)
+            radius = std::max(radius, glm::length(corner - center));
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        // snapping to whole texels keeps static casters on the same texels, the depth range moves in coarse steps
+        glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+        float texel = 2.0f * radius / resolution;
+        int64_t originX = (int64_t)std::floor(lightCenter.x / texel);
+        int64_t originY = (int64_t)std::floor(lightCenter.y / texel);
+        float depthStep = radius * 0.5f;
+        float depthCenter = std::round(lightCenter.z / depthStep) * depthStep;
+        glm::mat4 lightProjection = glm::ortho((originX - resolution / 2) * texel, (originX + resolution / 2) * texel,
+                                               (originY - resolution / 2) * texel, (originY + resolution / 2) * texel,
+                                               -(depthCenter + radius + _settings.casterDistance), -(depthCenter - radius - depthStep));
+
+        Cascade& cascade = _cascades[i];
+        int64_t dx = originX - cascade.originX, dy = originY - cascade.originY;
+        bool reusable = cascade.cached && cascade.radius == radius && cascade.depthCenter == depthCenter &&
+                        std::abs(dx) < resolution && std::abs(dy) < resolution;
+        cascade.viewProjection = lightProjection * lightView;
+        cascade.originX = originX;
+        cascade.originY = originY;
+        cascade.radius = radius;
+        cascade.depthCenter = depthCenter;
+        cascade.split = split;
+
+        if (!reusable) {
+            _drawStatic(i, 0, 0, resolution, resolution, drawStatic);
+        }
+        else if (dx != 0 || dy != 0) {
+            _scroll(i, (int)dx, (int)dy);
+            if (dx != 0)
+                _drawStatic(i, dx > 0 ? resolution - (int)dx : 0, 0, (int)std::abs(dx), resolution, drawStatic);
+            if (dy != 0)
+                _drawStatic(i, 0, dy > 0 ? resolution - (int)dy : 0, resolution, (int)std::abs(dy), drawStatic);
+        }
+        cascade.cached = true;
+
+        // the dynamic casters are drawn on top of a copy of the cache
+        GL_CALL(glCopyImageSubData(_cache.id(), GL_TEXTURE_2D_ARRAY, 0, 0, 0, i,
+                                   _shadowMap.id(), GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, resolution, resolution, 1));
+        if (drawDynamic) {
+            _shadowFramebuffers[i].bind();
+            drawDynamic(i, cascade.viewProjection);
+        }
+        data[i] = { cascade.viewProjection, glm::vec4(split, texel, 0.0f, 0.0f) };
+    }
+
+    glm::uvec4 info((unsigned int)count, 0, 0, 0);
+    _cascadeBuffer.setSubData(0, sizeof(info), &info);
+    _cascadeBuffer.setSubData(sizeof(info), sizeof(CascadeData) * count, data.data());
+}
+
+void CascadedShadows::invalidateStatic() {
+    for (Cascade& cascade : _cascades)
+        cascade.cached = false;
+}
+
+void CascadedShadows::bind() const {
+    _shadowMap.bind(_settings.textureUnit);
+    _cascadeBuffer.bindBase(_settings.binding);
+}
+
+std::string CascadedShadows::glslSource() const {
+    return "#define SHADOW_UNIT " + std::to_string(_settings.textureUnit) + "\n#define SHADOW_BINDING " +
+           std::to_string(_settings.binding) + "\n" + kShadowSource;
+}
+
+}
@@ -0,0 +1,243 @@
+#include <GLA/clusteredLighting.h>
+
+#include <GLA/shader.h>
+#include <GLA/debug.h>
+
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    constexpr int kBinGroupSize = 128;
+
+    struct GridHeader {
+        glm::uvec4 dims;    // grid x, y, z, index capacity
+        glm::vec4 slicing;  // tile width, tile height in pixels, slice scale, slice bias
+        glm::vec4 depth;    // near, far
+        glm::uvec4 counter; // light indices used
+    };
+    static_assert(sizeof(GridHeader) == 64, "GridHeader must match the std430 layout!");
+
+    const char* kClusterCommon = R"(
+struct ClusterLight {
+    vec4 positionRadius;    // world space position, radius
+    vec4 colorIntensity;
+};
+
+layout(std430, binding = CLUSTER_LIGHT_BINDING) readonly buffer ClusterLights {
+    ClusterLight clusterLights[];
+};
+
+layout(std430, binding = CLUSTER_GRID_BINDING) CLUSTER_ACCESS buffer ClusterGrid {
+    uvec4 clusterDims;      // grid x, y, z, index capacity
+    vec4 clusterSlicing;    // tile width, tile height in pixels, slice scale, slice bias
+    vec4 clusterDepth;      // near, far
+    uvec4 clusterCounter;
+    uvec2 clusterRanges[];  // offset into clusterIndices, count
+};
+
+layout(std430, binding = CLUSTER_INDEX_BINDING) CLUSTER_ACCESS buffer ClusterIndices {
+    uint clusterIndices[];
+};
+)";
+
+    const char* kClusterLookup = R"(
+// positive view space distance of gl_FragCoord.z
+float clusterViewDepth(float fragDepth) {
+    float ndc = fragDepth * 2.0 - 1.0;
+    return 2.0 * clusterDepth.x * clusterDepth.y / (clusterDepth.y + clusterDepth.x - ndc * (clusterDepth.y - clusterDepth.x));
+}
+
+// offset and count of the lights in the cluster of a fragment, iterate from offset to offset + count with clusterLight()
+uvec2 clusterRange(vec2 fragCoord, float viewDepth) {
+    uvec2 tile = min(uvec2(max(fragCoord, vec2(0.0)) / clusterSlicing.xy), clusterDims.xy - 1u);
+    int slice = int(floor(log(max(viewDepth, 1.0e-6)) * clusterSlicing.z + clusterSlicing.w));
+    uint z = uint(clamp(slice, 0, int(clusterDims.z) - 1));
+    return clusterRanges[(z * clusterDims.y + tile.y) * clusterDims.x + tile.x];
+}
+
+ClusterLight clusterLight(uint i) {
+    return clusterLights[clusterIndices[i]];
+}
+
+// inverse square falloff windowed to reach 0 at the radius
+float clusterAttenuation(ClusterLight light, vec3 position) {
+    float distance = length(light.positionRadius.xyz - position);
+    float window = clamp(1.0 - pow(distance / light.positionRadius.w, 4.0), 0.0, 1.0);
+    return light.colorIntensity.w * window * window / (distance * distance + 1.0);
+}
+)";
+
+    const char* kBinShader = R"(
+layout(local_size_x = 128) in;
+
+uniform mat4 uView;
+uniform mat4 uInverseProjection;
+uniform vec2 uScreenSize;
+uniform uint uLightCount;
+
+shared vec4 sLights[128];   // view space position, radius
+
+// view space point on the near plane behind a pixel
+vec3 nearPoint(vec2 pixel) {
+    vec4 point = uInverseProjection * vec4(pixel / uScreenSize * 2.0 - 1.0, -1.0, 1.0);
+    return point.xyz / point.w;
+}
+
+void main() {
+    uint cluster = gl_GlobalInvocationID.x;
+    bool active = cluster < clusterDims.x * clusterDims.y * clusterDims.z;
+    uvec3 cell = uvec3(cluster % clusterDims.x, (cluster / clusterDims.x) % clusterDims.y, cluster / (clusterDims.x * clusterDims.y));
+
+    // the box around the tile corner rays between the depths of the slice
+    float sliceNear = exp((float(cell.z) - clusterSlicing.w) / clusterSlicing.z);
+    float sliceFar = exp((float(cell.z + 1u) - clusterSlicing.w) / clusterSlicing.z);
+    vec2 low = vec2(cell.xy) * clusterSlicing.xy;
+    vec2 high = min(low + clusterSlicing.xy, uScreenSize);
+    vec3 boxMin = vec3(3.0e38), boxMax = vec3(-3.0e38);
+    for (int i = 0; i < 4; i++) {
+        vec3 ray = nearPoint(mix(low, high, vec2(i & 1, i >> 1)));
+        vec3 a = ray * (sliceNear / -ray.z);
+        vec3 b = ray * (sliceFar / -ray.z);
+        boxMin = min(boxMin, min(a, b));
+        boxMax = max(boxMax, max(a, b));
+    }
+
+    uint visible[CLUSTER_MAX_LIGHTS];
+    uint count = 0u;
+    for (uint batch = 0u; batch < uLightCount; batch += 128u) {
+        uint index = batch + gl_LocalInvocationIndex;
+        if (index < uLightCount) {
+            vec4 light = clusterLights[index].positionRadius;
+            sLights[gl_LocalInvocationIndex] = vec4((uView * vec4(light.xyz, 1.0)).xyz, light.w);
+        }
+        barrier();
+
+        uint batchSize = min(128u, uLightCount - batch);
+        for (uint i = 0u; active && i < batchSize && count < CLUSTER_MAX_LIGHTS; i++) {
+            vec4 light = sLights[i];
+            vec3 offset = clamp(light.xyz, boxMin, boxMax) - light.xyz;
+            if (dot(offset, offset) <= light.w * light.w)
+                visible[count++] = batch + i;
+        }
+        barrier();
+    }
+    if (!active)
+        return;
+
+    // clusters that don't fit into the index list anymore lose their lights
+    uint offset = atomicAdd(clusterCounter.x, count);
+    count = offset < clusterDims.w ? min(count, clusterDims.w - offset) : 0u;
+    clusterRanges[cluster] = uvec2(offset, count);
+    for (uint i = 0u; i < count; i++)
+        clusterIndices[offset + i] = visible[i];
+}
+)";
+
+    std::string defines(unsigned int binding, bool writable) {
+        return "#define CLUSTER_LIGHT_BINDING " + std::to_string(binding) +
+               "\n#define CLUSTER_GRID_BINDING " + std::to_string(binding + 1) +
+               "\n#define CLUSTER_INDEX_BINDING " + std::to_string(binding + 2) +
+               "\n#define CLUSTER_ACCESS " + (writable ? "coherent" : "readonly") + "\n";
+    }
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class ClusteredLighting
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+ClusteredLighting::ClusteredLighting(const ClusteredLightingSettings& settings)
+    : _settings(settings), _lights(BufferType::ShaderStorage, (int64_t)std::max(settings.maxLights, 1) * sizeof(PointLight) + 512),
+      _grid(BufferType::ShaderStorage), _indices(BufferType::ShaderStorage) {
+    if (glm::any(glm::lessThanEqual(settings.grid, glm::ivec3(0))))
+        throw std::invalid_argument("ClusteredLighting grid dimensions must be greater than 0!");
+    if (settings.maxLights <= 0 || settings.maxLightsPerCluster <= 0 || settings.averageLightsPerCluster <= 0)
+        throw std::invalid_argument("maxLights, maxLightsPerCluster and averageLightsPerCluster must be greater than 0!");
+
+    _grid.setStorage(sizeof(GridHeader) + (int64_t)clusterCount() * sizeof(glm::uvec2), nullptr, BufferFlag::DynamicStorage);
+    _indices.setStorage((int64_t)clusterCount() * settings.averageLightsPerCluster * sizeof(uint32_t), nullptr, BufferFlag::None);
+
+    std::string source = "#version 430 core\n" + defines(settings.binding, true) +
+                         "#define CLUSTER_MAX_LIGHTS " + std::to_string(settings.maxLightsPerCluster) + "\n" + kClusterCommon + kBinShader;
+    Shader compute(ShaderType::Compute, source);
+    _binProgram.attach(compute);
+    _binProgram.link();
+
+    GLint alignment = 256;
+    GL_CALL(glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    _storageAlignment = std::max(alignment, 1);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void ClusteredLighting::update(std::span<const PointLight> lights, const glm::mat4& view, const glm::mat4& projection, int width, int height) {
+    if (lights.size() > (size_t)_settings.maxLights)
+        throw std::invalid_argument("More than maxLights lights were passed to ClusteredLighting::update()!");
+    if (width <= 0 || height <= 0)
+        throw std::invalid_argument("ClusteredLighting viewport width and height must be greater than 0!");
+
+    // near and far plane of a glm::perspective() style projection
+    float near = projection[3][2] / (projection[2][2] - 1.0f);
+    float far = projection[3][2] / (projection[2][2] + 1.0f);
+    if (projection[2][3] != -1.0f || projection[3][3] != 0.0f || !(near > 0.0f) || !(far > near) || !std::isfinite(far))
+        throw std::invalid_argument("ClusteredLighting needs a perspective projection with a finite far plane!");
+
+    // the previous frame ends here, so its Fence also covers the draws that read its lights
+    if (_frameOpen)
+        _lights.endFrame();
+    _lights.beginFrame();
+    _frameOpen = true;
+
+    // an empty light list still binds a valid range
+    RingAllocation allocation = _lights.allocate((int64_t)std::max(lights.size(), (size_t)1) * sizeof(PointLight), _storageAlignment);
+    if (!lights.empty())
+        std::copy(lights.begin(), lights.end(), (PointLight*)allocation.data);
+    _lightOffset = allocation.offset;
+    _lightSize = allocation.size;
+    _lightCount = (uint32_t)lights.size();
+
+    // the slice of a depth is log(depth) * scale + bias, which makes slices grow with the distance
+    const glm::ivec3& grid = _settings.grid;
+    float logRange = std::log(far / near);
+    GridHeader header = {};
+    header.dims = glm::uvec4(grid, clusterCount() * (uint32_t)_settings.averageLightsPerCluster);
+    header.slicing = glm::vec4(std::ceil((float)width / grid.x), std::ceil((float)height / grid.y),
+                               grid.z / logRange, -grid.z * std::log(near) / logRange);
+    header.depth = glm::vec4(near, far, 0.0f, 0.0f);
+    _grid.setSubData(0, sizeof(header), &header);
+
+    _binProgram.bind();
+    _binProgram["uView"] = view;
+    _binProgram["uInverseProjection"] = glm::inverse(projection);
+    _binProgram["uScreenSize"] = glm::vec2(width, height);
+    _binProgram["uLightCount"] = _lightCount;
+    bind();
+    GL_CALL(glDispatchCompute((clusterCount() + kBinGroupSize - 1) / kBinGroupSize, 1, 1));
+    GL_CALL(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+}
+
+void ClusteredLighting::bind() const {
+    if (_lightSize > 0)
+        _lights.buffer().bindRange(_settings.binding, _lightOffset, _lightSize);
+    _grid.bindBase(_settings.binding + 1);
+    _indices.bindBase(_settings.binding + 2);
+}
+
+std::string ClusteredLighting::glslSource() const {
+    return defines(_settings.binding, false) + kClusterCommon + kClusterLookup;
+}
+
+}
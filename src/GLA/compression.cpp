@@ -0,0 +1,158 @@
+#include <GLA/compression.h>
+
+#include <cstring>
+
+namespace gla {
+
+namespace {
+
+    constexpr size_t kMinMatch = 4;
+    constexpr size_t kLastLiterals = 5;     // the last 5 bytes of a block are always literals
+    constexpr size_t kMatchStartLimit = 12; // no match may start within the last 12 bytes
+    constexpr size_t kMaxOffset = 65535;
+    constexpr int kHashBits = 16;
+
+    uint32_t read32(const uint8_t* data) {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint32_t hashSequence(uint32_t sequence) {
+        return (sequence * 2654435761u) >> (32 - kHashBits);
+    }
+
+    void writeLength(std::vector<uint8_t>& output, size_t length) {
+        while (length >= 255) {
+            output.push_back(255);
+            length -= 255;
+        }
+        output.push_back((uint8_t)length);
+    }
+
+    size_t readLength(std::span<const uint8_t> input, size_t& position) {
+        size_t length = 0;
+        uint8_t byte;
+        do {
+            if (position >= input.size())
+                throw std::runtime_error("LZ4 block is truncated!");
+            byte = input[position++];
+            length += byte;
+        } while (byte == 255);
+        return length;
+    }
+
+    void writeSequence(std::vector<uint8_t>& output, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength) {
+        size_t matchCode = matchLength - kMinMatch;
+        uint8_t token = (uint8_t)((literalLength < 15 ? literalLength : 15) << 4);
+        token |= (uint8_t)(matchCode < 15 ? matchCode : 15);
+        output.push_back(token);
+        if (literalLength >= 15)
+            writeLength(output, literalLength - 15);
+        output.insert(output.end(), literals, literals + literalLength);
+        output.push_back((uint8_t)(offset & 0xFF));
+        output.push_back((uint8_t)(offset >> 8));
+        if (matchCode >= 15)
+            writeLength(output, matchCode - 15);
+    }
+
+    void writeLastLiterals(std::vector<uint8_t>& output, const uint8_t* literals, size_t literalLength) {
+        output.push_back((uint8_t)((literalLength < 15 ? literalLength : 15) << 4));
+        if (literalLength >= 15)
+            writeLength(output, literalLength - 15);
+        output.insert(output.end(), literals, literals + literalLength);
+    }
+
+}
+
+std::vector<uint8_t> lz4Compress(std::span<const uint8_t> input) {
+    const uint8_t* data = input.data();
+    size_t size = input.size();
+
+    std::vector<uint8_t> output;
+    output.reserve(size + size / 255 + 16);
+
+    size_t anchor = 0;
+    if (size > kMatchStartLimit) {
+        std::vector<uint32_t> table((size_t)1 << kHashBits, UINT32_MAX);
+        size_t matchStartEnd = size - kMatchStartLimit;
+        size_t matchEnd = size - kLastLiterals;
+
+        size_t position = 0;
+        while (position < matchStartEnd) {
+            uint32_t sequence = read32(data + position);
+            uint32_t& slot = table[hashSequence(sequence)];
+            size_t candidate = slot;
+            slot = (uint32_t)position;
+
+            if (candidate == UINT32_MAX || position - candidate > kMaxOffset || read32(data + candidate) != sequence) {
+                position++;
+                continue;
+            }
+
+            size_t end = position + kMinMatch;
+            while (end < matchEnd && data[end] == data[candidate + end - position])
+                end++;
+
+            writeSequence(output, data + anchor, position - anchor, position - candidate, end - position);
+            position = end;
+            anchor = end;
+        }
+    }
+    writeLastLiterals(output, data + anchor, size - anchor);
+    return output;
+}
+
+void lz4Decompress(std::span<const uint8_t> input, std::span<uint8_t> output) {
+    size_t in = 0;
+    size_t out = 0;
+    while (true) {
+        if (in >= input.size())
+            throw std::runtime_error("LZ4 block is truncated!");
+        uint8_t token = input[in++];
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15)
+            literalLength += readLength(input, in);
+        if (literalLength > input.size() - in || literalLength > output.size() - out)
+            throw std::runtime_error("LZ4 literals exceed the block!");
+        std::memcpy(output.data() + out, input.data() + in, literalLength);
+        in += literalLength;
+        out += literalLength;
+
+        // the last sequence ends after its literals
+        if (in == input.size())
+            break;
+
+        if (input.size() - in < 2)
+            throw std::runtime_error("LZ4 block is truncated!");
+        size_t offset = input[in] | ((size_t)input[in + 1] << 8);
+        in += 2;
+        if (offset == 0 || offset > out)
+            throw std::runtime_error("LZ4 match offset is invalid!");
+
+        size_t matchLength = token & 0x0F;
+        if (matchLength == 15)
+            matchLength += readLength(input, in);
+        matchLength += kMinMatch;
+        if (matchLength > output.size() - out)
+            throw std::runtime_error("LZ4 match exceeds the output!");
+
+        uint8_t* destination = output.data() + out;
+        const uint8_t* source = destination - offset;
+        if (offset >= matchLength) {
+            std::memcpy(destination, source, matchLength);
+        }
+        else {
+            // overlapping matches repeat the last offset bytes
+            for (size_t i = 0; i < matchLength; i++)
+                destination[i] = source[i];
+        }
+        out += matchLength;
+    }
+
+    if (out != output.size())
+        throw std::runtime_error("LZ4 block decompressed to an unexpected size!");
+}
+
+}
@@ -0,0 +1,199 @@
+#include <GLA/debugDraw.h>
+
+#ifdef DEBUG_BUILD
+
+#include <GLA/shader.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/packing.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    const char* kDebugVertexShader = R"(#version 430 core
+
+struct Line {
+    vec3 a;
+    float width;
+    vec3 b;
+    uint color;
+};
+
+layout(std430, binding = 0) readonly buffer Lines { Line lines[]; };
+
+uniform mat4 uViewProjection;
+uniform vec2 uViewportSize;
+
+out vec4 vColor;
+
+void main() {
+    Line line = lines[gl_InstanceID];
+    vec4 a = uViewProjection * vec4(line.a, 1.0);
+    vec4 b = uViewProjection * vec4(line.b, 1.0);
+
+    // clip against the near plane so the screen direction stays valid
+    const float nearW = 1e-4;
+    if (a.w < nearW && b.w < nearW) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        vColor = vec4(0.0);
+        return;
+    }
+    if (a.w < nearW)
+        a = mix(a, b, (nearW - a.w) / (b.w - a.w));
+    else if (b.w < nearW)
+        b = mix(b, a, (nearW - b.w) / (a.w - b.w));
+
+    vec2 screenA = a.xy / a.w * uViewportSize;
+    vec2 screenB = b.xy / b.w * uViewportSize;
+    vec2 direction = screenB - screenA;
+    direction = dot(direction, direction) > 0.0 ? normalize(direction) : vec2(1.0, 0.0);
+    vec2 normal = vec2(-direction.y, direction.x) * line.width / uViewportSize;
+
+    // two triangles: corner.x selects the end, corner.y the side
+    const vec2 corners[6] = vec2[](vec2(0, -1), vec2(1, -1), vec2(1, 1), vec2(0, -1), vec2(1, 1), vec2(0, 1));
+    vec2 corner = corners[gl_VertexID];
+    vec4 position = corner.x == 0.0 ? a : b;
+    position.xy += normal * corner.y * position.w;
+
+    gl_Position = position;
+    vColor = unpackUnorm4x8(line.color);
+}
+)";
+
+    const char* kDebugFragmentShader = R"(#version 430 core
+
+in vec4 vColor;
+
+layout(location = 0) out vec4 color;
+
+void main() {
+    color = vColor;
+}
+)";
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class DebugDraw
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void DebugDraw::_draw(std::vector<Line>& lines) {
+    if (lines.empty())
+        return;
+    int64_t bytes = (int64_t)(lines.size() * sizeof(Line));
+    RingAllocation allocation = _ring.allocate(bytes, _storageAlignment);
+    std::memcpy(allocation.data, lines.data(), bytes);
+    _ring.buffer().bindRange(0, allocation.offset, allocation.size);
+    GL_CALL(glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)lines.size()));
+    lines.clear();
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+DebugDraw::DebugDraw(const DebugDrawSettings& settings)
+    : _settings(settings), _ring(BufferType::ShaderStorage, (int64_t)std::max(settings.maxLinesPerFrame, 1) * sizeof(Line) + 512) {
+    if (settings.maxLinesPerFrame <= 0)
+        throw std::invalid_argument("maxLinesPerFrame must be greater than 0!");
+
+    Shader vertex(ShaderType::Vertex, kDebugVertexShader);
+    Shader fragment(ShaderType::Fragment, kDebugFragmentShader);
+    _program.attach(vertex);
+    _program.attach(fragment);
+    _program.link();
+
+    GLint alignment = 256;
+    GL_CALL(glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    _storageAlignment = std::max(alignment, 1);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void DebugDraw::line(const glm::vec3& a, const glm::vec3& b, const glm::vec4& color, float width, DebugDepth depth) {
+    if (_lines[0].size() + _lines[1].size() >= (size_t)_settings.maxLinesPerFrame)
+        throw std::runtime_error("More than maxLinesPerFrame debug lines were added in one frame!");
+    _lines[(int)depth].push_back({ a, width, b, glm::packUnorm4x8(color) });
+}
+
+void DebugDraw::aabb(const glm::vec3& min, const glm::vec3& max, const glm::vec4& color, float width, DebugDepth depth) {
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; i++)
+        corners[i] = { (i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z };
+    for (int i = 0; i < 8; i++)
+        for (int axis = 1; axis < 8; axis <<= 1)
+            if (!(i & axis))
+                line(corners[i], corners[i | axis], color, width, depth);
+}
+
+void DebugDraw::frustum(const glm::mat4& viewProjection, const glm::vec4& color, float width, DebugDepth depth) {
+    glm::mat4 inverse = glm::inverse(viewProjection);
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; i++) {
+        glm::vec4 corner = inverse * glm::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 1.0f);
+        corners[i] = glm::vec3(corner) / corner.w;
+    }
+    for (int i = 0; i < 8; i++)
+        for (int axis = 1; axis < 8; axis <<= 1)
+            if (!(i & axis))
+                line(corners[i], corners[i | axis], color, width, depth);
+}
+
+void DebugDraw::sphere(const glm::vec3& center, float radius, const glm::vec4& color, float width, DebugDepth depth, int segments) {
+    segments = std::max(segments, 3);
+    float step = glm::two_pi<float>() / segments;
+    for (int axis = 0; axis < 3; axis++) {
+        glm::vec3 previous;
+        for (int i = 0; i <= segments; i++) {
+            float s = std::sin(i * step) * radius;
+            float c = std::cos(i * step) * radius;
+            glm::vec3 offset = axis == 0 ? glm::vec3(c, s, 0.0f) : axis == 1 ? glm::vec3(c, 0.0f, s) : glm::vec3(0.0f, c, s);
+            glm::vec3 point = center + offset;
+            if (i > 0)
+                line(previous, point, color, width, depth);
+            previous = point;
+        }
+    }
+}
+
+void DebugDraw::render(const glm::mat4& viewProjection, const glm::vec2& viewportSize) {
+    if (_lines[0].empty() && _lines[1].empty())
+        return;
+
+    GLboolean depthTest, depthMask;
+    GL_CALL(glGetBooleanv(GL_DEPTH_TEST, &depthTest));
+    GL_CALL(glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask));
+
+    _program.bind();
+    _program["uViewProjection"] = viewProjection;
+    _program["uViewportSize"] = viewportSize;
+
+    _ring.beginFrame();
+    GL_CALL(glDepthMask(GL_FALSE));
+    GL_CALL(glEnable(GL_DEPTH_TEST));
+    _draw(_lines[(int)DebugDepth::Tested]);
+    GL_CALL(glDisable(GL_DEPTH_TEST));
+    _draw(_lines[(int)DebugDepth::Overlay]);
+    _ring.endFrame();
+
+    if (depthTest)
+        GL_CALL(glEnable(GL_DEPTH_TEST));
+    GL_CALL(glDepthMask(depthMask));
+}
+
+}
+
+#endif
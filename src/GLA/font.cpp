@@ -0,0 +1,491 @@
+#include <GLA/font.h>
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/common.hpp>
+
+namespace gla {
+
+namespace {
+
+    constexpr int kMaxCompositeDepth = 8;
+    constexpr int kCurveSegments = 8;
+
+    uint32_t tag(const char* name) {
+        return ((uint32_t)name[0] << 24) | ((uint32_t)name[1] << 16) | ((uint32_t)name[2] << 8) | (uint32_t)name[3];
+    }
+
+    struct Reader {
+        const std::vector<uint8_t>& data;
+
+        void check(uint64_t offset, uint64_t size) const {
+            if (offset + size > data.size())
+                throw FontParseError("Read outside of font data at offset " + std::to_string(offset) + "!");
+        }
+        uint8_t u8(uint64_t offset) const { check(offset, 1); return data[offset]; }
+        int8_t i8(uint64_t offset) const { return (int8_t)u8(offset); }
+        uint16_t u16(uint64_t offset) const { check(offset, 2); return (uint16_t)((data[offset] << 8) | data[offset + 1]); }
+        int16_t i16(uint64_t offset) const { return (int16_t)u16(offset); }
+        uint32_t u32(uint64_t offset) const {
+            check(offset, 4);
+            return ((uint32_t)data[offset] << 24) | ((uint32_t)data[offset + 1] << 16) | ((uint32_t)data[offset + 2] << 8) | data[offset + 3];
+        }
+        float f2dot14(uint64_t offset) const { return i16(offset) / 16384.0f; }
+    };
+
+    void addQuadratic(std::vector<OutlineEdge>& edges, glm::vec2 p0, glm::vec2 p1, glm::vec2 p2) {
+        glm::vec2 prev = p0;
+        for (int i = 1; i <= kCurveSegments; i++) {
+            float t = (float)i / kCurveSegments;
+            float u = 1.0f - t;
+            glm::vec2 p = u * u * p0 + 2.0f * u * t * p1 + t * t * p2;
+            edges.push_back({ prev, p });
+            prev = p;
+        }
+    }
+
+    struct OutlinePoint {
+        glm::vec2 pos;
+        bool onCurve;
+    };
+
+    void addContour(std::vector<OutlineEdge>& edges, const std::vector<OutlinePoint>& points) {
+        size_t n = points.size();
+        if (n < 2)
+            return;
+
+        // insert the implicit on curve points between consecutive off curve points
+        std::vector<OutlinePoint> expanded;
+        expanded.reserve(n * 2);
+        for (size_t i = 0; i < n; i++) {
+            const OutlinePoint& cur = points[i];
+            const OutlinePoint& next = points[(i + 1) % n];
+            expanded.push_back(cur);
+            if (!cur.onCurve && !next.onCurve)
+                expanded.push_back({ (cur.pos + next.pos) * 0.5f, true });
+        }
+
+        size_t m = expanded.size();
+        size_t start = 0;
+        while (start < m && !expanded[start].onCurve)
+            start++;
+        if (start == m)
+            return;
+
+        glm::vec2 current = expanded[start].pos;
+        for (size_t k = 1; k <= m; k++) {
+            const OutlinePoint& q = expanded[(start + k) % m];
+            if (q.onCurve) {
+                edges.push_back({ current, q.pos });
+                current = q.pos;
+            }
+            else {
+                const OutlinePoint& r = expanded[(start + k + 1) % m];
+                addQuadratic(edges, current, q.pos, r.pos);
+                current = r.pos;
+                k++;
+            }
+        }
+    }
+
+    glm::vec2 applyTransform(const float t[6], glm::vec2 p) {
+        return { t[0] * p.x + t[2] * p.y + t[4], t[1] * p.x + t[3] * p.y + t[5] };
+    }
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class Font
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void Font::_parse() {
+    Reader r{ _data };
+    uint32_t version = r.u32(0);
+    if (version != 0x00010000 && version != tag("true"))
+        throw FontParseError("Unsupported font version, only TrueType outlines are supported!");
+
+    uint32_t head = 0, maxp = 0, hhea = 0;
+    uint16_t numTables = r.u16(4);
+    for (uint16_t i = 0; i < numTables; i++) {
+        uint64_t record = 12 + (uint64_t)i * 16;
+        uint32_t name = r.u32(record);
+        uint32_t offset = r.u32(record + 8);
+        if (name == tag("head")) head = offset;
+        else if (name == tag("maxp")) maxp = offset;
+        else if (name == tag("hhea")) hhea = offset;
+        else if (name == tag("hmtx")) _hmtx = offset;
+        else if (name == tag("cmap")) _cmap = offset;
+        else if (name == tag("loca")) _loca = offset;
+        else if (name == tag("glyf")) _glyf = offset;
+        else if (name == tag("kern")) _kern = offset;
+    }
+    if (!head || !maxp || !hhea || !_hmtx || !_cmap || !_loca || !_glyf)
+        throw FontParseError("Font is missing a required table (head, maxp, hhea, hmtx, cmap, loca or glyf)!");
+
+    _unitsPerEm = r.u16(head + 18);
+    _longLoca = r.i16(head + 50) != 0;
+    _numGlyphs = r.u16(maxp + 4);
+    _ascender = r.i16(hhea + 4);
+    _descender = r.i16(hhea + 6);
+    _lineGap = r.i16(hhea + 8);
+    _numHMetrics = r.u16(hhea + 34);
+    if (_unitsPerEm == 0 || _numHMetrics == 0)
+        throw FontParseError("Font header is invalid!");
+
+    // pick the best unicode subtable, format 12 covers the full range, format 4 only the BMP
+    uint32_t best = 0;
+    int bestScore = 0;
+    uint16_t numSubtables = r.u16(_cmap + 2);
+    for (uint16_t i = 0; i < numSubtables; i++) {
+        uint64_t record = _cmap + 4 + (uint64_t)i * 8;
+        uint16_t platform = r.u16(record);
+        uint16_t encoding = r.u16(record + 2);
+        uint32_t offset = _cmap + r.u32(record + 4);
+        uint16_t format = r.u16(offset);
+        bool unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+        int score = !unicode ? 0 : format == 12 ? 2 : format == 4 ? 1 : 0;
+        if (score > bestScore) {
+            best = offset;
+            bestScore = score;
+        }
+    }
+    if (best == 0)
+        throw FontParseError("Font has no supported unicode cmap subtable!");
+    _cmap = best;
+
+    // only keep horizontal format 0 kerning
+    if (_kern) {
+        uint32_t kern = _kern;
+        _kern = 0;
+        if (r.u16(kern) == 0 && r.u16(kern + 2) > 0) {
+            uint16_t coverage = r.u16(kern + 4 + 4);
+            if ((coverage >> 8) == 0 && (coverage & 1))
+                _kern = kern + 4 + 6;
+        }
+    }
+}
+
+uint32_t Font::_glyphOffset(uint32_t glyph, uint32_t& length) const {
+    Reader r{ _data };
+    uint32_t begin, end;
+    if (_longLoca) {
+        begin = r.u32(_loca + glyph * 4);
+        end = r.u32(_loca + glyph * 4 + 4);
+    }
+    else {
+        begin = r.u16(_loca + glyph * 2) * 2u;
+        end = r.u16(_loca + glyph * 2 + 2) * 2u;
+    }
+    if (end < begin)
+        throw FontParseError("Glyph location table is corrupt!");
+    length = end - begin;
+    return _glyf + begin;
+}
+
+void Font::_outline(uint32_t glyph, const float transform[6], std::vector<OutlineEdge>& edges, int depth) const {
+    if (depth > kMaxCompositeDepth)
+        throw FontParseError("Composite glyphs are nested too deeply!");
+    if (glyph >= (uint32_t)_numGlyphs)
+        throw std::out_of_range("Glyph index is out of range!");
+
+    Reader r{ _data };
+    uint32_t length;
+    uint64_t offset = _glyphOffset(glyph, length);
+    if (length == 0)
+        return;
+
+    int16_t numContours = r.i16(offset);
+    if (numContours >= 0) {
+        uint64_t endPts = offset + 10;
+        int numPoints = numContours > 0 ? r.u16(endPts + (numContours - 1) * 2) + 1 : 0;
+        uint64_t instructionLength = r.u16(endPts + numContours * 2);
+        uint64_t cursor = endPts + numContours * 2 + 2 + instructionLength;
+
+        std::vector<uint8_t> flags(numPoints);
+        for (int i = 0; i < numPoints;) {
+            uint8_t flag = r.u8(cursor++);
+            flags[i++] = flag;
+            if (flag & 8) {
+                uint8_t repeat = r.u8(cursor++);
+                for (uint8_t j = 0; j < repeat && i < numPoints; j++)
+                    flags[i++] = flag;
+            }
+        }
+
+        std::vector<OutlinePoint> points(numPoints);
+        int value = 0;
+        for (int i = 0; i < numPoints; i++) {
+            if (flags[i] & 2) {
+                uint8_t delta = r.u8(cursor++);
+                value += (flags[i] & 16) ? delta : -delta;
+            }
+            else if (!(flags[i] & 16)) {
+                value += r.i16(cursor);
+                cursor += 2;
+            }
+            points[i].pos.x = (float)value;
+            points[i].onCurve = flags[i] & 1;
+        }
+        value = 0;
+        for (int i = 0; i < numPoints; i++) {
+            if (flags[i] & 4) {
+                uint8_t delta = r.u8(cursor++);
+                value += (flags[i] & 32) ? delta : -delta;
+            }
+            else if (!(flags[i] & 32)) {
+                value += r.i16(cursor);
+                cursor += 2;
+            }
+            points[i].pos.y = (float)value;
+        }
+
+        for (OutlinePoint& point : points)
+            point.pos = applyTransform(transform, point.pos);
+
+        int first = 0;
+        for (int c = 0; c < numContours; c++) {
+            int last = r.u16(endPts + c * 2);
+            if (last < first || last >= numPoints)
+                throw FontParseError("Glyph contour end points are corrupt!");
+            addContour(edges, std::vector<OutlinePoint>(points.begin() + first, points.begin() + last + 1));
+            first = last + 1;
+        }
+        return;
+    }
+
+    // composite glyph
+    uint64_t cursor = offset + 10;
+    uint16_t flags;
+    do {
+        flags = r.u16(cursor);
+        uint16_t component = r.u16(cursor + 2);
+        cursor += 4;
+
+        float dx, dy;
+        if (flags & 1) {
+            dx = r.i16(cursor);
+            dy = r.i16(cursor + 2);
+            cursor += 4;
+        }
+        else {
+            dx = r.i8(cursor);
+            dy = r.i8(cursor + 1);
+            cursor += 2;
+        }
+
+        float local[6] = { 1.0f, 0.0f, 0.0f, 1.0f, dx, dy };
+        if (flags & 8) {
+            local[0] = local[3] = r.f2dot14(cursor);
+            cursor += 2;
+        }
+        else if (flags & 0x40) {
+            local[0] = r.f2dot14(cursor);
+            local[3] = r.f2dot14(cursor + 2);
+            cursor += 4;
+        }
+        else if (flags & 0x80) {
+            local[0] = r.f2dot14(cursor);
+            local[1] = r.f2dot14(cursor + 2);
+            local[2] = r.f2dot14(cursor + 4);
+            local[3] = r.f2dot14(cursor + 6);
+            cursor += 8;
+        }
+        if (!(flags & 2)) { // point matching is not supported, place the component at the origin
+            local[4] = 0.0f;
+            local[5] = 0.0f;
+        }
+
+        float combined[6] = {
+            transform[0] * local[0] + transform[2] * local[1],
+            transform[1] * local[0] + transform[3] * local[1],
+            transform[0] * local[2] + transform[2] * local[3],
+            transform[1] * local[2] + transform[3] * local[3],
+            transform[0] * local[4] + transform[2] * local[5] + transform[4],
+            transform[1] * local[4] + transform[3] * local[5] + transform[5]
+        };
+        _outline(component, combined, edges, depth + 1);
+    } while (flags & 0x20);
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+Font::Font(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good())
+        throw std::invalid_argument("Could not open font file: " + path + "!");
+    _data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (!file && !file.eof())
+        throw std::invalid_argument("Failed while reading font file: " + path + "!");
+    _parse();
+}
+
+Font::Font(std::vector<uint8_t> data) : _data(std::move(data)) {
+    _parse();
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+uint32_t Font::glyphIndex(uint32_t codepoint) const {
+    Reader r{ _data };
+    uint16_t format = r.u16(_cmap);
+
+    if (format == 12) {
+        uint32_t groups = r.u32(_cmap + 12);
+        uint32_t low = 0, high = groups;
+        while (low < high) {
+            uint32_t mid = (low + high) / 2;
+            uint64_t group = _cmap + 16 + (uint64_t)mid * 12;
+            uint32_t start = r.u32(group);
+            uint32_t end = r.u32(group + 4);
+            if (codepoint < start)
+                high = mid;
+            else if (codepoint > end)
+                low = mid + 1;
+            else
+                return r.u32(group + 8) + (codepoint - start);
+        }
+        return 0;
+    }
+
+    if (codepoint > 0xFFFF)
+        return 0;
+    uint16_t segCount = r.u16(_cmap + 6) / 2;
+    uint64_t endCodes = _cmap + 14;
+    uint64_t startCodes = endCodes + segCount * 2 + 2;
+    uint64_t idDeltas = startCodes + segCount * 2;
+    uint64_t idRangeOffsets = idDeltas + segCount * 2;
+    for (uint16_t i = 0; i < segCount; i++) {
+        if (r.u16(endCodes + i * 2) < codepoint)
+            continue;
+        uint16_t start = r.u16(startCodes + i * 2);
+        if (start > codepoint)
+            return 0;
+        uint16_t delta = r.u16(idDeltas + i * 2);
+        uint16_t rangeOffset = r.u16(idRangeOffsets + i * 2);
+        if (rangeOffset == 0)
+            return (codepoint + delta) & 0xFFFF;
+        uint16_t glyph = r.u16(idRangeOffsets + i * 2 + rangeOffset + (codepoint - start) * 2);
+        return glyph == 0 ? 0 : (glyph + delta) & 0xFFFF;
+    }
+    return 0;
+}
+
+GlyphMetrics Font::metrics(uint32_t glyph) const {
+    if (glyph >= (uint32_t)_numGlyphs)
+        throw std::out_of_range("Glyph index is out of range!");
+    Reader r{ _data };
+    GlyphMetrics result = {};
+    if (glyph < (uint32_t)_numHMetrics) {
+        result.advance = r.u16(_hmtx + glyph * 4);
+        result.leftBearing = r.i16(_hmtx + glyph * 4 + 2);
+    }
+    else {
+        result.advance = r.u16(_hmtx + (_numHMetrics - 1) * 4);
+        result.leftBearing = r.i16(_hmtx + _numHMetrics * 4 + (glyph - _numHMetrics) * 2);
+    }
+    uint32_t length;
+    uint64_t offset = _glyphOffset(glyph, length);
+    if (length >= 10) {
+        result.min = { r.i16(offset + 2), r.i16(offset + 4) };
+        result.max = { r.i16(offset + 6), r.i16(offset + 8) };
+    }
+    return result;
+}
+
+int Font::kerning(uint32_t left, uint32_t right) const {
+    if (_kern == 0)
+        return 0;
+    Reader r{ _data };
+    uint32_t key = (left << 16) | right;
+    uint32_t low = 0, high = r.u16(_kern);
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        uint64_t pair = _kern + 8 + (uint64_t)mid * 6;
+        uint32_t current = r.u32(pair);
+        if (key < current)
+            high = mid;
+        else if (key > current)
+            low = mid + 1;
+        else
+            return r.i16(pair + 4);
+    }
+    return 0;
+}
+
+std::vector<OutlineEdge> Font::outline(uint32_t glyph) const {
+    const float identity[6] = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+    std::vector<OutlineEdge> edges;
+    _outline(glyph, identity, edges, 0);
+    return edges;
+}
+
+SdfGlyph Font::rasterizeSdf(uint32_t glyph, float pixelsPerEm, int spread) const {
+    if (pixelsPerEm <= 0.0f || spread <= 0)
+        throw std::invalid_argument("pixelsPerEm and spread must be greater than 0!");
+
+    std::vector<OutlineEdge> edges = outline(glyph);
+    SdfGlyph result;
+    if (edges.empty())
+        return result;
+
+    // work in pixel space with y pointing up
+    float scale = pixelsPerEm / _unitsPerEm;
+    glm::vec2 min(INFINITY), max(-INFINITY);
+    for (OutlineEdge& edge : edges) {
+        edge.a *= scale;
+        edge.b *= scale;
+        min = glm::min(min, glm::min(edge.a, edge.b));
+        max = glm::max(max, glm::max(edge.a, edge.b));
+    }
+    int x0 = (int)std::floor(min.x) - spread;
+    int y0 = (int)std::floor(min.y) - spread;
+    int x1 = (int)std::ceil(max.x) + spread;
+    int y1 = (int)std::ceil(max.y) + spread;
+
+    result.width = x1 - x0;
+    result.height = y1 - y0;
+    result.planeMin = glm::vec2(x0, y0) / pixelsPerEm;
+    result.planeMax = glm::vec2(x1, y1) / pixelsPerEm;
+    result.pixels.resize((size_t)result.width * result.height);
+
+    float range = 2.0f * spread;
+    for (int py = 0; py < result.height; py++) {
+        float y = y1 - py - 0.5f;
+        for (int px = 0; px < result.width; px++) {
+            glm::vec2 p(x0 + px + 0.5f, y);
+            float minDist2 = INFINITY;
+            int winding = 0;
+            for (const OutlineEdge& edge : edges) {
+                glm::vec2 ab = edge.b - edge.a;
+                glm::vec2 ap = p - edge.a;
+                float len2 = ab.x * ab.x + ab.y * ab.y;
+                float t = len2 > 0.0f ? std::clamp((ap.x * ab.x + ap.y * ab.y) / len2, 0.0f, 1.0f) : 0.0f;
+                glm::vec2 d = ap - ab * t;
+                minDist2 = std::min(minDist2, d.x * d.x + d.y * d.y);
+
+                if ((edge.a.y <= p.y) != (edge.b.y <= p.y)) {
+                    float x = edge.a.x + (p.y - edge.a.y) * ab.x / ab.y;
+                    if (x > p.x)
+                        winding += ab.y > 0.0f ? 1 : -1;
+                }
+            }
+            float distance = std::sqrt(minDist2) * (winding != 0 ? 1.0f : -1.0f);
+            float value = std::clamp(0.5f + distance / range, 0.0f, 1.0f);
+            result.pixels[(size_t)py * result.width + px] = (uint8_t)std::lround(value * 255.0f);
+        }
+    }
+    return result;
+}
+
+}
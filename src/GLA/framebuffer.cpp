@@ -0,0 +1,191 @@
+#include <GLA/framebuffer.h>
+
+#include <GLA/debug.h>
+
+#include <algorithm>
+#include <string>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    // attaching and clearing must not change the framebuffer the application renders into
+    class FramebufferScope {
+    private:
+        GLint _draw = 0;
+        GLint _read = 0;
+
+    public:
+        FramebufferScope(unsigned int id) {
+            GL_CALL(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_draw));
+            GL_CALL(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &_read));
+            GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, id));
+        }
+
+        ~FramebufferScope() {
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _draw);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, _read);
+        }
+    };
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class Framebuffer
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void Framebuffer::_delete() {
+    if (_id != 0)
+        GL_CALL(glDeleteFramebuffers(1, &_id));
+    _id = 0;
+}
+
+void Framebuffer::_attach(unsigned int attachment, const Texture& texture, int level, int layer) {
+    if (texture.levels() == 0)
+        throw std::logic_error("Texture has no storage, setStorage must be called first!");
+    if (level < 0 || level >= texture.levels())
+        throw std::invalid_argument("level is out of range!");
+
+    FramebufferScope scope(_id);
+    if (layer < 0 || texture.getType() == TextureType::Texture2D)
+        GL_CALL(glFramebufferTexture(GL_FRAMEBUFFER, attachment, texture.id(), level));
+    else
+        GL_CALL(glFramebufferTextureLayer(GL_FRAMEBUFFER, attachment, texture.id(), level, layer));
+    _width = std::max(texture.width() >> level, 1);
+    _height = std::max(texture.height() >> level, 1);
+}
+
+void Framebuffer::_updateDrawBuffers() {
+    std::vector<GLenum> buffers(_colors.size(), GL_NONE);
+    for (size_t i = 0; i < _colors.size(); i++)
+        if (_colors[i])
+            buffers[i] = GL_COLOR_ATTACHMENT0 + (GLenum)i;
+    FramebufferScope scope(_id);
+    if (buffers.empty()) {
+        GL_CALL(glDrawBuffer(GL_NONE));
+        GL_CALL(glReadBuffer(GL_NONE));
+    }
+    else {
+        GL_CALL(glDrawBuffers((GLsizei)buffers.size(), buffers.data()));
+        GL_CALL(glReadBuffer(GL_COLOR_ATTACHMENT0));
+    }
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+Framebuffer::Framebuffer() {
+    GL_CALL(glGenFramebuffers(1, &_id));
+    if (_id == 0)
+        throw std::runtime_error("Failed to create framebuffer object!");
+    _updateDrawBuffers();
+}
+
+Framebuffer::Framebuffer(Framebuffer&& other)
+    : _id(other._id), _width(other._width), _height(other._height), _colors(std::move(other._colors)), _depthStencil(other._depthStencil) {
+    other._id = 0;
+}
+
+Framebuffer::~Framebuffer() noexcept {
+    _delete();
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void Framebuffer::attachColor(unsigned int index, const Texture& texture, int level, int layer) {
+    _attach(GL_COLOR_ATTACHMENT0 + index, texture, level, layer);
+    if (_colors.size() <= index)
+        _colors.resize(index + 1, false);
+    _colors[index] = true;
+    _updateDrawBuffers();
+}
+
+void Framebuffer::attachDepth(const Texture& texture, int level, int layer) {
+    switch (texture.getFormat())
+    {
+    case TextureFormat::Depth16:
+    case TextureFormat::Depth24:
+    case TextureFormat::Depth32F:
+        _attach(GL_DEPTH_ATTACHMENT, texture, level, layer);
+        _depthStencil = false;
+        break;
+    case TextureFormat::Depth24Stencil8:
+        _attach(GL_DEPTH_STENCIL_ATTACHMENT, texture, level, layer);
+        _depthStencil = true;
+        break;
+    default:
+        throw std::invalid_argument("Depth attachment needs a Texture with a depth format!");
+    }
+}
+
+void Framebuffer::check() const {
+    FramebufferScope scope(_id);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+        throw std::runtime_error("Framebuffer is incomplete (status " + std::to_string(status) + ")!");
+}
+
+void Framebuffer::bind() const {
+    GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, _id));
+    GL_CALL(glViewport(0, 0, _width, _height));
+}
+
+void Framebuffer::bindDefault() {
+    GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::clearColor(unsigned int index, const glm::vec4& color) const {
+    FramebufferScope scope(_id);
+    GL_CALL(glClearBufferfv(GL_COLOR, index, &color.x));
+}
+
+void Framebuffer::clearColor(unsigned int index, const glm::uvec4& color) const {
+    FramebufferScope scope(_id);
+    GL_CALL(glClearBufferuiv(GL_COLOR, index, &color.x));
+}
+
+void Framebuffer::clearDepth(float depth) const {
+    FramebufferScope scope(_id);
+    GL_CALL(glClearBufferfv(GL_DEPTH, 0, &depth));
+}
+
+void Framebuffer::invalidate(std::span<const unsigned int> colors, bool depth) const {
+    std::vector<GLenum> attachments;
+    for (unsigned int index : colors)
+        attachments.push_back(GL_COLOR_ATTACHMENT0 + index);
+    if (depth)
+        attachments.push_back(_depthStencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT);
+    if (attachments.empty())
+        return;
+    FramebufferScope scope(_id);
+    GL_CALL(glInvalidateFramebuffer(GL_FRAMEBUFFER, (GLsizei)attachments.size(), attachments.data()));
+}
+
+// --------------------------------------------------
+// operator overloads
+// --------------------------------------------------
+
+Framebuffer& Framebuffer::operator=(Framebuffer&& other) {
+    if (this != &other) {
+        _delete();
+        _id = other._id;
+        _width = other._width;
+        _height = other._height;
+        _colors = std::move(other._colors);
+        _depthStencil = other._depthStencil;
+        other._id = 0;
+    }
+    return *this;
+}
+
+}
@@ -0,0 +1,310 @@
+#include <GLA/gBuffer.h>
+
+#include <GLA/shader.h>
+#include <GLA/debug.h>
+
+#include <algorithm>
+#include <string>
+#include <glm/glm.hpp>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    constexpr int kTileSize = 16;
+    constexpr unsigned int kGBufferColors[] = { 0, 1, 2 };
+
+    const char* kOctahedral = R"(
+vec2 gbufferEncodeNormal(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 folded = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return (n.z >= 0.0 ? n.xy : folded) * 0.5 + 0.5;
+}
+
+vec3 gbufferDecodeNormal(vec2 encoded) {
+    encoded = encoded * 2.0 - 1.0;
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -fold : fold, n.y >= 0.0 ? -fold : fold);
+    return normalize(n);
+}
+)";
+
+    const char* kGBufferOutputs = R"(
+layout(location = 0) out vec4 gbufferAlbedo;
+layout(location = 1) out vec2 gbufferNormal;
+layout(location = 2) out vec4 gbufferMaterial;
+
+void writeGBuffer(vec3 albedo, float occlusion, vec3 normal, float roughness, float metallic, uint materialId) {
+    gbufferAlbedo = vec4(albedo, occlusion);
+    gbufferNormal = gbufferEncodeNormal(normalize(normal));
+    gbufferMaterial = vec4(roughness, metallic, float(materialId & 0xFFu) / 255.0, float((materialId >> 8u) & 0xFFu) / 255.0);
+}
+)";
+
+    const char* kLightShader = R"(
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(binding = 0) uniform sampler2D uAlbedo;
+layout(binding = 1) uniform sampler2D uNormal;
+layout(binding = 2) uniform sampler2D uMaterial;
+layout(binding = 3) uniform sampler2D uDepth;
+layout(rgba16f, binding = 0) uniform writeonly image2D uOutput;
+
+layout(std430, binding = 0) readonly buffer Lights {
+    vec4 lights[];  // position and radius, color and intensity
+};
+
+uniform mat4 uView;
+uniform mat4 uInverseView;
+uniform mat4 uInverseProjection;
+uniform uint uLightCount;
+uniform vec3 uAmbient;
+
+shared uint sNearest;
+shared uint sFarthest;
+shared uint sLightCount;
+shared uint sLights[MAX_TILE_LIGHTS];
+
+vec3 viewPosition(vec2 pixel, float depth, vec2 size) {
+    vec4 view = uInverseProjection * vec4(pixel / size * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    return view.xyz / view.w;
+}
+
+vec3 shade(vec3 position, vec3 normal, vec3 albedo, float roughness, float metallic) {
+    vec3 toCamera = normalize(uInverseView[3].xyz - position);
+    vec3 diffuse = albedo * (1.0 - metallic);
+    vec3 f0 = mix(vec3(0.04), albedo, metallic);
+    float alpha = max(roughness * roughness, 0.002);
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < min(sLightCount, uint(MAX_TILE_LIGHTS)); i++) {
+        vec4 positionRadius = lights[sLights[i] * 2u];
+        vec4 colorIntensity = lights[sLights[i] * 2u + 1u];
+        vec3 toLight = positionRadius.xyz - position;
+        float distance = length(toLight);
+        vec3 l = toLight / max(distance, 1.0e-4);
+        float nDotL = dot(normal, l);
+        if (nDotL <= 0.0 || distance >= positionRadius.w)
+            continue;
+        float window = clamp(1.0 - pow(distance / positionRadius.w, 4.0), 0.0, 1.0);
+        float attenuation = colorIntensity.w * window * window / (distance * distance + 1.0);
+
+        // GGX distribution, Schlick fresnel and an approximated Smith visibility
+        vec3 h = normalize(l + toCamera);
+        float nDotH = max(dot(normal, h), 0.0);
+        float nDotV = max(dot(normal, toCamera), 1.0e-4);
+        float d = alpha * alpha / (3.14159265 * pow(nDotH * nDotH * (alpha * alpha - 1.0) + 1.0, 2.0));
+        vec3 f = f0 + (1.0 - f0) * pow(1.0 - max(dot(h, toCamera), 0.0), 5.0);
+        float v = 0.5 / mix(2.0 * nDotL * nDotV, nDotL + nDotV, alpha);
+        result += (diffuse / 3.14159265 + d * f * v) * colorIntensity.rgb * (attenuation * nDotL);
+    }
+    return result;
+}
+
+void main() {
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    vec2 size = vec2(textureSize(uDepth, 0));
+    bool inside = all(lessThan(pixel, ivec2(size)));
+    float depth = inside ? texelFetch(uDepth, pixel, 0).r : 1.0;
+    bool geometry = depth < 1.0;
+    vec3 position = viewPosition(vec2(pixel) + 0.5, depth, size);
+
+    if (gl_LocalInvocationIndex == 0u) {
+        sNearest = 0xFFFFFFFFu;
+        sFarthest = 0u;
+        sLightCount = 0u;
+    }
+    barrier();
+    // positive floats keep their order as uints
+    if (geometry) {
+        atomicMin(sNearest, floatBitsToUint(-position.z));
+        atomicMax(sFarthest, floatBitsToUint(-position.z));
+    }
+    barrier();
+
+    if (sNearest <= sFarthest) {
+        // the box around the tile corner rays between the nearest and farthest pixel
+        float nearest = uintBitsToFloat(sNearest), farthest = uintBitsToFloat(sFarthest);
+        vec2 low = vec2(gl_WorkGroupID.xy * gl_WorkGroupSize.xy);
+        vec2 high = min(low + vec2(gl_WorkGroupSize.xy), size);
+        vec3 boxMin = vec3(3.0e38), boxMax = vec3(-3.0e38);
+        for (int i = 0; i < 4; i++) {
+            vec3 ray = viewPosition(mix(low, high, vec2(i & 1, i >> 1)), 0.0, size);
+            vec3 a = ray * (nearest / -ray.z);
+            vec3 b = ray * (farthest / -ray.z);
+            boxMin = min(boxMin, min(a, b));
+            boxMax = max(boxMax, max(a, b));
+        }
+        for (uint i = gl_LocalInvocationIndex; i < uLightCount; i += gl_WorkGroupSize.x * gl_WorkGroupSize.y) {
+            vec4 light = lights[i * 2u];
+            vec3 center = (uView * vec4(light.xyz, 1.0)).xyz;
+            vec3 offset = clamp(center, boxMin, boxMax) - center;
+            if (dot(offset, offset) <= light.w * light.w) {
+                uint slot = atomicAdd(sLightCount, 1u);
+                if (slot < uint(MAX_TILE_LIGHTS))
+                    sLights[slot] = i;
+            }
+        }
+    }
+    barrier();
+
+    if (!inside)
+        return;
+    if (!geometry) {
+        imageStore(uOutput, pixel, vec4(0.0));
+        return;
+    }
+    vec4 albedo = texelFetch(uAlbedo, pixel, 0);
+    vec3 normal = gbufferDecodeNormal(texelFetch(uNormal, pixel, 0).rg);
+    vec2 material = texelFetch(uMaterial, pixel, 0).rg;
+    vec3 world = (uInverseView * vec4(position, 1.0)).xyz;
+    vec3 color = uAmbient * albedo.rgb * albedo.a + shade(world, normal, albedo.rgb, material.r, material.g);
+    imageStore(uOutput, pixel, vec4(color, 1.0));
+}
+)";
+
+    const std::string kGeometrySource = std::string(kOctahedral) + kGBufferOutputs;
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class GBuffer
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void GBuffer::_allocate(int width, int height) {
+    if (width <= 0 || height <= 0)
+        throw std::invalid_argument("GBuffer width and height must be greater than 0!");
+
+    auto create = [&](Texture& texture, TextureFormat format) {
+        texture = Texture(TextureType::Texture2D);
+        texture.setStorage(1, format, width, height);
+        texture.setFilter(TextureFilter::Nearest, TextureFilter::Nearest);
+    };
+    create(_albedo, TextureFormat::SRGB8Alpha8);
+    create(_normal, TextureFormat::RG16);
+    create(_material, TextureFormat::RGBA8);
+    create(_depth, TextureFormat::Depth24Stencil8);
+    create(_output, TextureFormat::RGBA16F);
+
+    _framebuffer = Framebuffer();
+    _framebuffer.attachColor(0, _albedo);
+    _framebuffer.attachColor(1, _normal);
+    _framebuffer.attachColor(2, _material);
+    _framebuffer.attachDepth(_depth);
+    _framebuffer.check();
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+GBuffer::GBuffer(int width, int height, const GBufferSettings& settings)
+    : _settings(settings), _albedo(TextureType::Texture2D), _normal(TextureType::Texture2D), _material(TextureType::Texture2D),
+      _depth(TextureType::Texture2D), _output(TextureType::Texture2D),
+      _lights(BufferType::ShaderStorage, (int64_t)std::max(settings.maxLights, 1) * sizeof(PointLight) + 512) {
+    if (settings.maxLights <= 0 || settings.maxLightsPerTile <= 0)
+        throw std::invalid_argument("maxLights and maxLightsPerTile must be greater than 0!");
+    _allocate(width, height);
+
+    std::string source = "#version 430 core\n#define MAX_TILE_LIGHTS " + std::to_string(settings.maxLightsPerTile) + "\n" + kOctahedral + kLightShader;
+    Shader compute(ShaderType::Compute, source);
+    _lightProgram.attach(compute);
+    _lightProgram.link();
+
+    GLint alignment = 256;
+    GL_CALL(glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    _storageAlignment = std::max(alignment, 1);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void GBuffer::resize(int width, int height) {
+    if (_drawing)
+        throw std::logic_error("GBuffer can't be resized between begin() and end()!");
+    _allocate(width, height);
+}
+
+void GBuffer::begin() {
+    if (_drawing)
+        throw std::logic_error("GBuffer::begin() was already called!");
+    _drawing = true;
+    GL_CALL(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_previousFramebuffer));
+    GL_CALL(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &_previousReadFramebuffer));
+    GL_CALL(glGetIntegerv(GL_VIEWPORT, _previousViewport));
+    GLboolean depthMask = GL_TRUE;
+    GL_CALL(glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask));
+    _previousDepthMask = depthMask == GL_TRUE;
+    GL_CALL(glGetIntegerv(GL_STENCIL_WRITEMASK, &_previousStencilMask));
+    _previousSrgb = glIsEnabled(GL_FRAMEBUFFER_SRGB);
+    _framebuffer.bind();
+    _framebuffer.invalidate(kGBufferColors);
+    // the albedo is written linear and decoded again by texelFetch() in the light pass
+    GL_CALL(glEnable(GL_FRAMEBUFFER_SRGB));
+    GL_CALL(glDepthMask(GL_TRUE));
+    GL_CALL(glStencilMask(0xFF));
+    GL_CALL(glClearDepth(1.0));
+    GL_CALL(glClearStencil(0));
+    GL_CALL(glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
+}
+
+void GBuffer::end() {
+    if (!_drawing)
+        throw std::logic_error("GBuffer::begin() was not called!");
+    _drawing = false;
+    GL_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _previousFramebuffer));
+    GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, _previousReadFramebuffer));
+    GL_CALL(glViewport(_previousViewport[0], _previousViewport[1], _previousViewport[2], _previousViewport[3]));
+    GL_CALL(glDepthMask(_previousDepthMask ? GL_TRUE : GL_FALSE));
+    GL_CALL(glStencilMask((GLuint)_previousStencilMask));
+    if (!_previousSrgb)
+        GL_CALL(glDisable(GL_FRAMEBUFFER_SRGB));
+}
+
+void GBuffer::light(std::span<const PointLight> lights, const glm::mat4& view, const glm::mat4& projection) {
+    if (_drawing)
+        throw std::logic_error("GBuffer::light() can't be called between begin() and end()!");
+    if (lights.size() > (size_t)_settings.maxLights)
+        throw std::invalid_argument("More than maxLights lights were passed to GBuffer::light()!");
+
+    // the previous frame ends here, so its Fence also covers everything that read its lights
+    if (_frameOpen)
+        _lights.endFrame();
+    _lights.beginFrame();
+    _frameOpen = true;
+    RingAllocation allocation = _lights.allocate((int64_t)std::max(lights.size(), (size_t)1) * sizeof(PointLight), _storageAlignment);
+    if (!lights.empty())
+        std::copy(lights.begin(), lights.end(), (PointLight*)allocation.data);
+
+    _lightProgram.bind();
+    _lightProgram["uView"] = view;
+    _lightProgram["uInverseView"] = glm::inverse(view);
+    _lightProgram["uInverseProjection"] = glm::inverse(projection);
+    _lightProgram["uLightCount"] = (unsigned int)lights.size();
+    _lightProgram["uAmbient"] = _settings.ambient;
+    _albedo.bind(0);
+    _normal.bind(1);
+    _material.bind(2);
+    _depth.bind(3);
+    _output.bindImage(0, 0, ImageAccess::Write);
+    _lights.buffer().bindRange(0, allocation.offset, allocation.size);
+    GL_CALL(glDispatchCompute((_output.width() + kTileSize - 1) / kTileSize, (_output.height() + kTileSize - 1) / kTileSize, 1));
+    GL_CALL(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT));
+
+    // the G-buffer was read for the last time this frame
+    _framebuffer.invalidate(kGBufferColors, !_settings.keepDepth);
+}
+
+const char* GBuffer::glslSource() {
+    return kGeometrySource.c_str();
+}
+
+}
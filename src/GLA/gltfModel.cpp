@@ -0,0 +1,668 @@
+#include <GLA/gltfModel.h>
+
+#include <GLA/mappedFile.h>
+#include <GLA/debug.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    constexpr uint32_t kGlbMagic = 0x46546C67;      // "glTF"
+    constexpr uint32_t kGlbChunkJson = 0x4E4F534A;  // "JSON"
+    constexpr uint32_t kGlbChunkBin = 0x004E4942;   // "BIN\0"
+    constexpr int64_t kStreamAlignment = 16;
+
+    // --------------------------------------------------
+    // streaming JSON reader
+    // --------------------------------------------------
+
+    // Pull parser over the JSON chunk, values are consumed in document order and everything not asked for is skipped.
+    class JsonReader {
+    private:
+        const char* _p;
+        const char* _end;
+
+        [[noreturn]] void _error(const std::string& message) const {
+            throw GltfError("Invalid JSON: " + message + "!");
+        }
+
+        void _skipWhitespace() {
+            while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\n' || *_p == '\r'))
+                _p++;
+        }
+
+        void _expect(char c) {
+            _skipWhitespace();
+            if (_p >= _end || *_p != c)
+                _error(std::string("expected '") + c + "'");
+            _p++;
+        }
+
+        bool _next(char close) {
+            _skipWhitespace();
+            if (_p >= _end)
+                _error("unexpected end");
+            if (*_p == close) {
+                _p++;
+                return false;
+            }
+            if (*_p == ',')
+                _p++;
+            return true;
+        }
+
+    public:
+        JsonReader(std::string_view text) : _p(text.data()), _end(text.data() + text.size()) {}
+
+        char peek() {
+            _skipWhitespace();
+            return _p < _end ? *_p : '\0';
+        }
+
+        void beginObject() { _expect('{'); }
+        void beginArray() { _expect('['); }
+
+        // advances to the next key of the current object, false at its end
+        bool nextKey(std::string_view& key) {
+            if (!_next('}'))
+                return false;
+            key = string();
+            _expect(':');
+            return true;
+        }
+
+        // advances to the next element of the current array, false at its end
+        bool nextElement() {
+            return _next(']');
+        }
+
+        // raw string contents, escape sequences are kept
+        std::string_view string() {
+            _expect('"');
+            const char* begin = _p;
+            while (_p < _end && *_p != '"')
+                _p += *_p == '\\' ? 2 : 1;
+            if (_p >= _end)
+                _error("unterminated string");
+            return { begin, (size_t)(_p++ - begin) };
+        }
+
+        template <typename T>
+        T number() {
+            _skipWhitespace();
+            T value = 0;
+            auto [next, error] = std::from_chars(_p, _end, value);
+            if (next == _p || error != std::errc())
+                _error("expected a number");
+            _p = next;
+            return value;
+        }
+
+        bool boolean() {
+            _skipWhitespace();
+            if (_end - _p >= 4 && std::memcmp(_p, "true", 4) == 0) {
+                _p += 4;
+                return true;
+            }
+            if (_end - _p >= 5 && std::memcmp(_p, "false", 5) == 0) {
+                _p += 5;
+                return false;
+            }
+            _error("expected a boolean");
+        }
+
+        void skip() {
+            std::string_view key;
+            switch (peek()) {
+            case '{':
+                beginObject();
+                while (nextKey(key))
+                    skip();
+                break;
+            case '[':
+                beginArray();
+                while (nextElement())
+                    skip();
+                break;
+            case '"':
+                string();
+                break;
+            default: {
+                const char* begin = _p;
+                while (_p < _end && *_p != ',' && *_p != '}' && *_p != ']' && *_p != ' ' && *_p != '\t' && *_p != '\n' && *_p != '\r')
+                    _p++;
+                if (_p == begin)
+                    _error("expected a value");
+            }
+            }
+        }
+    };
+
+    template <typename Func>
+    void forEachKey(JsonReader& reader, Func func) {
+        std::string_view key;
+        reader.beginObject();
+        while (reader.nextKey(key))
+            func(key);
+    }
+
+    template <typename Func>
+    void forEachElement(JsonReader& reader, Func func) {
+        reader.beginArray();
+        while (reader.nextElement())
+            func();
+    }
+
+    // reads up to count numbers of an array, returns how many there were
+    int readNumbers(JsonReader& reader, float* values, int count) {
+        int read = 0;
+        forEachElement(reader, [&]() {
+            float value = (float)reader.number<double>();
+            if (read < count)
+                values[read] = value;
+            read++;
+        });
+        return read;
+    }
+
+    std::string unescape(std::string_view text) {
+        std::string result;
+        result.reserve(text.size());
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] != '\\' || i + 1 == text.size()) {
+                result += text[i];
+                continue;
+            }
+            switch (text[++i]) {
+            case 'n': result += '\n'; break;
+            case 't': result += '\t'; break;
+            case 'r': result += '\r'; break;
+            case 'b': result += '\b'; break;
+            case 'f': result += '\f'; break;
+            case 'u': result += "\\u"; break;
+            default:  result += text[i]; break;
+            }
+        }
+        return result;
+    }
+
+    // --------------------------------------------------
+    // glTF document
+    // --------------------------------------------------
+
+    struct BufferInfo {
+        uint64_t byteLength = 0;
+        bool external = false;
+    };
+
+    struct BufferViewInfo {
+        int buffer = 0;
+        uint64_t byteOffset = 0;
+        uint64_t byteLength = 0;
+        int byteStride = 0;
+    };
+
+    struct AccessorInfo {
+        int bufferView = -1;
+        uint64_t byteOffset = 0;
+        int componentType = 0;
+        bool normalized = false;
+        uint64_t count = 0;
+        int components = 0; // 0 for matrix types
+        bool sparse = false;
+        float min[4] = {};
+        float max[4] = {};
+        int minCount = 0;
+        int maxCount = 0;
+    };
+
+    struct PrimitiveInfo {
+        std::vector<std::pair<std::string_view, int>> attributes;
+        int indices = -1;
+        int mode = 4;
+        int material = -1;
+    };
+
+    struct MeshInfo {
+        std::string_view name;
+        std::vector<PrimitiveInfo> primitives;
+    };
+
+    struct Document {
+        std::vector<BufferInfo> buffers;
+        std::vector<BufferViewInfo> bufferViews;
+        std::vector<AccessorInfo> accessors;
+        std::vector<MeshInfo> meshes;
+        std::vector<GltfNode> nodes;
+        std::vector<std::vector<int>> scenes;
+        int scene = 0;
+    };
+
+    int accessorComponents(std::string_view type) {
+        if (type == "SCALAR")   return 1;
+        if (type == "VEC2")     return 2;
+        if (type == "VEC3")     return 3;
+        if (type == "VEC4")     return 4;
+        return 0;
+    }
+
+    GltfNode parseNode(JsonReader& reader) {
+        GltfNode node;
+        glm::vec3 translation(0.0f), scale(1.0f);
+        glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+        bool hasMatrix = false;
+        forEachKey(reader, [&](std::string_view key) {
+            if (key == "name") {
+                node.name = unescape(reader.string());
+            }
+            else if (key == "mesh") {
+                node.mesh = reader.number<int>();
+            }
+            else if (key == "children") {
+                forEachElement(reader, [&]() { node.children.push_back(reader.number<int>()); });
+            }
+            else if (key == "matrix") {
+                if (readNumbers(reader, glm::value_ptr(node.local), 16) != 16)
+                    throw GltfError("Node matrix must have 16 elements!");
+                hasMatrix = true;
+            }
+            else if (key == "translation") {
+                readNumbers(reader, glm::value_ptr(translation), 3);
+            }
+            else if (key == "rotation") {
+                float xyzw[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+                readNumbers(reader, xyzw, 4);
+                rotation = glm::quat(xyzw[3], xyzw[0], xyzw[1], xyzw[2]);
+            }
+            else if (key == "scale") {
+                readNumbers(reader, glm::value_ptr(scale), 3);
+            }
+            else {
+                reader.skip();
+            }
+        });
+        if (!hasMatrix)
+            node.local = glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+        return node;
+    }
+
+    PrimitiveInfo parsePrimitive(JsonReader& reader) {
+        PrimitiveInfo primitive;
+        forEachKey(reader, [&](std::string_view key) {
+            if (key == "attributes") {
+                forEachKey(reader, [&](std::string_view semantic) {
+                    primitive.attributes.emplace_back(semantic, reader.number<int>());
+                });
+            }
+            else if (key == "indices")  primitive.indices = reader.number<int>();
+            else if (key == "mode")     primitive.mode = reader.number<int>();
+            else if (key == "material") primitive.material = reader.number<int>();
+            else reader.skip();
+        });
+        return primitive;
+    }
+
+    Document parseDocument(std::string_view json) {
+        Document document;
+        JsonReader reader(json);
+        forEachKey(reader, [&](std::string_view key) {
+            if (key == "buffers") {
+                forEachElement(reader, [&]() {
+                    BufferInfo& buffer = document.buffers.emplace_back();
+                    forEachKey(reader, [&](std::string_view key) {
+                        if (key == "byteLength")    buffer.byteLength = reader.number<uint64_t>();
+                        else if (key == "uri")      { buffer.external = true; reader.skip(); }
+                        else reader.skip();
+                    });
+                });
+            }
+            else if (key == "bufferViews") {
+                forEachElement(reader, [&]() {
+                    BufferViewInfo& view = document.bufferViews.emplace_back();
+                    forEachKey(reader, [&](std::string_view key) {
+                        if (key == "buffer")            view.buffer = reader.number<int>();
+                        else if (key == "byteOffset")   view.byteOffset = reader.number<uint64_t>();
+                        else if (key == "byteLength")   view.byteLength = reader.number<uint64_t>();
+                        else if (key == "byteStride")   view.byteStride = reader.number<int>();
+                        else reader.skip();
+                    });
+                });
+            }
+            else if (key == "accessors") {
+                forEachElement(reader, [&]() {
+                    AccessorInfo& accessor = document.accessors.emplace_back();
+                    forEachKey(reader, [&](std::string_view key) {
+                        if (key == "bufferView")            accessor.bufferView = reader.number<int>();
+                        else if (key == "byteOffset")       accessor.byteOffset = reader.number<uint64_t>();
+                        else if (key == "componentType")    accessor.componentType = reader.number<int>();
+                        else if (key == "normalized")       accessor.normalized = reader.boolean();
+                        else if (key == "count")            accessor.count = reader.number<uint64_t>();
+                        else if (key == "type")             accessor.components = accessorComponents(reader.string());
+                        else if (key == "min")              accessor.minCount = readNumbers(reader, accessor.min, 4);
+                        else if (key == "max")              accessor.maxCount = readNumbers(reader, accessor.max, 4);
+                        else if (key == "sparse")           { accessor.sparse = true; reader.skip(); }
+                        else reader.skip();
+                    });
+                });
+            }
+            else if (key == "meshes") {
+                forEachElement(reader, [&]() {
+                    MeshInfo& mesh = document.meshes.emplace_back();
+                    forEachKey(reader, [&](std::string_view key) {
+                        if (key == "name")
+                            mesh.name = reader.string();
+                        else if (key == "primitives")
+                            forEachElement(reader, [&]() { mesh.primitives.push_back(parsePrimitive(reader)); });
+                        else
+                            reader.skip();
+                    });
+                });
+            }
+            else if (key == "nodes") {
+                forEachElement(reader, [&]() { document.nodes.push_back(parseNode(reader)); });
+            }
+            else if (key == "scenes") {
+                forEachElement(reader, [&]() {
+                    std::vector<int>& scene = document.scenes.emplace_back();
+                    forEachKey(reader, [&](std::string_view key) {
+                        if (key == "nodes")
+                            forEachElement(reader, [&]() { scene.push_back(reader.number<int>()); });
+                        else
+                            reader.skip();
+                    });
+                });
+            }
+            else if (key == "scene") {
+                document.scene = reader.number<int>();
+            }
+            else {
+                reader.skip();
+            }
+        });
+        return document;
+    }
+
+    VertexAttribType componentTypeToAttribType(int componentType) {
+        switch (componentType) {
+        case 5120: return VertexAttribType::Byte;
+        case 5121: return VertexAttribType::UnsignedByte;
+        case 5122: return VertexAttribType::Short;
+        case 5123: return VertexAttribType::UnsignedShort;
+        case 5125: return VertexAttribType::UnsignedInt;
+        case 5126: return VertexAttribType::Float;
+        }
+        throw GltfError("Invalid accessor componentType " + std::to_string(componentType) + "!");
+    }
+
+}
+
+int gltfAttributeLocation(std::string_view semantic) {
+    static const std::pair<std::string_view, int> locations[] = {
+        { "POSITION", 0 }, { "NORMAL", 1 }, { "TEXCOORD_0", 2 }, { "COLOR_0", 3 },
+        { "TANGENT", 4 }, { "TEXCOORD_1", 5 }, { "JOINTS_0", 6 }, { "WEIGHTS_0", 7 }
+    };
+    for (const auto& [name, location] : locations)
+        if (name == semantic)
+            return location;
+    return -1;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class GltfModel
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void GltfModel::_load(std::span<const uint8_t> glb, BufferFlag flags) {
+    // container
+    auto read32 = [&](size_t offset) {
+        uint32_t value;
+        std::memcpy(&value, glb.data() + offset, sizeof(value));
+        return value;
+    };
+    if (glb.size() < 20)
+        throw GltfError("File is smaller than the GLB header!");
+    if (read32(0) != kGlbMagic)
+        throw GltfError("File is not a GLB file!");
+    if (read32(4) != 2)
+        throw GltfError("Unsupported glTF version " + std::to_string(read32(4)) + ", expected 2!");
+    uint64_t length = std::min<uint64_t>(read32(8), glb.size());
+    uint64_t jsonLength = read32(12);
+    if (read32(16) != kGlbChunkJson || 20 + jsonLength > length)
+        throw GltfError("First GLB chunk is not a valid JSON chunk!");
+    std::string_view json((const char*)glb.data() + 20, (size_t)jsonLength);
+    std::span<const uint8_t> bin;
+    uint64_t binChunk = (20 + jsonLength + 3) & ~3ull;
+    if (binChunk + 8 <= length && read32((size_t)binChunk + 4) == kGlbChunkBin) {
+        uint64_t binLength = read32((size_t)binChunk);
+        if (binChunk + 8 + binLength > length)
+            throw GltfError("BIN chunk lies outside of the file!");
+        bin = glb.subspan((size_t)binChunk + 8, (size_t)binLength);
+    }
+
+    Document document = parseDocument(json);
+
+    // validation of everything that is read from the binary chunk
+    auto accessor = [&](int index) -> const AccessorInfo& {
+        if (index < 0 || index >= (int)document.accessors.size())
+            throw GltfError("Accessor " + std::to_string(index) + " does not exist!");
+        const AccessorInfo& info = document.accessors[index];
+        if (info.sparse)
+            throw GltfError("Sparse accessors are not supported!");
+        if (info.bufferView < 0 || info.bufferView >= (int)document.bufferViews.size())
+            throw GltfError("Accessor " + std::to_string(index) + " has no valid bufferView!");
+        if (info.components == 0)
+            throw GltfError("Accessor " + std::to_string(index) + " has a type that can't be used for vertices!");
+        const BufferViewInfo& view = document.bufferViews[info.bufferView];
+        if (view.buffer != 0 || document.buffers.empty() || document.buffers[0].external)
+            throw GltfError("Only the embedded GLB buffer is supported!");
+        if (view.byteOffset > bin.size() || view.byteLength > bin.size() - view.byteOffset)
+            throw GltfError("bufferView " + std::to_string(info.bufferView) + " lies outside of the BIN chunk!");
+        uint64_t elementSize = (uint64_t)typeToBytes(componentTypeToAttribType(info.componentType)) * info.components;
+        uint64_t stride = view.byteStride > 0 ? view.byteStride : elementSize;
+        if (info.count > 0 && info.byteOffset + stride * (info.count - 1) + elementSize > view.byteLength)
+            throw GltfError("Accessor " + std::to_string(index) + " lies outside of its bufferView!");
+        return info;
+    };
+
+    // every bufferView used by a primitive is packed once into the shared Buffer
+    std::vector<int64_t> viewOffsets(document.bufferViews.size(), -1);
+    int64_t size = 0;
+    auto useView = [&](int view) {
+        if (viewOffsets[view] < 0) {
+            viewOffsets[view] = size;
+            size = (size + (int64_t)document.bufferViews[view].byteLength + kStreamAlignment - 1) & ~(kStreamAlignment - 1);
+        }
+    };
+    for (const MeshInfo& mesh : document.meshes) {
+        for (const PrimitiveInfo& primitive : mesh.primitives) {
+            for (const auto& [semantic, index] : primitive.attributes)
+                if (gltfAttributeLocation(semantic) >= 0)
+                    useView(accessor(index).bufferView);
+            if (primitive.indices >= 0)
+                useView(accessor(primitive.indices).bufferView);
+        }
+    }
+    if (size > 0) {
+        _buffer.setStorage(size, nullptr, flags | BufferFlag::DynamicStorage);
+        for (size_t i = 0; i < viewOffsets.size(); i++)
+            if (viewOffsets[i] >= 0)
+                _buffer.setSubData(viewOffsets[i], (int64_t)document.bufferViews[i].byteLength, bin.data() + document.bufferViews[i].byteOffset);
+    }
+
+    // accessors become attributes pointing into the shared Buffer
+    _meshes.reserve(document.meshes.size());
+    for (const MeshInfo& meshInfo : document.meshes) {
+        GltfMesh& mesh = _meshes.emplace_back();
+        mesh.name = unescape(meshInfo.name);
+        for (const PrimitiveInfo& info : meshInfo.primitives) {
+            GltfPrimitive& primitive = mesh.primitives.emplace_back();
+            if (info.mode < 0 || info.mode > 6)
+                throw GltfError("Invalid primitive mode " + std::to_string(info.mode) + "!");
+            primitive.mode = (unsigned int)info.mode;
+            primitive.material = info.material;
+
+            std::vector<int> streamViews;
+            bool hasPosition = false;
+            for (const auto& [semantic, index] : info.attributes) {
+                int location = gltfAttributeLocation(semantic);
+                if (location < 0)
+                    continue;
+                const AccessorInfo& attribute = accessor(index);
+                const BufferViewInfo& view = document.bufferViews[attribute.bufferView];
+                VertexAttribType type = componentTypeToAttribType(attribute.componentType);
+                int elementSize = typeToBytes(type) * attribute.components;
+                bool integer = type != VertexAttribType::Float && !attribute.normalized && semantic.starts_with("JOINTS_");
+                VertexAttribute vertexAttribute = {
+                    (unsigned int)location, attribute.components, type,
+                    integer ? VertexAttribInterp::Integer : VertexAttribInterp::Float,
+                    attribute.normalized, 0
+                };
+
+                if (semantic == "POSITION") {
+                    hasPosition = true;
+                    primitive.vertexCount = (uint32_t)attribute.count;
+                    if (attribute.minCount >= 3 && attribute.maxCount >= 3) {
+                        primitive.boundsMin = glm::make_vec3(attribute.min);
+                        primitive.boundsMax = glm::make_vec3(attribute.max);
+                    }
+                }
+
+                // attributes of an interleaved bufferView share one stream
+                int64_t viewOffset = viewOffsets[attribute.bufferView];
+                if (view.byteStride > 0 && attribute.byteOffset + elementSize <= (uint64_t)view.byteStride) {
+                    auto it = std::find(streamViews.begin(), streamViews.end(), attribute.bufferView);
+                    if (it != streamViews.end()) {
+                        vertexAttribute.offset = (int)attribute.byteOffset;
+                        primitive.streams[it - streamViews.begin()].attributes.push_back(vertexAttribute);
+                        continue;
+                    }
+                    vertexAttribute.offset = (int)attribute.byteOffset;
+                    primitive.streams.push_back({ viewOffset, view.byteStride, { vertexAttribute } });
+                    streamViews.push_back(attribute.bufferView);
+                }
+                else {
+                    primitive.streams.push_back({ viewOffset + (int64_t)attribute.byteOffset, view.byteStride > 0 ? view.byteStride : elementSize, { vertexAttribute } });
+                    streamViews.push_back(-1);
+                }
+            }
+            if (!hasPosition)
+                throw GltfError("Primitive of mesh " + mesh.name + " has no POSITION attribute!");
+            for (const auto& [semantic, index] : info.attributes)
+                if (gltfAttributeLocation(semantic) >= 0 && document.accessors[index].count != primitive.vertexCount)
+                    throw GltfError("Attributes of a primitive of mesh " + mesh.name + " have different counts!");
+
+            if (info.indices >= 0) {
+                const AccessorInfo& indices = accessor(info.indices);
+                if (indices.components != 1)
+                    throw GltfError("Index accessor " + std::to_string(info.indices) + " is not SCALAR!");
+                switch (indices.componentType) {
+                case 5121: primitive.indexType = IndexType::UnsignedByte; break;
+                case 5123: primitive.indexType = IndexType::UnsignedShort; break;
+                case 5125: primitive.indexType = IndexType::UnsignedInt; break;
+                default: throw GltfError("Index accessor " + std::to_string(info.indices) + " has an invalid componentType!");
+                }
+                primitive.indexCount = (uint32_t)indices.count;
+                primitive.indexOffset = viewOffsets[indices.bufferView] + (int64_t)indices.byteOffset;
+                if (primitive.indexOffset % typeToBytes(primitive.indexType) != 0)
+                    throw GltfError("Index accessor " + std::to_string(info.indices) + " is not aligned!");
+            }
+        }
+    }
+
+    // node hierarchy
+    _nodes = std::move(document.nodes);
+    for (size_t i = 0; i < _nodes.size(); i++) {
+        if (_nodes[i].mesh >= (int)_meshes.size())
+            throw GltfError("Node " + std::to_string(i) + " references a mesh that does not exist!");
+        for (int child : _nodes[i].children) {
+            if (child < 0 || child >= (int)_nodes.size() || _nodes[child].parent >= 0 || child == (int)i)
+                throw GltfError("Node " + std::to_string(i) + " has an invalid child!");
+            _nodes[child].parent = (int)i;
+        }
+    }
+    std::vector<int> stack;
+    for (size_t i = 0; i < _nodes.size(); i++)
+        if (_nodes[i].parent < 0)
+            stack.push_back((int)i);
+    std::vector<int> roots = stack;
+    size_t resolved = 0;
+    while (!stack.empty()) {
+        GltfNode& node = _nodes[stack.back()];
+        stack.pop_back();
+        node.world = node.parent >= 0 ? _nodes[node.parent].world * node.local : node.local;
+        stack.insert(stack.end(), node.children.begin(), node.children.end());
+        resolved++;
+    }
+    if (resolved != _nodes.size())
+        throw GltfError("Node hierarchy contains a cycle!");
+
+    if (document.scenes.empty()) {
+        _scene = std::move(roots);
+    }
+    else {
+        if (document.scene < 0 || document.scene >= (int)document.scenes.size())
+            throw GltfError("Default scene does not exist!");
+        _scene = std::move(document.scenes[document.scene]);
+        for (int node : _scene)
+            if (node < 0 || node >= (int)_nodes.size())
+                throw GltfError("Scene references a node that does not exist!");
+    }
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+GltfModel::GltfModel(const std::string& path, BufferFlag flags) {
+    MappedFile file(path);
+    _load(file.bytes(), flags);
+}
+
+GltfModel::GltfModel(std::span<const uint8_t> glb, BufferFlag flags) {
+    _load(glb, flags);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void GltfModel::bind(const GltfPrimitive& primitive) {
+    for (size_t i = 0; i < primitive.streams.size(); i++) {
+        const GltfVertexStream& stream = primitive.streams[i];
+        if (i == 0)
+            _buffer.setAttributes(stream.attributes, stream.stride, stream.offset);
+        else
+            _buffer.addAttributes(stream.attributes, stream.stride, stream.offset);
+    }
+    if (primitive.indexCount > 0)
+        _buffer.bind(BufferType::ElementArray);
+}
+
+void GltfModel::draw(const GltfPrimitive& primitive) const {
+    if (primitive.indexCount > 0)
+        GL_CALL(glDrawElements(primitive.mode, (GLsizei)primitive.indexCount, toGLenum(primitive.indexType), (const void*)(uintptr_t)primitive.indexOffset));
+    else
+        GL_CALL(glDrawArrays(primitive.mode, 0, (GLsizei)primitive.vertexCount));
+}
+
+void GltfModel::draw(size_t mesh) {
+    for (const GltfPrimitive& primitive : _meshes.at(mesh).primitives) {
+        bind(primitive);
+        draw(primitive);
+    }
+}
+
+}
@@ -0,0 +1,406 @@
+#include <GLA/hiZPyramid.h>
+
+#include <GLA/shader.h>
+#include <GLA/debug.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <glm/glm.hpp>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    constexpr int kMaxLevels = 16;
+    constexpr int64_t kHeaderSize = sizeof(glm::ivec4) * (1 + kMaxLevels);
+
+    const char* kHiZCommon = R"(
+layout(std430, binding = HIZ_BINDING) coherent buffer HiZPyramid {
+    ivec4 hizInfo;      // depth width, depth height, level count
+    ivec4 hizLevels[16]; // offset, width, height
+    float hizDepth[];
+};
+
+#if HIZ_REVERSED_Z
+float hizFarthest(float a, float b) { return min(a, b); }
+float hizNearest(float a, float b) { return max(a, b); }
+float hizWindowDepth(float ndcZ) { return ndcZ; }
+const float kHiZFar = 0.0;
+#else
+float hizFarthest(float a, float b) { return max(a, b); }
+float hizNearest(float a, float b) { return min(a, b); }
+float hizWindowDepth(float ndcZ) { return ndcZ * 0.5 + 0.5; }
+const float kHiZFar = 1.0;
+#endif
+
+float hizFarthest(float a, float b, float c, float d) {
+    return hizFarthest(hizFarthest(a, b), hizFarthest(c, d));
+}
+
+float hizLoad(int level, ivec2 texel) {
+    ivec4 info = hizLevels[level];
+    texel = clamp(texel, ivec2(0), info.yz - 1);
+    return hizDepth[info.x + texel.y * info.y + texel.x];
+}
+
+// false if the box is certainly hidden behind the depth the pyramid was built from
+bool hizVisible(vec3 minimum, vec3 maximum, mat4 viewProjection) {
+    vec2 low = vec2(3.0e38), high = vec2(-3.0e38);
+    float nearest = kHiZFar;
+    for (int i = 0; i < 8; i++) {
+        vec4 clip = viewProjection * vec4(mix(minimum, maximum, vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1)), 1.0);
+        if (clip.w <= 0.0)
+            return true;
+        vec3 ndc = clip.xyz / clip.w;
+        low = min(low, ndc.xy);
+        high = max(high, ndc.xy);
+        nearest = hizNearest(nearest, hizWindowDepth(ndc.z));
+    }
+    if (any(greaterThan(low, vec2(1.0))) || any(lessThan(high, vec2(-1.0))))
+        return false;
+
+    // the level on which the rectangle covers at most 2x2 texels
+    vec2 size = vec2(hizInfo.xy) * 0.5;
+    vec2 rectMin = clamp(low * 0.5 + 0.5, 0.0, 1.0) * size;
+    vec2 rectMax = clamp(high * 0.5 + 0.5, 0.0, 1.0) * size;
+    float extent = max(rectMax.x - rectMin.x, rectMax.y - rectMin.y);
+    int level = int(ceil(log2(max(extent, 1.0))));
+    if (extent * exp2(-float(level)) > 1.0)
+        level++;
+    level = min(level, hizInfo.z - 1);
+    float scale = exp2(-float(level));
+    ivec2 a = ivec2(rectMin * scale);
+    ivec2 b = ivec2(rectMax * scale);
+    float farthest = hizFarthest(hizLoad(level, a), hizLoad(level, ivec2(b.x, a.y)), hizLoad(level, ivec2(a.x, b.y)), hizLoad(level, b));
+    return hizNearest(nearest, farthest) == nearest;
+}
+)";
+
+    const char* kReduceShader = R"(
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(std430, binding = 1) coherent buffer Counter { uint groupsDone; };
+layout(binding = 0) uniform sampler2D uDepth;
+
+uniform uint uGroupCount;
+
+shared float sTile[16][16];
+shared bool sLast;
+
+float loadDepth(ivec2 texel) {
+    return texelFetch(uDepth, min(texel, hizInfo.xy - 1), 0).r;
+}
+
+void hizStore(int level, ivec2 texel, float depth) {
+    ivec4 info = hizLevels[level];
+    if (level < hizInfo.z && all(lessThan(texel, info.yz)))
+        hizDepth[info.x + texel.y * info.y + texel.x] = depth;
+}
+
+void main() {
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    ivec2 group = ivec2(gl_WorkGroupID.xy);
+
+    // levels 0 and 1: every invocation reduces 4x4 depth texels
+    ivec2 texel1 = group * 16 + local;
+    float depth1 = kHiZFar;
+    for (int i = 0; i < 4; i++) {
+        ivec2 texel0 = texel1 * 2 + ivec2(i & 1, i >> 1);
+        ivec2 d = texel0 * 2;
+        float depth0 = hizFarthest(loadDepth(d), loadDepth(d + ivec2(1, 0)), loadDepth(d + ivec2(0, 1)), loadDepth(d + ivec2(1, 1)));
+        hizStore(0, texel0, depth0);
+        depth1 = i == 0 ? depth0 : hizFarthest(depth1, depth0);
+    }
+    hizStore(1, texel1, depth1);
+    sTile[local.y][local.x] = depth1;
+    barrier();
+
+    // levels 2 to 5 in shared memory, level 5 is a single texel per workgroup
+    for (int level = 2, size = 8; level <= 5; level++, size /= 2) {
+        bool active = all(lessThan(local, ivec2(size)));
+        float depth = kHiZFar;
+        if (active) {
+            ivec2 c = local * 2;
+            depth = hizFarthest(sTile[c.y][c.x], sTile[c.y][c.x + 1], sTile[c.y + 1][c.x], sTile[c.y + 1][c.x + 1]);
+        }
+        barrier();
+        if (active) {
+            sTile[local.y][local.x] = depth;
+            hizStore(level, group * size + local, depth);
+        }
+        barrier();
+    }
+    if (hizInfo.z <= 6)
+        return;
+
+    // the last workgroup to finish reduces the remaining levels
+    if (gl_LocalInvocationIndex == 0u) {
+        memoryBarrierBuffer();
+        sLast = atomicAdd(groupsDone, 1u) == uGroupCount - 1u;
+    }
+    barrier();
+    if (!sLast)
+        return;
+    memoryBarrierBuffer();
+
+    for (int level = 6; level < hizInfo.z; level++) {
+        ivec2 size = hizLevels[level].yz;
+        for (int i = int(gl_LocalInvocationIndex); i < size.x * size.y; i += 256) {
+            ivec2 texel = ivec2(i % size.x, i / size.x);
+            ivec2 c = texel * 2;
+            hizStore(level, texel, hizFarthest(hizLoad(level - 1, c), hizLoad(level - 1, c + ivec2(1, 0)), hizLoad(level - 1, c + ivec2(0, 1)), hizLoad(level - 1, c + ivec2(1, 1))));
+        }
+        memoryBarrierBuffer();
+        barrier();
+    }
+    if (gl_LocalInvocationIndex == 0u)
+        groupsDone = 0u;
+}
+)";
+
+    const char* kCullShader = R"(
+layout(local_size_x = 64) in;
+
+struct HiZBox {
+    vec4 minimum;
+    vec4 maximum;
+};
+
+layout(std430, binding = 1) readonly buffer Boxes { HiZBox boxes[]; };
+layout(std430, binding = 2) buffer Visibility { uint visibility[]; };
+
+uniform mat4 uViewProjection;
+uniform uint uCount;
+uniform int uHiddenOnly;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= uCount)
+        return;
+    if (uHiddenOnly != 0 && visibility[i] != 0u)
+        return;
+    bool visible = hizVisible(boxes[i].minimum.xyz, boxes[i].maximum.xyz, uViewProjection);
+    visibility[i] = visible ? (uHiddenOnly != 0 ? 2u : 1u) : 0u;
+}
+)";
+
+    std::string defines(bool reversedZ, unsigned int binding) {
+        return "#define HIZ_REVERSED_Z " + std::to_string(reversedZ ? 1 : 0) + "\n#define HIZ_BINDING " + std::to_string(binding) + "\n";
+    }
+
+    void buildCompute(Program& program, const std::string& source) {
+        Shader compute(ShaderType::Compute, source);
+        program.attach(compute);
+        program.link();
+    }
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class HiZPyramid
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void HiZPyramid::_allocate(int depthWidth, int depthHeight) {
+    std::vector<Level> levels;
+    int64_t texels = 0;
+    int width = (depthWidth + 1) / 2, height = (depthHeight + 1) / 2;
+    while (true) {
+        levels.push_back({ texels, width, height });
+        texels += (int64_t)width * height;
+        if (width == 1 && height == 1)
+            break;
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+    }
+    if (levels.size() > kMaxLevels)
+        throw std::invalid_argument("Depth Texture is too large for the HiZPyramid!");
+
+    std::vector<uint8_t> initial((size_t)(kHeaderSize + texels * sizeof(float)), 0);
+    glm::ivec4 header[1 + kMaxLevels] = {};
+    header[0] = glm::ivec4(depthWidth, depthHeight, (int)levels.size(), 0);
+    for (size_t i = 0; i < levels.size(); i++)
+        header[i + 1] = glm::ivec4((int)levels[i].offset, levels[i].width, levels[i].height, 0);
+    std::memcpy(initial.data(), header, sizeof(header));
+
+    _pyramid = Buffer(BufferType::ShaderStorage);
+    _pyramid.setStorage((int64_t)initial.size(), initial.data(), BufferFlag::None);
+    _levels = std::move(levels);
+    _depthWidth = depthWidth;
+    _depthHeight = depthHeight;
+
+    // the level read back for testCpu() is copied into a persistently mapped Buffer
+    _readbackFence.reset();
+    _readbackLevel = -1;
+    _readbackData = nullptr;
+    _readback = Buffer(BufferType::CopyWrite);
+    if (_settings.cpuLevelSize > 0) {
+        auto it = std::find_if(_levels.begin(), _levels.end(), [&](const Level& level) {
+            return level.width <= _settings.cpuLevelSize && level.height <= _settings.cpuLevelSize;
+        });
+        int64_t bytes = (int64_t)it->width * it->height * sizeof(float);
+        _readback.setStorage(bytes, nullptr, BufferFlag::MapRead | BufferFlag::MapPersistent | BufferFlag::MapCoherent);
+        _readbackData = (const float*)_readback.map(0, bytes, MapUsage::Read | MapUsage::Persistent | MapUsage::Coherent);
+    }
+}
+
+void HiZPyramid::_collectReadback() {
+    if (_readbackLevel < 0 || !_readbackFence.signaled())
+        return;
+
+    const Level& level = _levels[_readbackLevel];
+    _cpuLevelSizes.assign(1, glm::ivec2(level.width, level.height));
+    _cpuLevels.resize(1);
+    _cpuLevels[0].assign(_readbackData, _readbackData + (size_t)level.width * level.height);
+
+    // the coarser levels are cheap to reduce from the downloaded one
+    auto farthest = [&](float a, float b) { return _settings.reversedZ ? std::min(a, b) : std::max(a, b); };
+    while (_cpuLevelSizes.back() != glm::ivec2(1)) {
+        glm::ivec2 source = _cpuLevelSizes.back();
+        glm::ivec2 size = (source + 1) / 2;
+        const std::vector<float>& above = _cpuLevels.back();
+        std::vector<float> reduced((size_t)size.x * size.y);
+        for (int y = 0; y < size.y; y++) {
+            for (int x = 0; x < size.x; x++) {
+                int x0 = 2 * x, x1 = std::min(2 * x + 1, source.x - 1);
+                int y0 = 2 * y, y1 = std::min(2 * y + 1, source.y - 1);
+                reduced[(size_t)y * size.x + x] = farthest(farthest(above[(size_t)y0 * source.x + x0], above[(size_t)y0 * source.x + x1]),
+                                                           farthest(above[(size_t)y1 * source.x + x0], above[(size_t)y1 * source.x + x1]));
+            }
+        }
+        _cpuLevelSizes.push_back(size);
+        _cpuLevels.push_back(std::move(reduced));
+    }
+
+    _cpuLevel = _readbackLevel;
+    _cpuDepthSize = _readbackDepthSize;
+    _readbackLevel = -1;
+    _readbackFence.reset();
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+HiZPyramid::HiZPyramid(const HiZSettings& settings)
+    : _settings(settings), _pyramid(BufferType::ShaderStorage), _counter(BufferType::ShaderStorage), _readback(BufferType::CopyWrite) {
+    uint32_t zero = 0;
+    _counter.setStorage(sizeof(zero), &zero, BufferFlag::None);
+
+    std::string header = "#version 430 core\n" + defines(settings.reversedZ, 0) + kHiZCommon;
+    buildCompute(_reduceProgram, header + kReduceShader);
+    buildCompute(_cullProgram, header + kCullShader);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void HiZPyramid::build(const Texture& depth) {
+    if (depth.getType() != TextureType::Texture2D || depth.levels() == 0)
+        throw std::invalid_argument("HiZPyramid needs a 2D depth Texture with storage!");
+    _collectReadback();
+    if (depth.width() != _depthWidth || depth.height() != _depthHeight)
+        _allocate(depth.width(), depth.height());
+
+    // one workgroup per 64x64 depth tile, which is one texel of level 5
+    glm::ivec2 groups = (glm::ivec2(_levels[0].width, _levels[0].height) + 31) / 32;
+    _reduceProgram.bind();
+    _reduceProgram["uGroupCount"] = (unsigned int)(groups.x * groups.y);
+    depth.bind(0);
+    _pyramid.bindBase(0);
+    _counter.bindBase(1);
+    GL_CALL(glDispatchCompute(groups.x, groups.y, 1));
+    GL_CALL(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT));
+
+    if (_readbackData != nullptr && _readbackLevel < 0) {
+        int level = (int)(std::find_if(_levels.begin(), _levels.end(), [&](const Level& level) {
+            return level.width <= _settings.cpuLevelSize && level.height <= _settings.cpuLevelSize;
+        }) - _levels.begin());
+        _pyramid.bind(BufferType::CopyRead);
+        _readback.bind(BufferType::CopyWrite);
+        GL_CALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, kHeaderSize + _levels[level].offset * (int64_t)sizeof(float),
+                                    0, (int64_t)_levels[level].width * _levels[level].height * sizeof(float)));
+        _readbackFence.place();
+        _readbackLevel = level;
+        _readbackDepthSize = glm::ivec2(_depthWidth, _depthHeight);
+    }
+}
+
+void HiZPyramid::cull(const Buffer& boxes, const Buffer& visibility, uint32_t count, const glm::mat4& viewProjection, HiZCullMode mode) {
+    if (_levels.empty())
+        throw std::logic_error("HiZPyramid was never built!");
+    if (count == 0)
+        return;
+    _cullProgram.bind();
+    _cullProgram["uViewProjection"] = viewProjection;
+    _cullProgram["uCount"] = count;
+    _cullProgram["uHiddenOnly"] = mode == HiZCullMode::Hidden ? 1 : 0;
+    _pyramid.bindBase(0);
+    boxes.bindBase(BufferType::ShaderStorage, 1);
+    visibility.bindBase(BufferType::ShaderStorage, 2);
+    GL_CALL(glDispatchCompute((count + 63) / 64, 1, 1));
+    GL_CALL(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT));
+}
+
+bool HiZPyramid::testCpu(const glm::vec3& min, const glm::vec3& max, const glm::mat4& viewProjection) {
+    _collectReadback();
+    if (_cpuLevel < 0)
+        return true;
+
+    bool reversed = _settings.reversedZ;
+    glm::vec2 low(std::numeric_limits<float>::max()), high(std::numeric_limits<float>::lowest());
+    float nearest = reversed ? 0.0f : 1.0f;
+    for (int i = 0; i < 8; i++) {
+        glm::vec4 clip = viewProjection * glm::vec4(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z, 1.0f);
+        if (clip.w <= 0.0f)
+            return true;
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        low = glm::min(low, glm::vec2(ndc));
+        high = glm::max(high, glm::vec2(ndc));
+        float depth = reversed ? ndc.z : ndc.z * 0.5f + 0.5f;
+        nearest = reversed ? std::max(nearest, depth) : std::min(nearest, depth);
+    }
+    if (low.x > 1.0f || low.y > 1.0f || high.x < -1.0f || high.y < -1.0f)
+        return false;
+
+    // same level selection as hizVisible(), but never finer than the downloaded level
+    glm::vec2 size = glm::vec2(_cpuDepthSize) * 0.5f;
+    glm::vec2 rectMin = glm::clamp(low * 0.5f + 0.5f, 0.0f, 1.0f) * size;
+    glm::vec2 rectMax = glm::clamp(high * 0.5f + 0.5f, 0.0f, 1.0f) * size;
+    float extent = std::max(rectMax.x - rectMin.x, rectMax.y - rectMin.y);
+    int level = (int)std::ceil(std::log2(std::max(extent, 1.0f)));
+    if (extent * std::exp2(-(float)level) > 1.0f)
+        level++;
+    int index = std::min(std::max(level - _cpuLevel, 0), (int)_cpuLevels.size() - 1);
+    float scale = std::exp2(-(float)(_cpuLevel + index));
+
+    const std::vector<float>& texels = _cpuLevels[index];
+    glm::ivec2 levelSize = _cpuLevelSizes[index];
+    glm::ivec2 a = glm::clamp(glm::ivec2(rectMin * scale), glm::ivec2(0), levelSize - 1);
+    glm::ivec2 b = glm::clamp(glm::ivec2(rectMax * scale), glm::ivec2(0), levelSize - 1);
+    float farthest = texels[(size_t)a.y * levelSize.x + a.x];
+    for (float depth : { texels[(size_t)a.y * levelSize.x + b.x], texels[(size_t)b.y * levelSize.x + a.x], texels[(size_t)b.y * levelSize.x + b.x] })
+        farthest = reversed ? std::min(farthest, depth) : std::max(farthest, depth);
+    return reversed ? nearest >= farthest : nearest <= farthest;
+}
+
+std::string HiZPyramid::glslSource(unsigned int binding) const {
+    return defines(_settings.reversedZ, binding) + kHiZCommon;
+}
+
+glm::ivec2 HiZPyramid::levelSize(int level) const {
+    if (level < 0 || level >= (int)_levels.size())
+        throw std::out_of_range("HiZPyramid level " + std::to_string(level) + " is out of range!");
+    return { _levels[level].width, _levels[level].height };
+}
+
+}
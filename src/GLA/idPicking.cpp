@@ -0,0 +1,196 @@
+#include <GLA/idPicking.h>
+
+#include <GLA/debug.h>
+
+#include <algorithm>
+#include <limits>
+#include <glm/common.hpp>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    // ids are stored + 1 so the cleared value 0 becomes UINT32_MAX
+    const char* kPickShader = R"(
+layout(location = 0) out uvec2 glaPickId;
+
+void writePickId(uint id) {
+    glaPickId = uvec2(id + 1u, uint(gl_PrimitiveID));
+}
+)";
+
+}
+
+PickResult PickRegion::at(const glm::ivec2& pixel) const {
+    glm::ivec2 local = pixel - origin;
+    if (local.x < 0 || local.y < 0 || local.x >= size.x || local.y >= size.y)
+        return {};
+    return pixels[(size_t)local.y * size.x + local.x];
+}
+
+PickResult PickRegion::closest() const {
+    PickResult result;
+    int best = std::numeric_limits<int>::max();
+    for (int y = 0; y < size.y; y++) {
+        for (int x = 0; x < size.x; x++) {
+            const PickResult& pixel = pixels[(size_t)y * size.x + x];
+            glm::ivec2 offset = origin + glm::ivec2(x, y) - cursor;
+            int distance = offset.x * offset.x + offset.y * offset.y;
+            if (pixel.hit() && distance < best) {
+                best = distance;
+                result = pixel;
+            }
+        }
+    }
+    return result;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class IdPicking
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void IdPicking::_allocate(int width, int height) {
+    if (width <= 0 || height <= 0)
+        throw std::invalid_argument("IdPicking width and height must be greater than 0!");
+    _ids = Texture(TextureType::Texture2D);
+    _ids.setStorage(1, TextureFormat::RG32UI, width, height);
+    _ids.setFilter(TextureFilter::Nearest, TextureFilter::Nearest);
+    _depth = Texture(TextureType::Texture2D);
+    _depth.setStorage(1, TextureFormat::Depth24, width, height);
+    _framebuffer = Framebuffer();
+    _framebuffer.attachColor(0, _ids);
+    _framebuffer.attachDepth(_depth);
+    _framebuffer.check();
+    _framebuffer.clearColor(0, glm::uvec4(0));
+}
+
+bool IdPicking::_queue(const glm::ivec2& origin, const glm::ivec2& size, const glm::ivec2& cursor, Callback callback) {
+    if (size.x > _settings.maxRegionSize || size.y > _settings.maxRegionSize)
+        throw std::invalid_argument("Pick region is larger than maxRegionSize!");
+    glm::ivec2 low = glm::max(origin, glm::ivec2(0));
+    glm::ivec2 high = glm::min(origin + size, glm::ivec2(_ids.width(), _ids.height()));
+    if (low.x >= high.x || low.y >= high.y)
+        return false;
+    auto slot = std::find_if(_requests.begin(), _requests.end(), [](const Request& request) { return !request.active; });
+    if (slot == _requests.end())
+        return false;
+
+    Request& request = *slot;
+    request.region.origin = low;
+    request.region.size = high - low;
+    request.region.cursor = cursor;
+    request.callback = std::move(callback);
+    request.active = true;
+
+    // window coordinates have their origin at the top left, OpenGL at the bottom left
+    int64_t offset = (int64_t)(slot - _requests.begin()) * _settings.maxRegionSize * _settings.maxRegionSize * 2 * sizeof(uint32_t);
+    GLint previousRead = 0;
+    GL_CALL(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead));
+    GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffer.id()));
+    GL_CALL(glReadBuffer(GL_COLOR_ATTACHMENT0));
+    _readback.bind();
+    GL_CALL(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+    GL_CALL(glReadPixels(low.x, _ids.height() - high.y, request.region.size.x, request.region.size.y, GL_RG_INTEGER, GL_UNSIGNED_INT, (void*)offset));
+    GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, previousRead));
+    request.fence.place();
+    return true;
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+IdPicking::IdPicking(int width, int height, const IdPickingSettings& settings)
+    : _settings(settings), _ids(TextureType::Texture2D), _depth(TextureType::Texture2D), _readback(BufferType::PixelPack) {
+    if (settings.maxRequests <= 0 || settings.maxRegionSize <= 0)
+        throw std::invalid_argument("maxRequests and maxRegionSize must be greater than 0!");
+    _allocate(width, height);
+
+    int64_t bytes = (int64_t)settings.maxRequests * settings.maxRegionSize * settings.maxRegionSize * 2 * sizeof(uint32_t);
+    _readback.setStorage(bytes, nullptr, BufferFlag::MapRead | BufferFlag::MapPersistent | BufferFlag::MapCoherent);
+    _readbackData = (const uint32_t*)_readback.map(0, bytes, MapUsage::Read | MapUsage::Persistent | MapUsage::Coherent);
+    _requests.resize(settings.maxRequests);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void IdPicking::resize(int width, int height) {
+    if (_drawing)
+        throw std::logic_error("IdPicking can't be resized between begin() and end()!");
+    _allocate(width, height);
+}
+
+void IdPicking::begin() {
+    if (_drawing)
+        throw std::logic_error("IdPicking::begin() was already called!");
+    _drawing = true;
+    GL_CALL(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_previousFramebuffer));
+    GL_CALL(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &_previousReadFramebuffer));
+    GL_CALL(glGetIntegerv(GL_VIEWPORT, _previousViewport));
+    _framebuffer.bind();
+    GL_CALL(glDepthMask(GL_TRUE));
+    _framebuffer.clearColor(0, glm::uvec4(0));
+    _framebuffer.clearDepth(1.0f);
+}
+
+void IdPicking::end() {
+    if (!_drawing)
+        throw std::logic_error("IdPicking::begin() was not called!");
+    _drawing = false;
+    GL_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _previousFramebuffer));
+    GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, _previousReadFramebuffer));
+    GL_CALL(glViewport(_previousViewport[0], _previousViewport[1], _previousViewport[2], _previousViewport[3]));
+}
+
+bool IdPicking::pick(const glm::ivec2& cursor, int radius, Callback callback) {
+    radius = std::max(radius, 0);
+    return _queue(cursor - radius, glm::ivec2(radius * 2 + 1), cursor, std::move(callback));
+}
+
+bool IdPicking::pickRegion(const glm::ivec2& origin, const glm::ivec2& size, Callback callback) {
+    return _queue(origin, size, origin + size / 2, std::move(callback));
+}
+
+void IdPicking::update() {
+    size_t regionTexels = (size_t)_settings.maxRegionSize * _settings.maxRegionSize;
+    for (size_t i = 0; i < _requests.size(); i++) {
+        Request& request = _requests[i];
+        if (!request.active || !request.fence.signaled())
+            continue;
+
+        PickRegion region = std::move(request.region);
+        Callback callback = std::move(request.callback);
+        request.fence.reset();
+        request.active = false;
+
+        const uint32_t* texels = _readbackData + i * regionTexels * 2;
+        region.pixels.resize((size_t)region.size.x * region.size.y);
+        for (int y = 0; y < region.size.y; y++) {
+            const uint32_t* row = texels + (size_t)(region.size.y - 1 - y) * region.size.x * 2;
+            for (int x = 0; x < region.size.x; x++)
+                region.pixels[(size_t)y * region.size.x + x] = { row[x * 2] - 1u, row[x * 2 + 1] };
+        }
+        if (callback)
+            callback(region);
+    }
+}
+
+const char* IdPicking::glslSource() {
+    return kPickShader;
+}
+
+size_t IdPicking::pendingRequests() const {
+    return (size_t)std::count_if(_requests.begin(), _requests.end(), [](const Request& request) { return request.active; });
+}
+
+}
@@ -0,0 +1,119 @@
+#include <GLA/mappedFile.h>
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace gla {
+
+// ----------------------------------------------------------------------------------------------------
+// class MappedFile
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void MappedFile::_unmap() {
+    if (!_data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+#else
+    munmap((void*)_data, _size);
+#endif
+    _data = nullptr;
+    _size = 0;
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+MappedFile::MappedFile(const std::string& path) {
+    // the file and mapping handles can be closed right away, the view keeps the mapping alive
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::invalid_argument("Could not open file: " + path + "!");
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error("Could not query the size of file: " + path + "!");
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        throw std::runtime_error("Could not map file: " + path + "!");
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view)
+        throw std::runtime_error("Could not map file: " + path + "!");
+
+    _data = (const uint8_t*)view;
+    _size = (size_t)size.QuadPart;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::invalid_argument("Could not open file: " + path + "!");
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Could not query the size of file: " + path + "!");
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        return;
+    }
+
+    void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        throw std::runtime_error("Could not map file: " + path + "!");
+
+    _data = (const uint8_t*)view;
+    _size = (size_t)info.st_size;
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0)) {}
+
+MappedFile::~MappedFile() {
+    _unmap();
+}
+
+// --------------------------------------------------
+// operator overloads
+// --------------------------------------------------
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        _unmap();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+    }
+    return *this;
+}
+
+}
@@ -0,0 +1,254 @@
+#include <GLA/meshFile.h>
+
+#include <GLA/debug.h>
+
+#include <fstream>
+#include <cstring>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    uint64_t alignUp(uint64_t value) {
+        return (value + kMeshFileAlignment - 1) & ~(kMeshFileAlignment - 1);
+    }
+
+    void writePadding(std::ofstream& file, uint64_t& position) {
+        static const char zeros[kMeshFileAlignment] = {};
+        uint64_t aligned = alignUp(position);
+        file.write(zeros, (std::streamsize)(aligned - position));
+        position = aligned;
+    }
+
+    void writeBlock(std::ofstream& file, uint64_t& position, const void* data, uint64_t size) {
+        file.write((const char*)data, (std::streamsize)size);
+        position += size;
+    }
+
+    // checks that [offset; offset + size) lies inside of the file and offset is aligned
+    void checkBlock(uint64_t offset, uint64_t size, size_t fileSize, const char* name) {
+        if (offset % kMeshFileAlignment != 0)
+            throw MeshFileError(std::string(name) + " block is not aligned!");
+        if (offset > fileSize || size > fileSize - offset)
+            throw MeshFileError(std::string(name) + " block lies outside of the file!");
+    }
+
+    // checks that the indices, or the vertices of non indexed meshes, a submesh draws lie inside of the mesh
+    bool submeshInRange(const Submesh& submesh, uint32_t indexCount, uint32_t vertexCount) {
+        if (indexCount > 0)
+            return (uint64_t)submesh.firstIndex + submesh.count <= indexCount;
+        int64_t first = (int64_t)submesh.firstIndex + submesh.baseVertex;
+        return first >= 0 && first + submesh.count <= vertexCount;
+    }
+
+}
+
+void writeMeshFile(const std::string& path, const MeshData& mesh) {
+    if (mesh.stride <= 0 && mesh.vertexCount > 0)
+        throw std::invalid_argument("stride must be greater than 0!");
+    if (mesh.vertices.size() != (uint64_t)mesh.vertexCount * mesh.stride)
+        throw std::invalid_argument("Vertex data size doesn't match vertexCount * stride!");
+    if (mesh.indices.size() != (uint64_t)mesh.indexCount * typeToBytes(mesh.indexType))
+        throw std::invalid_argument("Index data size doesn't match indexCount and indexType!");
+    for (const Submesh& submesh : mesh.submeshes)
+        if (!submeshInRange(submesh, mesh.indexCount, mesh.vertexCount))
+            throw std::invalid_argument("Submesh lies outside of the indices or vertices of the mesh!");
+
+    std::vector<MeshFileAttribute> attributes;
+    attributes.reserve(mesh.attributes.size());
+    for (const VertexAttribute& attribute : mesh.attributes) {
+        if (attribute.offset < 0 || attribute.offset + typeToBytes(attribute.type) * attribute.numComponents > mesh.stride)
+            throw std::invalid_argument("VertexAttribute lies outside of the stride!");
+        attributes.push_back({ attribute.index, (uint32_t)attribute.numComponents, (uint32_t)attribute.type,
+                               (uint32_t)attribute.interp, attribute.normalized ? 1u : 0u, (uint32_t)attribute.offset });
+    }
+
+    MeshFileHeader header = {};
+    header.magic = kMeshFileMagic;
+    header.version = kMeshFileVersion;
+    header.attributeCount = (uint32_t)attributes.size();
+    header.submeshCount = (uint32_t)mesh.submeshes.size();
+    header.vertexCount = mesh.vertexCount;
+    header.vertexStride = (uint32_t)mesh.stride;
+    header.indexCount = mesh.indexCount;
+    header.indexType = (uint32_t)mesh.indexType;
+    header.attributeOffset = alignUp(sizeof(MeshFileHeader));
+    header.submeshOffset = alignUp(header.attributeOffset + attributes.size() * sizeof(MeshFileAttribute));
+    header.vertexOffset = alignUp(header.submeshOffset + mesh.submeshes.size() * sizeof(Submesh));
+    header.indexOffset = alignUp(header.vertexOffset + mesh.vertices.size());
+    std::memcpy(header.boundsMin, &mesh.boundsMin, sizeof(header.boundsMin));
+    std::memcpy(header.boundsMax, &mesh.boundsMax, sizeof(header.boundsMax));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("Could not open file for writing: " + path + "!");
+
+    uint64_t position = 0;
+    writeBlock(file, position, &header, sizeof(header));
+    writePadding(file, position);
+    writeBlock(file, position, attributes.data(), attributes.size() * sizeof(MeshFileAttribute));
+    writePadding(file, position);
+    writeBlock(file, position, mesh.submeshes.data(), mesh.submeshes.size() * sizeof(Submesh));
+    writePadding(file, position);
+    writeBlock(file, position, mesh.vertices.data(), mesh.vertices.size());
+    writePadding(file, position);
+    writeBlock(file, position, mesh.indices.data(), mesh.indices.size());
+
+    if (!file)
+        throw std::runtime_error("Could not write file: " + path + "!");
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class MeshFile
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void MeshFile::_validate() {
+    if (_data.size() < sizeof(MeshFileHeader))
+        throw MeshFileError("File is smaller than the header!");
+    if ((uintptr_t)_data.data() % alignof(MeshFileHeader) != 0)
+        throw MeshFileError("Mesh data is not aligned!");
+    // every block is aligned relative to the start, so all tables can be read in place
+    _header = (const MeshFileHeader*)_data.data();
+    if (_header->magic != kMeshFileMagic)
+        throw MeshFileError("File is not a mesh file!");
+    if (_header->version != kMeshFileVersion)
+        throw MeshFileError("Unsupported mesh file version " + std::to_string(_header->version) + ", expected " + std::to_string(kMeshFileVersion) + "!");
+    if (_header->indexType > (uint32_t)IndexType::UnsignedInt)
+        throw MeshFileError("Invalid index type!");
+
+    checkBlock(_header->attributeOffset, (uint64_t)_header->attributeCount * sizeof(MeshFileAttribute), _data.size(), "Attribute");
+    checkBlock(_header->submeshOffset, (uint64_t)_header->submeshCount * sizeof(Submesh), _data.size(), "Submesh");
+    checkBlock(_header->vertexOffset, (uint64_t)_header->vertexCount * _header->vertexStride, _data.size(), "Vertex");
+    checkBlock(_header->indexOffset, (uint64_t)_header->indexCount * typeToBytes(indexType()), _data.size(), "Index");
+
+    const MeshFileAttribute* attributes = (const MeshFileAttribute*)(_data.data() + _header->attributeOffset);
+    for (uint32_t i = 0; i < _header->attributeCount; i++) {
+        const MeshFileAttribute& attribute = attributes[i];
+        if (attribute.type > (uint32_t)VertexAttribType::Fixed || attribute.interp > (uint32_t)VertexAttribInterp::Integer ||
+            attribute.numComponents < 1 || attribute.numComponents > 4)
+            throw MeshFileError("Attribute " + std::to_string(i) + " is invalid!");
+        if (attribute.offset + typeToBytes((VertexAttribType)attribute.type) * attribute.numComponents > _header->vertexStride)
+            throw MeshFileError("Attribute " + std::to_string(i) + " lies outside of the stride!");
+    }
+
+    const Submesh* submeshes = (const Submesh*)(_data.data() + _header->submeshOffset);
+    for (uint32_t i = 0; i < _header->submeshCount; i++)
+        if (!submeshInRange(submeshes[i], _header->indexCount, _header->vertexCount))
+            throw MeshFileError("Submesh " + std::to_string(i) + " lies outside of the indices or vertices!");
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+MeshFile::MeshFile(const std::string& path) : _file(path) {
+    _data = _file.bytes();
+    _validate();
+}
+
+MeshFile::MeshFile(std::span<const uint8_t> data) : _data(data) {
+    _validate();
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+std::vector<VertexAttribute> MeshFile::attributes() const {
+    const MeshFileAttribute* attributes = (const MeshFileAttribute*)(_data.data() + _header->attributeOffset);
+    std::vector<VertexAttribute> result;
+    result.reserve(_header->attributeCount);
+    for (uint32_t i = 0; i < _header->attributeCount; i++) {
+        const MeshFileAttribute& attribute = attributes[i];
+        result.push_back({ attribute.index, (int)attribute.numComponents, (VertexAttribType)attribute.type,
+                           (VertexAttribInterp)attribute.interp, attribute.normalized != 0, (int)attribute.offset });
+    }
+    return result;
+}
+
+std::span<const Submesh> MeshFile::submeshes() const {
+    return { (const Submesh*)(_data.data() + _header->submeshOffset), _header->submeshCount };
+}
+
+std::span<const uint8_t> MeshFile::vertexData() const {
+    return { _data.data() + _header->vertexOffset, (size_t)_header->vertexCount * _header->vertexStride };
+}
+
+std::span<const uint8_t> MeshFile::indexData() const {
+    return { _data.data() + _header->indexOffset, (size_t)_header->indexCount * typeToBytes(indexType()) };
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class Mesh
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void Mesh::_upload(std::span<const uint8_t> vertices, std::span<const uint8_t> indices, BufferFlag flags) {
+    if (!vertices.empty())
+        _vertices.setStorage((int64_t)vertices.size(), vertices.data(), flags);
+    if (!indices.empty())
+        _indices.setStorage((int64_t)indices.size(), indices.data(), flags);
+    if (_submeshes.empty())
+        _submeshes.push_back({ 0, _indexCount > 0 ? _indexCount : _vertexCount, 0, 0 });
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+Mesh::Mesh(const MeshFile& file, BufferFlag flags)
+    : _indices(BufferType::ElementArray), _attributes(file.attributes()), _stride(file.stride()),
+      _vertexCount(file.vertexCount()), _indexCount(file.indexCount()), _indexType(file.indexType()),
+      _submeshes(file.submeshes().begin(), file.submeshes().end()), _boundsMin(file.boundsMin()), _boundsMax(file.boundsMax()) {
+    _upload(file.vertexData(), file.indexData(), flags);
+}
+
+Mesh::Mesh(const MeshData& data, BufferFlag flags)
+    : _indices(BufferType::ElementArray), _attributes(data.attributes), _stride(data.stride),
+      _vertexCount(data.vertexCount), _indexCount(data.indexCount), _indexType(data.indexType),
+      _submeshes(data.submeshes), _boundsMin(data.boundsMin), _boundsMax(data.boundsMax) {
+    _upload(data.vertices, data.indices, flags);
+}
+
+Mesh Mesh::load(const std::string& path, BufferFlag flags) {
+    MeshFile file(path);
+    return Mesh(file, flags);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void Mesh::bind() {
+    _vertices.setAttributes(_attributes, _stride);
+    if (_indexCount > 0)
+        _indices.bind();
+}
+
+void Mesh::draw(size_t submesh) const {
+    const Submesh& range = _submeshes.at(submesh);
+    if (_indexCount > 0) {
+        uintptr_t offset = (uintptr_t)range.firstIndex * typeToBytes(_indexType);
+        GL_CALL(glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)range.count, toGLenum(_indexType), (const void*)offset, range.baseVertex));
+    }
+    else {
+        GL_CALL(glDrawArrays(GL_TRIANGLES, (GLint)range.firstIndex + range.baseVertex, (GLsizei)range.count));
+    }
+}
+
+void Mesh::draw() const {
+    for (size_t i = 0; i < _submeshes.size(); i++)
+        draw(i);
+}
+
+}
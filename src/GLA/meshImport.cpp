@@ -0,0 +1,909 @@
+#include <GLA/meshImport.h>
+
+#include <GLA/mappedFile.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <glm/glm.hpp>
+#include <glm/packing.hpp>
+
+namespace gla {
+
+namespace {
+
+    // --------------------------------------------------
+    // text parsing
+    // --------------------------------------------------
+
+    struct TextRange {
+        const char* begin;
+        const char* end;
+    };
+
+    // splits text into chunks of about chunkSize bytes that each end after a newline
+    std::vector<TextRange> splitLines(const char* begin, const char* end, size_t chunkSize) {
+        std::vector<TextRange> chunks;
+        chunkSize = std::max<size_t>(chunkSize, 1);
+        while (begin < end) {
+            const char* split = begin + std::min(chunkSize, (size_t)(end - begin));
+            if (split < end) {
+                const char* newline = (const char*)std::memchr(split, '\n', end - split);
+                split = newline ? newline + 1 : end;
+            }
+            chunks.push_back({ begin, split });
+            begin = split;
+        }
+        return chunks;
+    }
+
+    const char* lineEnd(const char* p, const char* end) {
+        const char* newline = (const char*)std::memchr(p, '\n', end - p);
+        return newline ? newline : end;
+    }
+
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    const char* skipSpaces(const char* p, const char* end) {
+        while (p < end && isSpace(*p))
+            p++;
+        return p;
+    }
+
+    // lines holding more than whitespace, blank lines are no PLY records
+    size_t countRecords(TextRange range) {
+        size_t count = 0;
+        for (const char* line = range.begin; line < range.end;) {
+            const char* end = lineEnd(line, range.end);
+            if (skipSpaces(line, end) < end)
+                count++;
+            line = end + 1;
+        }
+        return count;
+    }
+
+    std::string excerpt(const char* begin, const char* end) {
+        return "\"" + std::string(begin, std::min<size_t>(end - begin, 64)) + "\"";
+    }
+
+    template <typename T>
+    bool parseNumber(const char*& p, const char* end, T& value) {
+        p = skipSpaces(p, end);
+        if (p < end && *p == '+')
+            p++;
+        auto [next, error] = std::from_chars(p, end, value);
+        if (next == p)
+            return false;
+        // denormals and huge values report out of range, they are flushed instead of failing the import
+        if (error == std::errc::result_out_of_range)
+            value = 0;
+        p = next;
+        return true;
+    }
+
+    // --------------------------------------------------
+    // output
+    // --------------------------------------------------
+
+    struct VertexLayout {
+        bool normals = false;
+        bool uvs = false;
+        bool colors = false;
+        int normalOffset = 0;
+        int uvOffset = 0;
+        int colorOffset = 0;
+        int stride = 0;
+    };
+
+    VertexLayout makeLayout(bool normals, bool uvs, bool colors, MeshData& mesh) {
+        VertexLayout layout{ normals, uvs, colors };
+        int offset = 0;
+        mesh.attributes.push_back({ 0, 3, VertexAttribType::Float, VertexAttribInterp::Float, false, offset });
+        offset += sizeof(glm::vec3);
+        if (normals) {
+            layout.normalOffset = offset;
+            mesh.attributes.push_back({ 1, 3, VertexAttribType::Float, VertexAttribInterp::Float, false, offset });
+            offset += sizeof(glm::vec3);
+        }
+        if (uvs) {
+            layout.uvOffset = offset;
+            mesh.attributes.push_back({ 2, 2, VertexAttribType::Float, VertexAttribInterp::Float, false, offset });
+            offset += sizeof(glm::vec2);
+        }
+        if (colors) {
+            layout.colorOffset = offset;
+            mesh.attributes.push_back({ 3, 4, VertexAttribType::UnsignedByte, VertexAttribInterp::Float, true, offset });
+            offset += sizeof(uint32_t);
+        }
+        layout.stride = offset;
+        mesh.stride = offset;
+        return layout;
+    }
+
+    void setIndices(MeshData& mesh, const std::vector<uint32_t>& indices) {
+        mesh.indexCount = (uint32_t)indices.size();
+        if (mesh.vertexCount <= 0xFFFF) {
+            mesh.indexType = IndexType::UnsignedShort;
+            mesh.indices.resize(indices.size() * sizeof(uint16_t));
+            uint16_t* out = (uint16_t*)mesh.indices.data();
+            for (size_t i = 0; i < indices.size(); i++)
+                out[i] = (uint16_t)indices[i];
+        }
+        else {
+            mesh.indexType = IndexType::UnsignedInt;
+            mesh.indices.resize(indices.size() * sizeof(uint32_t));
+            std::memcpy(mesh.indices.data(), indices.data(), mesh.indices.size());
+        }
+    }
+
+    void computeBounds(MeshData& mesh, ThreadPool& pool) {
+        const size_t chunkSize = 1 << 16;
+        size_t chunkCount = (mesh.vertexCount + chunkSize - 1) / chunkSize;
+        std::vector<glm::vec3> mins(chunkCount, glm::vec3(std::numeric_limits<float>::max()));
+        std::vector<glm::vec3> maxs(chunkCount, glm::vec3(std::numeric_limits<float>::lowest()));
+        pool.parallelFor(mesh.vertexCount, chunkSize, [&](size_t begin, size_t end) {
+            size_t chunk = begin / chunkSize;
+            for (size_t i = begin; i < end; i++) {
+                glm::vec3 position;
+                std::memcpy(&position, mesh.vertices.data() + i * mesh.stride, sizeof(glm::vec3));
+                mins[chunk] = glm::min(mins[chunk], position);
+                maxs[chunk] = glm::max(maxs[chunk], position);
+            }
+        });
+        mesh.boundsMin = glm::vec3(0.0f);
+        mesh.boundsMax = glm::vec3(0.0f);
+        if (chunkCount == 0)
+            return;
+        mesh.boundsMin = mins[0];
+        mesh.boundsMax = maxs[0];
+        for (size_t i = 1; i < chunkCount; i++) {
+            mesh.boundsMin = glm::min(mesh.boundsMin, mins[i]);
+            mesh.boundsMax = glm::max(mesh.boundsMax, maxs[i]);
+        }
+    }
+
+    // --------------------------------------------------
+    // OBJ
+    // --------------------------------------------------
+
+    enum class ObjLine {
+        Other,
+        Position,
+        UV,
+        Normal,
+        Face,
+        Material
+    };
+
+    // classifies a line and advances p past its keyword
+    ObjLine classifyObjLine(const char*& p, const char* end) {
+        p = skipSpaces(p, end);
+        size_t length = end - p;
+        if (length >= 2 && p[0] == 'v') {
+            if (isSpace(p[1])) {
+                p += 2;
+                return ObjLine::Position;
+            }
+            if (length >= 3 && isSpace(p[2])) {
+                if (p[1] == 't') {
+                    p += 3;
+                    return ObjLine::UV;
+                }
+                if (p[1] == 'n') {
+                    p += 3;
+                    return ObjLine::Normal;
+                }
+            }
+            return ObjLine::Other;
+        }
+        if (length >= 2 && p[0] == 'f' && isSpace(p[1])) {
+            p += 2;
+            return ObjLine::Face;
+        }
+        if (length >= 7 && std::memcmp(p, "usemtl", 6) == 0 && isSpace(p[6])) {
+            p += 7;
+            return ObjLine::Material;
+        }
+        return ObjLine::Other;
+    }
+
+    struct ObjCounts {
+        size_t positions = 0;
+        size_t uvs = 0;
+        size_t normals = 0;
+    };
+
+    struct ObjChunk {
+        ObjCounts base;                 // index of the chunk's first position, uv and normal in the merged arrays
+        std::vector<int> corners;       // position, uv, normal per triangle corner, -1 if absent
+        std::vector<std::pair<size_t, std::string>> materials; // first corner and name of every usemtl
+        bool colors = false;
+        bool uvs = false;
+        bool normals = false;
+    };
+
+    struct ObjArrays {
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> colors;   // packUnorm4x8, one per position
+        std::vector<glm::vec2> uvs;
+        std::vector<glm::vec3> normals;
+    };
+
+    // resolves a 1 based or negative (relative) OBJ index into a 0 based one
+    int resolveObjIndex(int64_t index, size_t current, size_t total, const char* begin, const char* end) {
+        int64_t resolved = index > 0 ? index - 1 : (int64_t)current + index;
+        if (index == 0 || resolved < 0 || resolved >= (int64_t)total)
+            throw MeshImportError("Face index out of range in line " + excerpt(begin, end) + "!");
+        return (int)resolved;
+    }
+
+    void parseObjChunk(TextRange range, ObjChunk& chunk, ObjArrays& arrays) {
+        ObjCounts current = chunk.base;
+        std::vector<int> face;
+        const char* line = range.begin;
+        while (line < range.end) {
+            const char* end = lineEnd(line, range.end);
+            const char* p = line;
+            switch (classifyObjLine(p, end)) {
+            case ObjLine::Position: {
+                glm::vec3 position;
+                if (!parseNumber(p, end, position.x) || !parseNumber(p, end, position.y) || !parseNumber(p, end, position.z))
+                    throw MeshImportError("Invalid position in line " + excerpt(line, end) + "!");
+                // "v x y z r g b" carries a vertex color, "v x y z w" a weight that is ignored
+                glm::vec3 color;
+                if (parseNumber(p, end, color.r) && parseNumber(p, end, color.g) && parseNumber(p, end, color.b)) {
+                    arrays.colors[current.positions] = glm::packUnorm4x8(glm::vec4(color, 1.0f));
+                    chunk.colors = true;
+                }
+                arrays.positions[current.positions++] = position;
+                break;
+            }
+            case ObjLine::UV: {
+                glm::vec2 uv;
+                if (!parseNumber(p, end, uv.x))
+                    throw MeshImportError("Invalid texture coordinate in line " + excerpt(line, end) + "!");
+                if (!parseNumber(p, end, uv.y))
+                    uv.y = 0.0f;
+                arrays.uvs[current.uvs++] = uv;
+                break;
+            }
+            case ObjLine::Normal: {
+                glm::vec3 normal;
+                if (!parseNumber(p, end, normal.x) || !parseNumber(p, end, normal.y) || !parseNumber(p, end, normal.z))
+                    throw MeshImportError("Invalid normal in line " + excerpt(line, end) + "!");
+                arrays.normals[current.normals++] = normal;
+                break;
+            }
+            case ObjLine::Face: {
+                face.clear();
+                while (true) {
+                    p = skipSpaces(p, end);
+                    if (p >= end)
+                        break;
+                    int64_t index;
+                    if (!parseNumber(p, end, index))
+                        throw MeshImportError("Invalid face in line " + excerpt(line, end) + "!");
+                    int position = resolveObjIndex(index, current.positions, arrays.positions.size(), line, end);
+                    int uv = -1, normal = -1;
+                    if (p < end && *p == '/') {
+                        p++;
+                        if (p < end && *p != '/') {
+                            if (!parseNumber(p, end, index))
+                                throw MeshImportError("Invalid face in line " + excerpt(line, end) + "!");
+                            uv = resolveObjIndex(index, current.uvs, arrays.uvs.size(), line, end);
+                        }
+                        if (p < end && *p == '/') {
+                            p++;
+                            if (!parseNumber(p, end, index))
+                                throw MeshImportError("Invalid face in line " + excerpt(line, end) + "!");
+                            normal = resolveObjIndex(index, current.normals, arrays.normals.size(), line, end);
+                        }
+                    }
+                    if (p < end && !isSpace(*p))
+                        throw MeshImportError("Invalid face in line " + excerpt(line, end) + "!");
+                    face.insert(face.end(), { position, uv, normal });
+                    chunk.uvs |= uv >= 0;
+                    chunk.normals |= normal >= 0;
+                }
+                // triangulate polygons as a fan
+                size_t corners = face.size() / 3;
+                for (size_t i = 2; i < corners; i++) {
+                    chunk.corners.insert(chunk.corners.end(), face.begin(), face.begin() + 3);
+                    chunk.corners.insert(chunk.corners.end(), face.begin() + 3 * (i - 1), face.begin() + 3 * (i + 1));
+                }
+                break;
+            }
+            case ObjLine::Material: {
+                p = skipSpaces(p, end);
+                const char* nameEnd = end;
+                while (nameEnd > p && isSpace(nameEnd[-1]))
+                    nameEnd--;
+                chunk.materials.emplace_back(chunk.corners.size() / 3, std::string(p, nameEnd));
+                break;
+            }
+            case ObjLine::Other:
+                break;
+            }
+            line = end + 1;
+        }
+    }
+
+    ObjCounts countObjChunk(TextRange range) {
+        ObjCounts counts;
+        const char* line = range.begin;
+        while (line < range.end) {
+            const char* end = lineEnd(line, range.end);
+            const char* p = line;
+            switch (classifyObjLine(p, end)) {
+            case ObjLine::Position: counts.positions++; break;
+            case ObjLine::UV:       counts.uvs++; break;
+            case ObjLine::Normal:   counts.normals++; break;
+            default: break;
+            }
+            line = end + 1;
+        }
+        return counts;
+    }
+
+    // --------------------------------------------------
+    // PLY
+    // --------------------------------------------------
+
+    enum class PlyType {
+        Int8,
+        UInt8,
+        Int16,
+        UInt16,
+        Int32,
+        UInt32,
+        Float32,
+        Float64
+    };
+
+    enum class PlyFormat {
+        Ascii,
+        BinaryLittleEndian,
+        BinaryBigEndian
+    };
+
+    // vertex attribute components a PLY property is read into
+    enum PlyRole {
+        kIgnored = -1,
+        kPositionX = 0, kPositionY, kPositionZ,
+        kNormalX, kNormalY, kNormalZ,
+        kU, kV,
+        kRed, kGreen, kBlue, kAlpha,
+        kRoleCount
+    };
+
+    struct PlyProperty {
+        std::string name;
+        PlyType type = PlyType::Float32;
+        bool list = false;
+        PlyType countType = PlyType::UInt8;
+        int role = kIgnored;
+        int offset = 0; // byte offset in fixed size binary records
+    };
+
+    struct PlyElement {
+        std::string name;
+        size_t count = 0;
+        std::vector<PlyProperty> properties;
+        bool fixedSize = true;
+        int stride = 0; // size of one binary record if fixedSize
+    };
+
+    bool parsePlyType(std::string_view name, PlyType& type) {
+        if (name == "char" || name == "int8")           type = PlyType::Int8;
+        else if (name == "uchar" || name == "uint8")    type = PlyType::UInt8;
+        else if (name == "short" || name == "int16")    type = PlyType::Int16;
+        else if (name == "ushort" || name == "uint16")  type = PlyType::UInt16;
+        else if (name == "int" || name == "int32")      type = PlyType::Int32;
+        else if (name == "uint" || name == "uint32")    type = PlyType::UInt32;
+        else if (name == "float" || name == "float32")  type = PlyType::Float32;
+        else if (name == "double" || name == "float64") type = PlyType::Float64;
+        else return false;
+        return true;
+    }
+
+    int plyTypeSize(PlyType type) {
+        switch (type) {
+        case PlyType::Int8:
+        case PlyType::UInt8:    return 1;
+        case PlyType::Int16:
+        case PlyType::UInt16:   return 2;
+        case PlyType::Int32:
+        case PlyType::UInt32:
+        case PlyType::Float32:  return 4;
+        case PlyType::Float64:  return 8;
+        }
+        return 0;
+    }
+
+    bool plyTypeIsFloat(PlyType type) {
+        return type == PlyType::Float32 || type == PlyType::Float64;
+    }
+
+    int plyRole(const std::string& name) {
+        static const std::pair<const char*, int> roles[] = {
+            { "x", kPositionX }, { "y", kPositionY }, { "z", kPositionZ },
+            { "nx", kNormalX }, { "ny", kNormalY }, { "nz", kNormalZ },
+            { "s", kU }, { "t", kV }, { "u", kU }, { "v", kV }, { "texture_u", kU }, { "texture_v", kV },
+            { "red", kRed }, { "green", kGreen }, { "blue", kBlue }, { "alpha", kAlpha },
+            { "diffuse_red", kRed }, { "diffuse_green", kGreen }, { "diffuse_blue", kBlue }
+        };
+        for (const auto& [roleName, role] : roles)
+            if (name == roleName)
+                return role;
+        return kIgnored;
+    }
+
+    double readPly(const uint8_t* data, PlyType type, bool swap) {
+        uint8_t bytes[8];
+        int size = plyTypeSize(type);
+        for (int i = 0; i < size; i++)
+            bytes[i] = data[swap ? size - 1 - i : i];
+        switch (type) {
+        case PlyType::Int8:     { int8_t v; std::memcpy(&v, bytes, 1); return v; }
+        case PlyType::UInt8:    return bytes[0];
+        case PlyType::Int16:    { int16_t v; std::memcpy(&v, bytes, 2); return v; }
+        case PlyType::UInt16:   { uint16_t v; std::memcpy(&v, bytes, 2); return v; }
+        case PlyType::Int32:    { int32_t v; std::memcpy(&v, bytes, 4); return v; }
+        case PlyType::UInt32:   { uint32_t v; std::memcpy(&v, bytes, 4); return v; }
+        case PlyType::Float32:  { float v; std::memcpy(&v, bytes, 4); return v; }
+        case PlyType::Float64:  { double v; std::memcpy(&v, bytes, 8); return v; }
+        }
+        return 0.0;
+    }
+
+    struct PlyVertexWriter {
+        const PlyElement* element;
+        MeshData* mesh;
+        VertexLayout layout;
+        bool colorsAreFloat[4] = {};
+
+        void write(size_t index, const double* values) const {
+            uint8_t* vertex = mesh->vertices.data() + index * layout.stride;
+            glm::vec3 position((float)values[kPositionX], (float)values[kPositionY], (float)values[kPositionZ]);
+            std::memcpy(vertex, &position, sizeof(glm::vec3));
+            if (layout.normals) {
+                glm::vec3 normal((float)values[kNormalX], (float)values[kNormalY], (float)values[kNormalZ]);
+                std::memcpy(vertex + layout.normalOffset, &normal, sizeof(glm::vec3));
+            }
+            if (layout.uvs) {
+                glm::vec2 uv((float)values[kU], (float)values[kV]);
+                std::memcpy(vertex + layout.uvOffset, &uv, sizeof(glm::vec2));
+            }
+            if (layout.colors) {
+                uint8_t color[4];
+                for (int i = 0; i < 4; i++) {
+                    double value = colorsAreFloat[i] ? values[kRed + i] * 255.0 : values[kRed + i];
+                    color[i] = (uint8_t)std::clamp(value + (colorsAreFloat[i] ? 0.5 : 0.0), 0.0, 255.0);
+                }
+                std::memcpy(vertex + layout.colorOffset, color, sizeof(color));
+            }
+        }
+
+        void reset(double* values) const {
+            std::fill(values, values + kRoleCount, 0.0);
+            values[kAlpha] = colorsAreFloat[3] ? 1.0 : 255.0;
+        }
+    };
+
+    bool isFaceIndexList(const PlyProperty& property) {
+        return property.list && (property.name == "vertex_indices" || property.name == "vertex_index");
+    }
+
+    void addPlyFace(const std::vector<int64_t>& face, uint32_t vertexCount, std::vector<uint32_t>& indices) {
+        for (int64_t index : face)
+            if (index < 0 || index >= vertexCount)
+                throw MeshImportError("Face index " + std::to_string(index) + " out of range!");
+        for (size_t i = 2; i < face.size(); i++)
+            indices.insert(indices.end(), { (uint32_t)face[0], (uint32_t)face[i - 1], (uint32_t)face[i] });
+    }
+
+}
+
+MeshData importObj(const std::string& path, const MeshImportSettings& settings, ThreadPool& pool) {
+    MappedFile file(path);
+    const char* text = (const char*)file.data();
+    std::vector<TextRange> ranges = splitLines(text, text + file.size(), settings.chunkSize);
+    std::vector<ObjChunk> chunks(ranges.size());
+
+    // count first, so every chunk knows where its elements go in the merged arrays
+    std::vector<ObjCounts> counts(ranges.size());
+    pool.parallelFor(ranges.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            counts[i] = countObjChunk(ranges[i]);
+    });
+    ObjCounts total;
+    for (size_t i = 0; i < ranges.size(); i++) {
+        chunks[i].base = total;
+        total.positions += counts[i].positions;
+        total.uvs += counts[i].uvs;
+        total.normals += counts[i].normals;
+    }
+    if (total.positions > (size_t)std::numeric_limits<int>::max())
+        throw MeshImportError("OBJ file has too many positions!");
+
+    ObjArrays arrays;
+    arrays.positions.resize(total.positions);
+    arrays.colors.resize(total.positions, 0xFFFFFFFFu);
+    arrays.uvs.resize(total.uvs);
+    arrays.normals.resize(total.normals);
+    pool.parallelFor(ranges.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            parseObjChunk(ranges[i], chunks[i], arrays);
+    });
+
+    bool colors = false, uvs = false, normals = false;
+    size_t cornerCount = 0;
+    for (const ObjChunk& chunk : chunks) {
+        colors |= chunk.colors;
+        uvs |= chunk.uvs;
+        normals |= chunk.normals;
+        cornerCount += chunk.corners.size() / 3;
+    }
+
+    MeshData mesh;
+    VertexLayout layout = makeLayout(normals, uvs, colors, mesh);
+
+    // merge corners into unique vertices, the variants of a position are kept in a short linked list
+    std::vector<int> keys; // position, uv, normal per vertex
+    std::vector<uint32_t> indices;
+    if (cornerCount == 0) {
+        // files without faces are point clouds
+        keys.reserve(total.positions * 3);
+        for (size_t i = 0; i < total.positions; i++)
+            keys.insert(keys.end(), { (int)i, -1, -1 });
+    }
+    else {
+        struct Variant {
+            int uv;
+            int normal;
+            uint32_t vertex;
+            int next;
+        };
+        std::vector<int> heads(settings.deduplicate ? total.positions : 0, -1);
+        std::vector<Variant> variants;
+        variants.reserve(settings.deduplicate ? total.positions : 0);
+        indices.reserve(cornerCount);
+        keys.reserve(settings.deduplicate ? total.positions * 3 : cornerCount * 3);
+
+        for (const ObjChunk& chunk : chunks) {
+            for (size_t c = 0; c < chunk.corners.size(); c += 3) {
+                int position = chunk.corners[c], uv = chunk.corners[c + 1], normal = chunk.corners[c + 2];
+                uint32_t vertex = (uint32_t)(keys.size() / 3);
+                if (settings.deduplicate) {
+                    int variant = heads[position];
+                    while (variant >= 0 && (variants[variant].uv != uv || variants[variant].normal != normal))
+                        variant = variants[variant].next;
+                    if (variant >= 0) {
+                        indices.push_back(variants[variant].vertex);
+                        continue;
+                    }
+                    variants.push_back({ uv, normal, vertex, heads[position] });
+                    heads[position] = (int)variants.size() - 1;
+                }
+                keys.insert(keys.end(), { position, uv, normal });
+                indices.push_back(vertex);
+            }
+        }
+    }
+
+    mesh.vertexCount = (uint32_t)(keys.size() / 3);
+    mesh.vertices.resize((size_t)mesh.vertexCount * layout.stride);
+    pool.parallelFor(mesh.vertexCount, 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            uint8_t* vertex = mesh.vertices.data() + i * layout.stride;
+            int position = keys[i * 3], uv = keys[i * 3 + 1], normal = keys[i * 3 + 2];
+            std::memcpy(vertex, &arrays.positions[position], sizeof(glm::vec3));
+            if (layout.normals) {
+                glm::vec3 value = normal >= 0 ? arrays.normals[normal] : glm::vec3(0.0f);
+                std::memcpy(vertex + layout.normalOffset, &value, sizeof(glm::vec3));
+            }
+            if (layout.uvs) {
+                glm::vec2 value = uv >= 0 ? arrays.uvs[uv] : glm::vec2(0.0f);
+                std::memcpy(vertex + layout.uvOffset, &value, sizeof(glm::vec2));
+            }
+            if (layout.colors)
+                std::memcpy(vertex + layout.colorOffset, &arrays.colors[position], sizeof(uint32_t));
+        }
+    });
+
+    if (!indices.empty()) {
+        setIndices(mesh, indices);
+
+        // usemtl starts a new submesh, materials are numbered in order of first use
+        std::vector<std::pair<uint32_t, uint32_t>> starts = { { 0, 0 } }; // first index, material
+        std::vector<std::string> materials;
+        size_t cornerBase = 0;
+        for (const ObjChunk& chunk : chunks) {
+            for (const auto& [corner, name] : chunk.materials) {
+                uint32_t first = (uint32_t)(cornerBase + corner);
+                auto it = std::find(materials.begin(), materials.end(), name);
+                uint32_t material = (uint32_t)(it - materials.begin());
+                if (it == materials.end())
+                    materials.push_back(name);
+                if (starts.back().first == first)
+                    starts.back().second = material;
+                else
+                    starts.push_back({ first, material });
+            }
+            cornerBase += chunk.corners.size() / 3;
+        }
+        starts.push_back({ mesh.indexCount, 0 });
+        for (size_t i = 0; i + 1 < starts.size(); i++)
+            if (starts[i + 1].first > starts[i].first)
+                mesh.submeshes.push_back({ starts[i].first, starts[i + 1].first - starts[i].first, 0, starts[i].second });
+    }
+
+    computeBounds(mesh, pool);
+    return mesh;
+}
+
+MeshData importPly(const std::string& path, const MeshImportSettings& settings, ThreadPool& pool) {
+    MappedFile file(path);
+    const char* text = (const char*)file.data();
+    const char* fileEnd = text + file.size();
+
+    // header
+    PlyFormat format = PlyFormat::Ascii;
+    std::vector<PlyElement> elements;
+    const char* line = text;
+    bool first = true, headerEnded = false, formatFound = false;
+    while (line < fileEnd && !headerEnded) {
+        const char* end = lineEnd(line, fileEnd);
+        std::vector<std::string_view> tokens;
+        for (const char* p = skipSpaces(line, end); p < end; p = skipSpaces(p, end)) {
+            const char* tokenEnd = p;
+            while (tokenEnd < end && !isSpace(*tokenEnd))
+                tokenEnd++;
+            tokens.emplace_back(p, tokenEnd - p);
+            p = tokenEnd;
+        }
+        line = end + 1;
+
+        if (first) {
+            if (tokens.size() != 1 || tokens[0] != "ply")
+                throw MeshImportError("File is not a PLY file!");
+            first = false;
+            continue;
+        }
+        if (tokens.empty() || tokens[0] == "comment" || tokens[0] == "obj_info")
+            continue;
+        if (tokens[0] == "end_header") {
+            headerEnded = true;
+        }
+        else if (tokens[0] == "format" && tokens.size() >= 2) {
+            if (tokens[1] == "ascii")                     format = PlyFormat::Ascii;
+            else if (tokens[1] == "binary_little_endian") format = PlyFormat::BinaryLittleEndian;
+            else if (tokens[1] == "binary_big_endian")    format = PlyFormat::BinaryBigEndian;
+            else throw MeshImportError("Unknown PLY format " + std::string(tokens[1]) + "!");
+            formatFound = true;
+        }
+        else if (tokens[0] == "element" && tokens.size() == 3) {
+            PlyElement element;
+            element.name = tokens[1];
+            const char* p = tokens[2].data();
+            if (!parseNumber(p, tokens[2].data() + tokens[2].size(), element.count))
+                throw MeshImportError("Invalid PLY element count!");
+            elements.push_back(std::move(element));
+        }
+        else if (tokens[0] == "property" && !elements.empty()) {
+            PlyElement& element = elements.back();
+            PlyProperty property;
+            if (tokens.size() == 5 && tokens[1] == "list") {
+                if (!parsePlyType(tokens[2], property.countType) || !parsePlyType(tokens[3], property.type))
+                    throw MeshImportError("Invalid PLY list property type!");
+                property.list = true;
+                property.name = tokens[4];
+                element.fixedSize = false;
+            }
+            else if (tokens.size() == 3) {
+                if (!parsePlyType(tokens[1], property.type))
+                    throw MeshImportError("Invalid PLY property type " + std::string(tokens[1]) + "!");
+                property.name = tokens[2];
+                property.offset = element.stride;
+                element.stride += plyTypeSize(property.type);
+            }
+            else {
+                throw MeshImportError("Invalid PLY property!");
+            }
+            element.properties.push_back(std::move(property));
+        }
+        else {
+            throw MeshImportError("Invalid PLY header line!");
+        }
+    }
+    if (!headerEnded || !formatFound)
+        throw MeshImportError("PLY header is incomplete!");
+    const char* body = std::min(line, fileEnd);
+
+    auto vertexIt = std::find_if(elements.begin(), elements.end(), [](const PlyElement& e) { return e.name == "vertex"; });
+    if (vertexIt == elements.end())
+        throw MeshImportError("PLY file has no vertex element!");
+    if (vertexIt->count > 0xFFFFFFFFull)
+        throw MeshImportError("PLY file has too many vertices!");
+
+    // vertex layout from the properties present
+    bool roles[kRoleCount] = {};
+    PlyVertexWriter writer;
+    writer.element = &*vertexIt;
+    for (PlyProperty& property : vertexIt->properties) {
+        if (property.list)
+            continue;
+        property.role = plyRole(property.name);
+        if (property.role == kIgnored)
+            continue;
+        roles[property.role] = true;
+        if (property.role >= kRed)
+            writer.colorsAreFloat[property.role - kRed] = plyTypeIsFloat(property.type);
+    }
+    if (!roles[kPositionX] || !roles[kPositionY] || !roles[kPositionZ])
+        throw MeshImportError("PLY vertices have no x, y and z properties!");
+
+    MeshData mesh;
+    writer.mesh = &mesh;
+    writer.layout = makeLayout(roles[kNormalX] || roles[kNormalY] || roles[kNormalZ], roles[kU] || roles[kV],
+                               roles[kRed] || roles[kGreen] || roles[kBlue], mesh);
+    mesh.vertexCount = (uint32_t)vertexIt->count;
+    mesh.vertices.resize((size_t)mesh.vertexCount * mesh.stride);
+
+    std::vector<uint32_t> indices;
+    if (format == PlyFormat::Ascii) {
+        // every record is one non-blank line, chunks learn the number of their first record from a counting pass
+        std::vector<TextRange> ranges = splitLines(body, fileEnd, settings.chunkSize);
+        std::vector<size_t> firstRecord(ranges.size() + 1, 0);
+        pool.parallelFor(ranges.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                firstRecord[i + 1] = countRecords(ranges[i]);
+        });
+        for (size_t i = 1; i < firstRecord.size(); i++)
+            firstRecord[i] += firstRecord[i - 1];
+
+        std::vector<size_t> elementStart(elements.size() + 1, 0);
+        for (size_t i = 0; i < elements.size(); i++)
+            elementStart[i + 1] = elementStart[i] + elements[i].count;
+        if (firstRecord.back() < elementStart.back())
+            throw MeshImportError("PLY file has " + std::to_string(firstRecord.back()) + " records but its header declares " +
+                                  std::to_string(elementStart.back()) + "!");
+
+        std::vector<std::vector<uint32_t>> chunkIndices(ranges.size());
+        pool.parallelFor(ranges.size(), 1, [&](size_t begin, size_t end) {
+            double values[kRoleCount];
+            std::vector<int64_t> face;
+            for (size_t c = begin; c < end; c++) {
+                size_t record = firstRecord[c];
+                const char* line = ranges[c].begin;
+                while (line < ranges[c].end) {
+                    const char* lineEndPtr = lineEnd(line, ranges[c].end);
+                    if (skipSpaces(line, lineEndPtr) == lineEndPtr) {
+                        line = lineEndPtr + 1;
+                        continue;
+                    }
+                    size_t e = std::upper_bound(elementStart.begin(), elementStart.end(), record) - elementStart.begin() - 1;
+                    if (e < elements.size()) {
+                        const PlyElement& element = elements[e];
+                        bool isVertex = &element == &*vertexIt;
+                        bool isFace = element.name == "face";
+                        if (isVertex || isFace) {
+                            const char* p = line;
+                            writer.reset(values);
+                            for (const PlyProperty& property : element.properties) {
+                                if (property.list) {
+                                    size_t count;
+                                    if (!parseNumber(p, lineEndPtr, count))
+                                        throw MeshImportError("Invalid PLY list in line " + excerpt(line, lineEndPtr) + "!");
+                                    face.clear();
+                                    for (size_t i = 0; i < count; i++) {
+                                        double value;
+                                        if (!parseNumber(p, lineEndPtr, value))
+                                            throw MeshImportError("Invalid PLY list in line " + excerpt(line, lineEndPtr) + "!");
+                                        face.push_back((int64_t)value);
+                                    }
+                                    if (isFace && isFaceIndexList(property))
+                                        addPlyFace(face, mesh.vertexCount, chunkIndices[c]);
+                                }
+                                else {
+                                    double value;
+                                    if (!parseNumber(p, lineEndPtr, value))
+                                        throw MeshImportError("Invalid PLY value in line " + excerpt(line, lineEndPtr) + "!");
+                                    if (isVertex && property.role != kIgnored)
+                                        values[property.role] = value;
+                                }
+                            }
+                            if (isVertex)
+                                writer.write(record - elementStart[e], values);
+                        }
+                    }
+                    record++;
+                    line = lineEndPtr + 1;
+                }
+            }
+        });
+        for (const std::vector<uint32_t>& chunk : chunkIndices)
+            indices.insert(indices.end(), chunk.begin(), chunk.end());
+    }
+    else {
+        bool swap = format == PlyFormat::BinaryBigEndian;
+        const uint8_t* data = (const uint8_t*)body;
+        const uint8_t* dataEnd = (const uint8_t*)fileEnd;
+        std::vector<int64_t> face;
+        for (const PlyElement& element : elements) {
+            if (&element == &*vertexIt) {
+                if (!element.fixedSize)
+                    throw MeshImportError("List properties in the PLY vertex element are not supported!");
+                if ((uint64_t)element.stride * element.count > (uint64_t)(dataEnd - data))
+                    throw MeshImportError("PLY vertex data is truncated!");
+                // fixed size records convert in parallel straight from the mapping
+                pool.parallelFor(element.count, 1 << 16, [&](size_t begin, size_t end) {
+                    double values[kRoleCount];
+                    for (size_t i = begin; i < end; i++) {
+                        const uint8_t* record = data + i * element.stride;
+                        writer.reset(values);
+                        for (const PlyProperty& property : element.properties)
+                            if (property.role != kIgnored)
+                                values[property.role] = readPly(record + property.offset, property.type, swap);
+                        writer.write(i, values);
+                    }
+                });
+                data += (size_t)element.stride * element.count;
+                continue;
+            }
+            if (element.fixedSize) {
+                if ((uint64_t)element.stride * element.count > (uint64_t)(dataEnd - data))
+                    throw MeshImportError("PLY " + element.name + " data is truncated!");
+                data += (size_t)element.stride * element.count;
+                continue;
+            }
+            // variable size records have to be walked
+            bool isFace = element.name == "face";
+            for (size_t r = 0; r < element.count; r++) {
+                for (const PlyProperty& property : element.properties) {
+                    if (!property.list) {
+                        if (dataEnd - data < plyTypeSize(property.type))
+                            throw MeshImportError("PLY " + element.name + " data is truncated!");
+                        data += plyTypeSize(property.type);
+                        continue;
+                    }
+                    int countSize = plyTypeSize(property.countType), itemSize = plyTypeSize(property.type);
+                    if (dataEnd - data < countSize)
+                        throw MeshImportError("PLY " + element.name + " data is truncated!");
+                    size_t count = (size_t)readPly(data, property.countType, swap);
+                    data += countSize;
+                    if ((uint64_t)(dataEnd - data) < (uint64_t)count * itemSize)
+                        throw MeshImportError("PLY " + element.name + " data is truncated!");
+                    if (isFace && isFaceIndexList(property)) {
+                        face.resize(count);
+                        for (size_t i = 0; i < count; i++)
+                            face[i] = (int64_t)readPly(data + i * itemSize, property.type, swap);
+                        addPlyFace(face, mesh.vertexCount, indices);
+                    }
+                    data += count * itemSize;
+                }
+            }
+        }
+    }
+
+    if (!indices.empty())
+        setIndices(mesh, indices);
+    computeBounds(mesh, pool);
+    return mesh;
+}
+
+MeshData importMesh(const std::string& path, const MeshImportSettings& settings, ThreadPool& pool) {
+    std::string extension = path.substr(std::min(path.find_last_of('.'), path.size()));
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    if (extension == ".obj")
+        return importObj(path, settings, pool);
+    if (extension == ".ply")
+        return importPly(path, settings, pool);
+    throw std::invalid_argument("Unsupported mesh file extension: " + path + "!");
+}
+
+}
@@ -0,0 +1,311 @@
+#include <GLA/occlusionQueries.h>
+
+#include <GLA/shader.h>
+#include <GLA/debug.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    const char* kProxyVertexShader = R"(#version 430 core
+
+struct Box {
+    vec4 minimum;
+    vec4 maximum;
+};
+
+layout(std430, binding = 0) readonly buffer Boxes { Box boxes[]; };
+
+uniform mat4 uViewProjection;
+
+// two triangles per face, corner bits are x = 1, y = 2, z = 4
+const int kCorners[36] = int[](
+    0, 2, 6, 0, 6, 4,   1, 5, 7, 1, 7, 3,
+    0, 4, 5, 0, 5, 1,   2, 3, 7, 2, 7, 6,
+    0, 1, 3, 0, 3, 2,   4, 6, 7, 4, 7, 5
+);
+
+void main() {
+    Box box = boxes[gl_VertexID / 36];
+    int corner = kCorners[gl_VertexID % 36];
+    vec3 position = mix(box.minimum.xyz, box.maximum.xyz, vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1));
+    gl_Position = uViewProjection * vec4(position, 1.0);
+}
+)";
+
+    const char* kProxyFragmentShader = R"(#version 430 core
+
+void main() {}
+)";
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class QueryPool
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void QueryPool::_delete() {
+    if (!_queries.empty())
+        GL_CALL(glDeleteQueries((GLsizei)_queries.size(), _queries.data()));
+    _queries.clear();
+    _free.clear();
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+QueryPool::QueryPool(int batchSize) : _batchSize(batchSize) {
+    if (batchSize <= 0)
+        throw std::invalid_argument("batchSize must be greater than 0!");
+}
+
+QueryPool::QueryPool(QueryPool&& other)
+    : _queries(std::move(other._queries)), _free(std::move(other._free)), _batchSize(other._batchSize) {
+    other._queries.clear();
+    other._free.clear();
+}
+
+QueryPool::~QueryPool() noexcept { _delete(); }
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+unsigned int QueryPool::acquire() {
+    if (_free.empty()) {
+        size_t first = _queries.size();
+        _queries.resize(first + _batchSize);
+        GL_CALL(glGenQueries(_batchSize, _queries.data() + first));
+        _free.assign(_queries.rbegin(), _queries.rbegin() + _batchSize);
+    }
+    unsigned int query = _free.back();
+    _free.pop_back();
+    return query;
+}
+
+void QueryPool::release(unsigned int query) {
+    _free.push_back(query);
+}
+
+// --------------------------------------------------
+// operator overloads
+// --------------------------------------------------
+
+QueryPool& QueryPool::operator=(QueryPool&& other) {
+    if (this != &other) {
+        _delete();
+        _queries = std::move(other._queries);
+        _free = std::move(other._free);
+        _batchSize = other._batchSize;
+        other._queries.clear();
+        other._free.clear();
+    }
+    return *this;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class OcclusionQueries
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+OcclusionQueries::Object& OcclusionQueries::_get(OcclusionObject object) {
+    if (object >= _objects.size() || !_objects[object].alive)
+        throw std::out_of_range("Invalid OcclusionObject " + std::to_string(object) + "!");
+    return _objects[object];
+}
+
+const OcclusionQueries::Object& OcclusionQueries::_get(OcclusionObject object) const {
+    if (object >= _objects.size() || !_objects[object].alive)
+        throw std::out_of_range("Invalid OcclusionObject " + std::to_string(object) + "!");
+    return _objects[object];
+}
+
+void OcclusionQueries::_releaseLatest(Object& object) {
+    // a pending latest query is released once its result was read
+    if (object.latest != 0 && std::find(object.pending.begin(), object.pending.end(), object.latest) == object.pending.end())
+        _pool.release(object.latest);
+    object.latest = 0;
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+OcclusionQueries::OcclusionQueries(const OcclusionSettings& settings)
+    : _settings(settings), _ring(BufferType::ShaderStorage, (int64_t)std::max(settings.maxQueriesPerFrame, 1) * sizeof(Box) + 512) {
+    if (settings.maxQueriesPerFrame <= 0)
+        throw std::invalid_argument("maxQueriesPerFrame must be greater than 0!");
+    if (settings.maxQueriesInFlight <= 0)
+        throw std::invalid_argument("maxQueriesInFlight must be greater than 0!");
+
+    Shader vertex(ShaderType::Vertex, kProxyVertexShader);
+    Shader fragment(ShaderType::Fragment, kProxyFragmentShader);
+    _program.attach(vertex);
+    _program.attach(fragment);
+    _program.link();
+
+    GLint alignment = 256;
+    GL_CALL(glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    _storageAlignment = std::max(alignment, 1);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+OcclusionObject OcclusionQueries::create() {
+    OcclusionObject object;
+    if (!_freeObjects.empty()) {
+        object = _freeObjects.back();
+        _freeObjects.pop_back();
+    }
+    else {
+        object = (OcclusionObject)_objects.size();
+        _objects.emplace_back();
+    }
+    _objects[object].alive = true;
+    _objects[object].visible = true;
+    return object;
+}
+
+void OcclusionQueries::destroy(OcclusionObject object) {
+    Object& entry = _get(object);
+    _releaseLatest(entry);
+    for (unsigned int query : entry.pending)
+        _pool.release(query);
+    entry.pending.clear();
+    entry.alive = false;
+    _freeObjects.push_back(object);
+}
+
+void OcclusionQueries::beginFrame(const glm::mat4& viewProjection) {
+    _viewProjection = viewProjection;
+    _boxes.clear();
+    _boxObjects.clear();
+
+    // results arrive in issue order, so polling stops at the first one that isn't available
+    for (Object& object : _objects) {
+        while (!object.pending.empty()) {
+            unsigned int query = object.pending.front();
+            GLuint available = GL_FALSE;
+            GL_CALL(glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available));
+            if (!available)
+                break;
+            GLuint samples = 0;
+            GL_CALL(glGetQueryObjectuiv(query, GL_QUERY_RESULT, &samples));
+            object.visible = samples != 0;
+            object.pending.erase(object.pending.begin());
+            if (query != object.latest)
+                _pool.release(query);
+        }
+    }
+}
+
+void OcclusionQueries::query(OcclusionObject object, const glm::vec3& min, const glm::vec3& max) {
+    Object& entry = _get(object);
+    if (_boxes.size() >= (size_t)_settings.maxQueriesPerFrame)
+        throw std::runtime_error("More than maxQueriesPerFrame occlusion queries were queued in one frame!");
+    if (entry.pending.size() >= (size_t)_settings.maxQueriesInFlight)
+        return;
+
+    glm::vec3 low = min - _settings.boxInflation;
+    glm::vec3 high = max + _settings.boxInflation;
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec4 clip = _viewProjection * glm::vec4(corner & 1 ? high.x : low.x, corner & 2 ? high.y : low.y, corner & 4 ? high.z : low.z, 1.0f);
+        if (clip.w <= 0.0f || clip.z < -clip.w) {
+            entry.visible = true;
+            _releaseLatest(entry);
+            return;
+        }
+    }
+
+    _boxes.push_back({ glm::vec4(low, 1.0f), glm::vec4(high, 1.0f) });
+    _boxObjects.push_back(object);
+}
+
+void OcclusionQueries::flush() {
+    if (_boxes.empty())
+        return;
+
+    GLboolean depthTest, depthMask, cullFace, colorMask[4];
+    GL_CALL(glGetBooleanv(GL_DEPTH_TEST, &depthTest));
+    GL_CALL(glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask));
+    GL_CALL(glGetBooleanv(GL_CULL_FACE, &cullFace));
+    GL_CALL(glGetBooleanv(GL_COLOR_WRITEMASK, colorMask));
+
+    _program.bind();
+    _program["uViewProjection"] = _viewProjection;
+
+    _ring.beginFrame();
+    int64_t bytes = (int64_t)(_boxes.size() * sizeof(Box));
+    RingAllocation allocation = _ring.allocate(bytes, _storageAlignment);
+    std::memcpy(allocation.data, _boxes.data(), bytes);
+    _ring.buffer().bindRange(0, allocation.offset, allocation.size);
+
+    GL_CALL(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+    GL_CALL(glDepthMask(GL_FALSE));
+    GL_CALL(glEnable(GL_DEPTH_TEST));
+    GL_CALL(glDisable(GL_CULL_FACE));
+
+    for (size_t i = 0; i < _boxes.size(); i++) {
+        Object& object = _objects[_boxObjects[i]];
+        if (!object.alive)
+            continue;
+        _releaseLatest(object);
+        object.latest = _pool.acquire();
+        object.pending.push_back(object.latest);
+        GL_CALL(glBeginQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE, object.latest));
+        GL_CALL(glDrawArrays(GL_TRIANGLES, (GLint)(i * 36), 36));
+        GL_CALL(glEndQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE));
+    }
+    _ring.endFrame();
+
+    GL_CALL(glColorMask(colorMask[0], colorMask[1], colorMask[2], colorMask[3]));
+    GL_CALL(glDepthMask(depthMask));
+    if (!depthTest)
+        GL_CALL(glDisable(GL_DEPTH_TEST));
+    if (cullFace)
+        GL_CALL(glEnable(GL_CULL_FACE));
+
+    _boxes.clear();
+    _boxObjects.clear();
+}
+
+bool OcclusionQueries::visible(OcclusionObject object) const {
+    return _get(object).visible;
+}
+
+void OcclusionQueries::beginConditionalRender(OcclusionObject object) {
+    const Object& entry = _get(object);
+    if (_conditional)
+        throw std::logic_error("Conditional rendering is already active!");
+    _conditional = true;
+    _conditionalQuery = entry.latest != 0;
+    if (_conditionalQuery)
+        GL_CALL(glBeginConditionalRender(entry.latest, GL_QUERY_NO_WAIT));
+}
+
+void OcclusionQueries::endConditionalRender() {
+    if (!_conditional)
+        throw std::logic_error("Conditional rendering is not active!");
+    if (_conditionalQuery)
+        GL_CALL(glEndConditionalRender());
+    _conditional = false;
+    _conditionalQuery = false;
+}
+
+}
@@ -0,0 +1,446 @@
+#include <GLA/particleSystem.h>
+
+#include <GLA/shader.h>
+#include <GLA/debug.h>
+
+#include <string>
+#include <numeric>
+#include <algorithm>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    // bindings shared by all particle shaders
+    // shader storage: 0 particles, 1 alive current, 2 alive next, 3 dead list, 4 indirect arguments, 5 counters, 6 sort entries
+    // atomic counter: 0 counters (alive current, alive next, dead)
+
+    const char* kParticleCommon = R"(#version 430 core
+
+struct Particle {
+    vec3 position;
+    float age;
+    vec3 velocity;
+    float lifetime;
+    vec4 colorStart;
+    vec4 colorEnd;
+    vec2 size;
+    vec2 padding;
+};
+
+struct SortEntry {
+    float key;
+    uint index;
+};
+
+layout(std430, binding = 0) buffer Particles { Particle particles[]; };
+)";
+
+    const char* kEmitShader = R"(
+layout(local_size_x = 64) in;
+
+layout(std430, binding = 1) writeonly buffer AliveCurrent { uint aliveCurrent[]; };
+layout(std430, binding = 3) readonly buffer DeadList { uint deadList[]; };
+layout(binding = 0, offset = 0) uniform atomic_uint aliveCount;
+layout(binding = 0, offset = 8) uniform atomic_uint deadCount;
+
+uniform uint uCount;
+uniform uint uSeed;
+uniform uint uMaxParticles;
+uniform vec3 uPosition;
+uniform float uPositionSpread;
+uniform vec3 uVelocity;
+uniform float uVelocitySpread;
+uniform vec4 uColorStart;
+uniform vec4 uColorEnd;
+uniform vec2 uSize;
+uniform vec2 uLifetime;
+
+uint hash(uint x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float random(inout uint state) {
+    state = hash(state);
+    return float(state) / 4294967295.0;
+}
+
+vec3 randomInSphere(inout uint state) {
+    float z = random(state) * 2.0 - 1.0;
+    float angle = random(state) * 6.28318530718;
+    float r = sqrt(max(1.0 - z * z, 0.0));
+    return vec3(r * cos(angle), r * sin(angle), z) * pow(random(state), 1.0 / 3.0);
+}
+
+void main() {
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= uCount)
+        return;
+
+    // allocate a slot, the counter wraps if the pool is exhausted
+    uint dead = atomicCounterDecrement(deadCount);
+    if (dead >= uMaxParticles) {
+        atomicCounterIncrement(deadCount);
+        return;
+    }
+    uint slot = deadList[dead];
+
+    uint state = hash(id ^ hash(uSeed));
+    Particle p;
+    p.position = uPosition + randomInSphere(state) * uPositionSpread;
+    p.age = 0.0;
+    p.velocity = uVelocity + randomInSphere(state) * uVelocitySpread;
+    p.lifetime = max(uLifetime.x + (random(state) * 2.0 - 1.0) * uLifetime.y, 1e-3);
+    p.colorStart = uColorStart;
+    p.colorEnd = uColorEnd;
+    p.size = uSize;
+    p.padding = vec2(0.0);
+    particles[slot] = p;
+
+    aliveCurrent[atomicCounterIncrement(aliveCount)] = slot;
+}
+)";
+
+    const char* kPrepareShader = R"(
+layout(local_size_x = 1) in;
+
+layout(std430, binding = 4) buffer Indirect {
+    uint dispatchX, dispatchY, dispatchZ, dispatchPadding;
+    uint drawCount, instanceCount, drawFirst, drawBaseInstance;
+};
+layout(binding = 0, offset = 0) uniform atomic_uint aliveCount;
+
+void main() {
+    dispatchX = (atomicCounter(aliveCount) + 255u) / 256u;
+    dispatchY = 1u;
+    dispatchZ = 1u;
+}
+)";
+
+    const char* kSimulateShader = R"(
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 1) readonly buffer AliveCurrent { uint aliveCurrent[]; };
+layout(std430, binding = 2) writeonly buffer AliveNext { uint aliveNext[]; };
+layout(std430, binding = 3) writeonly buffer DeadList { uint deadList[]; };
+layout(binding = 0, offset = 0) uniform atomic_uint aliveCount;
+layout(binding = 0, offset = 4) uniform atomic_uint aliveNextCount;
+layout(binding = 0, offset = 8) uniform atomic_uint deadCount;
+
+uniform float uDeltaTime;
+uniform vec3 uGravity;
+uniform float uDrag;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= atomicCounter(aliveCount))
+        return;
+
+    uint slot = aliveCurrent[i];
+    float age = particles[slot].age + uDeltaTime;
+    if (age >= particles[slot].lifetime) {
+        deadList[atomicCounterIncrement(deadCount)] = slot;
+        return;
+    }
+
+    vec3 velocity = particles[slot].velocity + uGravity * uDeltaTime;
+    velocity *= max(1.0 - uDrag * uDeltaTime, 0.0);
+    particles[slot].position += velocity * uDeltaTime;
+    particles[slot].velocity = velocity;
+    particles[slot].age = age;
+
+    aliveNext[atomicCounterIncrement(aliveNextCount)] = slot;
+}
+)";
+
+    const char* kFinalizeShader = R"(
+layout(local_size_x = 1) in;
+
+layout(std430, binding = 4) buffer Indirect {
+    uint dispatchX, dispatchY, dispatchZ, dispatchPadding;
+    uint drawCount, instanceCount, drawFirst, drawBaseInstance;
+};
+layout(std430, binding = 5) buffer Counters { uint aliveCount, aliveNextCount, deadCount, counterPadding; };
+
+void main() {
+    aliveCount = aliveNextCount;
+    aliveNextCount = 0u;
+    drawCount = 4u;
+    instanceCount = aliveCount;
+    drawFirst = 0u;
+    drawBaseInstance = 0u;
+}
+)";
+
+    const char* kSortKeyShader = R"(
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 1) readonly buffer Alive { uint alive[]; };
+layout(std430, binding = 5) readonly buffer Counters { uint aliveCount, aliveNextCount, deadCount, counterPadding; };
+layout(std430, binding = 6) writeonly buffer Sort { SortEntry entries[]; };
+
+uniform mat4 uView;
+uniform uint uCapacity;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= uCapacity)
+        return;
+    if (i < aliveCount) {
+        uint slot = alive[i];
+        // view space z is negative in front of the camera, ascending order draws far particles first
+        entries[i] = SortEntry((uView * vec4(particles[slot].position, 1.0)).z, slot);
+    }
+    else {
+        entries[i] = SortEntry(3.402823e38, 0u);
+    }
+}
+)";
+
+    const char* kSortShader = R"(
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 6) buffer Sort { SortEntry entries[]; };
+
+uniform uint uBlock;
+uniform uint uDistance;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    uint partner = i ^ uDistance;
+    if (partner <= i)
+        return;
+    SortEntry a = entries[i];
+    SortEntry b = entries[partner];
+    bool ascending = (i & uBlock) == 0u;
+    if ((a.key > b.key) == ascending) {
+        entries[i] = b;
+        entries[partner] = a;
+    }
+}
+)";
+
+    const char* kRenderVertexShader = R"(
+layout(std430, binding = 1) readonly buffer Alive { uint alive[]; };
+layout(std430, binding = 6) readonly buffer Sort { SortEntry entries[]; };
+
+uniform mat4 uView;
+uniform mat4 uProjection;
+uniform uint uSorted;
+
+out vec4 vColor;
+out vec2 vCorner;
+
+void main() {
+    uint slot = uSorted != 0u ? entries[gl_InstanceID].index : alive[gl_InstanceID];
+    Particle p = particles[slot];
+    float t = clamp(p.age / p.lifetime, 0.0, 1.0);
+
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    vec4 viewPosition = uView * vec4(p.position, 1.0);
+    viewPosition.xy += corner * mix(p.size.x, p.size.y, t) * 0.5;
+
+    gl_Position = uProjection * viewPosition;
+    vColor = mix(p.colorStart, p.colorEnd, t);
+    vCorner = corner;
+}
+)";
+
+    const char* kRenderFragmentShader = R"(#version 430 core
+
+in vec4 vColor;
+in vec2 vCorner;
+
+layout(location = 0) out vec4 color;
+
+void main() {
+    float falloff = 1.0 - smoothstep(0.6, 1.0, length(vCorner));
+    if (falloff <= 0.0)
+        discard;
+    color = vec4(vColor.rgb, vColor.a * falloff);
+}
+)";
+
+    void buildCompute(Program& program, const char* source) {
+        Shader compute(ShaderType::Compute, std::string(kParticleCommon) + source);
+        program.attach(compute);
+        program.link();
+    }
+
+    unsigned int nextPowerOfTwo(unsigned int value) {
+        unsigned int result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class ParticleSystem
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void ParticleSystem::_bindLists() const {
+    _particles.bindBase(0);
+    _aliveLists[_current].bindBase(1);
+    _aliveLists[1 - _current].bindBase(2);
+    _deadList.bindBase(3);
+    _indirect.bindBase(BufferType::ShaderStorage, 4);
+    _counters.bindBase(0);
+    _counters.bindBase(BufferType::ShaderStorage, 5);
+    if (_settings.depthSort)
+        _sortKeys.bindBase(6);
+}
+
+void ParticleSystem::_sort(const glm::mat4& view) {
+    _bindLists();
+
+    _sortKeyProgram.bind();
+    _sortKeyProgram["uView"] = view;
+    _sortKeyProgram["uCapacity"] = _sortCapacity;
+    GL_CALL(glDispatchCompute(_sortCapacity / 256, 1, 1));
+
+    _sortProgram.bind();
+    int blockLocation = _sortProgram.getUniformLocation("uBlock");
+    int distanceLocation = _sortProgram.getUniformLocation("uDistance");
+    for (unsigned int block = 2; block <= _sortCapacity; block <<= 1) {
+        for (unsigned int distance = block >> 1; distance > 0; distance >>= 1) {
+            GL_CALL(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+            _sortProgram.setUniform(blockLocation, block);
+            _sortProgram.setUniform(distanceLocation, distance);
+            GL_CALL(glDispatchCompute(_sortCapacity / 256, 1, 1));
+        }
+    }
+    GL_CALL(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+ParticleSystem::ParticleSystem(const ParticleSystemSettings& settings)
+    : _settings(settings), _particles(BufferType::ShaderStorage),
+      _aliveLists{ Buffer(BufferType::ShaderStorage), Buffer(BufferType::ShaderStorage) },
+      _deadList(BufferType::ShaderStorage), _counters(BufferType::AtomicCounter),
+      _indirect(BufferType::DrawIndirect), _sortKeys(BufferType::ShaderStorage) {
+    if (settings.maxParticles == 0)
+        throw std::invalid_argument("maxParticles must be greater than 0!");
+
+    const int64_t particleSize = 80; // sizeof(Particle) in std430
+    unsigned int count = settings.maxParticles;
+    _particles.setStorage(particleSize * count, nullptr, BufferFlag::None);
+    _aliveLists[0].setStorage(sizeof(uint32_t) * count, nullptr, BufferFlag::None);
+    _aliveLists[1].setStorage(sizeof(uint32_t) * count, nullptr, BufferFlag::None);
+
+    // the only upload ever made: every slot starts out dead
+    std::vector<uint32_t> dead(count);
+    std::iota(dead.begin(), dead.end(), 0u);
+    _deadList.setStorage(dead, BufferFlag::None);
+
+    std::vector<uint32_t> counters = { 0u, 0u, count, 0u };
+    _counters.setStorage(counters, BufferFlag::None);
+
+    std::vector<uint32_t> indirect = { 0u, 1u, 1u, 0u, 4u, 0u, 0u, 0u };
+    _indirect.setStorage(indirect, BufferFlag::None);
+
+    if (settings.depthSort) {
+        _sortCapacity = std::max(nextPowerOfTwo(count), 256u);
+        _sortKeys.setStorage(2 * sizeof(uint32_t) * (int64_t)_sortCapacity, nullptr, BufferFlag::None);
+        buildCompute(_sortKeyProgram, kSortKeyShader);
+        buildCompute(_sortProgram, kSortShader);
+    }
+
+    buildCompute(_emitProgram, kEmitShader);
+    buildCompute(_prepareProgram, kPrepareShader);
+    buildCompute(_simulateProgram, kSimulateShader);
+    buildCompute(_finalizeProgram, kFinalizeShader);
+
+    Shader vertex(ShaderType::Vertex, std::string(kParticleCommon) + kRenderVertexShader);
+    Shader fragment(ShaderType::Fragment, kRenderFragmentShader);
+    _renderProgram.attach(vertex);
+    _renderProgram.attach(fragment);
+    _renderProgram.link();
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void ParticleSystem::emit(const ParticleEmitter& emitter, unsigned int count) {
+    if (count > 0)
+        _emissions.push_back({ emitter, std::min(count, _settings.maxParticles) });
+}
+
+void ParticleSystem::update(float deltaTime, const glm::vec3& gravity, float drag) {
+    _bindLists();
+
+    if (!_emissions.empty()) {
+        _emitProgram.bind();
+        _emitProgram["uMaxParticles"] = _settings.maxParticles;
+        for (const Emission& emission : _emissions) {
+            const ParticleEmitter& e = emission.emitter;
+            _emitProgram["uCount"] = emission.count;
+            _emitProgram["uSeed"] = _seed++;
+            _emitProgram["uPosition"] = e.position;
+            _emitProgram["uPositionSpread"] = e.positionSpread;
+            _emitProgram["uVelocity"] = e.velocity;
+            _emitProgram["uVelocitySpread"] = e.velocitySpread;
+            _emitProgram["uColorStart"] = e.colorStart;
+            _emitProgram["uColorEnd"] = e.colorEnd;
+            _emitProgram["uSize"] = glm::vec2(e.sizeStart, e.sizeEnd);
+            _emitProgram["uLifetime"] = glm::vec2(e.lifetime, e.lifetimeSpread);
+            GL_CALL(glDispatchCompute((emission.count + 63) / 64, 1, 1));
+            GL_CALL(glMemoryBarrier(GL_ATOMIC_COUNTER_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT));
+        }
+        _emissions.clear();
+    }
+
+    _prepareProgram.bind();
+    GL_CALL(glDispatchCompute(1, 1, 1));
+    GL_CALL(glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT));
+
+    _simulateProgram.bind();
+    _simulateProgram["uDeltaTime"] = deltaTime;
+    _simulateProgram["uGravity"] = gravity;
+    _simulateProgram["uDrag"] = drag;
+    _indirect.bind(BufferType::DispatchIndirect);
+    GL_CALL(glDispatchComputeIndirect(0));
+    GL_CALL(glMemoryBarrier(GL_ATOMIC_COUNTER_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT));
+
+    _finalizeProgram.bind();
+    GL_CALL(glDispatchCompute(1, 1, 1));
+    GL_CALL(glMemoryBarrier(GL_ATOMIC_COUNTER_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT));
+
+    // the survivors are in the other list now
+    _current = 1 - _current;
+}
+
+void ParticleSystem::render(const glm::mat4& view, const glm::mat4& projection) {
+    if (_settings.depthSort)
+        _sort(view);
+    else
+        _bindLists();
+
+    _renderProgram.bind();
+    _renderProgram["uView"] = view;
+    _renderProgram["uProjection"] = projection;
+    _renderProgram["uSorted"] = _settings.depthSort ? 1u : 0u;
+
+    // draw arguments start after the dispatch arguments
+    _indirect.bind(BufferType::DrawIndirect);
+    GL_CALL(glDrawArraysIndirect(GL_TRIANGLE_STRIP, (const void*)(4 * sizeof(uint32_t))));
+}
+
+}
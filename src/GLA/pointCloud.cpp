@@ -0,0 +1,867 @@
+#include <GLA/pointCloud.h>
+
+#include <GLA/debug.h>
+#include <GLA/shader.h>
+
+#include <array>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <limits>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    // bytes a subtree built in memory needs per point: the source point, its cell, the copy passed on to a child
+    // with the slack of its growing vector and the quantized point
+    const uint64_t kBuildBytesPerPoint = 80;
+    // points read from or buffered for a spill file at once
+    const size_t kSpillBatch = 1 << 16;
+
+    struct BuildNode {
+        uint32_t parent = UINT32_MAX;
+        uint32_t octant = 0;
+        uint32_t level = 0;
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        float size = 0.0f;
+        float spacing = 0.0f;
+        std::vector<PointCloudSourcePoint> points;
+        std::vector<PointCloudPoint> stored;
+        std::array<std::vector<PointCloudSourcePoint>, 8> children;
+    };
+
+    // node whose points wait in a spill file
+    struct SpillNode {
+        std::string path;
+        uint64_t count = 0;
+        uint32_t parent = UINT32_MAX;
+        uint32_t octant = 0;
+        uint32_t level = 0;
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        float size = 0.0f;
+    };
+
+    // creates the spill files of one build and deletes the ones left over when it fails
+    class SpillFiles {
+    private:
+        std::filesystem::path _prefix;
+        std::vector<std::string> _paths;
+        uint64_t _counter = 0;
+
+    public:
+        SpillFiles(const std::string& output, const std::string& directory) {
+            std::filesystem::path path(output);
+            _prefix = directory.empty() ? path : std::filesystem::path(directory) / path.filename();
+        }
+
+        ~SpillFiles() {
+            std::error_code error;
+            for (const std::string& path : _paths)
+                std::filesystem::remove(path, error);
+        }
+
+        std::string create() {
+            _paths.push_back(_prefix.string() + "." + std::to_string(_counter++) + ".spill");
+            return _paths.back();
+        }
+
+        void remove(const std::string& path) {
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            _paths.erase(std::remove(_paths.begin(), _paths.end(), path), _paths.end());
+        }
+    };
+
+    class SpillWriter {
+    private:
+        std::string _path;
+        std::ofstream _file;
+        std::vector<PointCloudSourcePoint> _buffer;
+
+    public:
+        uint64_t count = 0;
+
+        SpillWriter(const std::string& path) : _path(path), _file(path, std::ios::binary | std::ios::trunc) {
+            if (!_file)
+                throw std::runtime_error("Could not open spill file for writing: " + path + "!");
+            _buffer.reserve(kSpillBatch);
+        }
+
+        void push(const PointCloudSourcePoint& point) {
+            _buffer.push_back(point);
+            count++;
+            if (_buffer.size() == kSpillBatch)
+                flush();
+        }
+
+        void flush() {
+            _file.write((const char*)_buffer.data(), (std::streamsize)(_buffer.size() * sizeof(PointCloudSourcePoint)));
+            _buffer.clear();
+            if (!_file)
+                throw std::runtime_error("Could not write spill file: " + _path + "!");
+        }
+    };
+
+    // reads the points of a spill file in batches of kSpillBatch, passing the index of the first point of every batch
+    template <typename Consume>
+    void readSpill(const SpillNode& node, Consume&& consume) {
+        std::ifstream file(node.path, std::ios::binary);
+        std::vector<PointCloudSourcePoint> batch;
+        for (uint64_t first = 0; first < node.count; first += batch.size()) {
+            batch.resize((size_t)std::min<uint64_t>(node.count - first, kSpillBatch));
+            if (!file.read((char*)batch.data(), (std::streamsize)(batch.size() * sizeof(PointCloudSourcePoint))))
+                throw std::runtime_error("Could not read spill file: " + node.path + "!");
+            consume(std::span<const PointCloudSourcePoint>(batch), first);
+        }
+    }
+
+    // output file and node table shared by the streamed and the in memory part of the build
+    struct OctreeWriter {
+        std::ofstream& file;
+        uint64_t& position;
+        uint64_t& pointCount;
+        std::vector<PointCloudNode> nodes;                  // in build order, relinked breadth first by breadthFirst()
+        std::vector<std::array<uint32_t, 8>> children;      // build order index of the child per octant, UINT32_MAX if missing
+
+        OctreeWriter(std::ofstream& file, uint64_t& position, uint64_t& pointCount) : file(file), position(position), pointCount(pointCount) {}
+
+        uint32_t addNode(uint32_t parent, uint32_t octant, uint32_t level, const glm::vec3& boundsMin, float size) {
+            PointCloudNode entry = {};
+            entry.firstPoint = pointCount;
+            entry.level = level;
+            std::memcpy(entry.boundsMin, &boundsMin, sizeof(entry.boundsMin));
+            entry.size = size;
+            uint32_t index = (uint32_t)nodes.size();
+            if (parent != UINT32_MAX)
+                children[parent][octant] = index;
+            nodes.push_back(entry);
+            children.emplace_back().fill(UINT32_MAX);
+            return index;
+        }
+
+        // nodes are written one at a time, so consecutive calls for the same node keep its points contiguous
+        void writePoints(uint32_t node, std::span<const PointCloudPoint> points) {
+            file.write((const char*)points.data(), (std::streamsize)points.size_bytes());
+            position += points.size_bytes();
+            pointCount += points.size();
+            nodes[node].pointCount += (uint32_t)points.size();
+        }
+
+        // the children of a node are contiguous in breadth first order, the root was added first
+        std::vector<PointCloudNode> breadthFirst() const {
+            std::vector<PointCloudNode> result;
+            std::vector<uint32_t> order = { 0 };
+            std::vector<uint32_t> parents = { UINT32_MAX };
+            result.reserve(nodes.size());
+            for (size_t i = 0; i < order.size(); i++) {
+                PointCloudNode node = nodes[order[i]];
+                node.parent = parents[i];
+                for (uint32_t octant = 0; octant < 8; octant++) {
+                    uint32_t child = children[order[i]][octant];
+                    if (child == UINT32_MAX)
+                        continue;
+                    if (node.childMask == 0)
+                        node.firstChild = (uint32_t)order.size();
+                    node.childMask |= 1u << octant;
+                    order.push_back(child);
+                    parents.push_back((uint32_t)i);
+                }
+                result.push_back(node);
+            }
+            return result;
+        }
+    };
+
+    uint64_t alignUp(uint64_t value) {
+        return (value + kPointCloudAlignment - 1) & ~(kPointCloudAlignment - 1);
+    }
+
+    void writePadding(std::ofstream& file, uint64_t& position) {
+        static const char zeros[kPointCloudAlignment] = {};
+        uint64_t aligned = alignUp(position);
+        file.write(zeros, (std::streamsize)(aligned - position));
+        position = aligned;
+    }
+
+    PointCloudPoint quantize(const PointCloudSourcePoint& point, const glm::vec3& boundsMin, float size) {
+        glm::vec3 q = glm::clamp((point.position - boundsMin) / size * 65535.0f + 0.5f, glm::vec3(0.0f), glm::vec3(65535.0f));
+        PointCloudPoint result;
+        result.position[0] = (uint16_t)q.x;
+        result.position[1] = (uint16_t)q.y;
+        result.position[2] = (uint16_t)q.z;
+        result.intensity = point.intensity;
+        std::memcpy(result.color, point.color, sizeof(result.color));
+        return result;
+    }
+
+    uint32_t gridCell(const glm::vec3& position, const glm::vec3& boundsMin, float scale, uint32_t grid) {
+        glm::uvec3 cell = glm::min(glm::uvec3(glm::max((position - boundsMin) * scale, 0.0f)), glm::uvec3(grid - 1));
+        return (cell.z * grid + cell.y) * grid + cell.x;
+    }
+
+    uint32_t octantOf(const glm::vec3& position, const glm::vec3& center) {
+        return (position.x >= center.x ? 1 : 0) | (position.y >= center.y ? 2 : 0) | (position.z >= center.z ? 4 : 0);
+    }
+
+    // random but reproducible 31 bit sampling priority of the index-th point of a spill file, splitmix64
+    uint32_t samplePriority(uint64_t index, uint64_t seed) {
+        uint64_t x = index + seed * 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return (uint32_t)((x ^ (x >> 31)) >> 33);
+    }
+
+    float leafSpacing(float size, uint64_t count, uint32_t grid) {
+        return std::min(size / grid, size / std::sqrt((float)count));
+    }
+
+    // inner nodes keep the first point of every occupied grid cell, the source is shuffled so that is a random one
+    void buildNode(BuildNode& node, const PointCloudBuildSettings& settings, ThreadPool& pool) {
+        size_t count = node.points.size();
+        if (count <= settings.maxNodePoints || node.level >= settings.maxDepth) {
+            node.stored.reserve(count);
+            for (const PointCloudSourcePoint& point : node.points)
+                node.stored.push_back(quantize(point, node.boundsMin, node.size));
+            node.spacing = leafSpacing(node.size, count, settings.gridSize);
+            node.points = {};
+            return;
+        }
+
+        uint32_t grid = settings.gridSize;
+        float scale = grid / node.size;
+        std::vector<uint32_t> cells(count);
+        pool.parallelFor(count, 1 << 16, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                cells[i] = gridCell(node.points[i].position, node.boundsMin, scale, grid);
+        });
+
+        glm::vec3 center = node.boundsMin + node.size * 0.5f;
+        std::vector<uint64_t> occupied(((size_t)grid * grid * grid + 63) / 64, 0);
+        for (size_t i = 0; i < count; i++) {
+            uint64_t bit = 1ull << (cells[i] & 63);
+            uint64_t& word = occupied[cells[i] >> 6];
+            const PointCloudSourcePoint& point = node.points[i];
+            if ((word & bit) == 0) {
+                word |= bit;
+                node.stored.push_back(quantize(point, node.boundsMin, node.size));
+                continue;
+            }
+            node.children[octantOf(point.position, center)].push_back(point);
+        }
+        node.spacing = node.size / grid;
+        node.points = {};
+    }
+
+    // builds a node and its whole subtree in memory, level by level
+    void buildSubtree(BuildNode root, OctreeWriter& octree, const PointCloudBuildSettings& settings, ThreadPool& pool) {
+        std::vector<BuildNode> level(1);
+        level[0] = std::move(root);
+        while (!level.empty()) {
+            pool.parallelFor(level.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    buildNode(level[i], settings, pool);
+            });
+
+            std::vector<BuildNode> next;
+            for (BuildNode& node : level) {
+                uint32_t index = octree.addNode(node.parent, node.octant, node.level, node.boundsMin, node.size);
+                octree.nodes[index].spacing = node.spacing;
+                octree.writePoints(index, node.stored);
+                node.stored = {};
+
+                float half = node.size * 0.5f;
+                for (uint32_t octant = 0; octant < 8; octant++) {
+                    if (node.children[octant].empty())
+                        continue;
+                    BuildNode child;
+                    child.parent = index;
+                    child.octant = octant;
+                    child.level = node.level + 1;
+                    child.boundsMin = node.boundsMin + glm::vec3(octant & 1, (octant >> 1) & 1, (octant >> 2) & 1) * half;
+                    child.size = half;
+                    child.points = std::move(node.children[octant]);
+                    next.push_back(std::move(child));
+                }
+            }
+            level = std::move(next);
+        }
+    }
+
+    // quantizes the points of a leaf batch by batch
+    void streamLeaf(const SpillNode& node, OctreeWriter& octree, const PointCloudBuildSettings& settings, ThreadPool& pool) {
+        uint32_t index = octree.addNode(node.parent, node.octant, node.level, node.boundsMin, node.size);
+        octree.nodes[index].spacing = leafSpacing(node.size, node.count, settings.gridSize);
+        std::vector<PointCloudPoint> stored;
+        readSpill(node, [&](std::span<const PointCloudSourcePoint> batch, uint64_t) {
+            stored.resize(batch.size());
+            pool.parallelFor(batch.size(), 1 << 14, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    stored[i] = quantize(batch[i], node.boundsMin, node.size);
+            });
+            octree.writePoints(index, stored);
+        });
+    }
+
+    // the first pass finds the lowest priority per grid cell, the second keeps those points and spills the rest into the octants
+    void streamInner(const SpillNode& node, OctreeWriter& octree, SpillFiles& spills, std::vector<SpillNode>& pending,
+                     const PointCloudBuildSettings& settings, ThreadPool& pool) {
+        uint32_t index = octree.addNode(node.parent, node.octant, node.level, node.boundsMin, node.size);
+        octree.nodes[index].spacing = node.size / settings.gridSize;
+
+        uint32_t grid = settings.gridSize;
+        float scale = grid / node.size;
+        std::vector<uint32_t> lowest((size_t)grid * grid * grid, UINT32_MAX);
+        std::vector<uint32_t> cells(kSpillBatch), priorities(kSpillBatch);
+        auto classify = [&](std::span<const PointCloudSourcePoint> batch, uint64_t first) {
+            pool.parallelFor(batch.size(), 1 << 14, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    cells[i] = gridCell(batch[i].position, node.boundsMin, scale, grid);
+                    priorities[i] = samplePriority(first + i, index);
+                }
+            });
+        };
+
+        readSpill(node, [&](std::span<const PointCloudSourcePoint> batch, uint64_t first) {
+            classify(batch, first);
+            for (size_t i = 0; i < batch.size(); i++)
+                lowest[cells[i]] = std::min(lowest[cells[i]], priorities[i]);
+        });
+
+        // priorities have 31 bits, so UINT32_MAX marks a taken cell and equal priorities keep only one point
+        glm::vec3 center = node.boundsMin + node.size * 0.5f;
+        std::array<std::unique_ptr<SpillWriter>, 8> writers;
+        std::array<SpillNode, 8> children;
+        std::vector<PointCloudPoint> stored;
+        readSpill(node, [&](std::span<const PointCloudSourcePoint> batch, uint64_t first) {
+            classify(batch, first);
+            stored.clear();
+            for (size_t i = 0; i < batch.size(); i++) {
+                if (lowest[cells[i]] == priorities[i]) {
+                    lowest[cells[i]] = UINT32_MAX;
+                    stored.push_back(quantize(batch[i], node.boundsMin, node.size));
+                    continue;
+                }
+                uint32_t octant = octantOf(batch[i].position, center);
+                if (!writers[octant]) {
+                    children[octant].path = spills.create();
+                    writers[octant] = std::make_unique<SpillWriter>(children[octant].path);
+                }
+                writers[octant]->push(batch[i]);
+            }
+            octree.writePoints(index, stored);
+        });
+
+        float half = node.size * 0.5f;
+        for (uint32_t octant = 0; octant < 8; octant++) {
+            if (!writers[octant])
+                continue;
+            writers[octant]->flush();
+            SpillNode& child = children[octant];
+            child.count = writers[octant]->count;
+            child.parent = index;
+            child.octant = octant;
+            child.level = node.level + 1;
+            child.boundsMin = node.boundsMin + glm::vec3(octant & 1, (octant >> 1) & 1, (octant >> 2) & 1) * half;
+            child.size = half;
+            writers[octant].reset();
+            pending.push_back(std::move(child));
+        }
+    }
+
+    // checks that [offset; offset + size) lies inside of the file and offset is aligned
+    void checkBlock(uint64_t offset, uint64_t size, size_t fileSize, const char* name) {
+        if (offset % kPointCloudAlignment != 0)
+            throw PointCloudFileError(std::string(name) + " block is not aligned!");
+        if (offset > fileSize || size > fileSize - offset)
+            throw PointCloudFileError(std::string(name) + " block lies outside of the file!");
+    }
+
+    // planes of the view frustum as (normal, distance) pointing inwards
+    std::array<glm::vec4, 6> frustumPlanes(const glm::mat4& viewProjection) {
+        glm::mat4 m = glm::transpose(viewProjection);
+        return { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+    }
+
+    bool cubeVisible(const std::array<glm::vec4, 6>& planes, const glm::vec3& boundsMin, float size) {
+        for (const glm::vec4& plane : planes) {
+            glm::vec3 corner = boundsMin + glm::vec3(plane.x >= 0.0f, plane.y >= 0.0f, plane.z >= 0.0f) * size;
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    const char* kPointVertexShader = R"(#version 430 core
+
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec4 aColor;
+
+uniform mat4 uViewProjection;
+uniform vec4 uNodeBounds;   // minimum, size
+uniform float uSpacing;
+uniform float uPointScale;
+uniform vec2 uPointSize;
+
+out vec4 vColor;
+
+void main() {
+    vec3 position = uNodeBounds.xyz + aPosition * uNodeBounds.w;
+    gl_Position = uViewProjection * vec4(position, 1.0);
+    gl_PointSize = clamp(uSpacing * uPointScale / max(gl_Position.w, 1e-4), uPointSize.x, uPointSize.y);
+    vColor = aColor;
+}
+)";
+
+    const char* kPointFragmentShader = R"(#version 430 core
+
+in vec4 vColor;
+
+layout(location = 0) out vec4 color;
+
+void main() {
+    vec2 d = gl_PointCoord * 2.0 - 1.0;
+    if (dot(d, d) > 1.0)
+        discard;
+    color = vColor;
+}
+)";
+
+}
+
+void buildPointCloudFile(const std::string& path, const PointCloudSource& source, const PointCloudBuildSettings& settings, ThreadPool& pool) {
+    if (settings.maxNodePoints == 0)
+        throw std::invalid_argument("maxNodePoints must be greater than 0!");
+    if (settings.gridSize < 2 || settings.gridSize > 256)
+        throw std::invalid_argument("gridSize must be in [2;256]!");
+    uint64_t streamMemory = (uint64_t)settings.gridSize * settings.gridSize * settings.gridSize * sizeof(uint32_t) +
+                            10 * kSpillBatch * sizeof(PointCloudSourcePoint);
+    if (settings.maxMemory < std::max(streamMemory, (uint64_t)settings.maxNodePoints * kBuildBytesPerPoint))
+        throw std::invalid_argument("maxMemory is too small for gridSize and maxNodePoints!");
+
+    // the source is streamed once into the spill file of the root, which yields the bounds
+    SpillFiles spills(path, settings.spillDirectory);
+    SpillNode root;
+    root.path = spills.create();
+    glm::vec3 boundsMin(std::numeric_limits<float>::max());
+    glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+    {
+        SpillWriter writer(root.path);
+        source([&](std::span<const PointCloudSourcePoint> points) {
+            for (const PointCloudSourcePoint& point : points) {
+                boundsMin = glm::min(boundsMin, point.position);
+                boundsMax = glm::max(boundsMax, point.position);
+                writer.push(point);
+            }
+        });
+        writer.flush();
+        root.count = writer.count;
+    }
+    if (root.count == 0)
+        throw std::invalid_argument("Point cloud source has no points!");
+    glm::vec3 extent = boundsMax - boundsMin;
+    root.boundsMin = boundsMin;
+    root.size = std::max({ extent.x, extent.y, extent.z, 1e-6f });
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("Could not open file for writing: " + path + "!");
+
+    // the header is written last, once the offsets are known
+    PointCloudHeader header = {};
+    header.magic = kPointCloudMagic;
+    header.version = kPointCloudVersion;
+    header.gridSize = settings.gridSize;
+    header.pointOffset = alignUp(sizeof(PointCloudHeader));
+    std::memcpy(header.boundsMin, &boundsMin, sizeof(header.boundsMin));
+    header.size = root.size;
+
+    uint64_t position = sizeof(PointCloudHeader);
+    file.write((const char*)&header, sizeof(header));
+    writePadding(file, position);
+
+    // nodes that fit into memory are built with their subtree, larger ones are split through spill files
+    OctreeWriter octree(file, position, header.pointCount);
+    std::mt19937 random(0x474C4150);
+    std::vector<SpillNode> pending = { std::move(root) };
+    while (!pending.empty()) {
+        SpillNode node = std::move(pending.back());
+        pending.pop_back();
+        if (node.count * kBuildBytesPerPoint <= settings.maxMemory) {
+            BuildNode subtree;
+            subtree.parent = node.parent;
+            subtree.octant = node.octant;
+            subtree.level = node.level;
+            subtree.boundsMin = node.boundsMin;
+            subtree.size = node.size;
+            subtree.points.reserve((size_t)node.count);
+            readSpill(node, [&](std::span<const PointCloudSourcePoint> batch, uint64_t) {
+                subtree.points.insert(subtree.points.end(), batch.begin(), batch.end());
+            });
+            spills.remove(node.path);
+            std::shuffle(subtree.points.begin(), subtree.points.end(), random);
+            buildSubtree(std::move(subtree), octree, settings, pool);
+        }
+        else if (node.count <= settings.maxNodePoints || node.level >= settings.maxDepth) {
+            streamLeaf(node, octree, settings, pool);
+            spills.remove(node.path);
+        }
+        else {
+            streamInner(node, octree, spills, pending, settings, pool);
+            spills.remove(node.path);
+        }
+        if (!file)
+            throw std::runtime_error("Could not write file: " + path + "!");
+    }
+
+    std::vector<PointCloudNode> nodes = octree.breadthFirst();
+    writePadding(file, position);
+    header.nodeOffset = position;
+    header.nodeCount = (uint32_t)nodes.size();
+    file.write((const char*)nodes.data(), (std::streamsize)(nodes.size() * sizeof(PointCloudNode)));
+    file.seekp(0);
+    file.write((const char*)&header, sizeof(header));
+
+    if (!file)
+        throw std::runtime_error("Could not write file: " + path + "!");
+}
+
+void buildPointCloudFile(const std::string& path, std::span<const PointCloudSourcePoint> points, const PointCloudBuildSettings& settings, ThreadPool& pool) {
+    buildPointCloudFile(path, [&](const std::function<void(std::span<const PointCloudSourcePoint>)>& consume) { consume(points); }, settings, pool);
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class PointCloudFile
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void PointCloudFile::_validate() {
+    if (_data.size() < sizeof(PointCloudHeader))
+        throw PointCloudFileError("File is smaller than the header!");
+    _header = (const PointCloudHeader*)_data.data();
+    if (_header->magic != kPointCloudMagic)
+        throw PointCloudFileError("File is not a point cloud file!");
+    if (_header->version != kPointCloudVersion)
+        throw PointCloudFileError("Unsupported point cloud file version " + std::to_string(_header->version) + ", expected " + std::to_string(kPointCloudVersion) + "!");
+    if (_header->nodeCount == 0)
+        throw PointCloudFileError("File has no root node!");
+
+    checkBlock(_header->pointOffset, _header->pointCount * sizeof(PointCloudPoint), _data.size(), "Point");
+    checkBlock(_header->nodeOffset, (uint64_t)_header->nodeCount * sizeof(PointCloudNode), _data.size(), "Node");
+
+    // children always follow their parent, so the traversal can't loop
+    std::span<const PointCloudNode> table = nodes();
+    for (uint32_t i = 0; i < _header->nodeCount; i++) {
+        const PointCloudNode& node = table[i];
+        if (node.firstPoint > _header->pointCount || node.pointCount > _header->pointCount - node.firstPoint)
+            throw PointCloudFileError("Points of node " + std::to_string(i) + " lie outside of the point block!");
+        if (node.childMask > 0xFF || (node.childMask != 0 && (node.firstChild <= i ||
+            node.firstChild > _header->nodeCount - (uint32_t)std::popcount(node.childMask))))
+            throw PointCloudFileError("Children of node " + std::to_string(i) + " are invalid!");
+    }
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+PointCloudFile::PointCloudFile(const std::string& path) : _file(path) {
+    _data = _file.bytes();
+    _validate();
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+std::span<const PointCloudNode> PointCloudFile::nodes() const {
+    return { (const PointCloudNode*)(_data.data() + _header->nodeOffset), _header->nodeCount };
+}
+
+std::span<const PointCloudPoint> PointCloudFile::points(uint32_t node) const {
+    if (node >= _header->nodeCount)
+        throw std::out_of_range("Point cloud node " + std::to_string(node) + " does not exist!");
+    const PointCloudNode& entry = nodes()[node];
+    return { (const PointCloudPoint*)(_data.data() + _header->pointOffset) + entry.firstPoint, entry.pointCount };
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class PointCloud
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+bool PointCloud::_allocate(uint32_t count, uint32_t& offset) {
+    if (count == 0) {
+        offset = 0;
+        return true;
+    }
+    for (auto it = _free.begin(); it != _free.end(); ++it) {
+        if (it->second < count)
+            continue;
+        offset = it->first;
+        uint32_t remaining = it->second - count;
+        _free.erase(it);
+        if (remaining > 0)
+            _free.emplace(offset + count, remaining);
+        return true;
+    }
+    return false;
+}
+
+void PointCloud::_release(uint32_t node) {
+    NodeState& state = _nodes[node];
+    uint32_t count = _file->nodes()[node].pointCount;
+    uint32_t offset = state.offset;
+    state.offset = UINT32_MAX;
+    _residentPoints -= count;
+    if (count == 0)
+        return;
+
+    // merge with the free neighbours
+    auto next = _free.lower_bound(offset);
+    if (next != _free.end() && offset + count == next->first) {
+        count += next->second;
+        next = _free.erase(next);
+    }
+    if (next != _free.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += count;
+            return;
+        }
+    }
+    _free.emplace(offset, count);
+}
+
+void PointCloud::_upload(LoadedNode& loaded) {
+    NodeState& state = _nodes[loaded.node];
+    uint32_t count = (uint32_t)loaded.points.size();
+    int64_t stride = sizeof(PointCloudPoint);
+    _points.setSubData((int64_t)state.offset * stride, count * stride, loaded.points.data());
+    _residentPoints += count;
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+PointCloud::PointCloud(std::shared_ptr<const PointCloudFile> file, const PointCloudSettings& settings, ThreadPool& pool)
+    : _settings(settings), _file(std::move(file)), _pool(pool), _queue(std::make_shared<LoadQueue>()) {
+    if (!_file)
+        throw std::invalid_argument("file may not be null!");
+    if (settings.capacity == 0 || settings.pointBudget == 0 || settings.maxError <= 0.0f || settings.maxLoads <= 0 ||
+        settings.maxUploadsPerFrame <= 0 || settings.pointScale <= 0.0f || settings.minPointSize <= 0.0f || settings.maxPointSize <= 0.0f)
+        throw std::invalid_argument("All PointCloudSettings must be greater than 0!");
+    if (settings.pointBudget > settings.capacity)
+        throw std::invalid_argument("pointBudget may not be greater than capacity!");
+
+    _nodes.resize(_file->nodes().size());
+    _points.setStorage((int64_t)settings.capacity * sizeof(PointCloudPoint), nullptr, BufferFlag::DynamicStorage);
+    _free.emplace(0u, settings.capacity);
+
+    Shader vertex(ShaderType::Vertex, kPointVertexShader);
+    Shader fragment(ShaderType::Fragment, kPointFragmentShader);
+    _program.attach(vertex);
+    _program.attach(fragment);
+    _program.link();
+}
+
+PointCloud::PointCloud(const std::string& path, const PointCloudSettings& settings, ThreadPool& pool)
+    : PointCloud(std::make_shared<const PointCloudFile>(path), settings, pool) {}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void PointCloud::update(const glm::mat4& view, const glm::mat4& projection, int viewportHeight) {
+    _frame++;
+    std::span<const PointCloudNode> nodes = _file->nodes();
+
+    // arrived nodes replace the ones not drawn last frame, least recently drawn and deepest first
+    std::vector<LoadedNode> arrived;
+    {
+        std::lock_guard<std::mutex> lock(_queue->mutex);
+        arrived.swap(_queue->nodes);
+    }
+    std::vector<uint32_t> evictable;
+    bool evictableCollected = false;
+    int uploads = 0;
+    size_t processed = 0;
+    for (; processed < arrived.size() && uploads < _settings.maxUploadsPerFrame; processed++) {
+        LoadedNode& loaded = arrived[processed];
+        NodeState& state = _nodes[loaded.node];
+        state.loading = false;
+        _loads--;
+        if (!loaded.loaded) {
+            state.failed = true;
+            continue;
+        }
+
+        uint32_t count = (uint32_t)loaded.points.size();
+        while (!_allocate(count, state.offset)) {
+            if (!evictableCollected) {
+                for (uint32_t i = 0; i < _nodes.size(); i++)
+                    if (_nodes[i].offset != UINT32_MAX && _nodes[i].lastUsed + 1 < _frame)
+                        evictable.push_back(i);
+                // popped from the back
+                std::sort(evictable.begin(), evictable.end(), [&](uint32_t a, uint32_t b) {
+                    if (_nodes[a].lastUsed != _nodes[b].lastUsed)
+                        return _nodes[a].lastUsed > _nodes[b].lastUsed;
+                    return nodes[a].level < nodes[b].level;
+                });
+                evictableCollected = true;
+            }
+            if (evictable.empty())
+                break;
+            _release(evictable.back());
+            evictable.pop_back();
+        }
+        if (state.offset == UINT32_MAX)
+            continue;
+        _upload(loaded);
+        uploads++;
+    }
+    if (processed < arrived.size()) {
+        std::lock_guard<std::mutex> lock(_queue->mutex);
+        _queue->nodes.insert(_queue->nodes.begin(), std::make_move_iterator(arrived.begin() + processed), std::make_move_iterator(arrived.end()));
+    }
+
+    // largest screen space error first until the point budget is used up, only resident nodes are refined
+    std::array<glm::vec4, 6> planes = frustumPlanes(projection * view);
+    glm::vec3 camera = glm::vec3(glm::inverse(view)[3]);
+    float pixelScale = projection[1][1] * 0.5f * viewportHeight;
+    auto error = [&](const PointCloudNode& node) {
+        glm::vec3 boundsMin(node.boundsMin[0], node.boundsMin[1], node.boundsMin[2]);
+        float distance = glm::length(camera - glm::clamp(camera, boundsMin, boundsMin + node.size));
+        return distance <= 0.0f ? std::numeric_limits<float>::max() : node.spacing * pixelScale / distance;
+    };
+
+    _visible.clear();
+    _visiblePoints = 0;
+    std::vector<uint32_t> missing;
+    std::priority_queue<std::pair<float, uint32_t>> queue;
+    const PointCloudNode& root = nodes[0];
+    if (cubeVisible(planes, glm::vec3(root.boundsMin[0], root.boundsMin[1], root.boundsMin[2]), root.size))
+        queue.push({ error(root), 0u });
+    while (!queue.empty()) {
+        auto [nodeError, index] = queue.top();
+        queue.pop();
+        const PointCloudNode& node = nodes[index];
+        NodeState& state = _nodes[index];
+        if (_visiblePoints + node.pointCount > _settings.pointBudget)
+            continue;
+        if (state.offset == UINT32_MAX) {
+            if (!state.loading && !state.failed)
+                missing.push_back(index);
+            continue;
+        }
+
+        state.lastUsed = _frame;
+        _visible.push_back({ index, node.spacing });
+        _visiblePoints += node.pointCount;
+        if (nodeError <= _settings.maxError)
+            continue;
+
+        uint32_t child = node.firstChild;
+        for (uint32_t octant = 0; octant < 8; octant++) {
+            if ((node.childMask & (1u << octant)) == 0)
+                continue;
+            const PointCloudNode& childNode = nodes[child];
+            if (cubeVisible(planes, glm::vec3(childNode.boundsMin[0], childNode.boundsMin[1], childNode.boundsMin[2]), childNode.size))
+                queue.push({ error(childNode), child });
+            child++;
+        }
+    }
+
+    // a node drawn together with its children only needs to fill the gaps left by their points, children outside of
+    // the frustum don't matter, any other child not drawn leaves the node at its own spacing
+    std::sort(_visible.begin(), _visible.end(), [&](const VisibleNode& a, const VisibleNode& b) { return nodes[a.node].level > nodes[b.node].level; });
+    std::unordered_map<uint32_t, float> drawn;
+    drawn.reserve(_visible.size());
+    for (VisibleNode& visible : _visible) {
+        const PointCloudNode& node = nodes[visible.node];
+        float spacing = 0.0f;
+        uint32_t children = (uint32_t)std::popcount(node.childMask);
+        for (uint32_t child = node.firstChild; child < node.firstChild + children; child++) {
+            auto it = drawn.find(child);
+            if (it != drawn.end())
+                spacing = std::max(spacing, it->second);
+            else if (cubeVisible(planes, glm::vec3(nodes[child].boundsMin[0], nodes[child].boundsMin[1], nodes[child].boundsMin[2]), nodes[child].size))
+                spacing = node.spacing;
+        }
+        visible.spacing = spacing > 0.0f ? std::min(spacing, node.spacing) : node.spacing;
+        drawn.emplace(visible.node, visible.spacing);
+    }
+
+    for (uint32_t index : missing) {
+        if (_loads >= _settings.maxLoads)
+            break;
+        _nodes[index].loading = true;
+        _loads++;
+        _pool.submit([queue = _queue, file = _file, index]() {
+            LoadedNode loaded = { index, false, {} };
+            try {
+                std::span<const PointCloudPoint> points = file->points(index);
+                loaded.points.assign(points.begin(), points.end());
+                loaded.loaded = true;
+            }
+            catch (...) {
+                loaded.loaded = false;
+            }
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            queue->nodes.push_back(std::move(loaded));
+        });
+    }
+}
+
+void PointCloud::draw(const glm::mat4& view, const glm::mat4& projection, int viewportHeight) {
+    if (_visible.empty())
+        return;
+
+    GLboolean programPointSize = glIsEnabled(GL_PROGRAM_POINT_SIZE);
+    GL_CALL(glEnable(GL_PROGRAM_POINT_SIZE));
+
+    _program.bind();
+    _program["uViewProjection"] = projection * view;
+    _program["uPointScale"] = projection[1][1] * 0.5f * viewportHeight * _settings.pointScale;
+    _program["uPointSize"] = glm::vec2(_settings.minPointSize, _settings.maxPointSize);
+    int boundsLocation = _program.getUniformLocation("uNodeBounds");
+    int spacingLocation = _program.getUniformLocation("uSpacing");
+
+    _points.setAttributes({
+        { 0, 3, VertexAttribType::UnsignedShort, VertexAttribInterp::Float, true, (int)offsetof(PointCloudPoint, position) },
+        { 1, 4, VertexAttribType::UnsignedByte, VertexAttribInterp::Float, true, (int)offsetof(PointCloudPoint, color) }
+    }, sizeof(PointCloudPoint));
+
+    std::span<const PointCloudNode> nodes = _file->nodes();
+    for (const VisibleNode& visible : _visible) {
+        const PointCloudNode& node = nodes[visible.node];
+        if (node.pointCount == 0)
+            continue;
+        _program.setUniform(boundsLocation, glm::vec4(node.boundsMin[0], node.boundsMin[1], node.boundsMin[2], node.size));
+        _program.setUniform(spacingLocation, visible.spacing);
+        GL_CALL(glDrawArrays(GL_POINTS, (GLint)_nodes[visible.node].offset, (GLsizei)node.pointCount));
+    }
+
+    if (!programPointSize)
+        GL_CALL(glDisable(GL_PROGRAM_POINT_SIZE));
+}
+
+}
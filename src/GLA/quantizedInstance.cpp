@@ -0,0 +1,268 @@
+#include <GLA/quantizedInstance.h>
+
+#include <GLA/simd.h>
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+namespace gla {
+
+namespace {
+
+    constexpr size_t kChunkSize = 8192;             // instances per ThreadPool task
+    constexpr float kSmallestThree = 0.70710678f;   // 1 / sqrt(2), bound of the components kept by the smallest three encoding
+
+    static_assert(offsetof(glm::quat, x) == 0 && offsetof(glm::quat, w) == 3 * sizeof(float), "glm::quat must be stored as x, y, z, w!");
+
+    // the chunk as scale and offset of the fixed point positions
+    struct Quantizer {
+        glm::vec3 origin;
+        glm::vec3 scale;    // 65535 / extent
+
+        explicit Quantizer(const InstanceChunk& chunk) : origin(chunk.origin), scale(65535.0f / chunk.extent) {
+            if (!(chunk.extent.x > 0.0f && chunk.extent.y > 0.0f && chunk.extent.z > 0.0f))
+                throw std::invalid_argument("InstanceChunk extent must be greater than 0!");
+        }
+    };
+
+#ifdef GLA_X86
+    __m128i select(__m128i mask, __m128i a, __m128i b) {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    __m128 select(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // rounds to the nearest even half including subnormals, infinity and NaN, the half is in the low 16 bits of every lane
+    __m128i floatToHalf(__m128 value) {
+        __m128 sign = _mm_and_ps(value, _mm_set1_ps(-0.0f));
+        __m128 absolute = _mm_xor_ps(value, sign);
+        __m128i bits = _mm_castps_si128(absolute);
+        __m128i special = _mm_or_si128(_mm_set1_epi32(0x7C00), _mm_and_si128(_mm_castps_si128(_mm_cmpunord_ps(absolute, absolute)), _mm_set1_epi32(0x200)));
+        __m128i finite = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), bits);
+        __m128i subnormal = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), bits);
+
+        // subnormal halves: the addition shifts the half mantissa to the end of the float mantissa and rounds it
+        __m128i magic = _mm_set1_epi32((127 - 15 + 23 - 10 + 1) << 23);
+        __m128i small = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, _mm_castsi128_ps(magic))), magic);
+
+        // normal halves: rebias the exponent, round half up and subtract the half again if the result would be odd
+        __m128i odd = _mm_srai_epi32(_mm_slli_epi32(bits, 18), 31);
+        __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, _mm_set1_epi32(0xFFF - ((127 - 15) << 23))), odd), 13);
+
+        __m128i half = select(finite, select(subnormal, small, normal), special);
+        return _mm_or_si128(half, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+    }
+
+    __m128i quantize(__m128 value, __m128 origin, __m128 scale) {
+        __m128 fixed = _mm_mul_ps(_mm_sub_ps(value, origin), scale);
+        fixed = _mm_min_ps(_mm_max_ps(fixed, _mm_setzero_ps()), _mm_set1_ps(65535.0f));
+        return _mm_cvttps_epi32(_mm_add_ps(fixed, _mm_set1_ps(0.5f)));
+    }
+
+    // 10 bit fixed point of a component in [-1 / sqrt(2); 1 / sqrt(2)]
+    __m128i quantizeSmall(__m128 value) {
+        __m128 fixed = _mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(511.5f / kSmallestThree)), _mm_set1_ps(512.0f));
+        return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(fixed, _mm_setzero_ps()), _mm_set1_ps(1023.0f)));
+    }
+
+    // encodes 4 instances
+    void encodeBlock(const Quantizer& quantizer, const float* positions, const float* rotations, const float* scales, QuantizedInstance* result) {
+        __m128 x, y, z;
+        deinterleave3(_mm_loadu_ps(positions), _mm_loadu_ps(positions + 4), _mm_loadu_ps(positions + 8), x, y, z);
+        __m128i px = quantize(x, _mm_set1_ps(quantizer.origin.x), _mm_set1_ps(quantizer.scale.x));
+        __m128i py = quantize(y, _mm_set1_ps(quantizer.origin.y), _mm_set1_ps(quantizer.scale.y));
+        __m128i pz = quantize(z, _mm_set1_ps(quantizer.origin.z), _mm_set1_ps(quantizer.scale.z));
+
+        __m128 sx = _mm_set1_ps(1.0f), sy = sx, sz = sx;
+        if (scales)
+            deinterleave3(_mm_loadu_ps(scales), _mm_loadu_ps(scales + 4), _mm_loadu_ps(scales + 8), sx, sy, sz);
+        __m128i hx = floatToHalf(sx), hy = floatToHalf(sy), hz = floatToHalf(sz);
+
+        // the first largest component is dropped, the quaternion is negated where it is negative
+        __m128 qx = _mm_loadu_ps(rotations), qy = _mm_loadu_ps(rotations + 4), qz = _mm_loadu_ps(rotations + 8), qw = _mm_loadu_ps(rotations + 12);
+        _MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+        __m128 signBit = _mm_set1_ps(-0.0f);
+        __m128 ax = _mm_andnot_ps(signBit, qx), ay = _mm_andnot_ps(signBit, qy), az = _mm_andnot_ps(signBit, qz), aw = _mm_andnot_ps(signBit, qw);
+        __m128 largest = _mm_max_ps(_mm_max_ps(ax, ay), _mm_max_ps(az, aw));
+        __m128i index = _mm_set1_epi32(3);
+        index = select(_mm_castps_si128(_mm_cmpeq_ps(az, largest)), _mm_set1_epi32(2), index);
+        index = select(_mm_castps_si128(_mm_cmpeq_ps(ay, largest)), _mm_set1_epi32(1), index);
+        index = select(_mm_castps_si128(_mm_cmpeq_ps(ax, largest)), _mm_setzero_si128(), index);
+        __m128 is0 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_setzero_si128()));
+        __m128 is1 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_set1_epi32(1)));
+        __m128 is2 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_set1_epi32(2)));
+        __m128 is3 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_set1_epi32(3)));
+        __m128 dropped = _mm_or_ps(_mm_or_ps(_mm_and_ps(is0, qx), _mm_and_ps(is1, qy)), _mm_or_ps(_mm_and_ps(is2, qz), _mm_and_ps(is3, qw)));
+        __m128 sign = _mm_and_ps(dropped, signBit);
+        qx = _mm_xor_ps(qx, sign);
+        qy = _mm_xor_ps(qy, sign);
+        qz = _mm_xor_ps(qz, sign);
+        qw = _mm_xor_ps(qw, sign);
+        __m128i a = quantizeSmall(select(is0, qy, qx));
+        __m128i b = quantizeSmall(select(_mm_or_ps(is0, is1), qz, qy));
+        __m128i c = quantizeSmall(select(is3, qz, qw));
+        __m128i rotation = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(index, 30), _mm_slli_epi32(a, 20)), _mm_or_si128(_mm_slli_epi32(b, 10), c));
+
+        // one dword per register and instance, transposed so every register holds one instance
+        __m128 d0 = _mm_castsi128_ps(_mm_or_si128(px, _mm_slli_epi32(py, 16)));
+        __m128 d1 = _mm_castsi128_ps(_mm_or_si128(pz, _mm_slli_epi32(hx, 16)));
+        __m128 d2 = _mm_castsi128_ps(_mm_or_si128(hy, _mm_slli_epi32(hz, 16)));
+        __m128 d3 = _mm_castsi128_ps(rotation);
+        _MM_TRANSPOSE4_PS(d0, d1, d2, d3);
+        _mm_storeu_ps((float*)&result[0], d0);
+        _mm_storeu_ps((float*)&result[1], d1);
+        _mm_storeu_ps((float*)&result[2], d2);
+        _mm_storeu_ps((float*)&result[3], d3);
+    }
+
+    // encodes up to 4 instances through a padded block
+    void encodePartialBlock(const Quantizer& quantizer, const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, QuantizedInstance* result, size_t count) {
+        glm::vec3 blockPositions[4] = {};
+        glm::quat blockRotations[4] = {};
+        glm::vec3 blockScales[4] = {};
+        QuantizedInstance blockResult[4];
+        std::copy(positions, positions + count, blockPositions);
+        std::copy(rotations, rotations + count, blockRotations);
+        if (scales)
+            std::copy(scales, scales + count, blockScales);
+        encodeBlock(quantizer, &blockPositions[0].x, &blockRotations[0].x, scales ? &blockScales[0].x : nullptr, blockResult);
+        std::copy(blockResult, blockResult + count, result);
+    }
+
+    void encodeRange(const Quantizer& quantizer, const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, QuantizedInstance* result, size_t count) {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            encodeBlock(quantizer, &positions[i].x, &rotations[i].x, scales ? &scales[i].x : nullptr, result + i);
+        if (i < count)
+            encodePartialBlock(quantizer, positions + i, rotations + i, scales ? scales + i : nullptr, result + i, count - i);
+    }
+#else
+    uint32_t quantizeSmall(float value) {
+        return (uint32_t)std::clamp(value * (511.5f / kSmallestThree) + 512.0f, 0.0f, 1023.0f);
+    }
+
+    QuantizedInstance encodeScalar(const Quantizer& quantizer, const glm::vec3& position, glm::quat rotation, const glm::vec3& scale) {
+        QuantizedInstance instance;
+        glm::vec3 fixed = glm::clamp((position - quantizer.origin) * quantizer.scale, 0.0f, 65535.0f);
+        for (int axis = 0; axis < 3; axis++) {
+            instance.position[axis] = (uint16_t)(fixed[axis] + 0.5f);
+            instance.scale[axis] = glm::packHalf1x16(scale[axis]);
+        }
+
+        float components[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+        uint32_t index = 0;
+        for (uint32_t i = 1; i < 4; i++)
+            if (std::abs(components[i]) > std::abs(components[index]))
+                index = i;
+        float sign = components[index] < 0.0f ? -1.0f : 1.0f;
+        instance.rotation = index << 30;
+        int shift = 20;
+        for (uint32_t i = 0; i < 4; i++) {
+            if (i == index)
+                continue;
+            instance.rotation |= quantizeSmall(components[i] * sign) << shift;
+            shift -= 10;
+        }
+        return instance;
+    }
+
+    void encodeRange(const Quantizer& quantizer, const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, QuantizedInstance* result, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            result[i] = encodeScalar(quantizer, positions[i], rotations[i], scales ? scales[i] : glm::vec3(1.0f));
+    }
+#endif
+
+    const char* kQuantizedInstanceSource = R"(
+layout(location = QUANTIZED_INSTANCE_LOCATION) in vec3 instancePosition;        // position in the chunk in [0;1]
+layout(location = QUANTIZED_INSTANCE_LOCATION + 1) in vec3 instanceScale;
+layout(location = QUANTIZED_INSTANCE_LOCATION + 2) in uint instanceRotationBits;
+uniform vec3 uInstanceChunkOrigin;
+uniform vec3 uInstanceChunkExtent;
+
+// smallest three quaternion, the dropped component is rebuilt from the unit length
+vec4 instanceRotation() {
+    uvec3 bits = uvec3(instanceRotationBits >> 20, instanceRotationBits >> 10, instanceRotationBits) & 1023u;
+    vec3 small = (vec3(bits) / 1023.0 * 2.0 - 1.0) * 0.70710678;
+    float dropped = sqrt(max(1.0 - dot(small, small), 0.0));
+    switch (instanceRotationBits >> 30) {
+    case 0u: return vec4(dropped, small);
+    case 1u: return vec4(small.x, dropped, small.yz);
+    case 2u: return vec4(small.xy, dropped, small.z);
+    default: return vec4(small, dropped);
+    }
+}
+
+vec3 instanceRotate(vec4 rotation, vec3 direction) {
+    return direction + 2.0 * cross(rotation.xyz, cross(rotation.xyz, direction) + rotation.w * direction);
+}
+
+vec3 instanceTransform(vec4 rotation, vec3 position) {
+    return uInstanceChunkOrigin + instancePosition * uInstanceChunkExtent + instanceRotate(rotation, position * instanceScale);
+}
+)";
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// functions
+// ----------------------------------------------------------------------------------------------------
+
+QuantizedInstance encodeInstance(const InstanceChunk& chunk, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+    QuantizedInstance instance;
+    encodeRange(Quantizer(chunk), &position, &rotation, &scale, &instance, 1);
+    return instance;
+}
+
+void encodeInstances(const InstanceChunk& chunk, std::span<const glm::vec3> positions, std::span<const glm::quat> rotations,
+                     std::span<const glm::vec3> scales, std::span<QuantizedInstance> result, ThreadPool& pool) {
+    if (rotations.size() != positions.size() || (!scales.empty() && scales.size() != positions.size()) || result.size() != positions.size())
+        throw std::invalid_argument("encodeInstances needs a rotation, a scale and a result for every position!");
+    Quantizer quantizer(chunk);
+    const glm::vec3* scaleData = scales.empty() ? nullptr : scales.data();
+    auto encode = [&](size_t begin, size_t end) {
+        encodeRange(quantizer, positions.data() + begin, rotations.data() + begin, scaleData ? scaleData + begin : nullptr, result.data() + begin, end - begin);
+    };
+    if (positions.size() <= kChunkSize)
+        encode(0, positions.size());
+    else
+        pool.parallelFor(positions.size(), kChunkSize, encode);
+}
+
+AffineTransform decodeInstance(const InstanceChunk& chunk, const QuantizedInstance& instance) {
+    glm::vec3 position, scale;
+    for (int axis = 0; axis < 3; axis++) {
+        position[axis] = chunk.origin[axis] + (float)instance.position[axis] / 65535.0f * chunk.extent[axis];
+        scale[axis] = glm::unpackHalf1x16(instance.scale[axis]);
+    }
+
+    glm::vec3 small;
+    for (int i = 0; i < 3; i++)
+        small[i] = ((float)((instance.rotation >> (20 - 10 * i)) & 1023u) / 1023.0f * 2.0f - 1.0f) * kSmallestThree;
+    float dropped = std::sqrt(std::max(1.0f - glm::dot(small, small), 0.0f));
+    float components[4];
+    uint32_t index = instance.rotation >> 30;
+    for (uint32_t i = 0, next = 0; i < 4; i++)
+        components[i] = i == index ? dropped : small[next++];
+    return AffineTransform(position, glm::quat(components[3], components[0], components[1], components[2]), scale);
+}
+
+std::vector<VertexAttribute> quantizedInstanceAttributes(unsigned int location, int offset, unsigned int divisor) {
+    return {
+        { location, 3, VertexAttribType::UnsignedShort, VertexAttribInterp::Float, true, offset + (int)offsetof(QuantizedInstance, position), divisor },
+        { location + 1, 3, VertexAttribType::HalfFloat, VertexAttribInterp::Float, false, offset + (int)offsetof(QuantizedInstance, scale), divisor },
+        { location + 2, 1, VertexAttribType::UnsignedInt, VertexAttribInterp::Integer, false, offset + (int)offsetof(QuantizedInstance, rotation), divisor }
+    };
+}
+
+std::string quantizedInstanceSource(unsigned int location) {
+    return "#define QUANTIZED_INSTANCE_LOCATION " + std::to_string(location) + "\n" + kQuantizedInstanceSource;
+}
+
+}
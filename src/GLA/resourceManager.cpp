@@ -0,0 +1,185 @@
+#include <GLA/resourceManager.h>
+
+#include <algorithm>
+
+namespace gla {
+
+// ----------------------------------------------------------------------------------------------------
+// class ResourceManager
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+std::shared_ptr<detail::ResourceEntry> ResourceManager::_load(const std::string& key, std::type_index type, const detail::ResourceReader* reader) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _entries.find(key);
+    if (it != _entries.end()) {
+        std::shared_ptr<detail::ResourceEntry> entry = it->second;
+        if (entry->type != type)
+            throw std::logic_error("Resource was already loaded as a different type!");
+        ResourceState failed = ResourceState::Failed;
+        if (entry->state.compare_exchange_strong(failed, ResourceState::Loading))
+            _submit(entry);
+        return entry;
+    }
+
+    detail::ResourceReader selected;
+    if (reader) {
+        selected = *reader;
+    }
+    else {
+        auto loader = _loaders.find(type);
+        if (loader == _loaders.end())
+            throw std::logic_error("No ResourceLoader was registered for the resource type!");
+        selected = loader->second;
+    }
+
+    auto entry = std::make_shared<detail::ResourceEntry>(key, type, std::move(selected));
+    entry->lastUsed = _frame.load();
+    _entries.emplace(key, entry);
+    _submit(entry);
+    return entry;
+}
+
+void ResourceManager::_submit(const std::shared_ptr<detail::ResourceEntry>& entry) {
+    std::shared_ptr<Workers> workers = _workers;
+    {
+        std::lock_guard<std::mutex> lock(workers->mutex);
+        workers->inFlight++;
+    }
+    _pool.submit([workers, entry]() {
+        Completed result{ entry, {}, {} };
+        try {
+            result.uploader = entry->reader(entry->key);
+        }
+        catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        catch (...) {
+            result.error = "Unknown error while reading the resource!";
+        }
+        std::lock_guard<std::mutex> lock(workers->mutex);
+        workers->completed.push_back(std::move(result));
+        workers->inFlight--;
+        workers->idle.notify_all();
+    });
+}
+
+void ResourceManager::_request(const std::shared_ptr<detail::ResourceEntry>& entry) {
+    ResourceState evicted = ResourceState::Evicted;
+    if (entry->state.compare_exchange_strong(evicted, ResourceState::Loading)) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _submit(entry);
+    }
+}
+
+void ResourceManager::_evict() {
+    struct Candidate {
+        detail::ResourceEntry* entry;
+        bool referenced;
+        uint64_t lastUsed;
+    };
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    uint64_t frame = _frame.load();
+    std::vector<Candidate> candidates;
+    for (auto& [key, entry] : _entries) {
+        if (entry->state.load() != ResourceState::Ready)
+            continue;
+        // the map holds the only reference when no handle is left
+        bool referenced = entry.use_count() > 1;
+        uint64_t lastUsed = entry->lastUsed.load();
+        if (referenced && lastUsed + _settings.evictionDelay >= frame)
+            continue;
+        candidates.push_back({ entry.get(), referenced, lastUsed });
+    }
+
+    // unreferenced resources first, then the least recently used
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.referenced != b.referenced)
+            return !a.referenced;
+        return a.lastUsed < b.lastUsed;
+    });
+
+    for (const Candidate& candidate : candidates) {
+        if (_memoryUsage <= _settings.memoryBudget)
+            break;
+        detail::ResourceEntry* entry = candidate.entry;
+        _memoryUsage -= entry->bytes;
+        entry->bytes = 0;
+        entry->resource.reset();
+        if (candidate.referenced)
+            entry->state = ResourceState::Evicted;
+        else {
+            // the key lives in the node that is erased
+            std::string key = entry->key;
+            _entries.erase(key);
+        }
+    }
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+ResourceManager::ResourceManager(const ResourceManagerSettings& settings, ThreadPool& pool)
+    : _settings(settings), _pool(pool), _workers(std::make_shared<Workers>()) {
+    if (settings.memoryBudget < 0 || settings.maxUploadsPerFrame <= 0)
+        throw std::invalid_argument("memoryBudget may not be negative and maxUploadsPerFrame must be greater than 0!");
+}
+
+ResourceManager::~ResourceManager() {
+    std::unique_lock<std::mutex> lock(_workers->mutex);
+    _workers->idle.wait(lock, [this]() { return _workers->inFlight == 0; });
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void ResourceManager::update() {
+    _frame++;
+
+    {
+        std::lock_guard<std::mutex> lock(_workers->mutex);
+        for (Completed& completed : _workers->completed)
+            _pending.push_back(std::move(completed));
+        _workers->completed.clear();
+    }
+
+    size_t uploads = std::min(_pending.size(), (size_t)_settings.maxUploadsPerFrame);
+    for (size_t i = 0; i < uploads; i++) {
+        Completed& completed = _pending[i];
+        detail::ResourceEntry& entry = *completed.entry;
+        if (!completed.uploader) {
+            entry.error = std::move(completed.error);
+            entry.state = ResourceState::Failed;
+            continue;
+        }
+        try {
+            auto [resource, bytes] = completed.uploader();
+            entry.resource = std::move(resource);
+            entry.bytes = bytes;
+            _memoryUsage += bytes;
+            entry.state = ResourceState::Ready;
+        }
+        catch (const std::exception& e) {
+            entry.error = e.what();
+            entry.state = ResourceState::Failed;
+        }
+        catch (...) {
+            entry.error = "Unknown error while uploading the resource!";
+            entry.state = ResourceState::Failed;
+        }
+    }
+    _pending.erase(_pending.begin(), _pending.begin() + uploads);
+
+    if (_memoryUsage > _settings.memoryBudget)
+        _evict();
+}
+
+}
@@ -0,0 +1,93 @@
+#include <GLA/ringBuffer.h>
+
+#include <GLA/debug.h>
+
+namespace gla {
+
+// ----------------------------------------------------------------------------------------------------
+// class RingBuffer
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+RingBuffer::RingBuffer(BufferType type, int64_t frameSize, int frameCount)
+    : _buffer(type), _frameSize(frameSize), _frameCount(frameCount) {
+    if (frameSize <= 0)
+        throw std::invalid_argument("frameSize must be greater than 0!");
+    if (frameCount <= 0)
+        throw std::invalid_argument("frameCount must be greater than 0!");
+    _buffer.setStorage(frameSize * frameCount, nullptr, BufferFlag::MapWrite | BufferFlag::MapPersistent | BufferFlag::MapCoherent);
+    _mapped = static_cast<uint8_t*>(_buffer.map(0, frameSize * frameCount, MapUsage::Write | MapUsage::Persistent | MapUsage::Coherent));
+    _fences.resize(frameCount);
+    _frame = frameCount - 1;
+}
+
+RingBuffer::RingBuffer(RingBuffer&& other)
+    : _buffer(std::move(other._buffer)), _frameSize(other._frameSize), _frameCount(other._frameCount), _mapped(other._mapped),
+      _fences(std::move(other._fences)), _frame(other._frame), _head(other._head), _inFrame(other._inFrame) {
+    other._mapped = nullptr;
+    other._inFrame = false;
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void RingBuffer::beginFrame() {
+    if (_inFrame)
+        throw std::logic_error("RingBuffer::endFrame must be called before beginning a new frame!");
+    _frame = (_frame + 1) % _frameCount;
+    _fences[_frame].wait();
+    _fences[_frame].reset();
+    _head = 0;
+    _inFrame = true;
+}
+
+RingAllocation RingBuffer::allocate(int64_t size, int64_t alignment) {
+    if (!_inFrame)
+        throw std::logic_error("RingBuffer::beginFrame must be called before allocating!");
+    if (size <= 0)
+        throw std::invalid_argument("size must be greater than 0!");
+    if (alignment <= 0)
+        throw std::invalid_argument("alignment must be greater than 0!");
+
+    int64_t base = (int64_t)_frame * _frameSize;
+    int64_t offset = base + _head;
+    offset = (offset + alignment - 1) / alignment * alignment;
+    if (offset + size > base + _frameSize)
+        throw std::runtime_error("RingBuffer frame region is out of memory!");
+
+    _head = offset + size - base;
+    return { _mapped + offset, offset, size };
+}
+
+void RingBuffer::endFrame() {
+    if (!_inFrame)
+        throw std::logic_error("RingBuffer::beginFrame must be called before ending a frame!");
+    _fences[_frame].place();
+    _inFrame = false;
+}
+
+// --------------------------------------------------
+// operator overloads
+// --------------------------------------------------
+
+RingBuffer& RingBuffer::operator=(RingBuffer&& other) {
+    if (this != &other) {
+        _buffer = std::move(other._buffer);
+        _frameSize = other._frameSize;
+        _frameCount = other._frameCount;
+        _mapped = other._mapped;
+        _fences = std::move(other._fences);
+        _frame = other._frame;
+        _head = other._head;
+        _inFrame = other._inFrame;
+        other._mapped = nullptr;
+        other._inFrame = false;
+    }
+    return *this;
+}
+
+}
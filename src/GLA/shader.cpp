@@ -71,6 +71,23 @@ std::string Shader::_getError() {
     return message;
 }
 
+void Shader::_compile(const char* src, int length) {
+    _ensure();
+
+    _compiled = false;
+    GL_CALL(glShaderSource(_id, 1, &src, &length));
+    GL_CALL(glCompileShader(_id));
+
+    GLint result;
+    GL_CALL(glGetShaderiv(_id, GL_COMPILE_STATUS, &result));
+    if (result == GL_FALSE) {
+        std::string message = _getError();
+        throw ShaderCompileError(_type, message);
+        return;
+    }
+    _compiled = true;
+}
+
 // --------------------------------------------------
 // constructors / destructors
 // --------------------------------------------------
@@ -89,6 +106,11 @@ Shader::Shader(ShaderType type, const std::string& src) : _type(type) {
     _check();
     compile(src);
 }
+Shader::Shader(ShaderType type, std::string_view src) : _type(type) {
+    GL_CALL(_id = glCreateShader(toGLenum(_type)));
+    _check();
+    compile(src);
+}
 Shader::Shader(ShaderType type, std::istream& in) : _type(type) { 
     GL_CALL(_id = glCreateShader(toGLenum(_type)));
     _check();
@@ -117,21 +139,13 @@ void Shader::reset() {
 void Shader::compile(const char* src) {
     if (!src)
         throw std::invalid_argument("Shader source is null!");
+    _compile(src, -1);
+}
 
-    _ensure();
-
-    _compiled = false;
-    GL_CALL(glShaderSource(_id, 1, &src, NULL));
-    GL_CALL(glCompileShader(_id));
-
-    GLint result;
-    GL_CALL(glGetShaderiv(_id, GL_COMPILE_STATUS, &result));
-    if (result == GL_FALSE) {
-        std::string message = _getError();
-        throw ShaderCompileError(_type, message);
-        return;
-    }
-    _compiled = true;
+void Shader::compile(std::string_view src) {
+    if (!src.data())
+        throw std::invalid_argument("Shader source is null!");
+    _compile(src.data(), (int)src.size());
 }
 
 void Shader::compile(std::istream& in) {
@@ -0,0 +1,47 @@
+#include <GLA/simd.h>
+
+#if defined(GLA_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace gla {
+
+namespace {
+
+    struct CpuFeatures {
+        bool avx = false;
+        bool avx2 = false;
+
+        CpuFeatures() {
+#if defined(GLA_X86) && defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 0);
+            int maxLeaf = info[0];
+            __cpuid(info, 1);
+            // the OS has to save the ymm registers on context switches (OSXSAVE and XCR0 bits 1, 2)
+            bool osYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+            avx = osYmm && (info[2] & (1 << 28));
+            if (maxLeaf >= 7) {
+                __cpuidex(info, 7, 0);
+                avx2 = avx && (info[1] & (1 << 5));
+            }
+#elif defined(GLA_X86)
+            __builtin_cpu_init();
+            avx = __builtin_cpu_supports("avx");
+            avx2 = __builtin_cpu_supports("avx2");
+#endif
+        }
+    };
+
+    const CpuFeatures& features() {
+        static const CpuFeatures features;
+        return features;
+    }
+
+}
+
+bool hasAvx2() { return features().avx2; }
+
+bool hasAvx() { return features().avx; }
+
+}
@@ -0,0 +1,405 @@
+#include <GLA/skinning.h>
+
+#include <GLA/simd.h>
+#include <GLA/debug.h>
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <glm/glm.hpp>
+
+#ifdef GLA_X86
+#include <immintrin.h>
+#endif
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    constexpr int kStreams = 10;                            // translation xyz, rotation xyzw, scale xyz
+    constexpr int kRotation = 3;                            // first rotation stream
+    constexpr int kLinearStreams[] = { 0, 1, 2, 7, 8, 9 };  // streams interpolated linearly
+    constexpr int kPaletteFloats = 12;                      // three rows of an affine matrix per bone
+
+    // frame before the sampled time and the fraction towards the next frame
+    void sampleTime(const AnimationLayer& layer, int& frame, float& t) {
+        const AnimationClip& clip = *layer.clip;
+        float duration = clip.duration();
+        if (clip.frameCount() == 1) {
+            frame = 0;
+            t = 0.0f;
+            return;
+        }
+        float time = layer.time;
+        if (layer.loop) {
+            time = std::fmod(time, duration);
+            if (time < 0.0f)
+                time += duration;
+        }
+        float position = std::clamp(time, 0.0f, duration) / duration * (float)(clip.frameCount() - 1);
+        frame = std::min((int)position, clip.frameCount() - 2);
+        t = position - (float)frame;
+    }
+
+#ifndef GLA_X86
+    // Adds weight times the interpolation of two frames to the pose. A rotation pointing away from the rotations accumulated
+    // so far is added negated, which is the same orientation, so blending always takes the short way.
+    void blendFramesScalar(const float* a, const float* b, float t, float weight, float* pose, int stride) {
+        for (int i = 0; i < stride; i++) {
+            for (int c : kLinearStreams) {
+                size_t o = (size_t)c * stride + i;
+                pose[o] += (a[o] + (b[o] - a[o]) * t) * weight;
+            }
+            float q[4];
+            float dot = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                size_t o = (size_t)(kRotation + k) * stride + i;
+                q[k] = a[o] + (b[o] - a[o]) * t;
+                dot += q[k] * pose[o];
+            }
+            float w = dot < 0.0f ? -weight : weight;
+            for (int k = 0; k < 4; k++)
+                pose[(size_t)(kRotation + k) * stride + i] += q[k] * w;
+        }
+    }
+#else
+    // Adds weight times the interpolation of two frames to the pose, 4 bones at a time, see blendFramesScalar().
+    void blendFramesSse2(const float* a, const float* b, float t, float weight, float* pose, int stride) {
+        __m128 t4 = _mm_set1_ps(t);
+        __m128 w4 = _mm_set1_ps(weight);
+        __m128 signBit = _mm_set1_ps(-0.0f);
+        for (int i = 0; i < stride; i += 4) {
+            for (int c : kLinearStreams) {
+                size_t o = (size_t)c * stride + i;
+                __m128 a4 = _mm_loadu_ps(a + o);
+                __m128 v = _mm_add_ps(a4, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + o), a4), t4));
+                _mm_storeu_ps(pose + o, _mm_add_ps(_mm_loadu_ps(pose + o), _mm_mul_ps(v, w4)));
+            }
+            __m128 q[4];
+            __m128 dot = _mm_setzero_ps();
+            for (int k = 0; k < 4; k++) {
+                size_t o = (size_t)(kRotation + k) * stride + i;
+                __m128 a4 = _mm_loadu_ps(a + o);
+                q[k] = _mm_add_ps(a4, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + o), a4), t4));
+                dot = _mm_add_ps(dot, _mm_mul_ps(q[k], _mm_loadu_ps(pose + o)));
+            }
+            __m128 w = _mm_xor_ps(w4, _mm_and_ps(_mm_cmplt_ps(dot, _mm_setzero_ps()), signBit));
+            for (int k = 0; k < 4; k++) {
+                size_t o = (size_t)(kRotation + k) * stride + i;
+                _mm_storeu_ps(pose + o, _mm_add_ps(_mm_loadu_ps(pose + o), _mm_mul_ps(q[k], w)));
+            }
+        }
+    }
+
+    GLA_TARGET_AVX void blendFramesAvx(const float* a, const float* b, float t, float weight, float* pose, int stride) {
+        __m256 t8 = _mm256_set1_ps(t);
+        __m256 w8 = _mm256_set1_ps(weight);
+        __m256 signBit = _mm256_set1_ps(-0.0f);
+        for (int i = 0; i < stride; i += 8) {
+            for (int c : kLinearStreams) {
+                size_t o = (size_t)c * stride + i;
+                __m256 a8 = _mm256_loadu_ps(a + o);
+                __m256 v = _mm256_add_ps(a8, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(b + o), a8), t8));
+                _mm256_storeu_ps(pose + o, _mm256_add_ps(_mm256_loadu_ps(pose + o), _mm256_mul_ps(v, w8)));
+            }
+            __m256 q[4];
+            __m256 dot = _mm256_setzero_ps();
+            for (int k = 0; k < 4; k++) {
+                size_t o = (size_t)(kRotation + k) * stride + i;
+                __m256 a8 = _mm256_loadu_ps(a + o);
+                q[k] = _mm256_add_ps(a8, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(b + o), a8), t8));
+                dot = _mm256_add_ps(dot, _mm256_mul_ps(q[k], _mm256_loadu_ps(pose + o)));
+            }
+            __m256 w = _mm256_xor_ps(w8, _mm256_and_ps(_mm256_cmp_ps(dot, _mm256_setzero_ps(), _CMP_LT_OQ), signBit));
+            for (int k = 0; k < 4; k++) {
+                size_t o = (size_t)(kRotation + k) * stride + i;
+                _mm256_storeu_ps(pose + o, _mm256_add_ps(_mm256_loadu_ps(pose + o), _mm256_mul_ps(q[k], w)));
+            }
+        }
+    }
+#endif
+
+    void checkPose(const SkinnedPose& pose) {
+        if (!pose.skeleton)
+            throw std::invalid_argument("SkinnedPose needs a skeleton!");
+        float total = 0.0f;
+        for (const AnimationLayer& layer : pose.layers) {
+            if (!layer.clip || layer.clip->boneCount() != pose.skeleton->boneCount())
+                throw std::invalid_argument("AnimationLayer clip must have as many bones as the skeleton!");
+            if (!(layer.weight >= 0.0f))
+                throw std::invalid_argument("AnimationLayer weight must be at least 0!");
+            total += layer.weight;
+        }
+        if (!(total > 0.0f))
+            throw std::invalid_argument("SkinnedPose layer weights must sum up to more than 0!");
+    }
+
+    // expects a checked pose
+    void evaluatePalette(const SkinnedPose& pose, float* palette, bool avx) {
+        const Skeleton& skeleton = *pose.skeleton;
+        int bones = skeleton.boneCount();
+        int stride = pose.layers[0].clip->stride();
+
+        // local transforms of all bones as structure of arrays, blended layer by layer
+        alignas(32) float local[kStreams * Skeleton::kMaxBones];
+        std::fill(local, local + (size_t)kStreams * stride, 0.0f);
+        float total = 0.0f;
+        for (const AnimationLayer& layer : pose.layers) {
+            if (layer.weight == 0.0f)
+                continue;
+            int frame;
+            float t;
+            sampleTime(layer, frame, t);
+            const float* a = layer.clip->frame(frame);
+            const float* b = layer.clip->frame(std::min(frame + 1, layer.clip->frameCount() - 1));
+#ifdef GLA_X86
+            if (avx)
+                blendFramesAvx(a, b, t, layer.weight, local, stride);
+            else
+                blendFramesSse2(a, b, t, layer.weight, local, stride);
+#else
+            (void)avx;
+            blendFramesScalar(a, b, t, layer.weight, local, stride);
+#endif
+            total += layer.weight;
+        }
+
+        // the hierarchy is walked in order, parents precede their children
+        glm::mat4 model[Skeleton::kMaxBones];
+        float inverseTotal = 1.0f / total;
+        const std::vector<int>& parents = skeleton.parents();
+        const std::vector<glm::mat4>& inverseBind = skeleton.inverseBindMatrices();
+        for (int bone = 0; bone < bones; bone++) {
+            const float* c = local + bone;
+            glm::vec3 translation(c[0], c[stride], c[2 * stride]);
+            glm::quat rotation(c[6 * stride], c[3 * stride], c[4 * stride], c[5 * stride]);
+            glm::vec3 scale(c[7 * stride], c[8 * stride], c[9 * stride]);
+            float length = glm::length(rotation);
+            rotation = length > 0.0f ? rotation / length : glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+
+            glm::mat3 basis = glm::mat3_cast(rotation);
+            scale *= inverseTotal;
+            glm::mat4 transform(glm::vec4(basis[0] * scale.x, 0.0f), glm::vec4(basis[1] * scale.y, 0.0f),
+                                glm::vec4(basis[2] * scale.z, 0.0f), glm::vec4(translation * inverseTotal, 1.0f));
+            model[bone] = parents[bone] < 0 ? transform : model[parents[bone]] * transform;
+
+            glm::mat4 skin = model[bone] * inverseBind[bone];
+            float* rows = palette + (size_t)bone * kPaletteFloats;
+            for (int row = 0; row < 3; row++)
+                for (int column = 0; column < 4; column++)
+                    rows[row * 4 + column] = skin[column][row];
+        }
+    }
+
+    const char* kSkinningSource = R"(
+layout(location = SKIN_JOINTS_LOCATION) in uvec4 skinJoints;
+layout(location = SKIN_WEIGHTS_LOCATION) in vec4 skinWeights;
+uniform uint uSkinPaletteOffset;
+
+layout(std430, binding = SKIN_PALETTE_BINDING) readonly buffer SkinPalettes {
+    vec4 skinPalette[];     // three rows of an affine matrix per bone
+};
+
+mat3x4 skinMatrix() {
+    mat3x4 skin = mat3x4(0.0);
+    for (int i = 0; i < 4; i++) {
+        uint bone = (uSkinPaletteOffset + skinJoints[i]) * 3u;
+        skin += skinWeights[i] * mat3x4(skinPalette[bone], skinPalette[bone + 1u], skinPalette[bone + 2u]);
+    }
+    return skin;
+}
+
+vec3 skinPosition(mat3x4 skin, vec3 position) {
+    return vec4(position, 1.0) * skin;
+}
+
+// normals are only correct for uniformly scaled bones
+vec3 skinDirection(mat3x4 skin, vec3 direction) {
+    return vec4(direction, 0.0) * skin;
+}
+)";
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class Skeleton
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+Skeleton::Skeleton(std::vector<int> parents, std::vector<glm::mat4> inverseBindMatrices)
+    : _parents(std::move(parents)), _inverseBind(std::move(inverseBindMatrices)) {
+    if (_parents.size() != _inverseBind.size())
+        throw std::invalid_argument("Skeleton needs an inverse bind matrix for every bone!");
+    if (_parents.empty() || _parents.size() > (size_t)kMaxBones)
+        throw std::invalid_argument("Skeleton must have between 1 and " + std::to_string(kMaxBones) + " bones!");
+    for (size_t bone = 0; bone < _parents.size(); bone++)
+        if (_parents[bone] < -1 || _parents[bone] >= (int)bone)
+            throw std::invalid_argument("Skeleton bones must be preceded by their parent!");
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class AnimationClip
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+AnimationClip::AnimationClip(int boneCount, float sampleRate, std::span<const BoneTransform> keys) {
+    if (boneCount <= 0 || boneCount > Skeleton::kMaxBones)
+        throw std::invalid_argument("AnimationClip must have between 1 and " + std::to_string(Skeleton::kMaxBones) + " bones!");
+    if (!(sampleRate > 0.0f))
+        throw std::invalid_argument("AnimationClip sampleRate must be greater than 0!");
+    if (keys.empty() || keys.size() % (size_t)boneCount != 0)
+        throw std::invalid_argument("AnimationClip needs a whole number of keyframes!");
+
+    _boneCount = boneCount;
+    _stride = (boneCount + 7) & ~7;
+    _frameCount = (int)(keys.size() / (size_t)boneCount);
+    _sampleRate = sampleRate;
+    _data.assign((size_t)_frameCount * kStreams * _stride, 0.0f);
+
+    for (int frame = 0; frame < _frameCount; frame++) {
+        float* streams = _data.data() + (size_t)frame * kStreams * _stride;
+        for (int bone = 0; bone < boneCount; bone++) {
+            const BoneTransform& key = keys[(size_t)frame * boneCount + bone];
+            // consecutive rotations share a hemisphere, so sampling can interpolate them without a sign check
+            glm::quat rotation = key.rotation;
+            if (frame > 0) {
+                const float* previous = streams - (size_t)kStreams * _stride + bone;
+                glm::quat last(previous[6 * _stride], previous[3 * _stride], previous[4 * _stride], previous[5 * _stride]);
+                if (glm::dot(rotation, last) < 0.0f)
+                    rotation = -rotation;
+            }
+            const float values[kStreams] = { key.translation.x, key.translation.y, key.translation.z,
+                                             rotation.x, rotation.y, rotation.z, rotation.w,
+                                             key.scale.x, key.scale.y, key.scale.z };
+            for (int c = 0; c < kStreams; c++)
+                streams[(size_t)c * _stride + bone] = values[c];
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+// functions
+// ----------------------------------------------------------------------------------------------------
+
+SkinVertex packSkinVertex(const glm::uvec4& joints, const glm::vec4& weights) {
+    float total = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        if (joints[i] >= (unsigned int)Skeleton::kMaxBones)
+            throw std::invalid_argument("SkinVertex joints must be less than " + std::to_string(Skeleton::kMaxBones) + "!");
+        if (!(weights[i] >= 0.0f))
+            throw std::invalid_argument("SkinVertex weights must be at least 0!");
+        total += weights[i];
+    }
+    if (!(total > 0.0f))
+        throw std::invalid_argument("SkinVertex needs a weight greater than 0!");
+
+    // the rounding error goes to the largest weight, so the weights sum up to exactly 65535
+    SkinVertex vertex;
+    int sum = 0;
+    int largest = 0;
+    for (int i = 0; i < 4; i++) {
+        int weight = (int)std::lround(weights[i] / total * 65535.0f);
+        vertex.joints[i] = (uint8_t)joints[i];
+        vertex.weights[i] = (uint16_t)weight;
+        sum += weight;
+        if (weights[i] > weights[largest])
+            largest = i;
+    }
+    vertex.weights[largest] = (uint16_t)(vertex.weights[largest] + 65535 - sum);
+    return vertex;
+}
+
+void evaluateSkinPalette(const SkinnedPose& pose, float* palette) {
+    checkPose(pose);
+    evaluatePalette(pose, palette, hasAvx());
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class Skinning
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+Skinning::Skinning(const SkinningSettings& settings, ThreadPool& pool)
+    : _settings(settings), _pool(pool),
+      _palettes(BufferType::ShaderStorage, (int64_t)std::max(settings.maxBones, 1) * kPaletteFloats * sizeof(float) + 256) {
+    if (settings.maxBones <= 0)
+        throw std::invalid_argument("Skinning maxBones must be greater than 0!");
+
+    GLint alignment = 256;
+    GL_CALL(glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    _storageAlignment = std::max(alignment, 1);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void Skinning::update(std::span<const SkinnedPose> poses) {
+    std::vector<uint32_t> offsets(poses.size());
+    int64_t bones = 0;
+    for (size_t i = 0; i < poses.size(); i++) {
+        checkPose(poses[i]);
+        offsets[i] = (uint32_t)bones;
+        bones += poses[i].skeleton->boneCount();
+    }
+    if (bones > _settings.maxBones)
+        throw std::invalid_argument("Skinning poses have more than " + std::to_string(_settings.maxBones) + " bones!");
+
+    // the previous frame ends here, so its Fence also covers the draws that read its palettes
+    if (_frameOpen)
+        _palettes.endFrame();
+    _palettes.beginFrame();
+    _frameOpen = true;
+    _offsets = std::move(offsets);
+    _paletteOffset = 0;
+    _paletteSize = 0;
+    if (bones == 0)
+        return;
+
+    RingAllocation allocation = _palettes.allocate(bones * kPaletteFloats * (int64_t)sizeof(float), _storageAlignment);
+    _paletteOffset = allocation.offset;
+    _paletteSize = allocation.size;
+
+    // the workers write straight into the mapped Buffer, every pose into its own range
+    float* palette = (float*)allocation.data;
+    bool avx = hasAvx();
+    _pool.parallelFor(poses.size(), 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            evaluatePalette(poses[i], palette + (size_t)_offsets[i] * kPaletteFloats, avx);
+    });
+}
+
+void Skinning::bind(Program& program, size_t pose) const {
+    if (pose >= _offsets.size())
+        throw std::out_of_range("Skinning pose index is out of range!");
+    _palettes.buffer().bindRange(_settings.paletteBinding, _paletteOffset, _paletteSize);
+    program["uSkinPaletteOffset"] = _offsets[pose];
+}
+
+std::vector<VertexAttribute> Skinning::skinAttributes(int offset) const {
+    return {
+        { _settings.jointsLocation, 4, VertexAttribType::UnsignedByte, VertexAttribInterp::Integer, false, offset + (int)offsetof(SkinVertex, joints) },
+        { _settings.weightsLocation, 4, VertexAttribType::UnsignedShort, VertexAttribInterp::Float, true, offset + (int)offsetof(SkinVertex, weights) }
+    };
+}
+
+std::string Skinning::glslSource() const {
+    return "#define SKIN_PALETTE_BINDING " + std::to_string(_settings.paletteBinding) +
+           "\n#define SKIN_JOINTS_LOCATION " + std::to_string(_settings.jointsLocation) +
+           "\n#define SKIN_WEIGHTS_LOCATION " + std::to_string(_settings.weightsLocation) + "\n" + kSkinningSource;
+}
+
+}
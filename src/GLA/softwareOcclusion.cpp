@@ -0,0 +1,323 @@
+#include <GLA/softwareOcclusion.h>
+
+#include <GLA/simd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#ifdef GLA_X86
+#include <immintrin.h>
+#endif
+
+namespace gla {
+
+namespace {
+
+    constexpr int kTileSize = 32;
+    constexpr int kBlockSize = 8;
+    constexpr int kBlocksPerTile = kTileSize / kBlockSize;
+
+    template <typename Triangle>
+    void rasterizeScalar(const std::vector<Triangle>& triangles, const std::vector<uint32_t>& bin, float* depth, int stride, int x0, int y0, int x1, int y1) {
+        for (uint32_t index : bin) {
+            const Triangle& t = triangles[index];
+            int minX = std::max(t.minX, x0), maxX = std::min(t.maxX, x1);
+            int minY = std::max(t.minY, y0), maxY = std::min(t.maxY, y1);
+            for (int y = minY; y < maxY; y++) {
+                float fy = (float)y;
+                float c0 = t.edgeB[0] * fy + t.edgeC[0], c1 = t.edgeB[1] * fy + t.edgeC[1], c2 = t.edgeB[2] * fy + t.edgeC[2];
+                float cz = t.depthB * fy + t.depthC;
+                float* row = depth + (size_t)y * stride;
+                for (int x = minX; x < maxX; x++) {
+                    float fx = (float)x;
+                    if (t.edgeA[0] * fx + c0 < 0.0f || t.edgeA[1] * fx + c1 < 0.0f || t.edgeA[2] * fx + c2 < 0.0f)
+                        continue;
+                    float z = std::min(t.depthA * fx + cz, t.depthMax);
+                    row[x] = std::min(row[x], z);
+                }
+            }
+        }
+    }
+
+#ifdef GLA_X86
+    template <typename Triangle>
+    GLA_TARGET_AVX2 void rasterizeAvx2(const std::vector<Triangle>& triangles, const std::vector<uint32_t>& bin, float* depth, int stride, int x0, int y0, int x1, int y1) {
+        const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+        const __m256 zero = _mm256_setzero_ps();
+        for (uint32_t index : bin) {
+            const Triangle& t = triangles[index];
+            // 8 pixel spans start 8 aligned inside the tile, so they never leave it
+            int minX = std::max(t.minX, x0) & ~7, maxX = std::min(t.maxX, x1);
+            int minY = std::max(t.minY, y0), maxY = std::min(t.maxY, y1);
+            __m256 a0 = _mm256_set1_ps(t.edgeA[0]), a1 = _mm256_set1_ps(t.edgeA[1]), a2 = _mm256_set1_ps(t.edgeA[2]);
+            __m256 depthA = _mm256_set1_ps(t.depthA), depthMax = _mm256_set1_ps(t.depthMax);
+            for (int y = minY; y < maxY; y++) {
+                float fy = (float)y;
+                __m256 c0 = _mm256_set1_ps(t.edgeB[0] * fy + t.edgeC[0]);
+                __m256 c1 = _mm256_set1_ps(t.edgeB[1] * fy + t.edgeC[1]);
+                __m256 c2 = _mm256_set1_ps(t.edgeB[2] * fy + t.edgeC[2]);
+                __m256 cz = _mm256_set1_ps(t.depthB * fy + t.depthC);
+                float* row = depth + (size_t)y * stride;
+                for (int x = minX; x < maxX; x += 8) {
+                    __m256 xs = _mm256_add_ps(_mm256_set1_ps((float)x), lanes);
+                    __m256 inside = _mm256_and_ps(
+                        _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a0, xs), c0), zero, _CMP_GE_OQ),
+                                      _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a1, xs), c1), zero, _CMP_GE_OQ)),
+                        _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(a2, xs), c2), zero, _CMP_GE_OQ));
+                    if (_mm256_testz_ps(inside, inside))
+                        continue;
+                    __m256 z = _mm256_min_ps(_mm256_add_ps(_mm256_mul_ps(depthA, xs), cz), depthMax);
+                    __m256 current = _mm256_loadu_ps(row + x);
+                    _mm256_storeu_ps(row + x, _mm256_blendv_ps(current, _mm256_min_ps(current, z), inside));
+                }
+            }
+        }
+    }
+#endif
+
+    // Sutherland-Hodgman against the near plane z >= -w, returns the amount of vertices (0, 3 or 4)
+    int clipNear(const glm::vec4* in, glm::vec4* out) {
+        int count = 0;
+        for (int i = 0; i < 3; i++) {
+            const glm::vec4& a = in[i];
+            const glm::vec4& b = in[(i + 1) % 3];
+            float da = a.z + a.w, db = b.z + b.w;
+            if (da >= 0.0f)
+                out[count++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f))
+                out[count++] = a + (b - a) * (da / (da - db));
+        }
+        return count;
+    }
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class SoftwareOcclusion
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void SoftwareOcclusion::_setup(const glm::vec4* clip) {
+    float width = (float)_settings.width, height = (float)_settings.height;
+    glm::vec3 screen[3];
+    for (int i = 0; i < 3; i++) {
+        glm::vec3 ndc = glm::vec3(clip[i]) / clip[i].w;
+        screen[i] = glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+    }
+
+    float area = (screen[1].x - screen[0].x) * (screen[2].y - screen[0].y) - (screen[2].x - screen[0].x) * (screen[1].y - screen[0].y);
+    if (area == 0.0f || !std::isfinite(area) || (area < 0.0f && _settings.backfaceCulling))
+        return;
+    if (area < 0.0f) {
+        std::swap(screen[1], screen[2]);
+        area = -area;
+    }
+
+    glm::vec3 low = glm::min(screen[0], glm::min(screen[1], screen[2]));
+    glm::vec3 high = glm::max(screen[0], glm::max(screen[1], screen[2]));
+    Triangle t;
+    t.minX = std::max((int)std::floor(low.x), 0);
+    t.minY = std::max((int)std::floor(low.y), 0);
+    t.maxX = (int)std::min(std::ceil(high.x), width);
+    t.maxY = (int)std::min(std::ceil(high.y), height);
+    if (t.minX >= t.maxX || t.minY >= t.maxY || low.z > 1.0f)
+        return;
+
+    // counter clockwise edges are >= 0 on their left, evaluated at pixel centers (shared edges are drawn twice, which
+    // is harmless for a depth only buffer and avoids cracks between the triangles of an occluder)
+    for (int i = 0; i < 3; i++) {
+        const glm::vec3& a = screen[i];
+        const glm::vec3& b = screen[(i + 1) % 3];
+        float edgeA = a.y - b.y, edgeB = b.x - a.x;
+        t.edgeA[i] = edgeA;
+        t.edgeB[i] = edgeB;
+        t.edgeC[i] = -(edgeA * a.x + edgeB * a.y) + 0.5f * (edgeA + edgeB);
+    }
+
+    // depth plane evaluated at the pixel center plus half a pixel's extent towards the far side
+    glm::vec3 d1 = screen[1] - screen[0], d2 = screen[2] - screen[0];
+    t.depthA = (d1.z * d2.y - d2.z * d1.y) / area;
+    t.depthB = (d2.z * d1.x - d1.z * d2.x) / area;
+    t.depthC = screen[0].z - t.depthA * screen[0].x - t.depthB * screen[0].y + 0.5f * (t.depthA + t.depthB) +
+               0.5f * (std::abs(t.depthA) + std::abs(t.depthB));
+    t.depthMax = high.z;
+    _triangles.push_back(t);
+}
+
+void SoftwareOcclusion::_rasterizeTile(int tile) {
+    int tileX = tile % _tilesX, tileY = tile / _tilesX;
+    int x0 = tileX * kTileSize, y0 = tileY * kTileSize;
+    int x1 = x0 + kTileSize, y1 = y0 + kTileSize;
+
+    for (int y = y0; y < y1; y++)
+        std::fill_n(_depth.data() + (size_t)y * _stride + x0, kTileSize, 1.0f);
+#ifdef GLA_X86
+    if (_avx2)
+        rasterizeAvx2(_triangles, _bins[tile], _depth.data(), _stride, x0, y0, x1, y1);
+    else
+#endif
+        rasterizeScalar(_triangles, _bins[tile], _depth.data(), _stride, x0, y0, x1, y1);
+
+    int blocksX = _stride / kBlockSize;
+    float tileMax = 0.0f;
+    for (int by = 0; by < kBlocksPerTile; by++) {
+        for (int bx = 0; bx < kBlocksPerTile; bx++) {
+            int px = x0 + bx * kBlockSize, py = y0 + by * kBlockSize;
+            float blockMax = 0.0f;
+            for (int y = py; y < py + kBlockSize; y++) {
+                const float* row = _depth.data() + (size_t)y * _stride + px;
+                for (int x = 0; x < kBlockSize; x++)
+                    blockMax = std::max(blockMax, row[x]);
+            }
+            _blockMax[(size_t)(py / kBlockSize) * blocksX + px / kBlockSize] = blockMax;
+            tileMax = std::max(tileMax, blockMax);
+        }
+    }
+    _tileMax[tile] = tileMax;
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+SoftwareOcclusion::SoftwareOcclusion(const SoftwareOcclusionSettings& settings, ThreadPool& pool)
+    : _settings(settings), _pool(pool), _avx2(hasAvx2()) {
+    if (settings.width <= 0 || settings.height <= 0)
+        throw std::invalid_argument("SoftwareOcclusion resolution must be greater than 0!");
+    _tilesX = (settings.width + kTileSize - 1) / kTileSize;
+    _tilesY = (settings.height + kTileSize - 1) / kTileSize;
+    _stride = _tilesX * kTileSize;
+    _bins.resize((size_t)_tilesX * _tilesY);
+    _depth.assign((size_t)_stride * _tilesY * kTileSize, 1.0f);
+    _blockMax.assign(_depth.size() / (kBlockSize * kBlockSize), 1.0f);
+    _tileMax.assign(_bins.size(), 1.0f);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void SoftwareOcclusion::beginFrame(const glm::mat4& viewProjection) {
+    _viewProjection = viewProjection;
+    _triangles.clear();
+}
+
+void SoftwareOcclusion::addOccluder(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, const glm::mat4& model) {
+    if (indices.size() % 3 != 0)
+        throw std::invalid_argument("Occluder index count must be a multiple of 3!");
+
+    glm::mat4 matrix = _viewProjection * model;
+    std::vector<glm::vec4> clip(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+        clip[i] = matrix * glm::vec4(positions[i], 1.0f);
+
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        glm::vec4 corners[3];
+        for (int j = 0; j < 3; j++) {
+            if (indices[i + j] >= clip.size())
+                throw std::out_of_range("Occluder index " + std::to_string(indices[i + j]) + " is out of range!");
+            corners[j] = clip[indices[i + j]];
+        }
+
+        // trivially reject triangles completely outside one frustum plane
+        bool outside = false;
+        for (int axis = 0; axis < 3 && !outside; axis++) {
+            outside = (corners[0][axis] > corners[0].w && corners[1][axis] > corners[1].w && corners[2][axis] > corners[2].w) ||
+                      (axis < 2 && corners[0][axis] < -corners[0].w && corners[1][axis] < -corners[1].w && corners[2][axis] < -corners[2].w);
+        }
+        if (outside)
+            continue;
+
+        if (corners[0].z >= -corners[0].w && corners[1].z >= -corners[1].w && corners[2].z >= -corners[2].w) {
+            _setup(corners);
+            continue;
+        }
+        glm::vec4 clipped[4];
+        int count = clipNear(corners, clipped);
+        for (int j = 2; j < count; j++) {
+            glm::vec4 fan[3] = { clipped[0], clipped[j - 1], clipped[j] };
+            _setup(fan);
+        }
+    }
+}
+
+void SoftwareOcclusion::rasterize() {
+    for (std::vector<uint32_t>& bin : _bins)
+        bin.clear();
+    for (uint32_t i = 0; i < (uint32_t)_triangles.size(); i++) {
+        const Triangle& t = _triangles[i];
+        for (int y = t.minY / kTileSize; y <= (t.maxY - 1) / kTileSize; y++)
+            for (int x = t.minX / kTileSize; x <= (t.maxX - 1) / kTileSize; x++)
+                _bins[(size_t)y * _tilesX + x].push_back(i);
+    }
+
+    _pool.parallelFor(_bins.size(), 1, [this](size_t begin, size_t end) {
+        for (size_t tile = begin; tile < end; tile++)
+            _rasterizeTile((int)tile);
+    });
+}
+
+bool SoftwareOcclusion::testBox(const glm::vec3& min, const glm::vec3& max) const {
+    glm::vec2 low(1e30f), high(-1e30f);
+    float nearest = 1.0f;
+    for (int i = 0; i < 8; i++) {
+        glm::vec4 clip = _viewProjection * glm::vec4(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z, 1.0f);
+        if (clip.w <= 0.0f || clip.z < -clip.w)
+            return true;
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        low = glm::min(low, glm::vec2(ndc));
+        high = glm::max(high, glm::vec2(ndc));
+        nearest = std::min(nearest, ndc.z * 0.5f + 0.5f);
+    }
+    if (low.x > 1.0f || low.y > 1.0f || high.x < -1.0f || high.y < -1.0f || nearest > 1.0f)
+        return false;
+
+    // every pixel the box touches, hidden only if all of them hold a nearer occluder
+    int minX = std::max((int)std::floor((low.x * 0.5f + 0.5f) * _settings.width), 0);
+    int minY = std::max((int)std::floor((low.y * 0.5f + 0.5f) * _settings.height), 0);
+    int maxX = std::min((int)std::ceil((high.x * 0.5f + 0.5f) * _settings.width), _settings.width);
+    int maxY = std::min((int)std::ceil((high.y * 0.5f + 0.5f) * _settings.height), _settings.height);
+    if (minX >= maxX || minY >= maxY)
+        return true;
+
+    int blocksX = _stride / kBlockSize;
+    for (int ty = minY / kTileSize; ty <= (maxY - 1) / kTileSize; ty++) {
+        for (int tx = minX / kTileSize; tx <= (maxX - 1) / kTileSize; tx++) {
+            if (_tileMax[(size_t)ty * _tilesX + tx] < nearest)
+                continue;
+            int bx0 = std::max(minX, tx * kTileSize) / kBlockSize, bx1 = (std::min(maxX, (tx + 1) * kTileSize) - 1) / kBlockSize;
+            int by0 = std::max(minY, ty * kTileSize) / kBlockSize, by1 = (std::min(maxY, (ty + 1) * kTileSize) - 1) / kBlockSize;
+            for (int by = by0; by <= by1; by++) {
+                for (int bx = bx0; bx <= bx1; bx++) {
+                    if (_blockMax[(size_t)by * blocksX + bx] < nearest)
+                        continue;
+                    int x1 = std::min(maxX, (bx + 1) * kBlockSize);
+                    int y1 = std::min(maxY, (by + 1) * kBlockSize);
+                    for (int y = std::max(minY, by * kBlockSize); y < y1; y++) {
+                        const float* row = _depth.data() + (size_t)y * _stride;
+                        for (int x = std::max(minX, bx * kBlockSize); x < x1; x++)
+                            if (row[x] >= nearest)
+                                return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void SoftwareOcclusion::testBoxes(std::span<const glm::vec3> minimums, std::span<const glm::vec3> maximums, std::span<uint8_t> visibility) const {
+    if (minimums.size() != maximums.size() || minimums.size() != visibility.size())
+        throw std::invalid_argument("testBoxes needs the same amount of minimums, maximums and visibility entries!");
+    _pool.parallelFor(minimums.size(), 256, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            visibility[i] = testBox(minimums[i], maximums[i]) ? 1 : 0;
+    });
+}
+
+}
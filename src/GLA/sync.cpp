@@ -0,0 +1,76 @@
+#include <GLA/sync.h>
+
+#include <GLA/debug.h>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+// ----------------------------------------------------------------------------------------------------
+// class Fence
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void Fence::_delete() {
+    if (_sync != nullptr)
+        GL_CALL(glDeleteSync(static_cast<GLsync>(_sync)));
+    _sync = nullptr;
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+Fence::Fence(Fence&& other) : _sync(other._sync) { other._sync = nullptr; }
+
+Fence::~Fence() noexcept { _delete(); }
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void Fence::place() {
+    _delete();
+    GL_CALL(_sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    if (_sync == nullptr)
+        throw std::runtime_error("Failed to create sync object!");
+}
+
+void Fence::reset() { _delete(); }
+
+bool Fence::signaled() const {
+    if (_sync == nullptr)
+        return true;
+    GLint status = GL_UNSIGNALED;
+    GL_CALL(glGetSynciv(static_cast<GLsync>(_sync), GL_SYNC_STATUS, 1, nullptr, &status));
+    return status == GL_SIGNALED;
+}
+
+bool Fence::wait(uint64_t timeout) {
+    if (_sync == nullptr)
+        return true;
+    GLenum result;
+    GL_CALL(result = glClientWaitSync(static_cast<GLsync>(_sync), GL_SYNC_FLUSH_COMMANDS_BIT, timeout));
+    if (result == GL_WAIT_FAILED)
+        throw std::runtime_error("glClientWaitSync failed!");
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+// --------------------------------------------------
+// operator overloads
+// --------------------------------------------------
+
+Fence& Fence::operator=(Fence&& other) {
+    if (this != &other) {
+        _delete();
+        _sync = other._sync;
+        other._sync = nullptr;
+    }
+    return *this;
+}
+
+}
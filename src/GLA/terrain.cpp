@@ -0,0 +1,472 @@
+#include <GLA/terrain.h>
+
+#include <GLA/debug.h>
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <glm/glm.hpp>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    constexpr int kMaxLevels = 16;
+    constexpr int kMaxTiles = 1 << 14;      // tiles per axis at level 0, x and z have 14 bits in a tile key
+
+    struct ChunkHeader {
+        glm::vec4 camera;                   // camera position, quads per chunk edge
+        glm::vec4 heights;                  // minimum height, height range, texels per tile edge
+        glm::vec4 morph[kMaxLevels];        // morph start distance, 1 / morph range
+    };
+
+    uint32_t tileKey(int level, int x, int z) {
+        return (uint32_t)level << 28 | (uint32_t)z << 14 | (uint32_t)x;
+    }
+
+    const TerrainSettings& checkSettings(const TerrainSettings& settings) {
+        if (settings.rootTilesX <= 0 || settings.rootTilesZ <= 0 || settings.levels <= 0 || settings.rootSize <= 0.0f ||
+            settings.tileSize <= 0 || settings.gridSize <= 0 || settings.cacheTiles <= 0 || settings.maxChunks <= 0 ||
+            settings.maxLoads <= 0 || settings.maxUploadsPerFrame <= 0)
+            throw std::invalid_argument("Terrain tile counts, sizes and limits must be greater than 0!");
+        if (settings.levels > kMaxLevels)
+            throw std::invalid_argument("Terrain may have at most " + std::to_string(kMaxLevels) + " levels!");
+        if ((int64_t)std::max(settings.rootTilesX, settings.rootTilesZ) << (settings.levels - 1) > kMaxTiles)
+            throw std::invalid_argument("Terrain has more than " + std::to_string(kMaxTiles) + " tiles per axis at level 0!");
+        if (settings.gridSize % 2 != 0 || settings.gridSize > 1024)
+            throw std::invalid_argument("Terrain gridSize must be even and at most 1024!");
+        if (!(settings.maxHeight > settings.minHeight))
+            throw std::invalid_argument("Terrain maxHeight must be greater than minHeight!");
+        if (!(settings.morphRatio >= 0.0f && settings.morphRatio < 1.0f))
+            throw std::invalid_argument("Terrain morphRatio must be in [0;1)!");
+        // a chunk must be able to morph completely before it meets a chunk of the next level
+        float chunkSize = std::ldexp(settings.rootSize, 1 - settings.levels);
+        if (settings.levels > 1 && settings.lodDistance < 2.0f * chunkSize)
+            throw std::invalid_argument("Terrain lodDistance must be at least twice the size of a level 0 chunk!");
+        if (settings.cacheTiles < settings.rootTilesX * settings.rootTilesZ)
+            throw std::invalid_argument("Terrain cacheTiles must hold at least all coarsest tiles!");
+        return settings;
+    }
+
+    // grid of (gridSize + 1)^2 vertices, the triangles are ordered by quadrant so each quadrant is one submesh
+    MeshData gridMesh(int gridSize) {
+        MeshData mesh;
+        mesh.attributes = { { 0, 2, VertexAttribType::UnsignedShort, VertexAttribInterp::Float, false, 0 } };
+        mesh.stride = 2 * sizeof(uint16_t);
+        int row = gridSize + 1;
+        mesh.vertexCount = (uint32_t)(row * row);
+        mesh.vertices.resize(mesh.vertexCount * mesh.stride);
+        uint16_t* vertices = (uint16_t*)mesh.vertices.data();
+        for (int z = 0; z < row; z++) {
+            for (int x = 0; x < row; x++) {
+                vertices[2 * (z * row + x)] = (uint16_t)x;
+                vertices[2 * (z * row + x) + 1] = (uint16_t)z;
+            }
+        }
+
+        std::vector<uint32_t> indices;
+        int half = gridSize / 2;
+        for (int quadrant = 0; quadrant < 4; quadrant++) {
+            int x0 = (quadrant & 1) * half;
+            int z0 = (quadrant >> 1) * half;
+            uint32_t first = (uint32_t)indices.size();
+            for (int z = z0; z < z0 + half; z++) {
+                for (int x = x0; x < x0 + half; x++) {
+                    uint32_t i = (uint32_t)(z * row + x);
+                    indices.insert(indices.end(), { i, i + row, i + 1, i + 1, i + row, i + row + 1 });
+                }
+            }
+            mesh.submeshes.push_back({ first, (uint32_t)indices.size() - first, 0, 0 });
+        }
+
+        mesh.indexCount = (uint32_t)indices.size();
+        if (mesh.vertexCount <= 65536) {
+            mesh.indexType = IndexType::UnsignedShort;
+            mesh.indices.resize(indices.size() * sizeof(uint16_t));
+            std::transform(indices.begin(), indices.end(), (uint16_t*)mesh.indices.data(), [](uint32_t i) { return (uint16_t)i; });
+        }
+        else {
+            mesh.indexType = IndexType::UnsignedInt;
+            mesh.indices.resize(indices.size() * sizeof(uint32_t));
+            std::copy(indices.begin(), indices.end(), (uint32_t*)mesh.indices.data());
+        }
+        mesh.boundsMax = glm::vec3((float)gridSize, 0.0f, (float)gridSize);
+        return mesh;
+    }
+
+    // planes of the view frustum as (normal, distance) pointing inwards
+    std::array<glm::vec4, 6> frustumPlanes(const glm::mat4& viewProjection) {
+        glm::mat4 m = glm::transpose(viewProjection);
+        return { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+    }
+
+    bool boxVisible(const std::array<glm::vec4, 6>& planes, const glm::vec3& min, const glm::vec3& max) {
+        for (const glm::vec4& plane : planes) {
+            glm::vec3 corner(plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z);
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    bool boxInRange(const glm::vec3& min, const glm::vec3& max, const glm::vec3& camera, float range) {
+        glm::vec3 closest = glm::clamp(camera, min, max);
+        return glm::dot(closest - camera, closest - camera) <= range * range;
+    }
+
+    const char* kTerrainSource = R"(
+layout(location = 0) in vec2 terrainGridPosition;
+layout(binding = TERRAIN_HEIGHT_UNIT) uniform sampler2DArray terrainHeights;
+uniform uint uTerrainChunkOffset;
+
+struct TerrainChunk {
+    vec4 bounds;    // origin x, origin z, size, level
+    vec4 tile;      // uv offset, uv scale, layer
+};
+
+layout(std430, binding = TERRAIN_CHUNK_BINDING) readonly buffer TerrainChunks {
+    vec4 terrainCamera;                     // camera position, quads per chunk edge
+    vec4 terrainHeight;                     // minimum height, height range, texels per tile edge
+    vec4 terrainMorph[TERRAIN_MAX_LEVELS];  // morph start distance, 1 / morph range
+    TerrainChunk terrainChunks[];
+};
+
+// world height at a position of the chunk grid, offset by whole texels of the sampled tile
+float terrainSample(TerrainChunk chunk, vec2 gridPosition, vec2 texelOffset) {
+    float tileSize = terrainHeight.z;
+    vec2 uv = chunk.tile.xy + gridPosition / terrainCamera.w * chunk.tile.z;
+    vec2 texel = uv * tileSize + texelOffset + 0.5;
+    return terrainHeight.x + terrainHeight.y * textureLod(terrainHeights, vec3(texel / (tileSize + 1.0), chunk.tile.w), 0.0).r;
+}
+
+void terrainVertex(out vec3 worldPosition, out vec3 normal) {
+    TerrainChunk chunk = terrainChunks[uTerrainChunkOffset + uint(gl_InstanceID)];
+    float quad = chunk.bounds.z / terrainCamera.w;
+    vec2 grid = terrainGridPosition;
+    vec2 xz = chunk.bounds.xy + grid * quad;
+    float height = terrainSample(chunk, grid, vec2(0.0));
+
+    // odd vertices slide onto their even neighbour, which is the grid of the next coarser level
+    vec4 morph = terrainMorph[int(chunk.bounds.w)];
+    float factor = clamp((distance(terrainCamera.xyz, vec3(xz.x, height, xz.y)) - morph.x) * morph.y, 0.0, 1.0);
+    grid -= fract(grid * 0.5) * 2.0 * factor;
+    xz = chunk.bounds.xy + grid * quad;
+    height = terrainSample(chunk, grid, vec2(0.0));
+
+    // central differences over the texels of the sampled tile
+    float texelSize = chunk.bounds.z / (chunk.tile.z * terrainHeight.z);
+    float dx = terrainSample(chunk, grid, vec2(1.0, 0.0)) - terrainSample(chunk, grid, vec2(-1.0, 0.0));
+    float dz = terrainSample(chunk, grid, vec2(0.0, 1.0)) - terrainSample(chunk, grid, vec2(0.0, -1.0));
+    normal = normalize(vec3(-dx, 2.0 * texelSize, -dz));
+    worldPosition = vec3(xz.x, height, xz.y);
+}
+)";
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class Terrain
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+float Terrain::_nodeSize(int level) const {
+    return std::ldexp(_settings.rootSize, level - (_settings.levels - 1));
+}
+
+const Terrain::TileState* Terrain::_residentTile(int level, int x, int z, int& residentLevel) const {
+    // the coarsest tiles are always resident, so the walk ends at the latest there
+    for (residentLevel = level; residentLevel < _settings.levels; residentLevel++) {
+        int shift = residentLevel - level;
+        auto it = _tiles.find(tileKey(residentLevel, x >> shift, z >> shift));
+        if (it != _tiles.end() && it->second.layer >= 0)
+            return &it->second;
+    }
+    throw std::logic_error("Coarsest terrain tile is not resident!");
+}
+
+glm::vec2 Terrain::_heightRange(int level, int x, int z) const {
+    int residentLevel;
+    return _residentTile(level, x, z, residentLevel)->heights;
+}
+
+void Terrain::_upload(LoadedTile& tile) {
+    int row = _settings.tileSize + 1;
+    TileState& state = _tiles[tile.key];
+    auto [low, high] = std::minmax_element(tile.heights.begin(), tile.heights.end());
+    float scale = (_settings.maxHeight - _settings.minHeight) / 65535.0f;
+    state.heights = glm::vec2(_settings.minHeight + *low * scale, _settings.minHeight + *high * scale);
+    _heights.setSubImage(0, 0, 0, state.layer, row, row, 1, tile.heights.data());
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+Terrain::Terrain(const TerrainSettings& settings, TileLoader loader, ThreadPool& pool)
+    : _settings(checkSettings(settings)), _loader(std::move(loader)), _pool(pool), _queue(std::make_shared<LoadQueue>()),
+      _heights(TextureType::Texture2DArray), _grid(gridMesh(settings.gridSize)),
+      _chunks(BufferType::ShaderStorage, sizeof(ChunkHeader) + (int64_t)settings.maxChunks * sizeof(Chunk) + 256) {
+    if (!_loader)
+        throw std::invalid_argument("Terrain needs a tile loader!");
+
+    GLint maxLayers = 256;
+    GL_CALL(glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers));
+    if (settings.cacheTiles > maxLayers)
+        throw std::invalid_argument("Terrain cacheTiles exceeds the " + std::to_string(maxLayers) + " layers supported by the GPU!");
+
+    GLint alignment = 256;
+    GL_CALL(glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    _storageAlignment = std::max(alignment, 1);
+
+    int row = settings.tileSize + 1;
+    _heights.setStorage(1, TextureFormat::R16, row, row, settings.cacheTiles);
+    _heights.setFilter(TextureFilter::Linear, TextureFilter::Linear);
+    _heights.setWrap(TextureWrap::ClampToEdge);
+    _layers.resize(settings.cacheTiles);
+
+    float range = settings.lodDistance;
+    for (int level = 0; level < settings.levels; level++, range *= 2.0f)
+        _ranges.push_back(level + 1 < settings.levels ? range : std::numeric_limits<float>::max());
+
+    // the coarsest tiles are the fallback of every other tile and never evicted
+    int root = settings.levels - 1;
+    for (int z = 0; z < settings.rootTilesZ; z++) {
+        for (int x = 0; x < settings.rootTilesX; x++) {
+            LoadedTile tile = { tileKey(root, x, z), false, std::vector<uint16_t>((size_t)row * row) };
+            if (!_loader(root, x, z, tile.heights))
+                throw std::invalid_argument("Coarsest terrain tile (" + std::to_string(x) + ", " + std::to_string(z) + ") could not be loaded!");
+            int layer = z * settings.rootTilesX + x;
+            _layers[layer] = { tile.key, UINT64_MAX };
+            _tiles[tile.key].layer = layer;
+            _upload(tile);
+        }
+    }
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void Terrain::update(const glm::mat4& view, const glm::mat4& projection) {
+    _frame++;
+
+    // arrived tiles take a free layer or the least recently used one not sampled last frame
+    std::vector<LoadedTile> arrived;
+    {
+        std::lock_guard<std::mutex> lock(_queue->mutex);
+        arrived.swap(_queue->tiles);
+    }
+    size_t processed = 0;
+    for (int uploads = 0; processed < arrived.size() && uploads < _settings.maxUploadsPerFrame; processed++) {
+        LoadedTile& tile = arrived[processed];
+        TileState& state = _tiles[tile.key];
+        state.loading = false;
+        _loads--;
+        if (!tile.loaded) {
+            state.failed = true;
+            continue;
+        }
+
+        int layer = -1;
+        for (int i = 0; i < (int)_layers.size(); i++) {
+            if (_layers[i].key == UINT32_MAX) {
+                layer = i;
+                break;
+            }
+            if (_layers[i].lastUsed != UINT64_MAX && _layers[i].lastUsed + 1 < _frame && (layer < 0 || _layers[i].lastUsed < _layers[layer].lastUsed))
+                layer = i;
+        }
+        if (layer < 0)
+            continue;
+        if (_layers[layer].key != UINT32_MAX)
+            _tiles.erase(_layers[layer].key);
+
+        state.layer = layer;
+        _layers[layer] = { tile.key, _frame };
+        _upload(tile);
+        uploads++;
+    }
+    if (processed < arrived.size()) {
+        std::lock_guard<std::mutex> lock(_queue->mutex);
+        _queue->tiles.insert(_queue->tiles.begin(), std::make_move_iterator(arrived.begin() + processed), std::make_move_iterator(arrived.end()));
+    }
+
+    // quadtree selection, a node is split where it reaches into the range of the next finer level
+    std::array<glm::vec4, 6> planes = frustumPlanes(projection * view);
+    glm::vec3 camera = glm::vec3(glm::inverse(view)[3]);
+    std::array<std::vector<Chunk>, 5> groups;
+    size_t chunks = 0;
+    struct Missing {
+        int level;
+        float distance;
+        uint32_t key;
+    };
+    std::vector<Missing> missing;
+
+    auto nodeBox = [&](int level, int x, int z, glm::vec3& min, glm::vec3& max) {
+        float size = _nodeSize(level);
+        glm::vec2 heights = _heightRange(level, x, z);
+        min = glm::vec3(x * size, heights.x, z * size);
+        max = glm::vec3((x + 1) * size, heights.y, (z + 1) * size);
+    };
+
+    auto addChunk = [&](int level, int x, int z, int group, const glm::vec3& min, const glm::vec3& max) {
+        if (chunks >= (size_t)_settings.maxChunks)
+            return;
+        chunks++;
+        int residentLevel;
+        const TileState* tile = _residentTile(level, x, z, residentLevel);
+        Layer& layer = _layers[tile->layer];
+        if (layer.lastUsed != UINT64_MAX)
+            layer.lastUsed = _frame;
+
+        int shift = residentLevel - level;
+        float scale = std::ldexp(1.0f, -shift);
+        glm::vec2 offset = glm::vec2(x & ((1 << shift) - 1), z & ((1 << shift) - 1)) * scale;
+        float size = _nodeSize(level);
+        groups[group].push_back({ glm::vec4(x * size, z * size, size, (float)level), glm::vec4(offset, scale, (float)tile->layer) });
+
+        if (shift > 0) {
+            auto it = _tiles.find(tileKey(level, x, z));
+            if (it == _tiles.end() || (!it->second.loading && !it->second.failed))
+                missing.push_back({ level, glm::length(glm::clamp(camera, min, max) - camera), tileKey(level, x, z) });
+        }
+    };
+
+    auto select = [&](auto&& self, int level, int x, int z) -> void {
+        glm::vec3 min, max;
+        nodeBox(level, x, z, min, max);
+        if (!boxVisible(planes, min, max))
+            return;
+        if (level == 0 || !boxInRange(min, max, camera, _ranges[level - 1])) {
+            addChunk(level, x, z, 0, min, max);
+            return;
+        }
+        for (int quadrant = 0; quadrant < 4; quadrant++) {
+            int childX = 2 * x + (quadrant & 1);
+            int childZ = 2 * z + (quadrant >> 1);
+            glm::vec3 childMin, childMax;
+            nodeBox(level - 1, childX, childZ, childMin, childMax);
+            if (boxInRange(childMin, childMax, camera, _ranges[level - 1]))
+                self(self, level - 1, childX, childZ);
+            else if (boxVisible(planes, childMin, childMax))
+                addChunk(level, x, z, 1 + quadrant, childMin, childMax);
+        }
+    };
+
+    for (int z = 0; z < _settings.rootTilesZ; z++)
+        for (int x = 0; x < _settings.rootTilesX; x++)
+            select(select, _settings.levels - 1, x, z);
+
+    // the previous frame ends here, so its Fence also covers the draws that read its chunks
+    if (_frameOpen)
+        _chunks.endFrame();
+    _chunks.beginFrame();
+    _frameOpen = true;
+
+    ChunkHeader header = {};
+    header.camera = glm::vec4(camera, (float)_settings.gridSize);
+    header.heights = glm::vec4(_settings.minHeight, _settings.maxHeight - _settings.minHeight, (float)_settings.tileSize, 0.0f);
+    for (int level = 0; level < _settings.levels; level++) {
+        float previous = level > 0 ? _ranges[level - 1] : 0.0f;
+        if (level + 1 < _settings.levels) {
+            float start = previous + (_ranges[level] - previous) * _settings.morphRatio;
+            header.morph[level] = glm::vec4(start, 1.0f / (_ranges[level] - start), 0.0f, 0.0f);
+        }
+        else {
+            header.morph[level] = glm::vec4(std::numeric_limits<float>::max(), 0.0f, 0.0f, 0.0f);
+        }
+    }
+
+    RingAllocation allocation = _chunks.allocate(sizeof(ChunkHeader) + (int64_t)std::max(chunks, (size_t)1) * sizeof(Chunk), _storageAlignment);
+    *(ChunkHeader*)allocation.data = header;
+    Chunk* target = (Chunk*)((uint8_t*)allocation.data + sizeof(ChunkHeader));
+    _groups[0] = 0;
+    for (int group = 0; group < 5; group++) {
+        std::copy(groups[group].begin(), groups[group].end(), target + _groups[group]);
+        _groups[group + 1] = _groups[group] + (uint32_t)groups[group].size();
+    }
+    _chunkOffset = allocation.offset;
+    _chunkSize = allocation.size;
+
+    // coarse tiles first, they are the fallback of the finer ones
+    std::sort(missing.begin(), missing.end(), [](const Missing& a, const Missing& b) {
+        return a.level != b.level ? a.level > b.level : a.distance < b.distance;
+    });
+    for (const Missing& request : missing) {
+        if (_loads >= _settings.maxLoads)
+            break;
+        TileState& state = _tiles[request.key];
+        if (state.loading || state.failed || state.layer >= 0)
+            continue;
+        state.loading = true;
+        _loads++;
+        int x = (int)(request.key & 0x3FFF);
+        int z = (int)((request.key >> 14) & 0x3FFF);
+        size_t texels = (size_t)(_settings.tileSize + 1) * (_settings.tileSize + 1);
+        _pool.submit([queue = _queue, loader = _loader, key = request.key, level = request.level, x, z, texels]() {
+            LoadedTile tile = { key, false, std::vector<uint16_t>(texels) };
+            try {
+                tile.loaded = loader(level, x, z, tile.heights);
+            }
+            catch (...) {
+                tile.loaded = false;
+            }
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            queue->tiles.push_back(std::move(tile));
+        });
+    }
+}
+
+void Terrain::draw(Program& program) {
+    if (_groups[5] == 0)
+        return;
+
+    program.bind();
+    _heights.bind(_settings.heightUnit);
+    _chunks.buffer().bindRange(_settings.chunkBinding, _chunkOffset, _chunkSize);
+    _grid.bind();
+    int offsetLocation = program.getUniformLocation("uTerrainChunkOffset");
+
+    // full chunks draw every quadrant, which are contiguous in the index Buffer
+    unsigned int indexType = toGLenum(_grid.indexType());
+    int indexBytes = typeToBytes(_grid.indexType());
+    for (int group = 0; group < 5; group++) {
+        GLsizei instances = (GLsizei)(_groups[group + 1] - _groups[group]);
+        if (instances == 0)
+            continue;
+        uint32_t first = group == 0 ? 0 : _grid.submeshes()[group - 1].firstIndex;
+        uint32_t count = group == 0 ? _grid.indexCount() : _grid.submeshes()[group - 1].count;
+        program.setUniform(offsetLocation, _groups[group]);
+        GL_CALL(glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)count, indexType, (const void*)((uintptr_t)first * indexBytes), instances));
+    }
+}
+
+std::string Terrain::glslSource() const {
+    return "#define TERRAIN_HEIGHT_UNIT " + std::to_string(_settings.heightUnit) +
+           "\n#define TERRAIN_CHUNK_BINDING " + std::to_string(_settings.chunkBinding) +
+           "\n#define TERRAIN_MAX_LEVELS " + std::to_string(kMaxLevels) + "\n" + kTerrainSource;
+}
+
+glm::vec2 Terrain::heightRange(const glm::vec2& position) const {
+    float size = _nodeSize(0);
+    int tilesX = _settings.rootTilesX << (_settings.levels - 1);
+    int tilesZ = _settings.rootTilesZ << (_settings.levels - 1);
+    int x = std::clamp((int)std::floor(position.x / size), 0, tilesX - 1);
+    int z = std::clamp((int)std::floor(position.y / size), 0, tilesZ - 1);
+    return _heightRange(0, x, z);
+}
+
+size_t Terrain::residentTiles() const {
+    return (size_t)std::count_if(_layers.begin(), _layers.end(), [](const Layer& layer) { return layer.key != UINT32_MAX; });
+}
+
+}
@@ -0,0 +1,323 @@
+#include <GLA/textRenderer.h>
+
+#include <GLA/shader.h>
+#include <GLA/debug.h>
+
+#include <algorithm>
+#include <cstring>
+#include <glm/packing.hpp>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    const char* kTextVertexShader = R"(#version 430 core
+
+struct Glyph {
+    vec4 rect;
+    vec4 uv;
+    uint color;
+    uint layer;
+    float pxRange;
+    float padding;
+};
+
+layout(std430, binding = 0) readonly buffer Glyphs { Glyph glyphs[]; };
+
+uniform mat4 uProjection;
+
+out vec3 vUV;
+out vec4 vColor;
+flat out float vPxRange;
+
+void main() {
+    Glyph glyph = glyphs[gl_InstanceID];
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = uProjection * vec4(mix(glyph.rect.xy, glyph.rect.zw, corner), 0.0, 1.0);
+    vUV = vec3(mix(glyph.uv.xy, glyph.uv.zw, corner), float(glyph.layer));
+    vColor = unpackUnorm4x8(glyph.color);
+    vPxRange = glyph.pxRange;
+}
+)";
+
+    const char* kTextFragmentShader = R"(#version 430 core
+
+layout(binding = 0) uniform sampler2DArray uAtlas;
+
+in vec3 vUV;
+in vec4 vColor;
+flat in float vPxRange;
+
+layout(location = 0) out vec4 color;
+
+void main() {
+    float distance = texture(uAtlas, vUV).r;
+    float alpha = clamp((distance - 0.5) * vPxRange + 0.5, 0.0, 1.0);
+    if (alpha <= 0.0)
+        discard;
+    color = vec4(vColor.rgb, vColor.a * alpha);
+}
+)";
+
+    // free texels right and below of every glyph in the atlas
+    const int kGlyphGap = 1;
+
+    // decodes the next codepoint and advances i, invalid sequences yield U+FFFD
+    uint32_t nextCodepoint(std::string_view text, size_t& i) {
+        uint8_t c = (uint8_t)text[i++];
+        if (c < 0x80)
+            return c;
+        int length = (c & 0xE0) == 0xC0 ? 1 : (c & 0xF0) == 0xE0 ? 2 : (c & 0xF8) == 0xF0 ? 3 : -1;
+        if (length < 0)
+            return 0xFFFD;
+        uint32_t codepoint = c & (0x3F >> length);
+        for (int j = 0; j < length; j++) {
+            if (i >= text.size() || ((uint8_t)text[i] & 0xC0) != 0x80)
+                return 0xFFFD;
+            codepoint = (codepoint << 6) | ((uint8_t)text[i++] & 0x3F);
+        }
+        return codepoint;
+    }
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class TextRenderer
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+const TextRenderer::ShapedRun& TextRenderer::_shape(std::string_view text) {
+    std::string key(text);
+    auto it = _runs.find(key);
+    if (it != _runs.end()) {
+        _runOrder.splice(_runOrder.begin(), _runOrder, it->second.second);
+        return it->second.first;
+    }
+
+    float unitsPerEm = (float)_font.unitsPerEm();
+    float lineHeight = (_font.ascender() - _font.descender() + _font.lineGap()) / unitsPerEm;
+
+    ShapedRun run;
+    run.glyphs.reserve(text.size());
+    glm::vec2 pen(0.0f);
+    float width = 0.0f;
+    int lines = 1;
+    uint32_t previous = 0;
+    for (size_t i = 0; i < text.size();) {
+        uint32_t codepoint = nextCodepoint(text, i);
+        if (codepoint == '\n') {
+            width = std::max(width, pen.x);
+            pen = { 0.0f, pen.y - lineHeight };
+            previous = 0;
+            lines++;
+            continue;
+        }
+        uint32_t glyph = _font.glyphIndex(codepoint);
+        if (previous != 0)
+            pen.x += _font.kerning(previous, glyph) / unitsPerEm;
+        run.glyphs.push_back({ glyph, pen });
+        pen.x += _font.metrics(glyph).advance / unitsPerEm;
+        previous = glyph;
+    }
+    run.size = { std::max(width, pen.x), lines * lineHeight };
+
+    if (_runs.size() >= _settings.shapedRunCacheSize && !_runOrder.empty()) {
+        _runs.erase(_runOrder.back());
+        _runOrder.pop_back();
+    }
+    _runOrder.push_front(key);
+    auto inserted = _runs.emplace(std::move(key), std::make_pair(std::move(run), _runOrder.begin()));
+    return inserted.first->second.first;
+}
+
+const TextRenderer::GlyphEntry* TextRenderer::_request(uint32_t glyph) {
+    auto it = _glyphs.find(glyph);
+    if (it != _glyphs.end())
+        return it->second.ready ? &it->second : nullptr;
+
+    _glyphs.emplace(glyph, GlyphEntry{});
+
+    std::shared_ptr<Workers> workers = _workers;
+    {
+        std::lock_guard<std::mutex> lock(workers->mutex);
+        workers->inFlight++;
+    }
+    const Font* font = &_font;
+    float pixelsPerEm = _settings.glyphPixelsPerEm;
+    int spread = _settings.spread;
+    uint32_t generation = _generation;
+    _pool.submit([workers, font, glyph, generation, pixelsPerEm, spread]() {
+        RasterizedGlyph result{ glyph, generation, {} };
+        try {
+            result.sdf = font->rasterizeSdf(glyph, pixelsPerEm, spread);
+        }
+        catch (...) {
+            // corrupt glyphs are treated as empty so they are not requested again
+            result.sdf = SdfGlyph{};
+        }
+        std::lock_guard<std::mutex> lock(workers->mutex);
+        workers->completed.push_back(std::move(result));
+        workers->inFlight--;
+        workers->idle.notify_all();
+    });
+    return nullptr;
+}
+
+bool TextRenderer::_pack(int width, int height, int& x, int& y, int& layer) {
+    const int gap = kGlyphGap;
+    if (width + gap > _settings.atlasSize || height + gap > _settings.atlasSize)
+        return false;
+    while (_page < _settings.atlasPages) {
+        if (_shelfX + width + gap > _settings.atlasSize) {
+            _shelfX = 0;
+            _shelfY += _shelfHeight;
+            _shelfHeight = 0;
+        }
+        if (_shelfY + height + gap <= _settings.atlasSize) {
+            x = _shelfX;
+            y = _shelfY;
+            layer = _page;
+            _shelfX += width + gap;
+            _shelfHeight = std::max(_shelfHeight, height + gap);
+            return true;
+        }
+        _page++;
+        _shelfX = _shelfY = _shelfHeight = 0;
+    }
+    return false;
+}
+
+void TextRenderer::_resetAtlas() {
+    _glyphs.clear();
+    _generation++;
+    _page = _shelfX = _shelfY = _shelfHeight = 0;
+}
+
+void TextRenderer::_uploadCompleted() {
+    std::vector<RasterizedGlyph> completed;
+    {
+        std::lock_guard<std::mutex> lock(_workers->mutex);
+        completed.swap(_workers->completed);
+    }
+
+    float atlasSize = (float)_settings.atlasSize;
+    for (RasterizedGlyph& result : completed) {
+        if (result.generation != _generation)
+            continue;
+        auto it = _glyphs.find(result.glyph);
+        if (it == _glyphs.end())
+            continue;
+        GlyphEntry& entry = it->second;
+        const SdfGlyph& sdf = result.sdf;
+
+        // a glyph larger than a page would never fit, even into an empty atlas, so it is skipped instead of resetting forever
+        if (sdf.width == 0 || sdf.height == 0 || sdf.width + kGlyphGap > _settings.atlasSize || sdf.height + kGlyphGap > _settings.atlasSize) {
+            entry.ready = true;
+            entry.empty = true;
+            continue;
+        }
+
+        int x, y, layer;
+        if (!_pack(sdf.width, sdf.height, x, y, layer)) {
+            // every page is full, start over and let the visible glyphs be requested again
+            _resetAtlas();
+            return;
+        }
+        _atlas.setSubImage(0, x, y, layer, sdf.width, sdf.height, 1, sdf.pixels.data());
+
+        entry.ready = true;
+        entry.layer = layer;
+        entry.planeMin = sdf.planeMin;
+        entry.planeMax = sdf.planeMax;
+        // row 0 of the distance field is the top of the glyph
+        entry.uv = { x / atlasSize, (y + sdf.height) / atlasSize, (x + sdf.width) / atlasSize, y / atlasSize };
+    }
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+TextRenderer::TextRenderer(const Font& font, const TextRendererSettings& settings, ThreadPool& pool)
+    : _font(font), _settings(settings), _pool(pool), _atlas(TextureType::Texture2DArray),
+      _ring(BufferType::ShaderStorage, (int64_t)std::max(settings.maxGlyphsPerFrame, 1) * sizeof(GlyphInstance) + 256),
+      _workers(std::make_shared<Workers>()) {
+    if (settings.atlasSize <= 0 || settings.atlasPages <= 0 || settings.glyphPixelsPerEm <= 0.0f ||
+        settings.spread <= 0 || settings.maxGlyphsPerFrame <= 0 || settings.shapedRunCacheSize == 0)
+        throw std::invalid_argument("TextRendererSettings must all be greater than 0!");
+
+    _atlas.setStorage(1, TextureFormat::R8, settings.atlasSize, settings.atlasSize, settings.atlasPages);
+    _atlas.setFilter(TextureFilter::Linear, TextureFilter::Linear);
+    _atlas.setWrap(TextureWrap::ClampToEdge);
+
+    Shader vertex(ShaderType::Vertex, kTextVertexShader);
+    Shader fragment(ShaderType::Fragment, kTextFragmentShader);
+    _program.attach(vertex);
+    _program.attach(fragment);
+    _program.link();
+
+    GLint alignment = 256;
+    GL_CALL(glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    _storageAlignment = std::max(alignment, 1);
+}
+
+TextRenderer::~TextRenderer() {
+    std::unique_lock<std::mutex> lock(_workers->mutex);
+    _workers->idle.wait(lock, [this]() { return _workers->inFlight == 0; });
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void TextRenderer::drawText(std::string_view text, glm::vec2 position, float size, const glm::vec4& color) {
+    const ShapedRun& run = _shape(text);
+    if (_instances.size() + run.glyphs.size() > (size_t)_settings.maxGlyphsPerFrame)
+        throw std::runtime_error("More than maxGlyphsPerFrame glyphs were drawn in one frame!");
+
+    uint32_t packedColor = glm::packUnorm4x8(color);
+    float pxRange = 2.0f * _settings.spread * size / _settings.glyphPixelsPerEm;
+    for (const ShapedGlyph& shaped : run.glyphs) {
+        const GlyphEntry* entry = _request(shaped.glyph);
+        if (!entry || entry->empty)
+            continue;
+        glm::vec2 min = position + (shaped.pen + entry->planeMin) * size;
+        glm::vec2 max = position + (shaped.pen + entry->planeMax) * size;
+        _instances.push_back({ { min, max }, entry->uv, packedColor, (uint32_t)entry->layer, pxRange, 0.0f });
+    }
+}
+
+glm::vec2 TextRenderer::measureText(std::string_view text, float size) {
+    return _shape(text).size * size;
+}
+
+void TextRenderer::render(const glm::mat4& projection) {
+    _uploadCompleted();
+    if (_instances.empty())
+        return;
+
+    _ring.beginFrame();
+    int64_t bytes = (int64_t)(_instances.size() * sizeof(GlyphInstance));
+    RingAllocation allocation = _ring.allocate(bytes, _storageAlignment);
+    std::memcpy(allocation.data, _instances.data(), bytes);
+
+    _program.bind();
+    _program["uProjection"] = projection;
+    _atlas.bind(0);
+    _ring.buffer().bindRange(0, allocation.offset, allocation.size);
+
+    GL_CALL(glEnable(GL_BLEND));
+    GL_CALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+    GL_CALL(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)_instances.size()));
+
+    _ring.endFrame();
+    _instances.clear();
+}
+
+}
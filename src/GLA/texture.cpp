@@ -0,0 +1,356 @@
+#include <GLA/texture.h>
+
+#include <GLA/debug.h>
+
+#include <algorithm>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+unsigned int toGLenum(TextureType type) {
+    switch (type)
+    {
+    case TextureType::Texture2D: return GL_TEXTURE_2D;
+    case TextureType::Texture2DArray: return GL_TEXTURE_2D_ARRAY;
+    case TextureType::Texture3D: return GL_TEXTURE_3D;
+    case TextureType::CubeMap: return GL_TEXTURE_CUBE_MAP;
+    }
+    throw std::invalid_argument("TextureType is invalid!");
+}
+
+unsigned int toGLenum(TextureFormat format) {
+    switch (format)
+    {
+    case TextureFormat::R8: return GL_R8;
+    case TextureFormat::RG8: return GL_RG8;
+    case TextureFormat::RGBA8: return GL_RGBA8;
+    case TextureFormat::SRGB8Alpha8: return GL_SRGB8_ALPHA8;
+    case TextureFormat::R16: return GL_R16;
+    case TextureFormat::RG16: return GL_RG16;
+    case TextureFormat::RG16SNorm: return GL_RG16_SNORM;
+    case TextureFormat::RGBA16: return GL_RGBA16;
+    case TextureFormat::R16F: return GL_R16F;
+    case TextureFormat::RG16F: return GL_RG16F;
+    case TextureFormat::RGBA16F: return GL_RGBA16F;
+    case TextureFormat::R32F: return GL_R32F;
+    case TextureFormat::RG32F: return GL_RG32F;
+    case TextureFormat::RGBA32F: return GL_RGBA32F;
+    case TextureFormat::R32UI: return GL_R32UI;
+    case TextureFormat::RG32UI: return GL_RG32UI;
+    case TextureFormat::RGBA32UI: return GL_RGBA32UI;
+    case TextureFormat::Depth16: return GL_DEPTH_COMPONENT16;
+    case TextureFormat::Depth24: return GL_DEPTH_COMPONENT24;
+    case TextureFormat::Depth32F: return GL_DEPTH_COMPONENT32F;
+    case TextureFormat::Depth24Stencil8: return GL_DEPTH24_STENCIL8;
+    }
+    throw std::invalid_argument("TextureFormat is invalid!");
+}
+
+unsigned int toGLenum(TextureFilter filter) {
+    switch (filter)
+    {
+    case TextureFilter::Nearest: return GL_NEAREST;
+    case TextureFilter::Linear: return GL_LINEAR;
+    case TextureFilter::NearestMipmapNearest: return GL_NEAREST_MIPMAP_NEAREST;
+    case TextureFilter::LinearMipmapNearest: return GL_LINEAR_MIPMAP_NEAREST;
+    case TextureFilter::NearestMipmapLinear: return GL_NEAREST_MIPMAP_LINEAR;
+    case TextureFilter::LinearMipmapLinear: return GL_LINEAR_MIPMAP_LINEAR;
+    }
+    throw std::invalid_argument("TextureFilter is invalid!");
+}
+
+unsigned int toGLenum(TextureWrap wrap) {
+    switch (wrap)
+    {
+    case TextureWrap::Repeat: return GL_REPEAT;
+    case TextureWrap::MirroredRepeat: return GL_MIRRORED_REPEAT;
+    case TextureWrap::ClampToEdge: return GL_CLAMP_TO_EDGE;
+    case TextureWrap::ClampToBorder: return GL_CLAMP_TO_BORDER;
+    }
+    throw std::invalid_argument("TextureWrap is invalid!");
+}
+
+unsigned int toGLenum(ImageAccess access) {
+    switch (access)
+    {
+    case ImageAccess::Read: return GL_READ_ONLY;
+    case ImageAccess::Write: return GL_WRITE_ONLY;
+    case ImageAccess::ReadWrite: return GL_READ_WRITE;
+    }
+    throw std::invalid_argument("ImageAccess is invalid!");
+}
+
+unsigned int toPixelFormat(TextureFormat format) {
+    switch (format)
+    {
+    case TextureFormat::R8:
+    case TextureFormat::R16:
+    case TextureFormat::R16F:
+    case TextureFormat::R32F: return GL_RED;
+    case TextureFormat::RG8:
+    case TextureFormat::RG16:
+    case TextureFormat::RG16SNorm:
+    case TextureFormat::RG16F:
+    case TextureFormat::RG32F: return GL_RG;
+    case TextureFormat::RGBA8:
+    case TextureFormat::SRGB8Alpha8:
+    case TextureFormat::RGBA16:
+    case TextureFormat::RGBA16F:
+    case TextureFormat::RGBA32F: return GL_RGBA;
+    case TextureFormat::R32UI: return GL_RED_INTEGER;
+    case TextureFormat::RG32UI: return GL_RG_INTEGER;
+    case TextureFormat::RGBA32UI: return GL_RGBA_INTEGER;
+    case TextureFormat::Depth16:
+    case TextureFormat::Depth24:
+    case TextureFormat::Depth32F: return GL_DEPTH_COMPONENT;
+    case TextureFormat::Depth24Stencil8: return GL_DEPTH_STENCIL;
+    }
+    throw std::invalid_argument("TextureFormat is invalid!");
+}
+
+unsigned int toPixelType(TextureFormat format) {
+    switch (format)
+    {
+    case TextureFormat::R8:
+    case TextureFormat::RG8:
+    case TextureFormat::RGBA8:
+    case TextureFormat::SRGB8Alpha8: return GL_UNSIGNED_BYTE;
+    case TextureFormat::R16:
+    case TextureFormat::RG16:
+    case TextureFormat::RGBA16:
+    case TextureFormat::Depth16: return GL_UNSIGNED_SHORT;
+    case TextureFormat::RG16SNorm: return GL_SHORT;
+    case TextureFormat::R16F:
+    case TextureFormat::RG16F:
+    case TextureFormat::RGBA16F: return GL_HALF_FLOAT;
+    case TextureFormat::R32F:
+    case TextureFormat::RG32F:
+    case TextureFormat::RGBA32F:
+    case TextureFormat::Depth32F: return GL_FLOAT;
+    case TextureFormat::R32UI:
+    case TextureFormat::RG32UI:
+    case TextureFormat::RGBA32UI:
+    case TextureFormat::Depth24: return GL_UNSIGNED_INT;
+    case TextureFormat::Depth24Stencil8: return GL_UNSIGNED_INT_24_8;
+    }
+    throw std::invalid_argument("TextureFormat is invalid!");
+}
+
+int formatToBytes(TextureFormat format) {
+    switch (format)
+    {
+    case TextureFormat::R8: return 1;
+    case TextureFormat::RG8: return 2;
+    case TextureFormat::RGBA8: return 4;
+    case TextureFormat::SRGB8Alpha8: return 4;
+    case TextureFormat::R16: return 2;
+    case TextureFormat::RG16: return 4;
+    case TextureFormat::RG16SNorm: return 4;
+    case TextureFormat::RGBA16: return 8;
+    case TextureFormat::R16F: return 2;
+    case TextureFormat::RG16F: return 4;
+    case TextureFormat::RGBA16F: return 8;
+    case TextureFormat::R32F: return 4;
+    case TextureFormat::RG32F: return 8;
+    case TextureFormat::RGBA32F: return 16;
+    case TextureFormat::R32UI: return 4;
+    case TextureFormat::RG32UI: return 8;
+    case TextureFormat::RGBA32UI: return 16;
+    case TextureFormat::Depth16: return 2;
+    case TextureFormat::Depth24: return 4;
+    case TextureFormat::Depth32F: return 4;
+    case TextureFormat::Depth24Stencil8: return 4;
+    }
+    throw std::invalid_argument("TextureFormat is invalid!");
+}
+
+int mipLevelCount(int width, int height, int depth) {
+    int size = std::max({ width, height, depth, 1 });
+    int levels = 1;
+    while (size > 1) {
+        size >>= 1;
+        levels++;
+    }
+    return levels;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class Texture
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// protected methods
+// --------------------------------------------------
+
+void Texture::_delete() {
+    if (_id != 0)
+        GL_CALL(glDeleteTextures(1, &_id));
+    _id = 0;
+    _levels = 0;
+}
+
+void Texture::_check() {
+    if (_id == 0)
+        throw std::runtime_error("Failed to create texture object!");
+}
+
+void Texture::_ensureStorage() const {
+    if (_levels == 0)
+        throw std::logic_error("Texture has no storage, setStorage must be called first!");
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+Texture::Texture(TextureType type) : _type(type) {
+    GL_CALL(glGenTextures(1, &_id));
+    _check();
+}
+Texture::Texture(Texture&& other)
+    : _id(other._id), _type(other._type), _format(other._format), _width(other._width),
+      _height(other._height), _depth(other._depth), _levels(other._levels) {
+    other._id = 0;
+    other._levels = 0;
+}
+Texture::~Texture() noexcept {
+    _delete();
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void Texture::bind(unsigned int unit) const {
+    GL_CALL(glActiveTexture(GL_TEXTURE0 + unit));
+    GL_CALL(glBindTexture(toGLenum(_type), _id));
+}
+
+void Texture::bindImage(unsigned int unit, int level, ImageAccess access, int layer) const {
+    _ensureStorage();
+    if (level < 0 || level >= _levels)
+        throw std::invalid_argument("level is out of range!");
+    GLboolean layered = layer < 0 ? GL_TRUE : GL_FALSE;
+    GL_CALL(glBindImageTexture(unit, _id, level, layered, std::max(layer, 0), toGLenum(access), toGLenum(_format)));
+}
+
+void Texture::setStorage(int levels, TextureFormat format, int width, int height, int depth) {
+    if (_levels != 0)
+        throw std::logic_error("Texture storage is immutable and was already allocated!");
+    if (_type == TextureType::CubeMap)
+        height = width;
+    if (_type == TextureType::Texture2D || _type == TextureType::CubeMap)
+        depth = 1;
+    if (levels <= 0 || width <= 0 || height <= 0 || depth <= 0)
+        throw std::invalid_argument("levels, width, height and depth must be greater than 0!");
+    if (levels > mipLevelCount(width, height, _type == TextureType::Texture3D ? depth : 1))
+        throw std::invalid_argument("levels is greater than the full mip chain of the given size!");
+
+    GL_CALL(glBindTexture(toGLenum(_type), _id));
+    if (_type == TextureType::Texture2D || _type == TextureType::CubeMap)
+        GL_CALL(glTexStorage2D(toGLenum(_type), levels, toGLenum(format), width, height));
+    else
+        GL_CALL(glTexStorage3D(toGLenum(_type), levels, toGLenum(format), width, height, depth));
+
+    _format = format;
+    _width = width;
+    _height = height;
+    _depth = _type == TextureType::CubeMap ? 6 : depth;
+    _levels = levels;
+}
+
+void Texture::setSubImage(int level, int x, int y, int z, int width, int height, int depth, const void* data) {
+    _ensureStorage();
+    if (level < 0 || level >= _levels)
+        throw std::invalid_argument("level is out of range!");
+    int levelWidth = std::max(_width >> level, 1);
+    int levelHeight = std::max(_height >> level, 1);
+    int levelDepth = _type == TextureType::Texture3D ? std::max(_depth >> level, 1) : _depth;
+    if (x < 0 || y < 0 || z < 0 || width < 0 || height < 0 || depth < 0 ||
+        x + width > levelWidth || y + height > levelHeight || z + depth > levelDepth)
+        throw std::invalid_argument("Region is outside of the Texture level!");
+
+    // rows are tightly packed, the alignment of the caller is restored after the upload
+    GLint previousAlignment = 4;
+    GL_CALL(glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousAlignment));
+    GL_CALL(glBindTexture(toGLenum(_type), _id));
+    GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    unsigned int pixelFormat = toPixelFormat(_format);
+    unsigned int pixelType = toPixelType(_format);
+    switch (_type)
+    {
+    case TextureType::Texture2D:
+        GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, pixelFormat, pixelType, data));
+        break;
+    case TextureType::CubeMap: {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        int64_t faceSize = (int64_t)width * height * formatToBytes(_format);
+        for (int face = 0; face < depth; face++)
+            GL_CALL(glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + z + face, level, x, y, width, height, pixelFormat, pixelType, bytes + face * faceSize));
+        break;
+    }
+    default:
+        GL_CALL(glTexSubImage3D(toGLenum(_type), level, x, y, z, width, height, depth, pixelFormat, pixelType, data));
+        break;
+    }
+    GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, previousAlignment));
+}
+
+void Texture::setFilter(TextureFilter min, TextureFilter mag) {
+    if (mag != TextureFilter::Nearest && mag != TextureFilter::Linear)
+        throw std::invalid_argument("Magnification filter may only be Nearest or Linear!");
+    GL_CALL(glBindTexture(toGLenum(_type), _id));
+    GL_CALL(glTexParameteri(toGLenum(_type), GL_TEXTURE_MIN_FILTER, toGLenum(min)));
+    GL_CALL(glTexParameteri(toGLenum(_type), GL_TEXTURE_MAG_FILTER, toGLenum(mag)));
+}
+
+void Texture::setWrap(TextureWrap wrap) {
+    GL_CALL(glBindTexture(toGLenum(_type), _id));
+    GL_CALL(glTexParameteri(toGLenum(_type), GL_TEXTURE_WRAP_S, toGLenum(wrap)));
+    GL_CALL(glTexParameteri(toGLenum(_type), GL_TEXTURE_WRAP_T, toGLenum(wrap)));
+    GL_CALL(glTexParameteri(toGLenum(_type), GL_TEXTURE_WRAP_R, toGLenum(wrap)));
+}
+
+void Texture::setDepthCompare(bool enabled) {
+    GL_CALL(glBindTexture(toGLenum(_type), _id));
+    GL_CALL(glTexParameteri(toGLenum(_type), GL_TEXTURE_COMPARE_MODE, enabled ? GL_COMPARE_REF_TO_TEXTURE : GL_NONE));
+    GL_CALL(glTexParameteri(toGLenum(_type), GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL));
+}
+
+void Texture::setBaseLevel(int level) {
+    _ensureStorage();
+    if (level < 0 || level >= _levels)
+        throw std::invalid_argument("level is out of range!");
+    GL_CALL(glBindTexture(toGLenum(_type), _id));
+    GL_CALL(glTexParameteri(toGLenum(_type), GL_TEXTURE_BASE_LEVEL, level));
+}
+
+void Texture::generateMipmaps() {
+    _ensureStorage();
+    GL_CALL(glBindTexture(toGLenum(_type), _id));
+    GL_CALL(glGenerateMipmap(toGLenum(_type)));
+}
+
+// --------------------------------------------------
+// operator overloads
+// --------------------------------------------------
+
+Texture& Texture::operator=(Texture&& other) {
+    if (this != &other) {
+        _delete();
+        _id = other._id;
+        _type = other._type;
+        _format = other._format;
+        _width = other._width;
+        _height = other._height;
+        _depth = other._depth;
+        _levels = other._levels;
+        other._id = 0;
+        other._levels = 0;
+    }
+    return *this;
+}
+
+}
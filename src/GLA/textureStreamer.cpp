@@ -0,0 +1,292 @@
+#include <GLA/textureStreamer.h>
+
+#include <GLA/debug.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+// ----------------------------------------------------------------------------------------------------
+// class TextureStreamer
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+TextureStreamer::Entry& TextureStreamer::_get(uint32_t handle) {
+    if (handle >= _entries.size() || !_entries[handle].active)
+        throw std::out_of_range("Streamed texture handle is invalid!");
+    return _entries[handle];
+}
+
+const TextureStreamer::Entry& TextureStreamer::_get(uint32_t handle) const {
+    if (handle >= _entries.size() || !_entries[handle].active)
+        throw std::out_of_range("Streamed texture handle is invalid!");
+    return _entries[handle];
+}
+
+int64_t TextureStreamer::_levelBytes(const Entry& entry, int level) const {
+    return (int64_t)std::max(entry.desc.width >> level, 1) * std::max(entry.desc.height >> level, 1) * formatToBytes(entry.desc.format);
+}
+
+int64_t TextureStreamer::_residentBytes(const Entry& entry, int resident) const {
+    int64_t bytes = 0;
+    for (int level = resident; level < entry.levels; level++)
+        bytes += _levelBytes(entry, level);
+    return bytes;
+}
+
+void TextureStreamer::_setResident(Entry& entry, int resident, const LoadedLevel* arrived) {
+    const StreamedTextureDesc& desc = entry.desc;
+    int width = std::max(desc.width >> resident, 1), height = std::max(desc.height >> resident, 1);
+
+    if (entry.sparse) {
+        // committed levels become visible by lowering the base level, dropped ones are hidden before their memory is released
+        if (resident < entry.resident) {
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, entry.texture.id()));
+            GL_CALL(glTexPageCommitmentARB(GL_TEXTURE_2D, resident, 0, 0, 0, width, height, 1, GL_TRUE));
+            entry.texture.setSubImage(resident, 0, 0, 0, width, height, 1, arrived->texels.data());
+            entry.texture.setBaseLevel(resident);
+        }
+        else {
+            entry.texture.setBaseLevel(resident);
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, entry.texture.id()));
+            for (int level = entry.resident; level < resident; level++)
+                GL_CALL(glTexPageCommitmentARB(GL_TEXTURE_2D, level, 0, 0, 0, std::max(desc.width >> level, 1), std::max(desc.height >> level, 1), 1, GL_FALSE));
+        }
+    }
+    else {
+        // a texture holding just the resident levels, the levels both have in common are copied on the GPU
+        Texture texture(TextureType::Texture2D);
+        texture.setStorage(entry.levels - resident, desc.format, width, height);
+        for (int level = std::max(resident, entry.resident); level < entry.levels; level++)
+            GL_CALL(glCopyImageSubData(entry.texture.id(), GL_TEXTURE_2D, level - entry.resident, 0, 0, 0,
+                                       texture.id(), GL_TEXTURE_2D, level - resident, 0, 0, 0,
+                                       std::max(desc.width >> level, 1), std::max(desc.height >> level, 1), 1));
+        if (arrived != nullptr)
+            texture.setSubImage(arrived->level - resident, 0, 0, 0, width, height, 1, arrived->texels.data());
+        texture.setFilter(desc.minFilter, desc.magFilter);
+        texture.setWrap(desc.wrap);
+        entry.texture = std::move(texture);
+    }
+
+    _memory += _residentBytes(entry, resident) - _residentBytes(entry, entry.resident);
+    entry.resident = resident;
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+TextureStreamer::TextureStreamer(const TextureStreamerSettings& settings, ThreadPool& pool)
+    : _settings(settings), _pool(pool), _queue(std::make_shared<LoadQueue>()) {
+    if (settings.budget <= 0 || settings.residentSize <= 0 || settings.maxLoads <= 0 || settings.maxUploadsPerFrame <= 0 || settings.unusedFrames <= 0)
+        throw std::invalid_argument("TextureStreamer settings must be greater than 0!");
+    _sparseSupported = settings.sparse && GLEW_ARB_sparse_texture;
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+uint32_t TextureStreamer::add(StreamedTextureDesc desc) {
+    if (desc.width <= 0 || desc.height <= 0)
+        throw std::invalid_argument("Streamed texture width and height must be greater than 0!");
+    if (!desc.loader)
+        throw std::invalid_argument("Streamed texture needs a loader!");
+    formatToBytes(desc.format);
+
+    Entry entry;
+    entry.desc = std::move(desc);
+    entry.active = true;
+    entry.levels = mipLevelCount(entry.desc.width, entry.desc.height);
+    entry.tailLevel = entry.levels - 1;
+    while (entry.tailLevel > 0 && std::max(entry.desc.width >> (entry.tailLevel - 1), entry.desc.height >> (entry.tailLevel - 1)) <= _settings.residentSize)
+        entry.tailLevel--;
+
+    // sparse storage needs a size in whole pages, levels in the mip tail can only be committed together
+    GLint pageWidth = 0, pageHeight = 0;
+    if (_sparseSupported) {
+        GL_CALL(glGetInternalformativ(GL_TEXTURE_2D, toGLenum(entry.desc.format), GL_VIRTUAL_PAGE_SIZE_X_ARB, 1, &pageWidth));
+        GL_CALL(glGetInternalformativ(GL_TEXTURE_2D, toGLenum(entry.desc.format), GL_VIRTUAL_PAGE_SIZE_Y_ARB, 1, &pageHeight));
+        entry.sparse = pageWidth > 0 && pageHeight > 0 && entry.desc.width % pageWidth == 0 && entry.desc.height % pageHeight == 0;
+    }
+    if (entry.sparse) {
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, entry.texture.id()));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SPARSE_ARB, GL_TRUE));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_VIRTUAL_PAGE_SIZE_INDEX_ARB, 0));
+        entry.texture.setStorage(entry.levels, entry.desc.format, entry.desc.width, entry.desc.height);
+        GLint sparseLevels = entry.levels;
+        GL_CALL(glGetTexParameteriv(GL_TEXTURE_2D, GL_NUM_SPARSE_LEVELS_ARB, &sparseLevels));
+        entry.tailLevel = std::min(entry.tailLevel, (int)sparseLevels);
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, entry.texture.id()));
+        for (int level = entry.tailLevel; level < entry.levels; level++)
+            GL_CALL(glTexPageCommitmentARB(GL_TEXTURE_2D, level, 0, 0, 0, std::max(entry.desc.width >> level, 1),
+                                           std::max(entry.desc.height >> level, 1), 1, GL_TRUE));
+    }
+    else {
+        entry.texture.setStorage(entry.levels - entry.tailLevel, entry.desc.format,
+                                 std::max(entry.desc.width >> entry.tailLevel, 1), std::max(entry.desc.height >> entry.tailLevel, 1));
+    }
+
+    int base = entry.sparse ? 0 : entry.tailLevel;
+    for (int level = entry.tailLevel; level < entry.levels; level++) {
+        std::vector<uint8_t> texels((size_t)_levelBytes(entry, level));
+        if (!entry.desc.loader(level, texels))
+            throw std::runtime_error("Failed to load resident level " + std::to_string(level) + " of a streamed texture!");
+        entry.texture.setSubImage(level - base, 0, 0, 0, std::max(entry.desc.width >> level, 1), std::max(entry.desc.height >> level, 1), 1, texels.data());
+    }
+    if (entry.sparse)
+        entry.texture.setBaseLevel(entry.tailLevel);
+    entry.texture.setFilter(entry.desc.minFilter, entry.desc.magFilter);
+    entry.texture.setWrap(entry.desc.wrap);
+    entry.resident = entry.wanted = entry.tailLevel;
+    entry.lastUsed = _frame;
+    _memory += _residentBytes(entry, entry.resident);
+
+    uint32_t handle;
+    if (!_free.empty()) {
+        handle = _free.back();
+        _free.pop_back();
+        entry.generation = _entries[handle].generation + 1;
+        _entries[handle] = std::move(entry);
+    }
+    else {
+        handle = (uint32_t)_entries.size();
+        _entries.push_back(std::move(entry));
+    }
+    return handle;
+}
+
+void TextureStreamer::remove(uint32_t handle) {
+    Entry& entry = _get(handle);
+    _memory -= _residentBytes(entry, entry.resident);
+    entry.active = false;
+    entry.texture = Texture(TextureType::Texture2D);
+    entry.desc = {};
+    _free.push_back(handle);
+}
+
+void TextureStreamer::use(uint32_t handle, float screenSize) {
+    Entry& entry = _get(handle);
+    entry.screenSize = std::max(entry.screenSize, screenSize);
+}
+
+void TextureStreamer::update() {
+    _frame++;
+
+    // arrived levels, those of removed textures or no longer wanted are discarded
+    std::vector<LoadedLevel> arrived;
+    {
+        std::lock_guard<std::mutex> lock(_queue->mutex);
+        arrived.swap(_queue->levels);
+    }
+    int uploads = 0;
+    std::vector<LoadedLevel> deferred;
+    for (LoadedLevel& level : arrived) {
+        if (level.handle >= _entries.size() || !_entries[level.handle].active || _entries[level.handle].generation != level.generation) {
+            _loads--;
+            continue;
+        }
+        Entry& entry = _entries[level.handle];
+        if (level.loaded && level.level == entry.resident - 1 && uploads >= _settings.maxUploadsPerFrame) {
+            deferred.push_back(std::move(level));
+            continue;
+        }
+        _loads--;
+        entry.loading = false;
+        if (!level.loaded)
+            entry.finest = std::max(entry.finest, level.level + 1);
+        else if (level.level == entry.resident - 1 && level.level >= entry.wanted) {
+            _setResident(entry, level.level, &level);
+            uploads++;
+        }
+    }
+    if (!deferred.empty()) {
+        std::lock_guard<std::mutex> lock(_queue->mutex);
+        _queue->levels.insert(_queue->levels.begin(), std::make_move_iterator(deferred.begin()), std::make_move_iterator(deferred.end()));
+    }
+
+    // the required level follows from the texels per pixel, unused textures keep what they have until memory runs out
+    int64_t total = 0;
+    std::vector<Entry*> entries;
+    for (Entry& entry : _entries) {
+        if (!entry.active)
+            continue;
+        if (entry.screenSize > 0.0f) {
+            float texelsPerPixel = std::max(entry.desc.width, entry.desc.height) / entry.screenSize;
+            int level = texelsPerPixel <= 1.0f ? 0 : (int)std::floor(std::log2(texelsPerPixel));
+            entry.wanted = std::clamp(level, std::min(entry.finest, entry.tailLevel), entry.tailLevel);
+            entry.lastScreenSize = entry.screenSize;
+            entry.lastUsed = _frame;
+        }
+        else {
+            entry.wanted = entry.resident;
+        }
+        entry.screenSize = 0.0f;
+        total += _residentBytes(entry, entry.wanted);
+        entries.push_back(&entry);
+    }
+
+    // over budget the finest levels of long unused textures go first, then those of the smallest on screen
+    if (total > _settings.budget) {
+        std::sort(entries.begin(), entries.end(), [&](const Entry* a, const Entry* b) {
+            bool unusedA = _frame - a->lastUsed > (uint64_t)_settings.unusedFrames;
+            bool unusedB = _frame - b->lastUsed > (uint64_t)_settings.unusedFrames;
+            if (unusedA != unusedB)
+                return unusedA;
+            return unusedA ? a->lastUsed < b->lastUsed : a->lastScreenSize < b->lastScreenSize;
+        });
+        for (Entry* entry : entries) {
+            while (total > _settings.budget && entry->wanted < entry->tailLevel) {
+                total -= _levelBytes(*entry, entry->wanted);
+                entry->wanted++;
+            }
+        }
+    }
+
+    std::vector<Entry*> missing;
+    for (Entry* entry : entries) {
+        if (entry->wanted > entry->resident)
+            _setResident(*entry, entry->wanted, nullptr);
+        else if (entry->wanted < entry->resident && !entry->loading)
+            missing.push_back(entry);
+    }
+
+    // one level at a time per texture, the largest on screen first
+    std::sort(missing.begin(), missing.end(), [](const Entry* a, const Entry* b) { return a->lastScreenSize > b->lastScreenSize; });
+    for (Entry* entry : missing) {
+        if (_loads >= _settings.maxLoads)
+            break;
+        entry->loading = true;
+        _loads++;
+        int level = entry->resident - 1;
+        LoadedLevel request = { (uint32_t)(entry - _entries.data()), entry->generation, level, false, {} };
+        _pool.submit([queue = _queue, loader = entry->desc.loader, request = std::move(request), bytes = _levelBytes(*entry, level)]() mutable {
+            request.texels.resize((size_t)bytes);
+            try {
+                request.loaded = loader(request.level, request.texels);
+            }
+            catch (...) {
+                request.loaded = false;
+            }
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            queue->levels.push_back(std::move(request));
+        });
+    }
+}
+
+float TextureStreamer::screenSize(const glm::vec3& center, float radius, const glm::mat4& view, const glm::mat4& projection, int viewportHeight) {
+    float depth = -(view * glm::vec4(center, 1.0f)).z;
+    if (depth <= radius)
+        return std::numeric_limits<float>::max();
+    return radius * projection[1][1] * viewportHeight / depth;
+}
+
+}
@@ -0,0 +1,126 @@
+#include <GLA/threadPool.h>
+
+#include <atomic>
+#include <algorithm>
+#include <exception>
+
+namespace gla {
+
+// ----------------------------------------------------------------------------------------------------
+// class ThreadPool
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+void ThreadPool::_work() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+            if (_stop && _tasks.empty())
+                return;
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::_push(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stop)
+            throw std::runtime_error("Can't submit tasks to a stopped ThreadPool!");
+        _tasks.push_back(std::move(task));
+    }
+    _condition.notify_one();
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    if (threadCount == 0) {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        threadCount = hardware > 1 ? hardware - 1 : 1;
+    }
+    _workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++)
+        _workers.emplace_back([this]() { _work(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _condition.notify_all();
+    for (std::thread& worker : _workers)
+        worker.join();
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void ThreadPool::parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t begin, size_t end)>& func) {
+    if (count == 0)
+        return;
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    size_t chunks = (count + chunkSize - 1) / chunkSize;
+    if (chunks == 1) {
+        func(0, count);
+        return;
+    }
+
+    // shared state, helpers that start after the caller returned just find no chunks left
+    struct State {
+        std::atomic<size_t> next = 0;
+        std::atomic<size_t> done = 0;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+
+    auto runChunks = [state, chunks, chunkSize, count, &func]() {
+        size_t chunk;
+        while ((chunk = state->next.fetch_add(1)) < chunks) {
+            try {
+                size_t begin = chunk * chunkSize;
+                func(begin, std::min(begin + chunkSize, count));
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error)
+                    state->error = std::current_exception();
+            }
+            if (state->done.fetch_add(1) + 1 == chunks) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min<size_t>(_workers.size(), chunks - 1);
+    for (size_t i = 0; i < helpers; i++)
+        _push(runChunks);
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&]() { return state->done.load() == chunks; });
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+}
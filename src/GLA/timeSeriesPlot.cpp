@@ -0,0 +1,347 @@
+#include <GLA/timeSeriesPlot.h>
+
+#include <GLA/debug.h>
+#include <GLA/shader.h>
+#include <GLA/simd.h>
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <glm/glm.hpp>
+
+#ifdef GLA_X86
+#include <emmintrin.h>
+#endif
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    constexpr int kFactorShift = 3;                 // every pyramid entry aggregates 1 << kFactorShift entries below
+    constexpr uint32_t kFactor = 1u << kFactorShift;
+    constexpr int kMaxLevels = 11;                  // level 10 aggregates 2^30 samples
+
+    const glm::vec2 kEmpty(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+
+    glm::vec2 combine(const glm::vec2& a, const glm::vec2& b) {
+        return { std::min(a.x, b.x), std::max(a.y, b.y) };
+    }
+
+    glm::vec2 minMax(const float* samples, size_t count) {
+        glm::vec2 result = kEmpty;
+        for (size_t i = 0; i < count; i++)
+            result = combine(result, glm::vec2(samples[i]));
+        return result;
+    }
+
+    // min / max of every group of kFactor samples
+    void groupMinMax(const float* samples, size_t groups, glm::vec2* result) {
+#ifdef GLA_X86
+        for (size_t i = 0; i < groups; i++, samples += kFactor) {
+            __m128 a = _mm_loadu_ps(samples);
+            __m128 b = _mm_loadu_ps(samples + 4);
+            __m128 low = _mm_min_ps(a, b);
+            __m128 high = _mm_max_ps(a, b);
+            low = _mm_min_ps(low, _mm_shuffle_ps(low, low, _MM_SHUFFLE(1, 0, 3, 2)));
+            high = _mm_max_ps(high, _mm_shuffle_ps(high, high, _MM_SHUFFLE(1, 0, 3, 2)));
+            low = _mm_min_ss(low, _mm_shuffle_ps(low, low, _MM_SHUFFLE(2, 3, 0, 1)));
+            high = _mm_max_ss(high, _mm_shuffle_ps(high, high, _MM_SHUFFLE(2, 3, 0, 1)));
+            result[i] = { _mm_cvtss_f32(low), _mm_cvtss_f32(high) };
+        }
+#else
+        for (size_t i = 0; i < groups; i++)
+            result[i] = minMax(samples + i * kFactor, kFactor);
+#endif
+    }
+
+    const char* kPlotVertexShader = R"(#version 430 core
+
+layout(std430, binding = 0) readonly buffer Series { float data[]; };
+
+uniform uint uOrigin;           // absolute index of relative sample 0, aligned to the entries of uLevel
+uniform float uStart;           // left edge of the plot relative to uOrigin
+uniform float uSamplesPerColumn;
+uniform ivec2 uValid;           // samples in the ring [begin; end) relative to uOrigin
+uniform uint uCapacity;
+uniform int uLevel;
+uniform uint uLevelOffset;      // first float of the level in data
+uniform vec2 uValueRange;       // value at the bottom and the top
+uniform vec2 uSize;             // plot size in pixels
+uniform float uThickness;
+
+float rawSample(int i) {
+    return data[(uOrigin + uint(i)) & (uCapacity - 1u)];
+}
+
+float interpolate(float x) {
+    int i = int(floor(x));
+    return mix(rawSample(i), rawSample(min(i + 1, uValid.y - 1)), x - float(i));
+}
+
+void main() {
+    float s0 = uStart + float(gl_InstanceID) * uSamplesPerColumn;
+    float s1 = s0 + uSamplesPerColumn;
+    vec2 range = vec2(3.0e38, -3.0e38);
+
+    if (uLevel == 0) {
+        // the interpolated values at the edges are shared with the neighbours, which connects the columns
+        if (s1 >= float(uValid.x) && s0 <= float(uValid.y - 1)) {
+            float a = clamp(s0, float(uValid.x), float(uValid.y - 1));
+            float b = clamp(s1, float(uValid.x), float(uValid.y - 1));
+            float va = interpolate(a);
+            float vb = interpolate(b);
+            range = vec2(min(va, vb), max(va, vb));
+            for (int i = int(floor(a)) + 1; i <= int(floor(b)); i++) {
+                float v = rawSample(i);
+                range = vec2(min(range.x, v), max(range.y, v));
+            }
+        }
+    }
+    else {
+        // the entry at the right edge is also the first entry of the next column
+        int shift = 3 * uLevel;
+        float size = float(1 << shift);
+        uint mask = (uCapacity >> uint(shift)) - 1u;
+        int first = max(int(floor(s0 / size)), (max(uValid.x, 0) + (1 << shift) - 1) >> shift);
+        int last = min(int(floor(s1 / size)), ((uValid.y + (1 << shift) - 1) >> shift) - 1);
+        for (int i = first; i <= last; i++) {
+            uint slot = ((uOrigin >> uint(shift)) + uint(i)) & mask;
+            range = vec2(min(range.x, data[uLevelOffset + 2u * slot]), max(range.y, data[uLevelOffset + 2u * slot + 1u]));
+        }
+    }
+
+    if (range.x > range.y) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    float padding = uThickness * 0.5 / uSize.y;
+    vec2 y = (range - uValueRange.x) / (uValueRange.y - uValueRange.x);
+    float x = (float(gl_InstanceID) + corner.x) / uSize.x;
+    gl_Position = vec4(x * 2.0 - 1.0, mix(y.x - padding, y.y + padding, corner.y) * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    const char* kPlotFragmentShader = R"(#version 430 core
+
+uniform vec4 uColor;
+
+layout(location = 0) out vec4 color;
+
+void main() {
+    color = uColor;
+}
+)";
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class TimeSeriesPlot
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+TimeSeriesPlot::Series& TimeSeriesPlot::_get(uint32_t handle) {
+    if (handle >= _series.size() || !_series[handle].active)
+        throw std::out_of_range("Series handle is invalid!");
+    return _series[handle];
+}
+
+const TimeSeriesPlot::Series& TimeSeriesPlot::_get(uint32_t handle) const {
+    if (handle >= _series.size() || !_series[handle].active)
+        throw std::out_of_range("Series handle is invalid!");
+    return _series[handle];
+}
+
+void TimeSeriesPlot::_write(Series& series, int level, uint64_t first, std::span<const float> values) {
+    // level 0 holds one float per sample, the others a min / max pair per entry
+    size_t components = level == 0 ? 1 : 2;
+    uint64_t ringSize = series.capacity >> (kFactorShift * level);
+    uint64_t offset = series.capacity;
+    for (int i = 1; i < level; i++)
+        offset += 2 * (uint64_t)(series.capacity >> (kFactorShift * i));
+
+    // only the newest ringSize entries survive
+    uint64_t count = values.size() / components;
+    if (count > ringSize) {
+        values = values.subspan((size_t)((count - ringSize) * components));
+        first += count - ringSize;
+        count = ringSize;
+    }
+    uint64_t slot = first & (ringSize - 1);
+    uint64_t head = std::min(count, ringSize - slot);
+    int64_t entryBytes = (int64_t)(components * sizeof(float));
+    uint64_t base = level == 0 ? 0 : offset;
+    series.data.setSubData((int64_t)(base * sizeof(float)) + (int64_t)slot * entryBytes, (int64_t)head * entryBytes, values.data());
+    if (head < count)
+        series.data.setSubData((int64_t)(base * sizeof(float)), (int64_t)(count - head) * entryBytes, values.data() + head * components);
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+TimeSeriesPlot::TimeSeriesPlot() {
+    Shader vertex(ShaderType::Vertex, kPlotVertexShader);
+    Shader fragment(ShaderType::Fragment, kPlotFragmentShader);
+    _program.attach(vertex);
+    _program.attach(fragment);
+    _program.link();
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+uint32_t TimeSeriesPlot::addSeries(uint32_t capacity) {
+    if (capacity < 64 || (capacity & (capacity - 1)) != 0)
+        throw std::invalid_argument("Series capacity must be a power of two of at least 64!");
+
+    Series series;
+    series.active = true;
+    series.capacity = capacity;
+    // every level keeps at least kFactor entries
+    series.levels = 1;
+    while (series.levels < kMaxLevels && (capacity >> (kFactorShift * series.levels)) >= kFactor)
+        series.levels++;
+    series.partial.assign(series.levels, kEmpty);
+
+    uint64_t floats = capacity;
+    for (int level = 1; level < series.levels; level++)
+        floats += 2 * (uint64_t)(capacity >> (kFactorShift * level));
+    series.data.setStorage((int64_t)(floats * sizeof(float)), nullptr, BufferFlag::DynamicStorage);
+
+    uint32_t handle;
+    if (!_free.empty()) {
+        handle = _free.back();
+        _free.pop_back();
+        _series[handle] = std::move(series);
+    }
+    else {
+        handle = (uint32_t)_series.size();
+        _series.push_back(std::move(series));
+    }
+    return handle;
+}
+
+void TimeSeriesPlot::removeSeries(uint32_t handle) {
+    Series& series = _get(handle);
+    series.active = false;
+    series.data = Buffer(BufferType::ShaderStorage);
+    series.partial = {};
+    _free.push_back(handle);
+}
+
+void TimeSeriesPlot::append(uint32_t handle, std::span<const float> samples) {
+    Series& series = _get(handle);
+    if (samples.empty())
+        return;
+
+    // entries completed or changed per level, starting at the entry the first new sample falls into
+    std::vector<std::vector<glm::vec2>> entries(series.levels);
+    std::vector<uint64_t> firstEntry(series.levels);
+    for (int level = 1; level < series.levels; level++)
+        firstEntry[level] = series.count >> (kFactorShift * level);
+
+    // completing a level 1 entry cascades upwards through every level whose entry completes with it
+    auto complete = [&](glm::vec2 value, uint64_t count) {
+        series.partial[1] = combine(series.partial[1], value);
+        for (int level = 1; level < series.levels && (count & ((1ull << (kFactorShift * level)) - 1)) == 0; level++) {
+            entries[level].push_back(series.partial[level]);
+            if (level + 1 < series.levels)
+                series.partial[level + 1] = combine(series.partial[level + 1], series.partial[level]);
+            series.partial[level] = kEmpty;
+        }
+    };
+
+    _write(series, 0, series.count, samples);
+
+    // unaligned head, whole groups with SIMD, unaligned tail
+    size_t position = 0;
+    size_t head = std::min<size_t>((kFactor - series.count % kFactor) % kFactor, samples.size());
+    if (head > 0) {
+        glm::vec2 value = minMax(samples.data(), head);
+        series.count += head;
+        position = head;
+        if (series.count % kFactor == 0)
+            complete(value, series.count);
+        else
+            series.partial[1] = combine(series.partial[1], value);
+    }
+
+    std::vector<glm::vec2> groups((samples.size() - position) / kFactor);
+    groupMinMax(samples.data() + position, groups.size(), groups.data());
+    for (const glm::vec2& group : groups) {
+        series.count += kFactor;
+        complete(group, series.count);
+    }
+    position += groups.size() * kFactor;
+
+    if (position < samples.size()) {
+        series.partial[1] = combine(series.partial[1], minMax(samples.data() + position, samples.size() - position));
+        series.count += samples.size() - position;
+    }
+
+    // incomplete entries contain everything below them so far
+    glm::vec2 below = kEmpty;
+    for (int level = 1; level < series.levels; level++) {
+        below = combine(series.partial[level], below);
+        if ((series.count & ((1ull << (kFactorShift * level)) - 1)) != 0)
+            entries[level].push_back(below);
+        if (!entries[level].empty())
+            _write(series, level, firstEntry[level], { (const float*)entries[level].data(), entries[level].size() * 2 });
+    }
+}
+
+void TimeSeriesPlot::draw(uint32_t handle, const PlotRange& range, int width, int height, const glm::vec4& color, float thickness) {
+    Series& series = _get(handle);
+    if (width <= 0 || height <= 0)
+        throw std::invalid_argument("Plot width and height must be greater than 0!");
+    if (!(range.lastSample > range.firstSample) || !(range.maxValue > range.minValue))
+        throw std::invalid_argument("Plot range may not be empty!");
+    if (series.count == 0)
+        return;
+
+    // the finest level with at most kFactor entries per column
+    double samplesPerColumn = (range.lastSample - range.firstSample) / width;
+    int level = 0;
+    while (level + 1 < series.levels && (double)(1ull << (kFactorShift * (level + 1))) <= samplesPerColumn)
+        level++;
+
+    // positions are relative to an origin aligned to the entries of the drawn level, so the level divides exactly
+    // and uStart stays below one entry of it, small enough for a float to resolve fractions of a sample when zoomed in
+    int64_t alignment = 1ll << (kFactorShift * level);
+    int64_t origin = std::max<int64_t>((int64_t)std::floor(range.firstSample), 0) & ~(alignment - 1);
+    int64_t validBegin = std::max<int64_t>((int64_t)series.count - series.capacity, 0) - origin;
+    int64_t validEnd = (int64_t)series.count - origin;
+    auto clampInt = [](int64_t value) { return (int)std::clamp<int64_t>(value, std::numeric_limits<int>::min(), std::numeric_limits<int>::max()); };
+
+    uint64_t levelOffset = series.capacity;
+    for (int i = 1; i < level; i++)
+        levelOffset += 2 * (uint64_t)(series.capacity >> (kFactorShift * i));
+
+    _program.bind();
+    _program["uOrigin"] = (unsigned int)origin;
+    _program["uStart"] = (float)(range.firstSample - (double)origin);
+    _program["uSamplesPerColumn"] = (float)samplesPerColumn;
+    _program["uValid"] = glm::ivec2(clampInt(validBegin), clampInt(validEnd));
+    _program["uCapacity"] = series.capacity;
+    _program["uLevel"] = level;
+    _program["uLevelOffset"] = (unsigned int)levelOffset;
+    _program["uValueRange"] = glm::vec2(range.minValue, range.maxValue);
+    _program["uSize"] = glm::vec2((float)width, (float)height);
+    _program["uThickness"] = thickness;
+    _program["uColor"] = color;
+    series.data.bindBase(0);
+
+    GL_CALL(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, width));
+}
+
+}
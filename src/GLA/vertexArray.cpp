@@ -51,6 +51,26 @@ int typeToBytes(VertexAttribType type) {
     throw std::invalid_argument("Given VertexAttribType is invalid!");
 }
 
+unsigned int toGLenum(IndexType type) {
+    switch (type)
+    {
+    case IndexType::UnsignedByte:   return GL_UNSIGNED_BYTE;
+    case IndexType::UnsignedShort:  return GL_UNSIGNED_SHORT;
+    case IndexType::UnsignedInt:    return GL_UNSIGNED_INT;
+    }
+    throw std::invalid_argument("Given IndexType is invalid!");
+}
+
+int typeToBytes(IndexType type) {
+    switch (type)
+    {
+    case IndexType::UnsignedByte:   return 1;
+    case IndexType::UnsignedShort:  return 2;
+    case IndexType::UnsignedInt:    return 4;
+    }
+    throw std::invalid_argument("Given IndexType is invalid!");
+}
+
 // ----------------------------------------------------------------------------------------------------
 // VertexArray class
 // ----------------------------------------------------------------------------------------------------
@@ -59,7 +79,17 @@ int typeToBytes(VertexAttribType type) {
 // public methods
 // --------------------------------------------------
 
-void VertexArray::setAttributes(const std::vector<VertexAttribute>& attribs, int stride) {
+void VertexArray::setAttributes(const std::vector<VertexAttribute>& attribs, int stride, int64_t offset) {
+    bind();
+
+    for (unsigned int i : _enabledVertexAttribs)
+        GL_CALL(glDisableVertexAttribArray(i));
+
+    _enabledVertexAttribs.clear();
+    addAttributes(attribs, stride, offset);
+}
+
+void VertexArray::addAttributes(const std::vector<VertexAttribute>& attribs, int stride, int64_t offset) {
     if (stride <= 0)
         throw std::invalid_argument("stride must be greater than 0!");
 
@@ -70,13 +100,12 @@ void VertexArray::setAttributes(const std::vector<VertexAttribute>& attribs, int
     if (maxVertexAttribs < attribs.size())
         throw std::runtime_error("The current GPU does not support " + std::to_string(attribs.size()) + " vertex attributes. Max allowed are: " + std::to_string(maxVertexAttribs) + ". At least 16 are guaranteed!");
 
-    bind();
+    if (offset < 0)
+        throw std::invalid_argument("offset may not be less than 0!");
 
-    for (unsigned int i : _enabledVertexAttribs)
-        GL_CALL(glDisableVertexAttribArray(i));
+    bind();
 
-    _enabledVertexAttribs.clear();
-    _enabledVertexAttribs.reserve(attribs.size());
+    _enabledVertexAttribs.reserve(_enabledVertexAttribs.size() + attribs.size());
 
     DEBUG_ONLY(
     
@@ -109,10 +138,11 @@ void VertexArray::setAttributes(const std::vector<VertexAttribute>& attribs, int
             throw std::invalid_argument(error);
         
         if (attrib.interp == VertexAttribInterp::Integer)
-            GL_CALL(glVertexAttribIPointer(attrib.index, attrib.numComponents, toGLenum(attrib.type), stride, (void*)attrib.offset));
+            GL_CALL(glVertexAttribIPointer(attrib.index, attrib.numComponents, toGLenum(attrib.type), stride, (void*)(offset + attrib.offset)));
         else
-            GL_CALL(glVertexAttribPointer(attrib.index, attrib.numComponents, toGLenum(attrib.type), attrib.normalized, stride, (void*)attrib.offset));
+            GL_CALL(glVertexAttribPointer(attrib.index, attrib.numComponents, toGLenum(attrib.type), attrib.normalized, stride, (void*)(offset + attrib.offset)));
+        GL_CALL(glVertexAttribDivisor(attrib.index, attrib.divisor));
     }
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,420 @@
+#include <GLA/virtualTexture.h>
+
+#include <GLA/assetPack.h>
+#include <GLA/debug.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/common.hpp>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace gla {
+
+namespace {
+
+    constexpr int kReadbackSlots = 3;
+    constexpr int kMaxPagesPerSide = 4096;
+
+    // page keys are also the feedback values (minus 1): 8 bit level, 12 bit y, 12 bit x
+    uint32_t pageKey(int level, int x, int y) {
+        return ((uint32_t)level << 24) | ((uint32_t)y << 12) | (uint32_t)x;
+    }
+
+    // indirection texels: cache slot x, cache slot y, level of the mapped page, 255
+    uint32_t indirectionEntry(int slot, int cachePages, int level) {
+        return (uint32_t)(slot % cachePages) | ((uint32_t)(slot / cachePages) << 8) | ((uint32_t)level << 16) | 0xFF000000u;
+    }
+
+    bool isPowerOfTwo(int value) {
+        return value > 0 && (value & (value - 1)) == 0;
+    }
+
+    const char* kVirtualSample = R"(
+layout(binding = VT_CACHE_UNIT) uniform sampler2D virtualCache;
+layout(binding = VT_INDIRECTION_UNIT) uniform sampler2D virtualIndirection;
+
+ivec2 virtualPages(int level) {
+    return max(ivec2(VT_PAGES_X, VT_PAGES_Y) >> level, ivec2(1));
+}
+
+float virtualLod(vec2 uv) {
+    vec2 dx = dFdx(uv * vec2(VT_WIDTH, VT_HEIGHT));
+    vec2 dy = dFdy(uv * vec2(VT_WIDTH, VT_HEIGHT));
+    return 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1.0e-8));
+}
+
+// samples the finest resident page covering uv at the given level
+vec4 sampleVirtualLevel(vec2 uv, int level) {
+    uv = clamp(uv, vec2(0.0), vec2(0.999999));
+    ivec2 page = ivec2(uv * vec2(virtualPages(level)));
+    uvec4 entry = uvec4(texelFetch(virtualIndirection, page, level) * 255.0 + 0.5);
+    vec2 inPage = fract(uv * vec2(virtualPages(int(entry.b))));
+    vec2 texel = vec2(entry.rg) * float(VT_PAGE_SIZE + 2 * VT_BORDER) + float(VT_BORDER) + inPage * float(VT_PAGE_SIZE);
+    return textureLod(virtualCache, texel / float(VT_CACHE_TEXELS), 0.0);
+}
+
+vec4 sampleVirtual(vec2 uv) {
+    return sampleVirtualLevel(uv, clamp(int(floor(virtualLod(uv))), 0, VT_LEVELS - 1));
+}
+)";
+
+    const char* kVirtualFeedback = R"(
+layout(location = 0) out uint virtualFeedback;
+
+// the feedback target is smaller than the screen, which makes the derivatives larger
+void writeVirtualFeedback(vec2 uv) {
+    int level = clamp(int(floor(virtualLod(uv) - VT_FEEDBACK_BIAS)), 0, VT_LEVELS - 1);
+    ivec2 page = ivec2(clamp(uv, vec2(0.0), vec2(0.999999)) * vec2(virtualPages(level)));
+    virtualFeedback = uint((level << 24) | (page.y << 12) | page.x) + 1u;
+}
+)";
+
+}
+
+// ----------------------------------------------------------------------------------------------------
+// class VirtualTexture
+// ----------------------------------------------------------------------------------------------------
+
+// --------------------------------------------------
+// private methods
+// --------------------------------------------------
+
+glm::ivec2 VirtualTexture::_pageCount(int level) const {
+    return glm::max(glm::ivec2(_pagesX, _pagesY) >> level, glm::ivec2(1));
+}
+
+void VirtualTexture::_map(uint32_t key, uint32_t entry, bool evict) {
+    int level = (int)(key >> 24), x = (int)(key & 0xFFF), y = (int)((key >> 12) & 0xFFF);
+    glm::ivec2 pages = _pageCount(level);
+
+    // the page covers a rectangle of entries on its own and every finer level
+    for (int target = level; target >= 0; target--) {
+        glm::ivec2 targetPages = _pageCount(target);
+        glm::ivec2 scale = targetPages / pages;
+        glm::ivec2 low = glm::ivec2(x, y) * scale;
+        glm::ivec2 high = low + scale;
+        std::vector<uint32_t>& entries = _indirectionData[target];
+        for (int ty = low.y; ty < high.y; ty++) {
+            for (int tx = low.x; tx < high.x; tx++) {
+                uint32_t& current = entries[(size_t)ty * targetPages.x + tx];
+                int mapped = (int)((current >> 16) & 0xFF);
+                // loading replaces coarser pages, evicting falls back to what the parent maps to
+                if (evict ? mapped == level : mapped >= level)
+                    current = entry;
+            }
+        }
+        glm::ivec4& dirty = _dirty[target];
+        dirty = glm::ivec4(glm::min(glm::ivec2(dirty), low), glm::max(glm::ivec2(dirty.z, dirty.w), high));
+    }
+}
+
+void VirtualTexture::_upload(const LoadedPage& page) {
+    PageState& state = _pages[page.key];
+    if (!page.loaded) {
+        state.failed = true;
+        return;
+    }
+    if (state.slot >= 0)
+        return;
+
+    // a free slot or the least recently used page that was not requested this frame
+    int slot = -1;
+    uint64_t oldest = _frame;
+    for (size_t i = 0; i < _slots.size(); i++) {
+        if (_slots[i].key == UINT32_MAX) {
+            slot = (int)i;
+            break;
+        }
+        if (_slots[i].lastUsed < oldest) {
+            oldest = _slots[i].lastUsed;
+            slot = (int)i;
+        }
+    }
+    if (slot < 0)
+        return; // the cache is full of visible pages, the page is requested again by the next feedback
+
+    Slot& target = _slots[slot];
+    if (target.key != UINT32_MAX) {
+        uint32_t evicted = target.key;
+        int level = (int)(evicted >> 24), x = (int)(evicted & 0xFFF), y = (int)((evicted >> 12) & 0xFFF);
+        glm::ivec2 parentPages = _pageCount(level + 1);
+        glm::ivec2 parent = glm::min(glm::ivec2(x, y) * parentPages / _pageCount(level), parentPages - 1);
+        _pages[evicted].slot = -1;
+        _map(evicted, _indirectionData[level + 1][(size_t)parent.y * parentPages.x + parent.x], true);
+    }
+
+    int padded = _settings.pageSize + 2 * _settings.border;
+    int cachePages = _settings.cachePages;
+    _cache.setSubImage(0, (slot % cachePages) * padded, (slot / cachePages) * padded, 0, padded, padded, 1, page.texels.data());
+    target.key = page.key;
+    target.lastUsed = _frame;
+    state.slot = slot;
+    _map(page.key, indirectionEntry(slot, cachePages, (int)(page.key >> 24)), false);
+}
+
+void VirtualTexture::_collectFeedback() {
+    std::unordered_map<uint32_t, uint32_t> requests;
+    size_t slotTexels = _readbackData == nullptr ? 0 : (size_t)_feedback.width() * _feedback.height();
+    for (size_t i = 0; i < _readbacks.size(); i++) {
+        Readback& readback = _readbacks[i];
+        if (!readback.active || !readback.fence.signaled())
+            continue;
+        const uint32_t* values = _readbackData + i * slotTexels;
+        for (size_t t = 0; t < (size_t)readback.width * readback.height; t++)
+            if (values[t] != 0)
+                requests[values[t] - 1]++;
+        readback.fence.reset();
+        readback.active = false;
+    }
+    if (requests.empty())
+        return;
+
+    struct Request {
+        uint32_t key;
+        uint32_t count;
+    };
+    std::vector<Request> missing;
+    for (const auto& [key, count] : requests) {
+        int level = (int)(key >> 24), x = (int)(key & 0xFFF), y = (int)((key >> 12) & 0xFFF);
+        if (level >= _levels)
+            continue;
+        glm::ivec2 pages = _pageCount(level);
+        if (x >= pages.x || y >= pages.y)
+            continue;
+
+        // the page that is sampled right now stays in the cache, whether it is the requested one or a fallback
+        uint32_t entry = _indirectionData[level][(size_t)y * pages.x + x];
+        int slot = (int)((entry >> 8) & 0xFF) * _settings.cachePages + (int)(entry & 0xFF);
+        _slots[slot].lastUsed = std::max(_slots[slot].lastUsed, _frame);
+
+        PageState& state = _pages[key];
+        if (state.slot < 0 && !state.loading && !state.failed)
+            missing.push_back({ key, count });
+    }
+
+    // coarse pages first, they replace the most fallback texels
+    std::sort(missing.begin(), missing.end(), [](const Request& a, const Request& b) {
+        return (a.key >> 24) != (b.key >> 24) ? (a.key >> 24) > (b.key >> 24) : a.count > b.count;
+    });
+    int padded = _settings.pageSize + 2 * _settings.border;
+    size_t bytes = (size_t)padded * padded * formatToBytes(_settings.format);
+    for (const Request& request : missing) {
+        if (_loads >= _settings.maxLoads)
+            break;
+        _pages[request.key].loading = true;
+        _loads++;
+        _pool.submit([queue = _queue, loader = _loader, key = request.key, bytes]() {
+            LoadedPage page = { key, false, std::vector<uint8_t>(bytes) };
+            try {
+                page.loaded = loader((int)(key >> 24), (int)(key & 0xFFF), (int)((key >> 12) & 0xFFF), page.texels);
+            }
+            catch (...) {
+                page.loaded = false;
+            }
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            queue->pages.push_back(std::move(page));
+        });
+    }
+}
+
+// --------------------------------------------------
+// constructors / destructors
+// --------------------------------------------------
+
+VirtualTexture::VirtualTexture(const VirtualTextureSettings& settings, PageLoader loader, int screenWidth, int screenHeight, ThreadPool& pool)
+    : _settings(settings), _loader(std::move(loader)), _pool(pool), _queue(std::make_shared<LoadQueue>()),
+      _cache(TextureType::Texture2D), _indirection(TextureType::Texture2D), _feedback(TextureType::Texture2D),
+      _feedbackDepth(TextureType::Texture2D), _readback(BufferType::PixelPack) {
+    if (settings.pageSize <= 0 || settings.border < 0 || settings.feedbackScale <= 0 || settings.maxLoads <= 0 || settings.maxUploadsPerFrame <= 0)
+        throw std::invalid_argument("VirtualTexture pageSize, feedbackScale, maxLoads and maxUploadsPerFrame must be greater than 0!");
+    if (settings.cachePages <= 0 || settings.cachePages > 256)
+        throw std::invalid_argument("VirtualTexture cachePages must be within 1 and 256!");
+    if (settings.width % settings.pageSize != 0 || settings.height % settings.pageSize != 0)
+        throw std::invalid_argument("VirtualTexture width and height must be multiples of pageSize!");
+    _pagesX = settings.width / settings.pageSize;
+    _pagesY = settings.height / settings.pageSize;
+    if (!isPowerOfTwo(_pagesX) || !isPowerOfTwo(_pagesY) || _pagesX > kMaxPagesPerSide || _pagesY > kMaxPagesPerSide)
+        throw std::invalid_argument("VirtualTexture page counts must be powers of two up to 4096!");
+    if (!_loader)
+        throw std::invalid_argument("VirtualTexture needs a PageLoader!");
+
+    _levels = mipLevelCount(_pagesX, _pagesY);
+    int padded = settings.pageSize + 2 * settings.border;
+    _cache.setStorage(1, settings.format, settings.cachePages * padded, settings.cachePages * padded);
+    _cache.setFilter(TextureFilter::Linear, TextureFilter::Linear);
+    _cache.setWrap(TextureWrap::ClampToEdge);
+    _slots.resize((size_t)settings.cachePages * settings.cachePages);
+
+    // the coarsest page is always resident and every entry starts out mapped to it
+    std::vector<uint8_t> texels((size_t)padded * padded * formatToBytes(settings.format));
+    if (!_loader(_levels - 1, 0, 0, texels))
+        throw std::invalid_argument("VirtualTexture failed to load the coarsest page!");
+    _cache.setSubImage(0, 0, 0, 0, padded, padded, 1, texels.data());
+    uint32_t root = pageKey(_levels - 1, 0, 0);
+    _slots[0] = { root, UINT64_MAX };
+    _pages[root].slot = 0;
+
+    _indirection.setStorage(_levels, TextureFormat::RGBA8, _pagesX, _pagesY);
+    _indirection.setFilter(TextureFilter::NearestMipmapNearest, TextureFilter::Nearest);
+    for (int level = 0; level < _levels; level++) {
+        glm::ivec2 pages = _pageCount(level);
+        _indirectionData.emplace_back((size_t)pages.x * pages.y, indirectionEntry(0, settings.cachePages, _levels - 1));
+        _indirection.setSubImage(level, 0, 0, 0, pages.x, pages.y, 1, _indirectionData.back().data());
+    }
+    _dirty.assign(_levels, glm::ivec4(INT32_MAX, INT32_MAX, 0, 0));
+
+    resize(screenWidth, screenHeight);
+}
+
+// --------------------------------------------------
+// public methods
+// --------------------------------------------------
+
+void VirtualTexture::resize(int screenWidth, int screenHeight) {
+    if (screenWidth <= 0 || screenHeight <= 0)
+        throw std::invalid_argument("VirtualTexture screen width and height must be greater than 0!");
+    if (_drawing)
+        throw std::logic_error("VirtualTexture can't be resized between beginFeedback() and endFeedback()!");
+    int width = (screenWidth + _settings.feedbackScale - 1) / _settings.feedbackScale;
+    int height = (screenHeight + _settings.feedbackScale - 1) / _settings.feedbackScale;
+
+    _feedback = Texture(TextureType::Texture2D);
+    _feedback.setStorage(1, TextureFormat::R32UI, width, height);
+    _feedback.setFilter(TextureFilter::Nearest, TextureFilter::Nearest);
+    _feedbackDepth = Texture(TextureType::Texture2D);
+    _feedbackDepth.setStorage(1, TextureFormat::Depth24, width, height);
+    _feedbackFramebuffer = Framebuffer();
+    _feedbackFramebuffer.attachColor(0, _feedback);
+    _feedbackFramebuffer.attachDepth(_feedbackDepth);
+    _feedbackFramebuffer.check();
+
+    // readbacks of the old size are dropped with their Buffer
+    int64_t bytes = (int64_t)kReadbackSlots * width * height * sizeof(uint32_t);
+    _readback = Buffer(BufferType::PixelPack);
+    _readback.setStorage(bytes, nullptr, BufferFlag::MapRead | BufferFlag::MapPersistent | BufferFlag::MapCoherent);
+    _readbackData = (const uint32_t*)_readback.map(0, bytes, MapUsage::Read | MapUsage::Persistent | MapUsage::Coherent);
+    _readbacks.clear();
+    _readbacks.resize(kReadbackSlots);
+}
+
+void VirtualTexture::beginFeedback() {
+    if (_drawing)
+        throw std::logic_error("VirtualTexture::beginFeedback() was already called!");
+    _drawing = true;
+    GL_CALL(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_previousFramebuffer));
+    GL_CALL(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &_previousReadFramebuffer));
+    GL_CALL(glGetIntegerv(GL_VIEWPORT, _previousViewport));
+    _feedbackFramebuffer.bind();
+    GL_CALL(glDepthMask(GL_TRUE));
+    _feedbackFramebuffer.clearColor(0, glm::uvec4(0));
+    _feedbackFramebuffer.clearDepth(1.0f);
+}
+
+void VirtualTexture::endFeedback() {
+    if (!_drawing)
+        throw std::logic_error("VirtualTexture::beginFeedback() was not called!");
+    _drawing = false;
+
+    auto slot = std::find_if(_readbacks.begin(), _readbacks.end(), [](const Readback& readback) { return !readback.active; });
+    if (slot != _readbacks.end()) {
+        int width = _feedback.width(), height = _feedback.height();
+        int64_t offset = (int64_t)(slot - _readbacks.begin()) * width * height * sizeof(uint32_t);
+        GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, _feedbackFramebuffer.id()));
+        GL_CALL(glReadBuffer(GL_COLOR_ATTACHMENT0));
+        _readback.bind();
+        GL_CALL(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+        GL_CALL(glReadPixels(0, 0, width, height, GL_RED_INTEGER, GL_UNSIGNED_INT, (void*)offset));
+        GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        slot->fence.place();
+        slot->active = true;
+        slot->width = width;
+        slot->height = height;
+    }
+    GL_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _previousFramebuffer));
+    GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, _previousReadFramebuffer));
+    GL_CALL(glViewport(_previousViewport[0], _previousViewport[1], _previousViewport[2], _previousViewport[3]));
+}
+
+void VirtualTexture::update() {
+    _frame++;
+    _collectFeedback();
+
+    std::vector<LoadedPage> finished;
+    {
+        std::lock_guard<std::mutex> lock(_queue->mutex);
+        finished.swap(_queue->pages);
+    }
+    int uploads = 0;
+    size_t processed = 0;
+    for (; processed < finished.size() && uploads < _settings.maxUploadsPerFrame; processed++) {
+        _upload(finished[processed]);
+        _loads--;
+        _pages[finished[processed].key].loading = false;
+        uploads += finished[processed].loaded ? 1 : 0;
+    }
+    if (processed < finished.size()) {
+        std::lock_guard<std::mutex> lock(_queue->mutex);
+        _queue->pages.insert(_queue->pages.begin(), std::make_move_iterator(finished.begin() + processed), std::make_move_iterator(finished.end()));
+    }
+
+    // only the changed rectangle of every level is uploaded
+    std::vector<uint32_t> rect;
+    for (int level = 0; level < _levels; level++) {
+        glm::ivec4& dirty = _dirty[level];
+        if (dirty.x >= dirty.z || dirty.y >= dirty.w)
+            continue;
+        int width = _pageCount(level).x;
+        rect.clear();
+        for (int y = dirty.y; y < dirty.w; y++)
+            rect.insert(rect.end(), _indirectionData[level].begin() + (size_t)y * width + dirty.x, _indirectionData[level].begin() + (size_t)y * width + dirty.z);
+        _indirection.setSubImage(level, dirty.x, dirty.y, 0, dirty.z - dirty.x, dirty.w - dirty.y, 1, rect.data());
+        dirty = glm::ivec4(INT32_MAX, INT32_MAX, 0, 0);
+    }
+}
+
+void VirtualTexture::bind() const {
+    _cache.bind(_settings.cacheUnit);
+    _indirection.bind(_settings.indirectionUnit);
+}
+
+std::string VirtualTexture::glslSource(bool feedback) const {
+    int padded = _settings.pageSize + 2 * _settings.border;
+    std::string source =
+        "#define VT_CACHE_UNIT " + std::to_string(_settings.cacheUnit) +
+        "\n#define VT_INDIRECTION_UNIT " + std::to_string(_settings.indirectionUnit) +
+        "\n#define VT_WIDTH " + std::to_string(_settings.width) + ".0" +
+        "\n#define VT_HEIGHT " + std::to_string(_settings.height) + ".0" +
+        "\n#define VT_PAGES_X " + std::to_string(_pagesX) +
+        "\n#define VT_PAGES_Y " + std::to_string(_pagesY) +
+        "\n#define VT_LEVELS " + std::to_string(_levels) +
+        "\n#define VT_PAGE_SIZE " + std::to_string(_settings.pageSize) +
+        "\n#define VT_BORDER " + std::to_string(_settings.border) +
+        "\n#define VT_CACHE_TEXELS " + std::to_string(_settings.cachePages * padded) +
+        "\n#define VT_FEEDBACK_BIAS " + std::to_string(std::log2((float)_settings.feedbackScale)) + "\n" + kVirtualSample;
+    if (feedback)
+        source += kVirtualFeedback;
+    return source;
+}
+
+VirtualTexture::PageLoader VirtualTexture::packLoader(std::shared_ptr<const AssetPack> pack, const std::string& prefix) {
+    return [pack = std::move(pack), prefix](int level, int x, int y, std::span<uint8_t> texels) {
+        std::string name = prefix + "/" + std::to_string(level) + "/" + std::to_string(x) + "_" + std::to_string(y);
+        if (!pack->contains(name))
+            return false;
+        std::vector<uint8_t> storage;
+        std::span<const uint8_t> data = pack->read(name, storage);
+        if (data.size() != texels.size())
+            return false;
+        std::memcpy(texels.data(), data.data(), data.size());
+        return true;
+    };
+}
+
+size_t VirtualTexture::residentPages() const {
+    return (size_t)std::count_if(_slots.begin(), _slots.end(), [](const Slot& slot) { return slot.key != UINT32_MAX; });
+}
+
+}
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <GLA/assetPack.h>
+
+// Packs every file below a directory into one asset pack loaded by gla::AssetPack.
+// Asset names are the paths relative to the directory with '/' separators, e.g. "shaders/basicTriangle/vertex.shader".
+// usage: assetPacker <input directory> <output.pack>
+
+// mesh files are uploaded in place from the mapping and images are compressed already
+bool storeUncompressed(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return extension == ".mesh" || extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+}
+
+std::vector<uint8_t> readFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Could not open file: " + path.string() + "!");
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: assetPacker <input directory> <output.pack>" << std::endl;
+        return 1;
+    }
+
+    try {
+        std::filesystem::path root(argv[1]);
+        if (!std::filesystem::is_directory(root))
+            throw std::runtime_error(std::string("Not a directory: ") + argv[1] + "!");
+
+        // sorted for reproducible packs
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root))
+            if (entry.is_regular_file())
+                files.push_back(entry.path());
+        std::sort(files.begin(), files.end());
+
+        gla::AssetPackWriter writer;
+        uint64_t bytes = 0;
+        for (const std::filesystem::path& file : files) {
+            std::vector<uint8_t> data = readFile(file);
+            bytes += data.size();
+            writer.add(std::filesystem::relative(file, root).generic_string(), std::move(data), !storeUncompressed(file));
+        }
+        writer.write(argv[2]);
+
+        std::cout << argv[2] << ": " << files.size() << " assets, " << bytes << " bytes" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+#include <iostream>
+#include <string>
+
+#include <GLA/meshFile.h>
+#include <GLA/meshImport.h>
+
+// Converts Wavefront OBJ and Stanford PLY meshes into the binary mesh format loaded by gla::MeshFile.
+// usage: meshConverter <input.obj|input.ply> <output.mesh>
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: meshConverter <input.obj|input.ply> <output.mesh>" << std::endl;
+        return 1;
+    }
+
+    try {
+        gla::MeshData mesh = gla::importMesh(argv[1]);
+        gla::writeMeshFile(argv[2], mesh);
+        std::cout << argv[2] << ": " << mesh.vertexCount << " vertices, " << mesh.indexCount / 3 << " triangles, "
+                  << mesh.submeshes.size() << " submeshes" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <charconv>
+#include <algorithm>
+#include <functional>
+
+#include <GLA/mappedFile.h>
+#include <GLA/pointCloud.h>
+#include <GLA/threadPool.h>
+
+// Builds the streamable octree of a point cloud loaded by gla::PointCloud.
+// The input is a text point list with one point per line: x y z [r g b [intensity]], colors in [0;255],
+// lines starting with '#' or that don't start with three numbers are skipped.
+// The input is streamed into the builder, so clouds larger than the memory cap are built through spill files next to the output.
+// usage: pointCloudBuilder <input.xyz> <output.pcloud> [max points per node] [max memory in MiB]
+
+const char* skipSpace(const char* it, const char* end) {
+    while (it < end && (*it == ' ' || *it == '\t' || *it == ','))
+        it++;
+    return it;
+}
+
+// parses the lines in [begin;end), which must start at the beginning of a line
+void parseLines(const char* begin, const char* end, std::vector<gla::PointCloudSourcePoint>& points) {
+    const char* line = begin;
+    while (line < end) {
+        const char* lineEnd = std::find(line, end, '\n');
+        const char* it = skipSpace(line, lineEnd);
+
+        float values[7] = {};
+        int count = 0;
+        while (count < 7 && it < lineEnd && *it != '#') {
+            auto [next, error] = std::from_chars(it, lineEnd, values[count]);
+            if (error != std::errc())
+                break;
+            count++;
+            it = skipSpace(next, lineEnd);
+        }
+
+        if (count >= 3) {
+            gla::PointCloudSourcePoint point;
+            point.position = { values[0], values[1], values[2] };
+            if (count >= 6)
+                for (int i = 0; i < 3; i++)
+                    point.color[i] = (uint8_t)std::clamp(values[3 + i], 0.0f, 255.0f);
+            if (count >= 7)
+                point.intensity = (uint16_t)std::clamp(values[6], 0.0f, 65535.0f);
+            points.push_back(point);
+        }
+        line = lineEnd + 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 5) {
+        std::cerr << "usage: pointCloudBuilder <input.xyz> <output.pcloud> [max points per node] [max memory in MiB]" << std::endl;
+        return 1;
+    }
+
+    try {
+        gla::PointCloudBuildSettings settings;
+        if (argc >= 4)
+            settings.maxNodePoints = (uint32_t)std::stoul(argv[3]);
+        if (argc >= 5)
+            settings.maxMemory = (uint64_t)std::stoull(argv[4]) << 20;
+
+        // the text is split into chunks at line breaks, which are parsed in parallel a batch at a time
+        gla::MappedFile input(argv[1]);
+        const char* text = (const char*)input.data();
+        size_t size = input.size();
+        size_t chunkSize = 16u << 20;
+        std::vector<size_t> starts = { 0 };
+        while (starts.back() + chunkSize < size) {
+            const char* lineEnd = std::find(text + starts.back() + chunkSize, text + size, '\n');
+            if (lineEnd == text + size)
+                break;
+            starts.push_back((size_t)(lineEnd - text) + 1);
+        }
+        starts.push_back(size);
+
+        // a parsed chunk takes about as much memory as its text, the batch stays within a quarter of the cap
+        gla::ThreadPool& pool = gla::ThreadPool::shared();
+        size_t chunkCount = starts.size() - 1;
+        size_t batchSize = (size_t)std::clamp<uint64_t>(settings.maxMemory / 4 / chunkSize, 1, std::max<size_t>(pool.size(), 1));
+
+        gla::buildPointCloudFile(argv[2], [&](const std::function<void(std::span<const gla::PointCloudSourcePoint>)>& consume) {
+            std::vector<std::vector<gla::PointCloudSourcePoint>> chunks(batchSize);
+            for (size_t first = 0; first < chunkCount; first += batchSize) {
+                size_t count = std::min(batchSize, chunkCount - first);
+                pool.parallelFor(count, 1, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++) {
+                        chunks[i].clear();
+                        parseLines(text + starts[first + i], text + starts[first + i + 1], chunks[i]);
+                    }
+                });
+                for (size_t i = 0; i < count; i++)
+                    consume(chunks[i]);
+            }
+        }, settings, pool);
+
+        gla::PointCloudFile output(argv[2]);
+        std::cout << argv[2] << ": " << output.pointCount() << " points, " << output.nodes().size() << " nodes" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}